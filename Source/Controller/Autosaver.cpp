@@ -159,7 +159,7 @@ namespace TrenchBroom {
             
             wxStopWatch watch;
             IO::MapWriter mapWriter;
-            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true);
+            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true, m_document.mapFile());
             m_document.console().debug("Autosaved to %s in %f seconds", backupFilePath.c_str(), watch.Time() / 1000.0f);
         }
         
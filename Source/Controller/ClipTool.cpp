@@ -57,6 +57,14 @@ namespace TrenchBroom {
     }
     
     namespace Controller {
+        namespace ClipToolUniforms {
+            static const Renderer::Uniform CameraPosition("CameraPosition");
+            static const Renderer::Uniform ScalingFactor("ScalingFactor");
+            static const Renderer::Uniform MaximumDistance("MaximumDistance");
+            static const Renderer::Uniform Position("Position");
+            static const Renderer::Uniform Color("Color");
+        }
+
         Vec3f ClipTool::selectNormal(const Vec3f::List& normals1, const Vec3f::List& normals2) const {
             assert(!normals1.empty());
             
@@ -203,11 +211,10 @@ namespace TrenchBroom {
             Vec3f::List normals;
             
             const Model::Brush& brush = *hitFace.brush();
-            const Model::VertexList& vertices = hitFace.vertices();
-            Model::VertexList::const_iterator vIt, vEnd;
-            for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd && !found; ++vIt) {
-                const Model::Vertex& vertex = **vIt;
-                if (hitPoint.equals(vertex.position)) {
+            const Model::SideVertexList vertices = hitFace.vertices();
+            for (size_t i = 0; i < vertices.size() && !found; i++) {
+                const Vec3f& vertex = vertices[i];
+                if (hitPoint.equals(vertex)) {
                     found = true;
                     const Model::FaceList incidentFaces = brush.incidentFaces(vertex);
                     Model::FaceList::const_iterator fIt, fEnd;
@@ -219,13 +226,12 @@ namespace TrenchBroom {
             }
             
             if (!found) {
-                const Model::EdgeList& edges = hitFace.edges();
-                Model::EdgeList::const_iterator eIt, eEnd;
-                for (eIt = edges.begin(), eEnd = edges.end(); eIt != eEnd && !found; ++eIt) {
-                    const Model::Edge& edge = **eIt;
+                const Model::BrushEdgeList edges = hitFace.edges();
+                for (size_t i = 0; i < edges.size() && !found; i++) {
+                    const Model::BrushEdge edge = edges[i];
                     if (edge.contains(hitPoint)) {
-                        normals.push_back(edge.left->face->boundary().normal);
-                        normals.push_back(edge.right->face->boundary().normal);
+                        normals.push_back(edge.leftFace()->boundary().normal);
+                        normals.push_back(edge.rightFace()->boundary().normal);
                         found = true;
                     }
                 }
@@ -373,18 +379,18 @@ namespace TrenchBroom {
             if (m_numPoints > 0 || m_hitIndex > -1) {
                 
                 Renderer::ActivateShader pointHandleShader(renderContext.shaderManager(), Renderer::Shaders::PointHandleShader);
-                pointHandleShader.setUniformVariable("CameraPosition", renderContext.camera().position());
-                pointHandleShader.setUniformVariable("ScalingFactor", prefs.getFloat(Preferences::HandleScalingFactor));
-                pointHandleShader.setUniformVariable("MaximumDistance", prefs.getFloat(Preferences::MaximumHandleDistance));
+                pointHandleShader.setUniformVariable(ClipToolUniforms::CameraPosition, renderContext.camera().position());
+                pointHandleShader.setUniformVariable(ClipToolUniforms::ScalingFactor, prefs.getFloat(Preferences::HandleScalingFactor));
+                pointHandleShader.setUniformVariable(ClipToolUniforms::MaximumDistance, prefs.getFloat(Preferences::MaximumHandleDistance));
 
                 Renderer::SphereFigure sphereFigure(prefs.getFloat(Preferences::HandleRadius), 1);
                 for (unsigned int i = 0; i < m_numPoints; i++) {
-                    pointHandleShader.setUniformVariable("Position", Vec4f(m_points[i], 1.0f));
+                    pointHandleShader.setUniformVariable(ClipToolUniforms::Position, Vec4f(m_points[i], 1.0f));
                     glDisable(GL_DEPTH_TEST);
-                    pointHandleShader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedClipHandleColor));
+                    pointHandleShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::OccludedClipHandleColor));
                     sphereFigure.render(vbo, renderContext);
                     glEnable(GL_DEPTH_TEST);
-                    pointHandleShader.setUniformVariable("Color", prefs.getColor(Preferences::ClipHandleColor));
+                    pointHandleShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::ClipHandleColor));
                     sphereFigure.render(vbo, renderContext);
                 }
                 
@@ -402,12 +408,12 @@ namespace TrenchBroom {
                             glEnable(GL_DEPTH_TEST);
                         }
                     } else {
-                        pointHandleShader.setUniformVariable("Position", Vec4f(m_points[m_hitIndex], 1.0f));
+                        pointHandleShader.setUniformVariable(ClipToolUniforms::Position, Vec4f(m_points[m_hitIndex], 1.0f));
                         glDisable(GL_DEPTH_TEST);
-                        pointHandleShader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedClipHandleColor));
+                        pointHandleShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::OccludedClipHandleColor));
                         sphereFigure.render(vbo, renderContext);
                         glEnable(GL_DEPTH_TEST);
-                        pointHandleShader.setUniformVariable("Color", prefs.getColor(Preferences::ClipHandleColor));
+                        pointHandleShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::ClipHandleColor));
                         sphereFigure.render(vbo, renderContext);
                     }
                 }
@@ -433,16 +439,16 @@ namespace TrenchBroom {
                     
                     Renderer::SetVboState activateVbo(vbo, Renderer::Vbo::VboActive);
                     glDisable(GL_DEPTH_TEST);
-                    planeShader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedClipHandleColor));
+                    planeShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::OccludedClipHandleColor));
                     linesArray->render();
                     glEnable(GL_DEPTH_TEST);
-                    planeShader.setUniformVariable("Color", prefs.getColor(Preferences::ClipHandleColor));
+                    planeShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::ClipHandleColor));
                     linesArray->render();
                     
                     if (m_numPoints == 3) {
                         glDisable(GL_DEPTH_TEST);
                         glDisable(GL_CULL_FACE);
-                        planeShader.setUniformVariable("Color", prefs.getColor(Preferences::ClipPlaneColor));
+                        planeShader.setUniformVariable(ClipToolUniforms::Color, prefs.getColor(Preferences::ClipPlaneColor));
                         triangleArray->render();
                         glEnable(GL_CULL_FACE);
                         glEnable(GL_DEPTH_TEST);
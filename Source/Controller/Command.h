@@ -23,12 +23,13 @@
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
 #include "Model/MapDocument.h"
+#include "Utility/CommandProcessor.h"
 
 #include <wx/cmdproc.h>
 
 namespace TrenchBroom {
     namespace Controller {
-        class Command : public wxCommand {
+        class Command : public CollatableCommand {
         public:
             typedef enum {
                 LoadMap,
@@ -69,6 +70,7 @@ namespace TrenchBroom {
         protected:
             virtual bool performDo() { return true; }
             virtual bool performUndo() { return true; }
+            virtual bool performCollate(Command& command) { return false; }
             virtual void updateViews() {}
         public:
             static wxString makeObjectActionName(const wxString& action, const Model::EntityList& entities, const Model::BrushList& brushes) {
@@ -82,12 +84,12 @@ namespace TrenchBroom {
             }
             
             Command(Type type) :
-            wxCommand(false, ""),
+            CollatableCommand(false, ""),
             m_type(type),
             m_state(None) {}
 
             Command(Type type, bool undoable, const wxString& name) :
-            wxCommand(undoable, name),
+            CollatableCommand(undoable, name),
             m_type(type),
             m_state(None) {}
             
@@ -124,6 +126,17 @@ namespace TrenchBroom {
                 }
                 return result;
             }
+            
+            bool collateWith(CollatableCommand& command) {
+                // every collatable command is a command
+                Command& other = static_cast<Command&>(command);
+                if (m_state != Done || other.state() != None || other.type() != m_type)
+                    return false;
+                if (!performCollate(other))
+                    return false;
+                updateViews();
+                return true;
+            }
         };
         
         class DocumentCommand : public Command {
@@ -260,7 +260,7 @@ namespace TrenchBroom {
                 m_pickRay = m_camera.pickRay(static_cast<float>(m_mouseX), static_cast<float>(m_mouseY));
                 if (m_pickResult != NULL)
                     delete m_pickResult;
-                m_pickResult = m_picker.pick(pickRay());
+                m_pickResult = m_picker.pickCoherent(pickRay());
             }
         
             inline Model::PickResult& pickResult() {
@@ -30,7 +30,6 @@ namespace TrenchBroom {
             if (!canDo())
                 return false;
 
-            m_handleManager.remove(m_brushes);
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             m_edgesAfter.clear();
@@ -44,18 +43,19 @@ namespace TrenchBroom {
             }
 
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectEdgeHandles(m_edgesAfter);
 
             return true;
         }
 
         bool MoveEdgesCommand::performUndo() {
-            m_handleManager.remove(m_brushes);
             document().brushesWillChange(m_brushes);
             restoreSnapshots(m_brushes);
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectEdgeHandles(m_edgesBefore);
             
             return true;
@@ -68,12 +68,12 @@ namespace TrenchBroom {
             const Model::VertexToEdgesMap& brushEdges = m_handleManager.selectedEdgeHandles();
             Model::VertexToEdgesMap::const_iterator mapIt, mapEnd;
             for (mapIt = brushEdges.begin(), mapEnd = brushEdges.end(); mapIt != mapEnd; ++mapIt) {
-                const Model::EdgeList& edges = mapIt->second;
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
+                const Model::BrushEdge::List& edges = mapIt->second;
+                Model::BrushEdge::List::const_iterator edgeIt, edgeEnd;
                 for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    Model::Edge* edge = *edgeIt;
-                    Model::Brush* brush = edge->left->face->brush();
-                    const Model::EdgeInfo edgeInfo = edge->info();
+                    const Model::BrushEdge& edge = *edgeIt;
+                    Model::Brush* brush = edge.leftFace()->brush();
+                    const Model::EdgeInfo edgeInfo = edge.info();
 
                     Model::BrushEdgesMapInsertResult result = m_brushEdges.insert(Model::BrushEdgesMapEntry(brush, Model::EdgeInfoList()));
                     if (result.second)
@@ -29,7 +29,6 @@ namespace TrenchBroom {
             if (!canDo())
                 return false;
 
-            m_handleManager.remove(m_brushes);
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             m_facesAfter.clear();
@@ -43,18 +42,19 @@ namespace TrenchBroom {
             }
 
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectFaceHandles(m_facesAfter);
 
             return true;
         }
 
         bool MoveFacesCommand::performUndo() {
-            m_handleManager.remove(m_brushes);
             document().brushesWillChange(m_brushes);
             restoreSnapshots(m_brushes);
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectFaceHandles(m_facesBefore);
             
             return true;
@@ -27,6 +27,8 @@
 namespace TrenchBroom {
     namespace Controller {
         bool MoveTexturesCommand::performDo() {
+            document().facesWillChange(m_faces);
+            
             Model::FaceList::const_iterator it, end;
             for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
                 Model::Face& face = **it;
@@ -37,6 +39,8 @@ namespace TrenchBroom {
         }
         
         bool MoveTexturesCommand::performUndo() {
+            document().facesWillChange(m_faces);
+            
             Model::FaceList::const_iterator it, end;
             for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
                 Model::Face& face = **it;
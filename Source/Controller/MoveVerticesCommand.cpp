@@ -33,7 +33,6 @@ namespace TrenchBroom {
             if (!canDo())
                 return false;
             
-            m_handleManager.remove(m_brushes);
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
@@ -48,18 +47,19 @@ namespace TrenchBroom {
             }
             
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectVertexHandles(m_verticesAfter);
 
             return true;
         }
         
         bool MoveVerticesCommand::performUndo() {
-            m_handleManager.remove(m_brushes);
             document().brushesWillChange(m_brushes);
             restoreSnapshots(m_brushes);
             document().brushesDidChange(m_brushes);
-            m_handleManager.add(m_brushes);
+            m_handleManager.deselectAll();
+            m_handleManager.update(m_brushes);
             m_handleManager.selectVertexHandles(m_verticesBefore);
 
             return true;
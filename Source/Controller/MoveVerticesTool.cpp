@@ -270,12 +270,12 @@ namespace TrenchBroom {
             HandleHitList::const_iterator it, end;
             for (it = hits.begin(), end = hits.end(); it != end; ++it) {
                 const Model::VertexHandleHit* hit = *it;
-                const Model::EdgeList& edges = m_handleManager.edges(hit->vertex());
+                const Model::BrushEdge::List& edges = m_handleManager.edges(hit->vertex());
                 
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
+                Model::BrushEdge::List::const_iterator edgeIt, edgeEnd;
                 for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    linesRenderer.add(edge.start->position, edge.end->position);
+                    const Model::BrushEdge& edge = *edgeIt;
+                    linesRenderer.add(edge.start(), edge.end());
                 }
             }
         }
@@ -289,12 +289,11 @@ namespace TrenchBroom {
                 Model::FaceList::const_iterator faceIt, faceEnd;
                 for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                     const Model::Face& face = **faceIt;
-                    const Model::EdgeList& edges = face.edges();
+                    const Model::BrushEdgeList edges = face.edges();
                     
-                    Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                    for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                        const Model::Edge& edge = **edgeIt;
-                        linesRenderer.add(edge.start->position, edge.end->position);
+                    for (size_t i = 0; i < edges.size(); i++) {
+                        const Model::BrushEdge edge = edges[i];
+                        linesRenderer.add(edge.start(), edge.end());
                     }
                 }
             }
@@ -20,12 +20,14 @@
 #include "RebuildBrushGeometryCommand.h"
 
 #include "Model/Brush.h"
+#include "Utility/Tracer.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Controller {
         bool RebuildBrushGeometryCommand::performDo() {
+            TRACE_ZONE("RebuildBrushGeometryCommand::performDo");
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             
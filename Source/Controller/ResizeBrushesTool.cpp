@@ -40,6 +40,10 @@ namespace TrenchBroom {
     }
 
     namespace Controller {
+        namespace ResizeBrushesToolUniforms {
+            static const Renderer::Uniform Color("Color");
+        }
+
         Model::FaceList ResizeBrushesTool::dragFaces(Model::Face& dragFace) {
             Model::FaceList result;
             result.push_back(&dragFace);
@@ -75,7 +79,6 @@ namespace TrenchBroom {
                 inputState.pickResult().add(new Model::DragFaceHit(faceHit->hitPoint(), faceHit->distance(), faceHit->face()));
             } else {
                 float closestEdgeDist = std::numeric_limits<float>::max();
-                const Model::Edge* closestEdge = NULL;
                 Model::Face* dragFace = NULL;
                 Vec3f hitPoint;
                 float hitDistance = 0.0f;
@@ -87,36 +90,36 @@ namespace TrenchBroom {
                 Model::BrushList::const_iterator brushIt, brushEnd;
                 for (brushIt = selectedBrushes.begin(), brushEnd = selectedBrushes.end(); brushIt != brushEnd; ++brushIt) {
                     Model::Brush& brush = **brushIt;
-                    const Model::EdgeList& edges = brush.edges();
-                    Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                    for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                        const Model::Edge* edge = *edgeIt;
-
-                        float leftDot = edge->left->face->boundary().normal.dot(inputState.pickRay().direction);
-                        float rightDot = edge->right->face->boundary().normal.dot(inputState.pickRay().direction);
+                    const Model::BrushEdgeList edges = brush.edges();
+                    for (size_t i = 0; i < edges.size(); i++) {
+                        const Model::BrushEdge edge = edges[i];
+                        Model::Face* leftFace = edge.leftFace();
+                        Model::Face* rightFace = edge.rightFace();
+
+                        float leftDot = leftFace->boundary().normal.dot(inputState.pickRay().direction);
+                        float rightDot = rightFace->boundary().normal.dot(inputState.pickRay().direction);
                         if ((leftDot > 0.0f) != (rightDot > 0.0f)) {
                             Vec3f pointOnSegment;
                             float distanceToClosestPointOnRay;
-                            float distanceBetweenRayAndEdge = inputState.pickRay().distanceToSegment(edge->start->position,
-                                                                                                     edge->end->position,
+                            float distanceBetweenRayAndEdge = inputState.pickRay().distanceToSegment(edge.start(),
+                                                                                                     edge.end(),
                                                                                                      pointOnSegment,
                                                                                                      distanceToClosestPointOnRay);
                             if (!Math<float>::isnan(distanceBetweenRayAndEdge) && distanceBetweenRayAndEdge < closestEdgeDist) {
-                                closestEdge = edge;
                                 closestEdgeDist = distanceBetweenRayAndEdge;
                                 hitDistance = distanceToClosestPointOnRay;
                                 hitPoint = inputState.pickRay().pointAtDistance(hitDistance);
                                 if (leftDot > rightDot) {
-                                    dragFace = edge->left->face;
+                                    dragFace = leftFace;
                                 } else {
-                                    dragFace = edge->right->face;
+                                    dragFace = rightFace;
                                 }
                             }
                         }
                     }
                 }
                 
-                if (closestEdge != NULL)
+                if (dragFace != NULL)
                     inputState.pickResult().add(new Model::DragFaceHit(hitPoint, hitDistance, *dragFace));
             }
         }
@@ -150,12 +153,11 @@ namespace TrenchBroom {
 
             for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                 Model::Face& face = **faceIt;
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator eIt, eEnd;
-                for (eIt = edges.begin(), eEnd = edges.end(); eIt != eEnd; ++eIt) {
-                    const Model::Edge& edge = **eIt;
-                    edgeArray.addAttribute(edge.start->position);
-                    edgeArray.addAttribute(edge.end->position);
+                const Model::BrushEdgeList edges = face.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    edgeArray.addAttribute(edge.start());
+                    edgeArray.addAttribute(edge.end());
                 }
             }
 
@@ -165,7 +167,7 @@ namespace TrenchBroom {
             Renderer::ActivateShader shader(renderContext.shaderManager(), Renderer::Shaders::EdgeShader);
 
             glDisable(GL_DEPTH_TEST);
-            shader.setUniformVariable("Color", prefs.getColor(Preferences::ResizeBrushFaceColor));
+            shader.setUniformVariable(ResizeBrushesToolUniforms::Color, prefs.getColor(Preferences::ResizeBrushFaceColor));
             edgeArray.render();
             glEnable(GL_DEPTH_TEST);
 
@@ -44,6 +44,10 @@ namespace TrenchBroom {
     }
 
     namespace Controller {
+        namespace RotateHandleUniforms {
+            static const Renderer::Uniform Color("Color");
+        }
+
         Model::RotateHandleHit* RotateHandle::pickRing(const Rayf& ray, const Vec3f& normal, const Vec3f& axis1, const Vec3f& axis2, Model::RotateHandleHit::HitArea hitArea) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
@@ -95,25 +99,25 @@ namespace TrenchBroom {
                 rotation = rotationMatrix(angle, Vec3f::PosX);
                 Renderer::ApplyModelMatrix applyRotation(context.transformation(), rotation);
 
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 0.25f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 0.25f));
                 Renderer::RingFigure(Axis::AX, yAxis, zAxis, m_ringRadius, m_ringThickness, 8).render(vbo, context);
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 1.0f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 1.0f));
                 Renderer::CircleFigure(Axis::AX, 0.0f, 2.0f * Math<float>::Pi, m_ringRadius + m_ringThickness, 32, false).render(vbo, context);
             } else if (hit->hitArea() == Model::RotateHandleHit::HAYAxis) {
                 rotation = rotationMatrix(angle, Vec3f::PosY);
                 Renderer::ApplyModelMatrix applyRotation(context.transformation(), rotation);
 
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 0.25f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 0.25f));
                 Renderer::RingFigure(Axis::AY, xAxis, zAxis, m_ringRadius, m_ringThickness, 8).render(vbo, context);
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 1.0f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 1.0f));
                 Renderer::CircleFigure(Axis::AY, 0.0f, 2.0f * Math<float>::Pi, m_ringRadius + m_ringThickness, 32, false).render(vbo, context);
             } else {
                 rotation = rotationMatrix(angle, Vec3f::PosZ);
                 Renderer::ApplyModelMatrix applyRotation(context.transformation(), rotation);
 
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 0.25f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 0.25f));
                 Renderer::RingFigure(Axis::AZ, xAxis, yAxis, m_ringRadius, m_ringThickness, 8).render(vbo, context);
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 1.0f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 1.0f));
                 Renderer::CircleFigure(Axis::AZ, 0.0f, 2.0f * Math<float>::Pi, m_ringRadius + m_ringThickness, 32, false).render(vbo, context);
             }
         }
@@ -174,7 +178,7 @@ namespace TrenchBroom {
                 axisFigure.render(vbo, renderContext);
 
                 Renderer::ActivateShader shader(renderContext.shaderManager(), Renderer::Shaders::HandleShader);
-                shader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 0.25f));
+                shader.setUniformVariable(RotateHandleUniforms::Color, Color(1.0f, 1.0f, 1.0f, 0.25f));
 
                 Renderer::RingFigure(Axis::AX, yAxis, zAxis, m_ringRadius, m_ringThickness, 8).render(vbo, renderContext);
                 Renderer::RingFigure(Axis::AY, xAxis, zAxis, m_ringRadius, m_ringThickness, 8).render(vbo, renderContext);
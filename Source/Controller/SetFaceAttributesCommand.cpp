@@ -26,6 +26,7 @@
 namespace TrenchBroom {
     namespace Controller {
         bool SetFaceAttributesCommand::performDo() {
+            document().facesWillChange(m_faces);
             makeSnapshots(m_faces);
             
             Model::FaceList::const_iterator faceIt, faceEnd;
@@ -109,6 +110,7 @@ namespace TrenchBroom {
         }
         
         bool SetFaceAttributesCommand::performUndo() {
+            document().facesWillChange(m_faces);
             restoreSnapshots(m_faces);
             clear();
             
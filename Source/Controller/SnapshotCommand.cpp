@@ -24,12 +24,16 @@
 #include "Model/EntityDefinitionManager.h"
 #include "Model/Face.h"
 #include "Utility/Map.h"
+#include "Utility/MemoryRegistry.h"
+#include "Utility/Tracer.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Controller {
-        
+        // estimated size of the snapshots kept by the command history
+        static Utility::MemoryTag SnapshotMemory("Undo snapshots", Utility::MemoryTag::Unshared);
+
         EntitySnapshot::EntitySnapshot(const Model::Entity& entity) {
             m_uniqueId = entity.uniqueId();
             m_properties = entity.properties();
@@ -42,8 +46,16 @@ namespace TrenchBroom {
         void EntitySnapshot::restore(Model::Entity& entity) {
             entity.setProperties(m_properties, true);
         }
+
+        size_t EntitySnapshot::memorySize() const {
+            size_t size = sizeof(EntitySnapshot) + m_properties.capacity() * sizeof(Model::Property);
+            for (size_t i = 0; i < m_properties.size(); i++)
+                size += m_properties[i].value().capacity();
+            return size;
+        }
         
-        BrushSnapshot::BrushSnapshot(const Model::Brush& brush) {
+        BrushSnapshot::BrushSnapshot(const Model::Brush& brush) :
+        m_geometry(brush.geometry()) {
             m_uniqueId = brush.uniqueId();
             const Model::FaceList& brushFaces = brush.faces();
             for (unsigned int i = 0; i < brushFaces.size(); i++) {
@@ -61,7 +73,11 @@ namespace TrenchBroom {
         }
         
         void BrushSnapshot::restore(Model::Brush& brush) {
-            brush.restore(m_faces);
+            brush.restore(m_faces, m_geometry);
+        }
+
+        size_t BrushSnapshot::memorySize() const {
+            return sizeof(BrushSnapshot) + m_faces.size() * (sizeof(Model::Face*) + sizeof(Model::Face)) + m_geometry.memorySize();
         }
         
         FaceSnapshot::FaceSnapshot(const Model::Face& face) {
@@ -89,25 +105,48 @@ namespace TrenchBroom {
             if (m_texture == NULL)
                 face.setTextureName(m_textureName);
         }
+
+        size_t FaceSnapshot::memorySize() const {
+            return sizeof(FaceSnapshot) + m_textureName.capacity();
+        }
         
         void SnapshotCommand::makeSnapshots(const Model::EntityList& entities) {
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Model::Entity& entity = *entities[i];
-                m_entities[entity.uniqueId()] = new EntitySnapshot(entity);
+                // a command that is redone takes its snapshots again
+                EntitySnapshot*& snapshot = m_entities[entity.uniqueId()];
+                if (snapshot != NULL) {
+                    SnapshotMemory.deallocate(snapshot->memorySize());
+                    delete snapshot;
+                }
+                snapshot = new EntitySnapshot(entity);
+                SnapshotMemory.allocate(snapshot->memorySize());
             }
         }
         
         void SnapshotCommand::makeSnapshots(const Model::BrushList& brushes) {
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush& brush = *brushes[i];
-                m_brushes[brush.uniqueId()] = new BrushSnapshot(brush);
+                BrushSnapshot*& snapshot = m_brushes[brush.uniqueId()];
+                if (snapshot != NULL) {
+                    SnapshotMemory.deallocate(snapshot->memorySize());
+                    delete snapshot;
+                }
+                snapshot = new BrushSnapshot(brush);
+                SnapshotMemory.allocate(snapshot->memorySize());
             }
         }
         
         void SnapshotCommand::makeSnapshots(const Model::FaceList& faces) {
             for (unsigned int i = 0; i < faces.size(); i++) {
                 Model::Face& face = *faces[i];
-                m_faces[face.faceId()] = new FaceSnapshot(face);
+                FaceSnapshot*& snapshot = m_faces[face.faceId()];
+                if (snapshot != NULL) {
+                    SnapshotMemory.deallocate(snapshot->memorySize());
+                    delete snapshot;
+                }
+                snapshot = new FaceSnapshot(face);
+                SnapshotMemory.allocate(snapshot->memorySize());
             }
         }
         
@@ -132,7 +171,8 @@ namespace TrenchBroom {
         
         void SnapshotCommand::restoreSnapshots(const Model::BrushList& brushes) {
             assert(m_brushes.size() == brushes.size());
-            
+            TRACE_ZONE("SnapshotCommand::restoreBrushSnapshots");
+
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush& brush = *brushes[i];
                 BrushSnapshot& snapshot = *m_brushes[brush.uniqueId()];
@@ -154,6 +194,16 @@ namespace TrenchBroom {
         }
 
         void SnapshotCommand::clear() {
+            EntitySnapshotMap::const_iterator entityIt, entityEnd;
+            for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt)
+                SnapshotMemory.deallocate(entityIt->second->memorySize());
+            BrushSnapshotMap::const_iterator brushIt, brushEnd;
+            for (brushIt = m_brushes.begin(), brushEnd = m_brushes.end(); brushIt != brushEnd; ++brushIt)
+                SnapshotMemory.deallocate(brushIt->second->memorySize());
+            FaceSnapshotMap::const_iterator faceIt, faceEnd;
+            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt)
+                SnapshotMemory.deallocate(faceIt->second->memorySize());
+
             Utility::deleteAll(m_entities);
             Utility::deleteAll(m_brushes);
             Utility::deleteAll(m_faces);
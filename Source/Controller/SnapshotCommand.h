@@ -26,6 +26,7 @@
 #include "Model/EntityProperty.h"
 #include "Model/EntityTypes.h"
 #include "Model/FaceTypes.h"
+#include "Model/IndexedBrushGeometry.h"
 #include "Utility/String.h"
 
 
@@ -46,17 +47,20 @@ namespace TrenchBroom {
             EntitySnapshot(const Model::Entity& entity);
             unsigned int uniqueId();
             void restore(Model::Entity& entity);
+            size_t memorySize() const;
         };
         
         class BrushSnapshot {
         private:
             unsigned int m_uniqueId;
             Model::FaceList m_faces;
+            Model::IndexedBrushGeometry m_geometry;
         public:
             BrushSnapshot(const Model::Brush& brush);
             ~BrushSnapshot();
             unsigned int uniqueId();
             void restore(Model::Brush& brush);
+            size_t memorySize() const;
         };
         
         class FaceSnapshot {
@@ -73,6 +77,7 @@ namespace TrenchBroom {
             FaceSnapshot(const Model::Face& face);
             unsigned int faceId();
             void restore(Model::Face& face);
+            size_t memorySize() const;
         };
         
         class SnapshotCommand : public DocumentCommand {
@@ -23,36 +23,44 @@
 #include "Model/Entity.h"
 #include "Model/MapDocument.h"
 #include "Utility/Console.h"
+#include "Utility/Tracer.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Controller {
-        bool TransformObjectsCommand::performDo() {
+        void TransformObjectsCommand::transformObjects(const Mat4f& pointTransform, const Mat4f& vectorTransform, bool invertOrientation) {
             if (!m_entities.empty()) {
-                makeSnapshots(m_entities);
                 document().entitiesWillChange(m_entities);
 
                 Model::EntityList::const_iterator entityIt, entityEnd;
                 for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
                     Model::Entity& entity = **entityIt;
-                    entity.transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+                    entity.transform(pointTransform, vectorTransform, m_lockTextures, invertOrientation);
                 }
                 document().entitiesDidChange(m_entities);
             }
             
             if (!m_brushes.empty()) {
-                makeSnapshots(m_brushes);
+                TRACE_ZONE("TransformObjectsCommand::transformBrushes");
                 document().brushesWillChange(m_brushes);
                 
                 Model::BrushList::const_iterator brushIt, brushEnd;
                 for (brushIt = m_brushes.begin(), brushEnd = m_brushes.end(); brushIt != brushEnd; ++brushIt) {
                     Model::Brush& brush = **brushIt;
-                    brush.transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+                    brush.transform(pointTransform, vectorTransform, m_lockTextures, invertOrientation);
                 }
                 document().brushesDidChange(m_brushes);
             }
+        }
+
+        bool TransformObjectsCommand::performDo() {
+            if (!m_entities.empty())
+                makeSnapshots(m_entities);
+            if (!m_brushes.empty())
+                makeSnapshots(m_brushes);
             
+            transformObjects(m_pointTransform, m_vectorTransform, m_invertOrientation);
             return true;
         }
 
@@ -73,6 +81,21 @@ namespace TrenchBroom {
             return true;
         }
 
+        bool TransformObjectsCommand::performCollate(Command& command) {
+            TransformObjectsCommand& other = static_cast<TransformObjectsCommand&>(command);
+            if (other.m_entities != m_entities ||
+                other.m_brushes != m_brushes ||
+                other.m_lockTextures != m_lockTextures)
+                return false;
+            
+            // the snapshots taken by this command still hold the state before both transformations
+            transformObjects(other.m_pointTransform, other.m_vectorTransform, other.m_invertOrientation);
+            m_pointTransform = other.m_pointTransform * m_pointTransform;
+            m_vectorTransform = other.m_vectorTransform * m_vectorTransform;
+            m_invertOrientation = m_invertOrientation != other.m_invertOrientation;
+            return true;
+        }
+
         TransformObjectsCommand::TransformObjectsCommand(Model::MapDocument& document, const Model::EntityList& entities, const Model::BrushList& brushes, const wxString& name, const Mat4f& pointTransform, const Mat4f& vectorTransform, bool invertOrientation) :
         SnapshotCommand(TransformObjects, document, name),
         m_entities(entities),
@@ -97,7 +120,9 @@ namespace TrenchBroom {
 
         TransformObjectsCommand* TransformObjectsCommand::rotateObjects(Model::MapDocument& document, const Model::EntityList& entities, const Model::BrushList& brushes, const Vec3f& axis, float angle, bool clockwise, const Vec3f& center) {
             const wxString commandName = Command::makeObjectActionName(wxT("Rotate"), entities, brushes);
-            const Mat4f vectorTransform = clockwise ? rotationMatrix(-angle, axis) : rotationMatrix(angle, axis);
+            Mat4f vectorTransform = clockwise ? rotationMatrix(-angle, axis) : rotationMatrix(angle, axis);
+            // keep rotations by multiples of 90 degrees exact so that the translation below is exact, too
+            snapSignedPermutation(vectorTransform, 0.00001f);
             const Mat4f pointTransform = translationMatrix(center) * vectorTransform * translationMatrix(-center);
             return new TransformObjectsCommand(document, entities, brushes, commandName, pointTransform, vectorTransform, false);
         }
@@ -36,13 +36,16 @@ namespace TrenchBroom {
             Model::EntityList m_entities;
             Model::BrushList m_brushes;
             
-            const Mat4f m_pointTransform;
-            const Mat4f m_vectorTransform;
+            Mat4f m_pointTransform;
+            Mat4f m_vectorTransform;
             bool m_lockTextures;
             bool m_invertOrientation;
             
+            void transformObjects(const Mat4f& pointTransform, const Mat4f& vectorTransform, bool invertOrientation);
+            
             bool performDo();
             bool performUndo();
+            bool performCollate(Command& command);
 
             TransformObjectsCommand(Model::MapDocument& document, const Model::EntityList& entities, const Model::BrushList& brushes, const wxString& name, const Mat4f& pointTransform, const Mat4f& vectorTransform, bool invertOrientation);
         public:
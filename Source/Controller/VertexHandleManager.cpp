@@ -22,6 +22,8 @@
 #include "Renderer/LinesRenderer.h"
 #include "Renderer/PointHandleRenderer.h"
 
+#include <limits>
+
 namespace TrenchBroom {
     namespace Model {
         VertexHandleHit::VertexHandleHit(HitType::Type type, const Vec3f& hitPoint, float distance, const Vec3f& vertex) :
@@ -38,6 +40,185 @@ namespace TrenchBroom {
     }
 
     namespace Controller {
+        bool VertexHandleGrid::remove(const Cell& cell, const Vec3f& position, Model::HitType::Type type) {
+            CellMap::iterator cellIt = m_cells.find(cell);
+            if (cellIt == m_cells.end())
+                return false;
+            
+            Vec3f::LexicographicOrder order;
+            HandleList& handles = cellIt->second;
+            HandleList::iterator it, end;
+            for (it = handles.begin(), end = handles.end(); it != end; ++it) {
+                const Handle& handle = *it;
+                if (handle.type == type && !order(handle.position, position) && !order(position, handle.position)) {
+                    handles.erase(it);
+                    if (handles.empty())
+                        m_cells.erase(cellIt);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        VertexHandleGrid::VertexHandleGrid(float cellSize) :
+        m_cellSize(cellSize) {
+            assert(m_cellSize > 0.0f);
+        }
+        
+        void VertexHandleGrid::add(const Vec3f& position, Model::HitType::Type type) {
+            m_cells[cell(position)].push_back(Handle(position, type));
+        }
+        
+        void VertexHandleGrid::remove(const Vec3f& position, Model::HitType::Type type) {
+            const Cell center = cell(position);
+            if (remove(center, position, type))
+                return;
+            
+            // the handle was added at a position which is only almost equal to the given one and may lie in a neighbouring cell
+            for (int x = center.x - 1; x <= center.x + 1; x++)
+                for (int y = center.y - 1; y <= center.y + 1; y++)
+                    for (int z = center.z - 1; z <= center.z + 1; z++)
+                        if (remove(Cell(x, y, z), position, type))
+                            return;
+        }
+        
+        void VertexHandleGrid::clear() {
+            m_cells.clear();
+        }
+        
+        void VertexHandleGrid::RayWalk::addCandidate(const Cell& cell, CandidateList& result) {
+            if (!m_visited.insert(cell).second)
+                return;
+            
+            CellMap::const_iterator it = m_grid.m_cells.find(cell);
+            if (it == m_grid.m_cells.end())
+                return;
+            
+            const float cellSize = m_grid.m_cellSize;
+            const Vec3f center((cell.x + 0.5f) * cellSize, (cell.y + 0.5f) * cellSize, (cell.z + 0.5f) * cellSize);
+            const Vec3f toCenter = center - m_ray.origin;
+            
+            const float distanceToCenter = toCenter.length();
+            if (distanceToCenter - m_cellRadius > m_maxDistance)
+                return;
+            
+            const float distanceOnRay = toCenter.dot(m_ray.direction);
+            if (distanceOnRay < -m_cellRadius)
+                return;
+            
+            // the largest handle radius that any handle in this cell can have
+            const float handleRadius = m_scalingFactor * (distanceToCenter + m_cellRadius);
+            const float distanceToRay = (toCenter - m_ray.direction * distanceOnRay).length();
+            if (distanceToRay > m_cellRadius + handleRadius)
+                return;
+            
+            result.push_back(Candidate(distanceOnRay - m_cellRadius - handleRadius, &it->second));
+        }
+        
+        VertexHandleGrid::RayWalk::RayWalk(const VertexHandleGrid& grid, const Rayf& ray, float scalingFactor, float maxDistance) :
+        m_grid(grid),
+        m_ray(ray),
+        m_scalingFactor(scalingFactor),
+        m_maxDistance(maxDistance),
+        m_cellRadius(0.5f * std::sqrt(3.0f) * grid.m_cellSize),
+        m_current(grid.cell(ray.origin)),
+        m_distance(0.0f) {
+            const float cellSize = m_grid.m_cellSize;
+            // cells farther away than the maximum distance are skipped, so this bounds the handle radius of every candidate
+            const float maxHandleRadius = m_scalingFactor * (m_maxDistance + 2.0f * m_cellRadius);
+            m_reach = static_cast<int>(std::ceil(maxHandleRadius / cellSize));
+            m_margin = 2.0f * (m_reach + 1) * m_cellRadius + maxHandleRadius;
+            
+            const int current[3] = { m_current.x, m_current.y, m_current.z };
+            for (size_t i = 0; i < 3; i++) {
+                const float direction = m_ray.direction[i];
+                if (direction > 0.0f) {
+                    m_step[i] = 1;
+                    m_next[i] = ((current[i] + 1) * cellSize - m_ray.origin[i]) / direction;
+                    m_delta[i] = cellSize / direction;
+                } else if (direction < 0.0f) {
+                    m_step[i] = -1;
+                    m_next[i] = (current[i] * cellSize - m_ray.origin[i]) / direction;
+                    m_delta[i] = -cellSize / direction;
+                } else {
+                    m_step[i] = 0;
+                    m_next[i] = std::numeric_limits<float>::max();
+                    m_delta[i] = std::numeric_limits<float>::max();
+                }
+            }
+        }
+        
+        bool VertexHandleGrid::RayWalk::next(CandidateList& result) {
+            if (m_distance > m_maxDistance)
+                return false;
+            
+            const size_t first = result.size();
+            for (int x = m_current.x - m_reach; x <= m_current.x + m_reach; x++)
+                for (int y = m_current.y - m_reach; y <= m_current.y + m_reach; y++)
+                    for (int z = m_current.z - m_reach; z <= m_current.z + m_reach; z++)
+                        addCandidate(Cell(x, y, z), result);
+            std::sort(result.begin() + static_cast<CandidateList::difference_type>(first), result.end());
+            
+            // step into the neighbouring cell whose boundary the ray crosses first
+            size_t axis = 0;
+            if (m_next[1] < m_next[axis])
+                axis = 1;
+            if (m_next[2] < m_next[axis])
+                axis = 2;
+            
+            m_distance = m_next[axis];
+            m_next[axis] += m_delta[axis];
+            if (axis == 0)
+                m_current.x += m_step[0];
+            else if (axis == 1)
+                m_current.y += m_step[1];
+            else
+                m_current.z += m_step[2];
+            return true;
+        }
+        
+        void VertexHandleGrid::findCandidates(const Rayf& ray, float scalingFactor, float maxDistance, CandidateList& result) const {
+            RayWalk walk(*this, ray, scalingFactor, maxDistance);
+            while (walk.next(result));
+            std::sort(result.begin(), result.end());
+        }
+
+        void VertexHandleManager::collectHandles(Model::Brush& brush, BrushHandles& handles) const {
+            const Vec3f::List& brushVertices = brush.vertices();
+            handles.vertices.reserve(brushVertices.size());
+            Vec3f::List::const_iterator vIt, vEnd;
+            for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
+                const Vec3f& vertex = *vIt;
+                handles.vertices.push_back(VertexHandle(vertex, &brush));
+            }
+            
+            const Model::BrushEdgeList brushEdges = brush.edges();
+            handles.edges.reserve(brushEdges.size());
+            for (size_t i = 0; i < brushEdges.size(); i++) {
+                const Model::BrushEdge edge = brushEdges[i];
+                handles.edges.push_back(EdgeHandle(edge.center(), edge));
+            }
+            
+            const Model::FaceList& brushFaces = brush.faces();
+            handles.faces.reserve(brushFaces.size());
+            Model::FaceList::const_iterator fIt, fEnd;
+            for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
+                Model::Face* face = *fIt;
+                handles.faces.push_back(FaceHandle(face->center(), face));
+            }
+            
+            std::sort(handles.vertices.begin(), handles.vertices.end(), HandleOrder());
+            std::sort(handles.edges.begin(), handles.edges.end(), HandleOrder());
+            std::sort(handles.faces.begin(), handles.faces.end(), HandleOrder());
+        }
+        
+        void VertexHandleManager::updateHandles(const BrushHandles& oldHandles, const BrushHandles& newHandles) {
+            updateElements(oldHandles.vertices, newHandles.vertices, m_selectedVertexHandles, m_unselectedVertexHandles, m_selectedVertexCount, m_totalVertexCount, Model::HitType::VertexHandleHit);
+            updateElements(oldHandles.edges, newHandles.edges, m_selectedEdgeHandles, m_unselectedEdgeHandles, m_selectedEdgeCount, m_totalEdgeCount, Model::HitType::EdgeHandleHit);
+            updateElements(oldHandles.faces, newHandles.faces, m_selectedFaceHandles, m_unselectedFaceHandles, m_selectedFaceCount, m_totalFaceCount, Model::HitType::FaceHandleHit);
+            m_renderStateValid = false;
+        }
+
         void VertexHandleManager::createRenderers() {
             assert(m_selectedHandleRenderer == NULL);
             assert(m_unselectedVertexHandleRenderer == NULL);
@@ -73,6 +254,7 @@ namespace TrenchBroom {
         }
 
         VertexHandleManager::VertexHandleManager() :
+        m_handleGrid(64.0f),
         m_totalVertexCount(0),
         m_selectedVertexCount(0),
         m_totalEdgeCount(0),
@@ -97,14 +279,15 @@ namespace TrenchBroom {
             return Model::EmptyBrushList;
         }
 
-        const Model::EdgeList& VertexHandleManager::edges(const Vec3f& handlePosition) const {
+        const Model::BrushEdge::List& VertexHandleManager::edges(const Vec3f& handlePosition) const {
+
             Model::VertexToEdgesMap::const_iterator mapIt = m_selectedEdgeHandles.find(handlePosition);
             if (mapIt != m_selectedEdgeHandles.end())
                 return mapIt->second;
             mapIt = m_unselectedEdgeHandles.find(handlePosition);
             if (mapIt != m_unselectedEdgeHandles.end())
                 return mapIt->second;
-            return Model::EmptyEdgeList;
+            return Model::EmptyBrushEdgeList;
         }
 
         const Model::FaceList& VertexHandleManager::faces(const Vec3f& handlePosition) const {
@@ -118,51 +301,13 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::add(Model::Brush& brush) {
-            const Model::VertexList& brushVertices = brush.vertices();
-            Model::VertexList::const_iterator vIt, vEnd;
-            for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
-                const Model::Vertex& vertex = **vIt;
-                Model::VertexToBrushesMap::iterator mapIt = m_selectedVertexHandles.find(vertex.position);
-                if (mapIt != m_selectedVertexHandles.end()) {
-                    mapIt->second.push_back(&brush);
-                    m_selectedVertexCount++;
-                } else {
-                    m_unselectedVertexHandles[vertex.position].push_back(&brush);
-                }
-            }
-            m_totalVertexCount += brushVertices.size();
-
-            const Model::EdgeList& brushEdges = brush.edges();
-            Model::EdgeList::const_iterator eIt, eEnd;
-            for (eIt = brushEdges.begin(), eEnd = brushEdges.end(); eIt != eEnd; ++eIt) {
-                Model::Edge& edge = **eIt;
-                Vec3f position = edge.center();
-                Model::VertexToEdgesMap::iterator mapIt = m_selectedEdgeHandles.find(position);
-                if (mapIt != m_selectedEdgeHandles.end()) {
-                    mapIt->second.push_back(&edge);
-                    m_selectedEdgeCount++;
-                } else {
-                    m_unselectedEdgeHandles[position].push_back(&edge);
-                }
-            }
-            m_totalEdgeCount+= brushEdges.size();
-
-            const Model::FaceList& brushFaces = brush.faces();
-            Model::FaceList::const_iterator fIt, fEnd;
-            for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
-                Model::Face& face = **fIt;
-                Vec3f position = face.center();
-                Model::VertexToFacesMap::iterator mapIt = m_selectedFaceHandles.find(position);
-                if (mapIt != m_selectedFaceHandles.end()) {
-                    mapIt->second.push_back(&face);
-                    m_selectedFaceCount++;
-                } else {
-                    m_unselectedFaceHandles[position].push_back(&face);
-                }
-            }
-            m_totalFaceCount += brushFaces.size();
-
-            m_renderStateValid = false;
+            BrushHandles& handles = m_brushHandles[&brush];
+            assert(handles.vertices.empty());
+            
+            BrushHandles newHandles;
+            collectHandles(brush, newHandles);
+            updateHandles(handles, newHandles);
+            std::swap(handles, newHandles);
         }
 
         void VertexHandleManager::add(const Model::BrushList& brushes) {
@@ -172,51 +317,13 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::remove(Model::Brush& brush) {
-            const Model::VertexList& brushVertices = brush.vertices();
-            Model::VertexList::const_iterator vIt, vEnd;
-            for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
-                const Model::Vertex& vertex = **vIt;
-                if (removeHandle(vertex.position, brush, m_selectedVertexHandles)) {
-                    assert(m_selectedVertexCount > 0);
-                    m_selectedVertexCount--;
-                } else {
-                    removeHandle(vertex.position, brush, m_unselectedVertexHandles);
-                }
-            }
-            assert(m_totalVertexCount >= brushVertices.size());
-            m_totalVertexCount -= brushVertices.size();
-
-            const Model::EdgeList& brushEdges = brush.edges();
-            Model::EdgeList::const_iterator eIt, eEnd;
-            for (eIt = brushEdges.begin(), eEnd = brushEdges.end(); eIt != eEnd; ++eIt) {
-                Model::Edge& edge = **eIt;
-                Vec3f position = edge.center();
-                if (removeHandle(position, edge, m_selectedEdgeHandles)) {
-                    assert(m_selectedEdgeCount > 0);
-                    m_selectedEdgeCount--;
-                } else {
-                    removeHandle(position, edge, m_unselectedEdgeHandles);
-                }
-            }
-            assert(m_totalEdgeCount >= brushEdges.size());
-            m_totalEdgeCount -= brushEdges.size();
-
-            const Model::FaceList& brushFaces = brush.faces();
-            Model::FaceList::const_iterator fIt, fEnd;
-            for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
-                Model::Face& face = **fIt;
-                Vec3f position = face.center();
-                if (removeHandle(position, face, m_selectedFaceHandles)) {
-                    assert(m_selectedFaceCount > 0);
-                    m_selectedFaceCount--;
-                } else {
-                    removeHandle(position, face, m_unselectedFaceHandles);
-                }
-            }
-            assert(m_totalFaceCount >= brushFaces.size());
-            m_totalFaceCount -= brushFaces.size();
-
-            m_renderStateValid = false;
+            BrushHandlesMap::iterator it = m_brushHandles.find(&brush);
+            if (it == m_brushHandles.end())
+                return;
+            
+            // use the recorded handles because the brush's geometry may already have changed
+            updateHandles(it->second, BrushHandles());
+            m_brushHandles.erase(it);
         }
 
         void VertexHandleManager::remove(const Model::BrushList& brushes) {
@@ -225,7 +332,28 @@ namespace TrenchBroom {
                 remove(**it);
         }
 
+        void VertexHandleManager::update(Model::Brush& brush) {
+            BrushHandlesMap::iterator it = m_brushHandles.find(&brush);
+            if (it == m_brushHandles.end()) {
+                add(brush);
+                return;
+            }
+            
+            BrushHandles newHandles;
+            collectHandles(brush, newHandles);
+            updateHandles(it->second, newHandles);
+            std::swap(it->second, newHandles);
+        }
+        
+        void VertexHandleManager::update(const Model::BrushList& brushes) {
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                update(**it);
+        }
+
         void VertexHandleManager::clear() {
+            m_brushHandles.clear();
+            m_handleGrid.clear();
             m_unselectedVertexHandles.clear();
             m_selectedVertexHandles.clear();
             m_totalVertexCount = 0;
@@ -306,8 +434,8 @@ namespace TrenchBroom {
             Model::VertexToEdgesMap::const_iterator eIt, eEnd;
             for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
                 const Vec3f& position = eIt->first;
-                const Model::EdgeList& selectedEdges = eIt->second;
-                Model::EdgeList& unselectedEdges = m_unselectedEdgeHandles[position];
+                const Model::BrushEdge::List& selectedEdges = eIt->second;
+                Model::BrushEdge::List& unselectedEdges = m_unselectedEdgeHandles[position];
                 unselectedEdges.insert(unselectedEdges.begin(), selectedEdges.begin(), selectedEdges.end());
             }
             m_selectedEdgeHandles.clear();
@@ -360,56 +488,52 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::pick(const Rayf& ray, Model::PickResult& pickResult, bool splitMode) const {
-            Model::VertexToBrushesMap::const_iterator vIt, vEnd;
-            Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-            Model::VertexToFacesMap::const_iterator fIt, fEnd;
-
-            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode) {
-                for (vIt = m_unselectedVertexHandles.begin(), vEnd = m_unselectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                    const Vec3f& position = vIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
-
-            for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                const Vec3f& position = vIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
-
-            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode) {
-                for (eIt = m_unselectedEdgeHandles.begin(), eEnd = m_unselectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                    const Vec3f& position = eIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const float handleRadius = prefs.getFloat(Preferences::HandleRadius);
+            const float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
+            const float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
+            
+            const bool pickUnselectedVertices = (m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode;
+            const bool pickUnselectedEdges = m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode;
+            const bool pickUnselectedFaces = m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode;
 
-            for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                const Vec3f& position = eIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
+            const float handleScalingFactor = 2.0f * handleRadius * scalingFactor;
+            VertexHandleGrid::RayWalk walk(m_handleGrid, ray, handleScalingFactor, maxDistance);
+            VertexHandleGrid::CandidateList candidates;
 
-            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode) {
-                for (fIt = m_unselectedFaceHandles.begin(), fEnd = m_unselectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                    const Vec3f& position = fIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
+            // once a handle was hit, only handles that overlap it can still yield hits that matter to the tools
+            const float margin = 2.0f * handleScalingFactor * maxDistance;
+            float closestDistance = std::numeric_limits<float>::max();
+            
+            while (walk.distance() <= closestDistance + margin && walk.next(candidates)) {
+                VertexHandleGrid::CandidateList::const_iterator cIt, cEnd;
+                for (cIt = candidates.begin(), cEnd = candidates.end(); cIt != cEnd; ++cIt) {
+                    if (cIt->distance > closestDistance + margin)
+                        continue;
+                    
+                    const VertexHandleGrid::HandleList& handles = *cIt->handles;
+                    VertexHandleGrid::HandleList::const_iterator hIt, hEnd;
+                    for (hIt = handles.begin(), hEnd = handles.end(); hIt != hEnd; ++hIt) {
+                        const VertexHandleGrid::Handle& handle = *hIt;
+                    
+                        bool pickable = false;
+                        if (handle.type == Model::HitType::VertexHandleHit)
+                            pickable = pickUnselectedVertices || m_selectedVertexHandles.count(handle.position) > 0;
+                        else if (handle.type == Model::HitType::EdgeHandleHit)
+                            pickable = pickUnselectedEdges || m_selectedEdgeHandles.count(handle.position) > 0;
+                        else
+                            pickable = pickUnselectedFaces || m_selectedFaceHandles.count(handle.position) > 0;
+                    
+                        if (pickable) {
+                            Model::VertexHandleHit* hit = pickHandle(ray, handle.position, handle.type, handleRadius, scalingFactor, maxDistance);
+                            if (hit != NULL) {
+                                closestDistance = std::min(closestDistance, hit->distance());
+                                pickResult.add(hit);
+                            }
+                        }
+                    }
                 }
-            }
-
-            for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                const Vec3f& position = fIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
+                candidates.clear();
             }
         }
 
@@ -453,11 +577,11 @@ namespace TrenchBroom {
                     const Vec3f& position = eIt->first;
                     m_selectedHandleRenderer->add(position);
                     
-                    const Model::EdgeList& edges = eIt->second;
-                    Model::EdgeList::const_iterator edgeIt, edgeEnd;
+                    const Model::BrushEdge::List& edges = eIt->second;
+                    Model::BrushEdge::List::const_iterator edgeIt, edgeEnd;
                     for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                        const Model::Edge& edge = **edgeIt;
-                        m_selectedEdgeRenderer->add(edge.start->position, edge.end->position);
+                        const Model::BrushEdge& edge = *edgeIt;
+                        m_selectedEdgeRenderer->add(edge.start(), edge.end());
                     }
                 }
 
@@ -476,11 +600,10 @@ namespace TrenchBroom {
                     Model::FaceList::const_iterator faceIt, faceEnd;
                     for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                         const Model::Face& face = **faceIt;
-                        const Model::EdgeList& edges = face.edges();
-                        Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                        for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                            const Model::Edge& edge = **edgeIt;
-                            m_selectedEdgeRenderer->add(edge.start->position, edge.end->position);
+                        const Model::BrushEdgeList edges = face.edges();
+                        for (size_t i = 0; i < edges.size(); i++) {
+                            const Model::BrushEdge edge = edges[i];
+                            m_selectedEdgeRenderer->add(edge.start(), edge.end());
                         }
                     }
                 }
@@ -22,10 +22,18 @@
 
 #include "Model/Brush.h"
 #include "Model/BrushGeometryTypes.h"
+#include "Model/IndexedBrushGeometry.h"
 #include "Model/Picker.h"
 #include "Utility/Preferences.h"
 #include "Utility/VecMath.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -59,8 +67,151 @@ namespace TrenchBroom {
     }
     
     namespace Controller {
+        class VertexHandleGrid {
+        public:
+            struct Handle {
+                Vec3f position;
+                Model::HitType::Type type;
+                
+                Handle(const Vec3f& i_position, Model::HitType::Type i_type) :
+                position(i_position),
+                type(i_type) {}
+            };
+            
+            typedef std::vector<Handle> HandleList;
+            
+            struct Candidate {
+                float distance;
+                const HandleList* handles;
+                
+                Candidate(float i_distance, const HandleList* i_handles) :
+                distance(i_distance),
+                handles(i_handles) {}
+                
+                inline bool operator<(const Candidate& other) const {
+                    return distance < other.distance;
+                }
+            };
+            
+            typedef std::vector<Candidate> CandidateList;
+        private:
+            struct Cell {
+                int x, y, z;
+                
+                Cell(int i_x, int i_y, int i_z) :
+                x(i_x),
+                y(i_y),
+                z(i_z) {}
+                
+                inline bool operator<(const Cell& other) const {
+                    if (x != other.x)
+                        return x < other.x;
+                    if (y != other.y)
+                        return y < other.y;
+                    return z < other.z;
+                }
+            };
+            
+            typedef std::map<Cell, HandleList> CellMap;
+            typedef std::set<Cell> CellSet;
+            
+            float m_cellSize;
+            CellMap m_cells;
+            
+            bool remove(const Cell& cell, const Vec3f& position, Model::HitType::Type type);
+            
+            inline Cell cell(const Vec3f& position) const {
+                return Cell(static_cast<int>(std::floor(position.x() / m_cellSize)),
+                            static_cast<int>(std::floor(position.y() / m_cellSize)),
+                            static_cast<int>(std::floor(position.z() / m_cellSize)));
+            }
+        public:
+            /*
+             Walks the cells along a ray, one cell at a time, and collects the occupied cells around it which might
+             contain a handle hit by the ray. Handles grow with their distance to the ray origin by the given scaling
+             factor, so the cells within the largest handle radius of each visited cell are examined, too. The walk
+             ends at the given maximum distance.
+             */
+            class RayWalk {
+            private:
+                const VertexHandleGrid& m_grid;
+                const Rayf& m_ray;
+                float m_scalingFactor;
+                float m_maxDistance;
+                float m_cellRadius;
+                // the number of neighbouring cells that may contain a handle touching the visited cell
+                int m_reach;
+                // how much smaller the distance of a candidate can be than the distance at which its cell is reached
+                float m_margin;
+                
+                Cell m_current;
+                int m_step[3];
+                float m_next[3];
+                float m_delta[3];
+                float m_distance;
+                CellSet m_visited;
+                
+                void addCandidate(const Cell& cell, CandidateList& result);
+            public:
+                RayWalk(const VertexHandleGrid& grid, const Rayf& ray, float scalingFactor, float maxDistance);
+                
+                /*
+                 Appends the candidates around the next cell on the ray to the given list, sorted by distance.
+                 Returns false if the walk has passed the maximum distance.
+                 */
+                bool next(CandidateList& result);
+                
+                // a lower bound for the distance of all candidates that are yet to be found
+                inline float distance() const {
+                    return m_distance - m_margin;
+                }
+            };
+            
+            friend class RayWalk;
+            
+            VertexHandleGrid(float cellSize);
+            
+            void add(const Vec3f& position, Model::HitType::Type type);
+            void remove(const Vec3f& position, Model::HitType::Type type);
+            void clear();
+            
+            /*
+             Collects the cells which might contain a handle hit by the given ray. The candidates are sorted by the
+             smallest distance at which the ray could hit any of their handles.
+             */
+            void findCandidates(const Rayf& ray, float scalingFactor, float maxDistance, CandidateList& result) const;
+        };
+        
         class VertexHandleManager {
         private:
+            typedef std::pair<Vec3f, Model::Brush*> VertexHandle;
+            typedef std::vector<VertexHandle> VertexHandleList;
+            typedef std::pair<Vec3f, Model::BrushEdge> EdgeHandle;
+            typedef std::vector<EdgeHandle> EdgeHandleList;
+            typedef std::pair<Vec3f, Model::Face*> FaceHandle;
+            typedef std::vector<FaceHandle> FaceHandleList;
+            
+            struct HandleOrder {
+                template <typename Element>
+                inline bool operator()(const std::pair<Vec3f, Element>& lhs, const std::pair<Vec3f, Element>& rhs) const {
+                    Vec3f::LexicographicOrder order;
+                    if (order(lhs.first, rhs.first))
+                        return true;
+                    if (order(rhs.first, lhs.first))
+                        return false;
+                    return lhs.second < rhs.second;
+                }
+            };
+            
+            // the handles that were created for a brush, sorted by HandleOrder
+            struct BrushHandles {
+                VertexHandleList vertices;
+                EdgeHandleList edges;
+                FaceHandleList faces;
+            };
+            
+            typedef std::map<Model::Brush*, BrushHandles> BrushHandlesMap;
+            
             Model::VertexToBrushesMap m_unselectedVertexHandles;
             Model::VertexToBrushesMap m_selectedVertexHandles;
             Model::VertexToEdgesMap m_unselectedEdgeHandles;
@@ -68,6 +219,9 @@ namespace TrenchBroom {
             Model::VertexToFacesMap m_unselectedFaceHandles;
             Model::VertexToFacesMap m_selectedFaceHandles;
             
+            BrushHandlesMap m_brushHandles;
+            VertexHandleGrid m_handleGrid;
+            
             size_t m_totalVertexCount;
             size_t m_selectedVertexCount;
             size_t m_totalEdgeCount;
@@ -83,9 +237,27 @@ namespace TrenchBroom {
             bool m_renderStateValid;
             bool m_recreateRenderers;
             
+            // the elements may already be dangling when they are removed, so they must not be dereferenced here
+            template <typename Element>
+            inline void addElement(const Vec3f& position, const Element& element, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& selected, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& unselected, size_t& selectedCount, Model::HitType::Type type) {
+                typedef std::vector<Element> List;
+                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                
+                typename Map::iterator mapIt = selected.find(position);
+                if (mapIt != selected.end()) {
+                    mapIt->second.push_back(element);
+                    selectedCount++;
+                } else {
+                    List& elements = unselected[position];
+                    if (elements.empty())
+                        m_handleGrid.add(position, type);
+                    elements.push_back(element);
+                }
+            }
+            
             template <typename Element>
-            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map) {
-                typedef std::vector<Element*> List;
+            inline bool removeElement(const Vec3f& position, const Element& element, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& map) {
+                typedef std::vector<Element> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
                 typename Map::iterator mapIt = map.find(position);
@@ -93,7 +265,7 @@ namespace TrenchBroom {
                     return false;
                 
                 List& elements = mapIt->second;
-                typename List::iterator listIt = std::find(elements.begin(), elements.end(), &element);
+                typename List::iterator listIt = std::find(elements.begin(), elements.end(), element);
                 if (listIt == elements.end())
                     return false;
                 
@@ -104,8 +276,42 @@ namespace TrenchBroom {
             }
             
             template <typename Element>
-            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to) {
-                typedef std::vector<Element*> List;
+            inline void removeElement(const Vec3f& position, const Element& element, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& selected, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& unselected, size_t& selectedCount, Model::HitType::Type type) {
+                if (removeElement(position, element, selected)) {
+                    assert(selectedCount > 0);
+                    selectedCount--;
+                } else {
+                    removeElement(position, element, unselected);
+                }
+                
+                if (selected.find(position) == selected.end() &&
+                    unselected.find(position) == unselected.end())
+                    m_handleGrid.remove(position, type);
+            }
+            
+            // only touches the handles which are not contained in both of the given sorted lists
+            template <typename Element>
+            inline void updateElements(const std::vector<std::pair<Vec3f, Element> >& oldHandles, const std::vector<std::pair<Vec3f, Element> >& newHandles, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& selected, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& unselected, size_t& selectedCount, size_t& totalCount, Model::HitType::Type type) {
+                typedef std::vector<std::pair<Vec3f, Element> > HandleList;
+                
+                HandleList removedHandles;
+                HandleList addedHandles;
+                std::set_difference(oldHandles.begin(), oldHandles.end(), newHandles.begin(), newHandles.end(), std::back_inserter(removedHandles), HandleOrder());
+                std::set_difference(newHandles.begin(), newHandles.end(), oldHandles.begin(), oldHandles.end(), std::back_inserter(addedHandles), HandleOrder());
+                
+                typename HandleList::const_iterator it, end;
+                for (it = removedHandles.begin(), end = removedHandles.end(); it != end; ++it)
+                    removeElement(it->first, it->second, selected, unselected, selectedCount, type);
+                for (it = addedHandles.begin(), end = addedHandles.end(); it != end; ++it)
+                    addElement(it->first, it->second, selected, unselected, selectedCount, type);
+                
+                assert(totalCount >= removedHandles.size());
+                totalCount = totalCount - removedHandles.size() + addedHandles.size();
+            }
+            
+            template <typename Element>
+            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& from, std::map<Vec3f, std::vector<Element>, Vec3f::LexicographicOrder >& to) {
+                typedef std::vector<Element> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
                 typename Map::iterator mapIt = from.find(position);
@@ -121,12 +327,7 @@ namespace TrenchBroom {
                 return elementCount;
             }
             
-            inline Model::VertexHandleHit* pickHandle(const Rayf& ray, const Vec3f& position, Model::HitType::Type type) const {
-                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-                float handleRadius = prefs.getFloat(Preferences::HandleRadius);
-                float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
-                float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
-
+            inline Model::VertexHandleHit* pickHandle(const Rayf& ray, const Vec3f& position, Model::HitType::Type type, float handleRadius, float scalingFactor, float maxDistance) const {
                 float distance = ray.intersectWithSphere(position, 2.0f * handleRadius, scalingFactor, maxDistance);
                 if (!Math<float>::isnan(distance)) {
                     Vec3f hitPoint = ray.pointAtDistance(distance);
@@ -136,6 +337,9 @@ namespace TrenchBroom {
                 return NULL;
             }
             
+            void collectHandles(Model::Brush& brush, BrushHandles& handles) const;
+            void updateHandles(const BrushHandles& oldHandles, const BrushHandles& newHandles);
+            
             void createRenderers();
             void destroyRenderers();
         public:
@@ -202,13 +406,16 @@ namespace TrenchBroom {
             }
             
             const Model::BrushList& brushes(const Vec3f& handlePosition) const;
-            const Model::EdgeList& edges(const Vec3f& handlePosition) const;
+            const Model::BrushEdge::List& edges(const Vec3f& handlePosition) const;
             const Model::FaceList& faces(const Vec3f& handlePosition) const;
 
             void add(Model::Brush& brush);
             void add(const Model::BrushList& brushes);
             void remove(Model::Brush& brush);
             void remove(const Model::BrushList& brushes);
+            // updates the handles of brushes whose geometry has changed since they were added
+            void update(Model::Brush& brush);
+            void update(const Model::BrushList& brushes);
             void clear();
 
             void selectVertexHandle(const Vec3f& position);
@@ -0,0 +1,340 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MapCache.h"
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "Model/Brush.h"
+#include "Model/IndexedBrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Utility/List.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace IO {
+        template <typename T>
+        T MapCache::Reader::read() {
+            if (m_cursor + sizeof(T) > m_end)
+                throw IOException::unexpectedEof();
+            T value;
+            memcpy(&value, m_cursor, sizeof(T));
+            m_cursor += sizeof(T);
+            return value;
+        }
+
+        float MapCache::Reader::readFloat() {
+            return read<float>();
+        }
+
+        size_t MapCache::Reader::readIndex(size_t count) {
+            const uint32_t index = read<uint32_t>();
+            if (index >= count)
+                throw IOException("Invalid index %u in map cache", index);
+            return static_cast<size_t>(index);
+        }
+
+        String MapCache::Reader::readString() {
+            const size_t length = static_cast<size_t>(read<uint32_t>());
+            if (m_cursor + length > m_end)
+                throw IOException::unexpectedEof();
+            String str(m_cursor, length);
+            m_cursor += length;
+            return str;
+        }
+
+        template <typename T>
+        void MapCache::write(Buffer& buffer, T value) {
+            const char* data = reinterpret_cast<const char*>(&value);
+            buffer.insert(buffer.end(), data, data + sizeof(T));
+        }
+
+        void MapCache::writeString(Buffer& buffer, const String& str) {
+            write(buffer, static_cast<uint32_t>(str.size()));
+            buffer.insert(buffer.end(), str.begin(), str.end());
+        }
+
+        void MapCache::writeBrush(Buffer& buffer, const Model::Brush& brush) {
+            const Model::FaceList& faces = brush.faces();
+            const Model::IndexedBrushGeometry& geometry = brush.geometry();
+            const Vec3f::List& vertices = geometry.vertices();
+            const Model::IndexedBrushGeometry::EdgeList& edges = geometry.edges();
+            const Model::IndexedBrushGeometry::SideList& sides = geometry.sides();
+
+            write(buffer, static_cast<uint8_t>(brush.forceIntegerFacePoints() ? 1 : 0));
+            write(buffer, static_cast<uint32_t>(brush.fileLine()));
+            write(buffer, static_cast<uint32_t>(brush.fileLineCount()));
+            write(buffer, static_cast<uint64_t>(brush.fileOffset()));
+            write(buffer, static_cast<uint64_t>(brush.fileLength()));
+
+            write(buffer, static_cast<uint32_t>(faces.size()));
+            for (size_t i = 0; i < faces.size(); i++) {
+                const Model::Face& face = *faces[i];
+                for (size_t j = 0; j < 3; j++)
+                    for (size_t k = 0; k < 3; k++)
+                        write(buffer, face.point(j)[k]);
+                const Planef& boundary = face.boundary();
+                for (size_t k = 0; k < 3; k++)
+                    write(buffer, boundary.normal[k]);
+                write(buffer, boundary.distance);
+                writeString(buffer, face.textureName());
+                write(buffer, face.xOffset());
+                write(buffer, face.yOffset());
+                write(buffer, face.rotation());
+                write(buffer, face.xScale());
+                write(buffer, face.yScale());
+                write(buffer, static_cast<uint32_t>(face.filePosition()));
+            }
+
+            write(buffer, static_cast<uint32_t>(vertices.size()));
+            for (size_t i = 0; i < vertices.size(); i++)
+                for (size_t k = 0; k < 3; k++)
+                    write(buffer, vertices[i][k]);
+
+            // the geometry already refers to its elements by index, and uses the same value for missing sides and faces
+            write(buffer, static_cast<uint32_t>(edges.size()));
+            for (size_t i = 0; i < edges.size(); i++) {
+                const Model::IndexedBrushGeometry::IndexedEdge& edge = edges[i];
+                write(buffer, edge.start);
+                write(buffer, edge.end);
+                write(buffer, edge.left);
+                write(buffer, edge.right);
+            }
+
+            write(buffer, static_cast<uint32_t>(sides.size()));
+            for (size_t i = 0; i < sides.size(); i++) {
+                const Model::IndexedBrushGeometry::IndexedSide& side = sides[i];
+                const uint32_t* sideEdges = geometry.sideEdges(i);
+                write(buffer, side.face);
+                write(buffer, side.edgeCount);
+                for (size_t j = 0; j < side.edgeCount; j++)
+                    write(buffer, sideEdges[j]);
+            }
+        }
+
+        void MapCache::writeEntity(Buffer& buffer, const Model::Entity& entity) {
+            write(buffer, static_cast<uint32_t>(entity.fileLine()));
+            write(buffer, static_cast<uint32_t>(entity.fileLineCount()));
+            write(buffer, static_cast<uint64_t>(entity.fileOffset()));
+            write(buffer, static_cast<uint64_t>(entity.fileLength()));
+
+            const Model::PropertyList& properties = entity.properties();
+            write(buffer, static_cast<uint32_t>(properties.size()));
+            for (size_t i = 0; i < properties.size(); i++) {
+                writeString(buffer, properties[i].key());
+                writeString(buffer, properties[i].value());
+            }
+
+            const Model::BrushList& brushes = entity.brushes();
+            write(buffer, static_cast<uint32_t>(brushes.size()));
+            for (size_t i = 0; i < brushes.size(); i++)
+                writeBrush(buffer, *brushes[i]);
+        }
+
+        Model::Brush* MapCache::readBrush(Reader& reader, const Model::Map& map) {
+            const BBoxf& worldBounds = map.worldBounds();
+            Model::FaceList faces;
+
+            try {
+                const bool forceIntegerFacePoints = reader.read<uint8_t>() != 0;
+                const size_t firstLine = static_cast<size_t>(reader.read<uint32_t>());
+                const size_t lineCount = static_cast<size_t>(reader.read<uint32_t>());
+                const size_t fileOffset = static_cast<size_t>(reader.read<uint64_t>());
+                const size_t fileLength = static_cast<size_t>(reader.read<uint64_t>());
+
+                const size_t faceCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < faceCount; i++) {
+                    Model::FacePoints points;
+                    for (size_t j = 0; j < 3; j++)
+                        for (size_t k = 0; k < 3; k++)
+                            points[j][k] = reader.readFloat();
+                    Planef boundary;
+                    for (size_t k = 0; k < 3; k++)
+                        boundary.normal[k] = reader.readFloat();
+                    boundary.distance = reader.readFloat();
+                    const String textureName = reader.readString();
+
+                    Model::Face* face = new Model::Face(worldBounds, forceIntegerFacePoints, points, boundary, textureName);
+                    faces.push_back(face);
+                    face->setXOffset(reader.readFloat());
+                    face->setYOffset(reader.readFloat());
+                    face->setRotation(reader.readFloat());
+                    face->setXScale(reader.readFloat());
+                    face->setYScale(reader.readFloat());
+                    face->setFilePosition(static_cast<size_t>(reader.read<uint32_t>()));
+                }
+
+                Model::IndexedBrushGeometry geometry;
+                const size_t vertexCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < vertexCount; i++) {
+                    const float x = reader.readFloat();
+                    const float y = reader.readFloat();
+                    const float z = reader.readFloat();
+                    geometry.addVertex(Vec3f(x, y, z));
+                }
+
+                // the edges refer to sides that are read later, so their side indices are checked afterwards
+                const size_t edgeCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < edgeCount; i++) {
+                    const uint32_t start = static_cast<uint32_t>(reader.readIndex(vertexCount));
+                    const uint32_t end = static_cast<uint32_t>(reader.readIndex(vertexCount));
+                    const uint32_t left = reader.read<uint32_t>();
+                    const uint32_t right = reader.read<uint32_t>();
+                    geometry.addEdge(start, end, left, right);
+                }
+
+                const size_t sideCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < sideCount; i++) {
+                    const uint32_t faceIndex = reader.read<uint32_t>();
+                    if (faceIndex != NoIndex && faceIndex >= faces.size())
+                        throw IOException("Invalid face index %u in map cache", faceIndex);
+                    geometry.addSide(faceIndex);
+
+                    const size_t sideEdgeCount = static_cast<size_t>(reader.read<uint32_t>());
+                    for (size_t j = 0; j < sideEdgeCount; j++) {
+                        if (!geometry.addSideEdge(static_cast<uint32_t>(reader.readIndex(edgeCount))))
+                            throw IOException("Inconsistent brush topology in map cache");
+                    }
+                }
+
+                const Model::IndexedBrushGeometry::EdgeList& edges = geometry.edges();
+                for (size_t i = 0; i < edgeCount; i++) {
+                    const uint32_t left = edges[i].left;
+                    const uint32_t right = edges[i].right;
+                    if ((left != NoIndex && left >= sideCount) || (right != NoIndex && right >= sideCount))
+                        throw IOException("Invalid side index in map cache");
+                }
+                geometry.finish();
+
+                Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces, geometry);
+                brush->setFilePosition(firstLine, lineCount);
+                brush->setFileRange(fileOffset, fileLength);
+                return brush;
+            } catch (IOException&) {
+                Utility::deleteAll(faces);
+                throw;
+            }
+        }
+
+        Model::Entity* MapCache::readEntity(Reader& reader, const Model::Map& map) {
+            Model::Entity* entity = new Model::Entity(map.worldBounds());
+            try {
+                const size_t firstLine = static_cast<size_t>(reader.read<uint32_t>());
+                const size_t lineCount = static_cast<size_t>(reader.read<uint32_t>());
+                const size_t fileOffset = static_cast<size_t>(reader.read<uint64_t>());
+                const size_t fileLength = static_cast<size_t>(reader.read<uint64_t>());
+
+                const size_t propertyCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < propertyCount; i++) {
+                    const String key = reader.readString();
+                    const String value = reader.readString();
+                    entity->setProperty(key, value);
+                }
+
+                const size_t brushCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < brushCount; i++)
+                    entity->addBrush(*readBrush(reader, map));
+
+                entity->setFilePosition(firstLine, lineCount);
+                entity->setFileRange(fileOffset, fileLength);
+                return entity;
+            } catch (IOException&) {
+                delete entity;
+                throw;
+            }
+        }
+
+        String MapCache::cachePath(const String& mapPath) {
+            FileManager fileManager;
+            return fileManager.appendExtension(mapPath, "tbcache");
+        }
+
+        uint64_t MapCache::hash(const char* begin, const char* end) {
+            // 64 bit FNV-1a
+            uint64_t hash = 14695981039346656037ULL;
+            for (const char* c = begin; c < end; ++c) {
+                hash ^= static_cast<unsigned char>(*c);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        bool MapCache::readMap(const String& path, const char* mapBegin, const char* mapEnd, Model::Map& map) {
+            FileManager fileManager;
+            if (!fileManager.exists(path))
+                return false;
+
+            MappedFile::Ptr file = fileManager.mapFile(path);
+            if (file.get() == NULL)
+                return false;
+
+            Model::EntityList entities;
+            try {
+                Reader reader(file->begin(), file->end());
+                if (reader.read<uint32_t>() != Magic ||
+                    reader.read<uint32_t>() != Version ||
+                    reader.read<uint64_t>() != static_cast<uint64_t>(mapEnd - mapBegin) ||
+                    reader.read<uint64_t>() != hash(mapBegin, mapEnd))
+                    return false;
+
+                const size_t entityCount = static_cast<size_t>(reader.read<uint32_t>());
+                for (size_t i = 0; i < entityCount; i++)
+                    entities.push_back(readEntity(reader, map));
+            } catch (IOException&) {
+                Utility::deleteAll(entities);
+                return false;
+            }
+
+            for (size_t i = 0; i < entities.size(); i++) {
+                map.addEntity(*entities[i]);
+                entities[i]->setModified(false);
+                const Model::BrushList& brushes = entities[i]->brushes();
+                for (size_t j = 0; j < brushes.size(); j++)
+                    brushes[j]->setModified(false);
+            }
+            return true;
+        }
+
+        void MapCache::writeMap(const String& path, const char* mapBegin, const char* mapEnd, const Model::Map& map) {
+            Buffer buffer;
+            write(buffer, Magic);
+            write(buffer, Version);
+            write(buffer, static_cast<uint64_t>(mapEnd - mapBegin));
+            write(buffer, hash(mapBegin, mapEnd));
+
+            const Model::EntityList& entities = map.entities();
+            write(buffer, static_cast<uint32_t>(entities.size()));
+            for (size_t i = 0; i < entities.size(); i++)
+                writeEntity(buffer, *entities[i]);
+
+            FILE* stream = fopen(path.c_str(), "wb");
+            if (stream == NULL)
+                throw IOException::openError(path);
+            const size_t written = fwrite(&buffer[0], 1, buffer.size(), stream);
+            fclose(stream);
+            if (written != buffer.size())
+                throw IOException("Unable to write map cache %s", path.c_str());
+        }
+    }
+}
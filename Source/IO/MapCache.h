@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__MapCache__
+#define __TrenchBroom__MapCache__
+
+#include "Model/EntityTypes.h"
+#include "Utility/String.h"
+
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Entity;
+        class Map;
+    }
+
+    namespace IO {
+        // Stores the fully built map in a binary sidecar file next to the map file so that reopening an unchanged
+        // map neither tokenizes the text nor rebuilds the brush geometry. The cache is keyed by a hash of the map
+        // file's contents and is simply ignored if it is missing, stale or damaged.
+        class MapCache {
+        private:
+            typedef std::vector<char> Buffer;
+
+            static const uint32_t Magic = 0x434D4254; // "TBMC"
+            static const uint32_t Version = 3;
+            static const uint32_t NoIndex = 0xFFFFFFFF;
+
+            class Reader {
+            private:
+                const char* m_cursor;
+                const char* m_end;
+            public:
+                Reader(const char* begin, const char* end) :
+                m_cursor(begin),
+                m_end(end) {}
+
+                template <typename T>
+                T read();
+                float readFloat();
+                size_t readIndex(size_t count);
+                String readString();
+            };
+
+            template <typename T>
+            void write(Buffer& buffer, T value);
+            void writeString(Buffer& buffer, const String& str);
+            void writeBrush(Buffer& buffer, const Model::Brush& brush);
+            void writeEntity(Buffer& buffer, const Model::Entity& entity);
+
+            Model::Brush* readBrush(Reader& reader, const Model::Map& map);
+            Model::Entity* readEntity(Reader& reader, const Model::Map& map);
+        public:
+            static String cachePath(const String& mapPath);
+            static uint64_t hash(const char* begin, const char* end);
+
+            // returns false and leaves the map untouched unless the cache matches the given map file contents
+            bool readMap(const String& path, const char* mapBegin, const char* mapEnd, Model::Map& map);
+            void writeMap(const String& path, const char* mapBegin, const char* mapEnd, const Model::Map& map);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapCache__) */
@@ -27,6 +27,7 @@
 #include "Utility/Console.h"
 #include "Utility/List.h"
 #include "Utility/ProgressIndicator.h"
+#include "Utility/Tracer.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -136,7 +137,8 @@ namespace TrenchBroom {
                 return NULL;
             
             Model::Entity* entity = new Model::Entity(worldBounds);
-            size_t firstLine = token.line();
+            const size_t firstLine = token.line();
+            const size_t firstPosition = token.position();
             
             while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
                 switch (token.type()) {
@@ -179,6 +181,7 @@ namespace TrenchBroom {
                         if (indicator != NULL)
                             indicator->update(static_cast<int>(token.position()));
                         entity->setFilePosition(firstLine, token.line() - firstLine);
+                        entity->setFileRange(firstPosition, token.position() + 1 - firstPosition);
                         return entity;
                     }
                     default:
@@ -205,13 +208,19 @@ namespace TrenchBroom {
         m_size(str.size()) {}
 
         void MapParser::parseMap(Model::Map& map, Utility::ProgressIndicator* indicator) {
+            TRACE_ZONE("MapParser::parseMap");
             Model::Entity* entity = NULL;
             
             if (indicator != NULL) indicator->reset(static_cast<int>(m_size));
             try {
                 FacePointFormat facePointFormat = Unknown;
-                while ((entity = parseEntity(map.worldBounds(), facePointFormat, indicator)) != NULL)
+                while ((entity = parseEntity(map.worldBounds(), facePointFormat, indicator)) != NULL) {
                     map.addEntity(*entity);
+                    entity->setModified(false);
+                    const Model::BrushList& brushes = entity->brushes();
+                    for (size_t i = 0; i < brushes.size(); i++)
+                        brushes[i]->setModified(false);
+                }
             } catch (MapParserException& e) {
                 m_console.error(e.what());
             }
@@ -235,6 +244,7 @@ namespace TrenchBroom {
                 return NULL;
             
             const size_t firstLine = token.line();
+            const size_t firstPosition = token.position();
             Model::FaceList faces;
             
             while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
@@ -252,6 +262,7 @@ namespace TrenchBroom {
                         try {
                             Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces);
                             brush->setFilePosition(firstLine, token.line() - firstLine);
+                            brush->setFileRange(firstPosition, token.position() + 1 - firstPosition);
                             if (!brush->closed())
                                 m_console.warn("Non-closed brush at line %i", firstLine);
                             return brush;
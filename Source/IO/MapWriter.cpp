@@ -29,6 +29,7 @@
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <limits>
@@ -89,16 +90,83 @@ namespace TrenchBroom {
             return 1;
         }
         
-        size_t MapWriter::writeEntity(Model::Entity& entity, const size_t lineNumber, FILE* stream) {
+        static bool copyable(const Model::MapObject& object, const MappedFile* source) {
+            return source != NULL && !object.modified() && object.fileLength() > 0 && object.fileOffset() + object.fileLength() <= source->size();
+        }
+        
+        size_t MapWriter::copyBrush(Model::Brush& brush, const MappedFile& source, const size_t lineNumber, FILE* stream) {
+            const char* begin = source.begin() + brush.fileOffset();
+            const char* end = begin + brush.fileLength();
+            std::fwrite(begin, 1, brush.fileLength(), stream);
+            std::fprintf(stream, "\n");
+            
+            const size_t lineCount = static_cast<size_t>(std::count(begin, end, '\n')) + 1;
+            
+            // the faces keep their line offsets within the brush
+            const size_t firstLine = brush.fileLine();
+            const Model::FaceList& faces = brush.faces();
+            for (unsigned int i = 0; i < faces.size(); i++) {
+                Model::Face& face = *faces[i];
+                face.setFilePosition(face.filePosition() - firstLine + lineNumber);
+            }
+            
+            brush.setFilePosition(lineNumber, brush.fileLineCount());
+            return lineCount;
+        }
+        
+        size_t MapWriter::writeEntity(Model::Entity& entity, const MappedFile* source, bool updateFileRanges, const size_t lineNumber, FILE* stream) {
             size_t lineCount = writeEntityHeader(entity, stream);
             const Model::BrushList& brushes = entity.brushes();
-            for (unsigned int i = 0; i < brushes.size(); i++)
-                lineCount += writeBrush(*brushes[i], lineNumber + lineCount, stream);
+            for (unsigned int i = 0; i < brushes.size(); i++) {
+                Model::Brush& brush = *brushes[i];
+                const long offset = std::ftell(stream);
+                
+                if (copyable(brush, source))
+                    lineCount += copyBrush(brush, *source, lineNumber + lineCount, stream);
+                else
+                    lineCount += writeBrush(brush, lineNumber + lineCount, stream);
+                
+                if (updateFileRanges) {
+                    // the range ends with the closing brace and does not include the following newline
+                    const long length = std::ftell(stream) - offset - 1;
+                    brush.setFileRange(static_cast<size_t>(offset), static_cast<size_t>(length));
+                    brush.setModified(false);
+                }
+            }
             lineCount += writeEntityFooter(stream);
             entity.setFilePosition(lineNumber, lineCount);
             return lineCount;
         }
 
+        size_t MapWriter::copyEntity(Model::Entity& entity, const MappedFile& source, bool updateFileRanges, const size_t lineNumber, FILE* stream) {
+            const long offset = std::ftell(stream);
+            const char* begin = source.begin() + entity.fileOffset();
+            const char* end = begin + entity.fileLength();
+            std::fwrite(begin, 1, entity.fileLength(), stream);
+            std::fprintf(stream, "\n");
+            
+            const size_t lineCount = static_cast<size_t>(std::count(begin, end, '\n')) + 1;
+            
+            // the brushes and faces keep their line and byte offsets within the entity
+            const size_t firstLine = entity.fileLine();
+            const Model::BrushList& brushes = entity.brushes();
+            for (unsigned int i = 0; i < brushes.size(); i++) {
+                Model::Brush& brush = *brushes[i];
+                brush.setFilePosition(brush.fileLine() - firstLine + lineNumber, brush.fileLineCount());
+                if (updateFileRanges)
+                    brush.setFileRange(brush.fileOffset() - entity.fileOffset() + static_cast<size_t>(offset), brush.fileLength());
+                
+                const Model::FaceList& faces = brush.faces();
+                for (unsigned int j = 0; j < faces.size(); j++) {
+                    Model::Face& face = *faces[j];
+                    face.setFilePosition(face.filePosition() - firstLine + lineNumber);
+                }
+            }
+            
+            entity.setFilePosition(lineNumber, lineCount);
+            return lineCount;
+        }
+
         void MapWriter::writeFace(const Model::Face& face, std::ostream& stream) {
             const String textureName = Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
             
@@ -245,7 +313,7 @@ namespace TrenchBroom {
                 writeEntity(*entities[i], stream);
         }
         
-        void MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite) {
+        void MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite, const MappedFile* source, bool updateFileRanges) {
             FileManager fileManager;
             if (fileManager.exists(path) && !overwrite)
                 return;
@@ -254,15 +322,36 @@ namespace TrenchBroom {
             if (!fileManager.exists(directoryPath))
                 fileManager.makeDirectory(directoryPath);
             
-            FILE* stream = fopen(path.c_str(), "w");
+            // binary mode so that copied entities and the recorded byte ranges match the file contents exactly
+            FILE* stream = fopen(path.c_str(), "wb");
             if (stream == NULL)
                 throw IOException::openError(path);
             // std::fstream stream(path.c_str(), std::ios::out | std::ios::trunc);
 
             size_t lineNumber = 1;
             const Model::EntityList& entities = map.entities();
-            for (unsigned int i = 0; i < entities.size(); i++)
-                lineNumber += writeEntity(*entities[i], lineNumber, stream);
+            for (unsigned int i = 0; i < entities.size(); i++) {
+                Model::Entity& entity = *entities[i];
+                const long offset = std::ftell(stream);
+                
+                // an entity can only be copied as a whole if none of its brushes was modified either
+                bool copyWholeEntity = copyable(entity, source);
+                const Model::BrushList& brushes = entity.brushes();
+                for (unsigned int j = 0; j < brushes.size() && copyWholeEntity; j++)
+                    copyWholeEntity = !brushes[j]->modified();
+                
+                if (copyWholeEntity)
+                    lineNumber += copyEntity(entity, *source, updateFileRanges, lineNumber, stream);
+                else
+                    lineNumber += writeEntity(entity, source, updateFileRanges, lineNumber, stream);
+                
+                if (updateFileRanges) {
+                    // the range ends with the closing brace and does not include the following newline
+                    const long length = std::ftell(stream) - offset - 1;
+                    entity.setFileRange(static_cast<size_t>(offset), static_cast<size_t>(length));
+                    entity.setModified(false);
+                }
+            }
             fclose(stream);
         }
     }
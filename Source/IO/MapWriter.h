@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_MapWriter_h
 #define TrenchBroom_MapWriter_h
 
+#include "IO/AbstractFileManager.h"
 #include "Model/EntityTypes.h"
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
@@ -52,7 +53,9 @@ namespace TrenchBroom {
             size_t writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream);
             size_t writeEntityHeader(Model::Entity& entity, FILE* stream);
             size_t writeEntityFooter(FILE* stream);
-            size_t writeEntity(Model::Entity& entity, const size_t lineNumber, FILE* stream);
+            size_t copyBrush(Model::Brush& brush, const MappedFile& source, const size_t lineNumber, FILE* stream);
+            size_t writeEntity(Model::Entity& entity, const MappedFile* source, bool updateFileRanges, const size_t lineNumber, FILE* stream);
+            size_t copyEntity(Model::Entity& entity, const MappedFile& source, bool updateFileRanges, const size_t lineNumber, FILE* stream);
             
             void writeFace(const Model::Face& face, std::ostream& stream);
             void writeBrush(const Model::Brush& brush, std::ostream& stream);
@@ -64,7 +67,10 @@ namespace TrenchBroom {
             void writeObjectsToStream(const Model::EntityList& pointEntities, const Model::BrushList& brushes, std::ostream& stream);
             void writeFacesToStream(const Model::FaceList& faces, std::ostream& stream);
             void writeToStream(const Model::Map& map, std::ostream& stream);
-            void writeToFileAtPath(Model::Map& map, const String& path, bool overwrite);
+            // Unmodified entities and brushes are copied verbatim from the given source file, which must be the file
+            // that their byte ranges refer to. Within a modified entity, only the modified brushes are formatted again.
+            // If updateFileRanges is set, the ranges are changed to refer to the written file.
+            void writeToFileAtPath(Model::Map& map, const String& path, bool overwrite, const MappedFile* source = NULL, bool updateFileRanges = false);
         };
     }
 }
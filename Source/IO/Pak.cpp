@@ -98,6 +98,7 @@ namespace TrenchBroom {
         }
 
         MappedFile::Ptr PakManager::entry(const String& name, const String& searchPath) {
+            wxCriticalSectionLocker lock(m_lock);
             PakList paks;
             if (findPaks(searchPath, paks)) {
                 PakList::reverse_iterator pak, endPak;
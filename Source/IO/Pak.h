@@ -27,6 +27,8 @@
 #include <map>
 #include <vector>
 
+#include <wx/thread.h>
+
 #ifdef _MSC_VER
 #include <cstdint>
 #elif defined __GNUC__
@@ -86,11 +88,13 @@ namespace TrenchBroom {
             }
         };
 
+        // The entity model loaders of all open documents use the shared manager, so its lookups are serialized.
         class PakManager {
         private:
             typedef std::vector<Pak> PakList;
             typedef std::map<String, PakList> PakMap;
 
+            wxCriticalSection m_lock;
             PakMap m_paks;
             bool findPaks(const String& path, PakList& result);
         public:
@@ -21,6 +21,7 @@
 
 #include "IO/IOUtils.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace TrenchBroom {
@@ -61,6 +62,33 @@ namespace TrenchBroom {
             return new Mip(entry.name(), static_cast<unsigned int>(width), static_cast<unsigned int>(height), mip0);
         }
 
+        Mip* Wad::loadMipLevel(const WadEntry& entry, unsigned int level) const throw (IOException) {
+            assert(level < 4);
+            if (entry.type() != WadEntryType::WEMip)
+                throw IOException("Entry %s is not a mip", entry.name().c_str());
+            
+            char* cursor = m_file->begin() + entry.address() + WadLayout::TexWidthOffset;
+            unsigned int width = readUnsignedInt<int32_t>(cursor);
+            unsigned int height = readUnsignedInt<int32_t>(cursor);
+            cursor += level * sizeof(int32_t);
+            unsigned int mipOffset = readUnsignedInt<int32_t>(cursor);
+            
+            if (width == 0 || height == 0)
+                throw IOException("Invalid mip dimensions (%ix%i)", width, height);
+            
+            width = std::max(1u, width >> level);
+            height = std::max(1u, height >> level);
+            unsigned int mipSize = width * height;
+            if (mipOffset + mipSize > entry.length())
+                throw IOException("Mip data beyond wad entry");
+            
+            unsigned char* mipData = new unsigned char[mipSize];
+            cursor = m_file->begin() + entry.address() + mipOffset;
+            readBytes(cursor, mipData, mipSize);
+            
+            return new Mip(entry.name(), width, height, mipData);
+        }
+        
         Wad::Wad(const String& path) throw (IOException) {
             FileManager fileManager;
             m_file = fileManager.mapFile(path);
@@ -109,6 +137,13 @@ namespace TrenchBroom {
             return loadMip(it->second, mipCount);
         }
 
+        Mip* Wad::loadMipLevel(const String& name, unsigned int level) const throw (IOException) {
+            EntryMap::const_iterator it = m_entries.find(name);
+            if (it == m_entries.end())
+                throw IOException("Wad entry %s not found", name.c_str());
+            return loadMipLevel(it->second, level);
+        }
+        
         Mip::List Wad::loadMips(unsigned int mipCount) const throw (IOException) {
             Mip::List mips;
             EntryMap::const_iterator it, end;
@@ -123,10 +123,13 @@ namespace TrenchBroom {
             EntryMap m_entries;
 
             Mip* loadMip(const WadEntry& entry, unsigned int mipCount) const throw (IOException);
+            Mip* loadMipLevel(const WadEntry& entry, unsigned int level) const throw (IOException);
         public:
             Wad(const String& path) throw (IOException);
             
             Mip* loadMip(const String& name, unsigned int mipCount) const throw (IOException);
+            // loads only the given level (0 to 3) of the mip, each level being half the size of the previous one
+            Mip* loadMipLevel(const String& name, unsigned int level) const throw (IOException);
             Mip::List loadMips(unsigned int mipCount) const throw (IOException);
         };
     }
@@ -22,6 +22,7 @@
 #include "Model/AliasNormals.h"
 #include "IO/IOUtils.h"
 #include "Utility/List.h"
+#include "Utility/MemoryRegistry.h"
 
 #include <cassert>
 #include <cmath>
@@ -29,11 +30,17 @@
 
 namespace TrenchBroom {
     namespace Model {
+        static Utility::MemoryTag AliasSkinMemory("Alias skins", Utility::MemoryTag::Shared);
+        static Utility::MemoryTag AliasFrameMemory("Alias frames", Utility::MemoryTag::Shared);
+        // the entity model loaders of several documents may decode the same frame at once
+        static wxCriticalSection FrameDecodeLock;
+
         AliasSkin::AliasSkin(const unsigned char* picture, unsigned int width, unsigned int height) :
         m_width(width),
         m_height(height) {
             m_count = 1;
             m_pictures.push_back(picture);
+            AliasSkinMemory.allocate(m_width * m_height);
         }
 
         AliasSkin::AliasSkin(const AliasPictureList& pictures, const AliasTimeList& times, unsigned int count, unsigned  int width, unsigned int height) :
@@ -43,17 +50,96 @@ namespace TrenchBroom {
         m_width(width),
         m_height(height) {
             assert(m_pictures.size() == m_times.size());
+            AliasSkinMemory.allocate(m_pictures.size() * m_width * m_height);
         }
 
         AliasSkin::~AliasSkin() {
+            AliasSkinMemory.deallocate(m_pictures.size() * m_width * m_height);
             Utility::deleteAll(m_pictures);
         }
 
-        AliasSingleFrame::AliasSingleFrame(const String& name, const AliasFrameTriangleList& triangles, const Vec3f& center, const BBoxf& bounds) :
+        AliasVertexLayout::AliasVertexLayout(const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles) :
+        m_origin(origin),
+        m_scale(scale) {
+            m_frameVertices.reserve(vertices.size());
+            m_texCoords.reserve(vertices.size());
+            for (unsigned int i = 0; i < vertices.size(); i++) {
+                Vec2f texCoords;
+                texCoords[0] = static_cast<float>(vertices[i].s) / static_cast<float>(skinWidth);
+                texCoords[1] = static_cast<float>(vertices[i].t) / static_cast<float>(skinHeight);
+                m_frameVertices.push_back(i);
+                m_texCoords.push_back(texCoords);
+            }
+            
+            // back facing triangles use a copy of their seam vertices shifted to the other half of the skin
+            IndexList backVertices(vertices.size(), 0);
+            m_indices.reserve(3 * triangles.size());
+            for (unsigned int i = 0; i < triangles.size(); i++) {
+                for (unsigned int j = 0; j < 3; j++) {
+                    unsigned int index = triangles[i].vertices[j];
+                    if (vertices[index].onseam && !triangles[i].front) {
+                        if (backVertices[index] == 0) {
+                            backVertices[index] = static_cast<unsigned int>(m_frameVertices.size());
+                            m_frameVertices.push_back(index);
+                            m_texCoords.push_back(Vec2f(m_texCoords[index].x() + 0.5f, m_texCoords[index].y()));
+                        }
+                        index = backVertices[index];
+                    }
+                    m_indices.push_back(index);
+                }
+            }
+        }
+        
+        void AliasSingleFrame::decode() {
+            wxCriticalSectionLocker lock(FrameDecodeLock);
+            if (m_decoded)
+                return;
+            
+            const Vec3f& origin = m_layout.origin();
+            const Vec3f& scale = m_layout.scale();
+            
+            Vec3f::List frameVertices(m_packedVertices.size());
+            for (unsigned int i = 0; i < m_packedVertices.size(); i++)
+                for (size_t j = 0; j < 3; j++)
+                    frameVertices[i][j] = scale[j] * m_packedVertices[i][j] + origin[j];
+            
+            if (!frameVertices.empty()) {
+                m_center = frameVertices[0];
+                m_bounds.min = m_bounds.max = frameVertices[0];
+                for (unsigned int i = 1; i < frameVertices.size(); i++) {
+                    m_center += frameVertices[i];
+                    m_bounds.mergeWith(frameVertices[i]);
+                }
+                m_center /= static_cast<float>(frameVertices.size());
+            } else {
+                m_center = Vec3f::Null;
+                m_bounds.min = m_bounds.max = Vec3f::Null;
+            }
+            
+            const AliasVertexLayout::IndexList& layoutVertices = m_layout.frameVertices();
+            m_positions.resize(layoutVertices.size());
+            m_normals.resize(layoutVertices.size());
+            for (unsigned int i = 0; i < layoutVertices.size(); i++) {
+                const unsigned int index = layoutVertices[i];
+                m_positions[i] = frameVertices[index];
+                m_normals[i] = AliasNormals[m_packedVertices[index][3]];
+            }
+            
+            m_decoded = true;
+            AliasFrameMemory.allocate(decodedSize(), 0);
+        }
+        
+        AliasSingleFrame::AliasSingleFrame(const String& name, const AliasVertexLayout& layout, const AliasPackedFrameVertexList& packedVertices) :
         m_name(name),
-        m_triangles(triangles),
-        m_center(center),
-        m_bounds(bounds) {}
+        m_layout(layout),
+        m_packedVertices(packedVertices),
+        m_decoded(false) {
+            AliasFrameMemory.allocate(m_packedVertices.size() * sizeof(AliasPackedFrameVertex));
+        }
+
+        AliasSingleFrame::~AliasSingleFrame() {
+            AliasFrameMemory.deallocate(m_packedVertices.size() * sizeof(AliasPackedFrameVertex) + decodedSize());
+        }
 
         AliasSingleFrame* AliasSingleFrame::firstFrame() {
             return this;
@@ -63,14 +149,6 @@ namespace TrenchBroom {
         m_times(times),
         m_frames(frames) {
             assert(m_times.size() == m_frames.size());
-
-            if (!m_frames.empty()) {
-                m_bounds = m_frames[0]->bounds();
-                for (size_t i = 1; i < m_frames.size(); i++)
-                    m_bounds.mergeWith(m_frames[i]->bounds());
-            } else {
-                m_bounds.min = m_bounds.max = Vec3f::Null;
-            }
         }
 
         AliasFrameGroup::~AliasFrameGroup() {
@@ -81,71 +159,24 @@ namespace TrenchBroom {
             return m_frames[0];
         }
 
-        Vec3f Alias::unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size) {
-            Vec3f vertex;
-            for (size_t i = 0; i < 3; i++)
-                vertex[i] = size[i] * packedVertex[i] + origin[i];
-            return vertex;
-        }
-
-        AliasSingleFrame* Alias::readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles) {
+        AliasSingleFrame* Alias::readFrame(char*& cursor, unsigned int vertexCount) {
             using namespace IO;
             
             char name[AliasLayout::SimpleFrameLength];
             cursor += AliasLayout::SimpleFrameName;
             readBytes(cursor, name, AliasLayout::SimpleFrameLength);
 
-            std::vector<AliasPackedFrameVertex> packedFrameVertices(vertices.size());
-            readBytes(cursor, reinterpret_cast<char*>(&packedFrameVertices[0]), vertices.size() * 4);
-
-            Vec3f::List frameVertices(vertices.size());
-            Vec3f center;
-            BBoxf bounds;
-
-            frameVertices[0] = unpackFrameVertex(packedFrameVertices[0], origin, scale);
-            center = frameVertices[0];
-            bounds.min = frameVertices[0];
-            bounds.max = frameVertices[0];
-
-            for (unsigned int i = 1; i < vertices.size(); i++) {
-                frameVertices[i] = unpackFrameVertex(packedFrameVertices[i], origin, scale);
-                center += frameVertices[i];
-                bounds.mergeWith(frameVertices[i]);
-            }
-
-            center /= static_cast<float>(vertices.size());
-
-            AliasFrameTriangleList frameTriangles;
-            frameTriangles.reserve(triangles.size());
-            for (unsigned int i = 0; i < triangles.size(); i++) {
-                AliasFrameTriangle* frameTriangle = new AliasFrameTriangle();
-                for (unsigned int j = 0; j < 3; j++) {
-                    size_t index = triangles[i].vertices[j];
-
-                    Vec2f texCoords;
-                    texCoords[0] = static_cast<float>(vertices[index].s) / static_cast<float>(skinWidth);
-                    texCoords[1] = static_cast<float>(vertices[index].t) / static_cast<float>(skinHeight);
-
-                    if (vertices[index].onseam && !triangles[i].front)
-                        texCoords[0] += 0.5f;
-
-                    (*frameTriangle)[j].setPosition(frameVertices[index]);
-                    (*frameTriangle)[j].setNormal(AliasNormals[packedFrameVertices[index][3]]);
-                    (*frameTriangle)[j].setTexCoords(texCoords);
-                }
-
-                frameTriangles.push_back(frameTriangle);
-            }
-
-            return new AliasSingleFrame(name, frameTriangles, center, bounds);
-        }
+            // the vertices are only unpacked when the frame is decoded
+            AliasPackedFrameVertexList packedVertices(vertexCount);
+            if (vertexCount > 0)
+                readBytes(cursor, reinterpret_cast<char*>(&packedVertices[0]), vertexCount * 4);
 
-        AliasSingleFrame::~AliasSingleFrame() {
-            Utility::deleteAll(m_triangles);
+            return new AliasSingleFrame(name, *m_layout, packedVertices);
         }
 
         Alias::Alias(const String& name, char* begin, char* end) :
-        m_name(name) {
+        m_name(name),
+        m_layout(NULL) {
             using namespace IO;
             
             char* cursor = begin + AliasLayout::HeaderScale;
@@ -210,11 +241,13 @@ namespace TrenchBroom {
                     triangles[i].vertices[j] = readUnsignedInt<int32_t>(cursor);
             }
 
+            m_layout = new AliasVertexLayout(origin, scale, skinWidth, skinHeight, vertices, triangles);
+
             // now cursor is at the first frame
             for (unsigned int i = 0; i < frameCount; i++) {
                 int type = readInt<int32_t>(cursor);
                 if (type == 0) { // single frame
-                    m_frames.push_back(readFrame(cursor, origin, scale, skinWidth, skinHeight, vertices, triangles));
+                    m_frames.push_back(readFrame(cursor, vertexCount));
                 } else { // frame group
                     char* base = cursor;
                     unsigned int groupFrameCount = readUnsignedInt<int32_t>(cursor);
@@ -225,8 +258,8 @@ namespace TrenchBroom {
                     AliasTimeList groupFrameTimes(groupFrameCount);
                     AliasSingleFrameList groupFrames(groupFrameCount);
                     for (unsigned int j = 0; j < groupFrameCount; j++) {
-                        groupFrameTimes[i] = readFloat<float>(timeCursor);
-                        groupFrames[j] = readFrame(frameCursor, origin, scale, skinWidth, skinHeight, vertices, triangles);
+                        groupFrameTimes[j] = readFloat<float>(timeCursor);
+                        groupFrames[j] = readFrame(frameCursor, vertexCount);
                     }
 
                     m_frames.push_back(new AliasFrameGroup(groupFrameTimes, groupFrames));
@@ -238,11 +271,14 @@ namespace TrenchBroom {
         Alias::~Alias() {
             Utility::deleteAll(m_frames);
             Utility::deleteAll(m_skins);
+            delete m_layout;
+            m_layout = NULL;
         }
 
         AliasManager* AliasManager::sharedManager = NULL;
 
         Alias const * const AliasManager::alias(const String& name, const StringList& paths, Utility::Console& console) {
+            wxCriticalSectionLocker lock(m_lock);
             String pathList = Utility::join(paths, ",");
             String key = pathList + ":" + name;
 
@@ -29,6 +29,8 @@
 #include <map>
 #include <vector>
 
+#include <wx/thread.h>
+
 #ifdef _MSC_VER
 #include <cstdint>
 #endif
@@ -83,55 +85,47 @@ namespace TrenchBroom {
             }
         };
         
+        typedef std::vector<AliasPackedFrameVertex> AliasPackedFrameVertexList;
+        
         // publicly visible classes below
         
-        class AliasFrameVertex {
+        // The vertex layout shared by all frames of a model. Skin vertices on the seam are split into a front and a
+        // back vertex with different texture coordinates, and each triangle refers to three of the layout vertices.
+        class AliasVertexLayout {
+        public:
+            typedef std::vector<unsigned int> IndexList;
         private:
-            Vec3f m_position;
-            Vec3f m_normal;
-            Vec2f m_texCoords;
+            Vec3f m_origin;
+            Vec3f m_scale;
+            IndexList m_frameVertices;
+            Vec2f::List m_texCoords;
+            IndexList m_indices;
         public:
-            inline const Vec3f& position() const {
-                return m_position;
-            }
+            AliasVertexLayout(const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
             
-            inline void setPosition(const Vec3f& position) {
-                m_position = position;
+            inline const Vec3f& origin() const {
+                return m_origin;
             }
             
-            inline const Vec3f& normal() const {
-                return m_normal;
+            inline const Vec3f& scale() const {
+                return m_scale;
             }
             
-            inline void setNormal(const Vec3f& normal) {
-                m_normal = normal;
+            // the index of the packed frame vertex of each layout vertex
+            inline const IndexList& frameVertices() const {
+                return m_frameVertices;
             }
             
-            inline const Vec2f& texCoords() const {
+            inline const Vec2f::List& texCoords() const {
                 return m_texCoords;
             }
             
-            inline void setTexCoords(const Vec2f& texCoords) {
-                m_texCoords = texCoords;
-            }
-        };
-        
-        class AliasFrameTriangle {
-        private:
-            AliasFrameVertex m_vertices[3];
-        public:
-            inline AliasFrameVertex& operator[] (const size_t index) {
-                assert(index < 3);
-                return m_vertices[index];
-            }
-            
-            inline const AliasFrameVertex& operator[] (const size_t index) const {
-                assert(index < 3);
-                return m_vertices[index];
+            // three layout vertex indices per triangle
+            inline const IndexList& indices() const {
+                return m_indices;
             }
         };
         
-        typedef std::vector<AliasFrameTriangle*> AliasFrameTriangleList;
         typedef std::vector<float> AliasTimeList;
         typedef std::vector<const unsigned char*> AliasPictureList;
         
@@ -173,29 +167,51 @@ namespace TrenchBroom {
         
         typedef std::vector<AliasFrame*> AliasFrameList;
         
+        // Keeps the packed vertices of a frame as they were read and only decodes them into the vertex layout when the
+        // frame is actually used. Frames are shared by all documents, so they are decoded under a lock.
         class AliasSingleFrame : public AliasFrame {
         private:
             String m_name;
-            AliasFrameTriangleList m_triangles;
+            const AliasVertexLayout& m_layout;
+            AliasPackedFrameVertexList m_packedVertices;
+            
+            bool m_decoded;
+            Vec3f::List m_positions;
+            Vec3f::List m_normals;
             Vec3f m_center;
             BBoxf m_bounds;
+            
+            void decode();
+
+            inline size_t decodedSize() const {
+                return (m_positions.capacity() + m_normals.capacity()) * sizeof(Vec3f);
+            }
         public:
-            AliasSingleFrame(const String& name, const AliasFrameTriangleList& triangles, const Vec3f& center, const BBoxf& bounds);
+            AliasSingleFrame(const String& name, const AliasVertexLayout& layout, const AliasPackedFrameVertexList& packedVertices);
             ~AliasSingleFrame();
             
             inline const String& name() const {
                 return m_name;
             }
             
-            inline const AliasFrameTriangleList& triangles() const {
-                return m_triangles;
+            // the positions and normals are indexed like the vertices of the layout
+            inline const Vec3f::List& positions() {
+                decode();
+                return m_positions;
             }
             
-            inline const Vec3f& center() const {
+            inline const Vec3f::List& normals() {
+                decode();
+                return m_normals;
+            }
+            
+            inline const Vec3f& center() {
+                decode();
                 return m_center;
             }
             
-            inline const BBoxf& bounds() const {
+            inline const BBoxf& bounds() {
+                decode();
                 return m_bounds;
             }
             
@@ -206,7 +222,6 @@ namespace TrenchBroom {
         private:
             AliasTimeList m_times;
             AliasSingleFrameList m_frames;
-            BBoxf m_bounds;
         public:
             AliasFrameGroup(const AliasTimeList& times, const AliasSingleFrameList& frames);
             ~AliasFrameGroup();
@@ -216,11 +231,11 @@ namespace TrenchBroom {
         class Alias {
         private:
             String m_name;
+            AliasVertexLayout* m_layout;
             AliasFrameList m_frames;
             AliasSkinList m_skins;
             
-            Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size);
-            AliasSingleFrame* readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
+            AliasSingleFrame* readFrame(char*& cursor, unsigned int vertexCount);
         public:
             Alias(const String& name, char* begin, char* end);
             ~Alias();
@@ -229,6 +244,10 @@ namespace TrenchBroom {
                 return m_name;
             }
             
+            inline const AliasVertexLayout& layout() const {
+                return *m_layout;
+            }
+            
             inline const AliasFrameList& frames() const {
                 return m_frames;
             }
@@ -247,10 +266,12 @@ namespace TrenchBroom {
             }
         };
         
+        // The entity model loaders of all open documents use the shared manager, so its lookups are serialized.
         class AliasManager {
         private:
             typedef std::map<String, Alias*> AliasMap;
             
+            wxCriticalSection m_lock;
             AliasMap m_aliases;
         public:
             static AliasManager* sharedManager;
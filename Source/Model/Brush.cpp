@@ -36,9 +36,31 @@ namespace TrenchBroom {
             m_selectedFaceCount = 0;
         }
 
+        void Brush::setGeometry(const BrushGeometry& geometry) {
+            m_geometry.compact(geometry, m_faces);
+            updateFaceSides();
+        }
+
+        void Brush::updateFaceSides() {
+            for (size_t i = 0; i < m_faces.size(); i++) {
+                m_faces[i]->setSide(NULL);
+                m_faces[i]->setSideIndex(IndexedBrushGeometry::NoIndex);
+            }
+
+            const IndexedBrushGeometry::SideList& sides = m_geometry.sides();
+            for (size_t i = 0; i < sides.size(); i++) {
+                if (sides[i].face != IndexedBrushGeometry::NoIndex)
+                    m_faces[sides[i].face]->setSideIndex(static_cast<uint32_t>(i));
+            }
+        }
+
+        void Brush::clearFaceSides() const {
+            for (size_t i = 0; i < m_faces.size(); i++)
+                m_faces[i]->setSide(NULL);
+        }
+
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
         MapObject(),
-        m_geometry(NULL),
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints) {
             init();
@@ -55,7 +77,6 @@ namespace TrenchBroom {
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate) :
         MapObject(),
-        m_geometry(NULL),
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints) {
             init();
@@ -64,7 +85,6 @@ namespace TrenchBroom {
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const BBoxf& brushBounds, Texture* texture) :
         MapObject(),
-        m_geometry(NULL),
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints) {
             init();
@@ -131,10 +151,25 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
+        Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, const IndexedBrushGeometry& geometry) :
+        MapObject(),
+        m_geometry(geometry),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {
+            init();
+
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->setBrush(this);
+                m_faces.push_back(face);
+            }
+
+            updateFaceSides();
+        }
+
         Brush::~Brush() {
             setEntity(NULL);
-            delete m_geometry;
-            m_geometry = NULL;
             Utility::deleteAll(m_faces);
         }
 
@@ -151,7 +186,24 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
-            rebuildGeometry();
+            // the copied faces have the same boundaries as the template's faces, so its geometry fits them
+            if (!brushTemplate.m_geometry.empty() &&
+                m_worldBounds == brushTemplate.worldBounds() &&
+                m_forceIntegerFacePoints == brushTemplate.forceIntegerFacePoints()) {
+                m_geometry = brushTemplate.m_geometry;
+                updateFaceSides();
+
+                for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
+                    Face* face = *it;
+                    face->invalidateTexAxes();
+                    face->invalidateVertexCache();
+                }
+
+                if (m_entity != NULL)
+                    m_entity->invalidateGeometry();
+            } else {
+                rebuildGeometry();
+            }
         }
 
         void Brush::restore(const FaceList& faces) {
@@ -167,6 +219,31 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
+        void Brush::restore(const FaceList& faces, const IndexedBrushGeometry& geometry) {
+            Utility::deleteAll(m_faces);
+
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->setBrush(this);
+                face->invalidateTexAxes();
+                face->invalidateVertexCache();
+                m_faces.push_back(face);
+            }
+
+            // the geometry of a brush which was not part of an entity has been discarded
+            if (geometry.empty()) {
+                rebuildGeometry();
+                return;
+            }
+
+            m_geometry = geometry;
+            updateFaceSides();
+
+            if (m_entity != NULL)
+                m_entity->invalidateGeometry();
+        }
+
         void Brush::setEntity(Entity* entity) {
             if (entity == m_entity)
                 return;
@@ -176,11 +253,11 @@ namespace TrenchBroom {
                     m_entity->decSelectedBrushCount();
                 else if (hidden())
                     m_entity->decHiddenBrushCount();
-                if (entity == NULL && m_geometry != NULL) {
-                    delete m_geometry;
-                    m_geometry = NULL;
+                if (entity == NULL && !m_geometry.empty()) {
+                    m_geometry.clear();
+                    updateFaceSides();
                 }
-            } else if (entity != NULL && m_geometry == NULL) {
+            } else if (entity != NULL && m_geometry.empty()) {
                 rebuildGeometry();
             }
 
@@ -220,24 +297,73 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
-        void Brush::rebuildGeometry() {
-            delete m_geometry;
-            m_geometry = new BrushGeometry(m_worldBounds);
+        const FaceList Brush::incidentFaces(const Vec3f& vertexPosition) const {
+            FaceList result;
 
-            // sort the faces by the weight of their plane normals like QBSP does
-            Model::FaceList sortedFaces = m_faces;
-            std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(true)));
-            std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(false)));
+            const Vec3f::List& vertices = m_geometry.vertices();
+            const IndexedBrushGeometry::EdgeList& edges = m_geometry.edges();
+            const IndexedBrushGeometry::SideList& sides = m_geometry.sides();
 
-            FaceSet droppedFaces;
-            bool success = m_geometry->addFaces(sortedFaces, droppedFaces);
-            assert(success);
+            uint32_t vertex = IndexedBrushGeometry::NoIndex;
+            for (size_t i = 0; i < vertices.size() && vertex == IndexedBrushGeometry::NoIndex; i++)
+                if (vertices[i] == vertexPosition)
+                    vertex = static_cast<uint32_t>(i);
+            if (vertex == IndexedBrushGeometry::NoIndex)
+                return result;
 
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
-                Face* face = *it;
-                face->setBrush(NULL);
-                m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
-                delete face;
+            // find any edge that is incident to the vertex
+            uint32_t edge = IndexedBrushGeometry::NoIndex;
+            for (size_t i = 0; i < edges.size() && edge == IndexedBrushGeometry::NoIndex; i++)
+                if (edges[i].start == vertex || edges[i].end == vertex)
+                    edge = static_cast<uint32_t>(i);
+            assert(edge != IndexedBrushGeometry::NoIndex);
+
+            // iterate over the incident sides in clockwise order
+            const uint32_t firstSide = edges[edge].start == vertex ? edges[edge].right : edges[edge].left;
+            uint32_t side = firstSide;
+            do {
+                const uint32_t face = sides[side].face;
+                result.push_back(face != IndexedBrushGeometry::NoIndex ? m_faces[face] : NULL);
+
+                const uint32_t* sideEdges = m_geometry.sideEdges(side);
+                const size_t edgeCount = sides[side].edgeCount;
+                size_t i = 0;
+                while (sideEdges[i] != edge)
+                    i++;
+                edge = sideEdges[pred(i, edgeCount)];
+                side = edges[edge].start == vertex ? edges[edge].right : edges[edge].left;
+            } while (side != firstSide);
+
+            return result;
+        }
+
+        void Brush::rebuildGeometry() {
+            Face* boxFaces[6];
+            BBoxf boxBounds;
+            if (BrushGeometry::findBoxFaces(m_faces, m_worldBounds, boxFaces, boxBounds)) {
+                // axis aligned boxes are by far the most common brushes and need no clipping
+                const BrushGeometry geometry(boxBounds, boxFaces);
+                setGeometry(geometry);
+            } else {
+                BrushGeometry geometry(m_worldBounds);
+
+                // sort the faces by the weight of their plane normals like QBSP does
+                Model::FaceList sortedFaces = m_faces;
+                std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(true)));
+                std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(false)));
+
+                FaceSet droppedFaces;
+                bool success = geometry.addFaces(sortedFaces, droppedFaces);
+                assert(success);
+
+                for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
+                    Face* face = *it;
+                    face->setBrush(NULL);
+                    m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
+                    delete face;
+                }
+
+                setGeometry(geometry);
             }
 
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
@@ -250,11 +376,43 @@ namespace TrenchBroom {
                 m_entity->invalidateGeometry();
         }
 
-        void Brush::transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation) {
+        // rotation matrices built with sinf and cosf are off by about 1e-7 for multiples of 90 degrees
+        static const float TransformSnapEpsilon = 0.00001f;
+
+        void Brush::transform(const Mat4f& i_pointTransform, const Mat4f& i_vectorTransform, const bool lockTextures, const bool invertOrientation) {
+            // translations, rotations by multiples of 90 degrees and flips cannot change the topology of the brush
+            Mat4f pointTransform = i_pointTransform;
+            Mat4f vectorTransform = i_vectorTransform;
+            bool keepGeometry = snapSignedPermutation(vectorTransform, TransformSnapEpsilon);
+            if (keepGeometry)
+                keepGeometry = snapSignedPermutation(pointTransform, TransformSnapEpsilon);
+
             FaceList::const_iterator faceIt, faceEnd;
             for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
                 Face& face = **faceIt;
+                const Planef expectedBoundary = face.boundary().transformed(pointTransform, vectorTransform);
                 face.transform(pointTransform, vectorTransform, lockTextures, invertOrientation);
+                
+                // integer face points may have moved the plane
+                if (keepGeometry && !face.boundary().equals(expectedBoundary))
+                    keepGeometry = false;
+            }
+
+            if (keepGeometry) {
+                m_geometry.transform(pointTransform, invertOrientation);
+                
+                // the brush geometry is always clipped against the world bounds
+                if (m_worldBounds.contains(m_geometry.bounds())) {
+                    for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
+                        Face& face = **faceIt;
+                        face.invalidateTexAxes();
+                        face.invalidateVertexCache();
+                    }
+                    
+                    if (m_entity != NULL)
+                        m_entity->invalidateGeometry();
+                    return;
+                }
             }
 
             rebuildGeometry();
@@ -275,7 +433,8 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            m_geometry->correct(newFaces, droppedFaces, epsilon);
+            BrushGeometry geometry(m_geometry, m_faces);
+            geometry.correct(newFaces, droppedFaces, epsilon);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -297,7 +456,8 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            m_geometry->snap(newFaces, droppedFaces, snapTo);
+            BrushGeometry geometry(m_geometry, m_faces);
+            geometry.snap(newFaces, droppedFaces, snapTo);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -324,17 +484,18 @@ namespace TrenchBroom {
             testFace.transform(pointTransform, Mat4f::Identity, false, false);
 
             FaceSet droppedFaces;
+            BrushGeometry::AddFaceBuffers buffers;
             FaceList::const_iterator it, end;
             for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
                 Face* otherFace = *it;
                 if (otherFace != &face)
-                    testGeometry.addFace(*otherFace, droppedFaces);
+                    testGeometry.addFace(*otherFace, droppedFaces, buffers);
             }
 
-            BrushGeometry::CutResult result = testGeometry.addFace(testFace, droppedFaces);
+            BrushGeometry::CutResult result = testGeometry.addFace(testFace, droppedFaces, buffers);
             bool inWorldBounds = m_worldBounds.contains(testGeometry.bounds);
 
-            m_geometry->restoreFaceSides();
+            clearFaceSides();
 
             return inWorldBounds && result == BrushGeometry::Split && droppedFaces.empty();
         }
@@ -348,14 +509,20 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) const {
-            return m_geometry->canMoveVertices(m_worldBounds, vertexPositions, delta);
+            BrushGeometry testGeometry(m_geometry, m_faces);
+            const bool result = testGeometry.canMoveVertices(m_worldBounds, vertexPositions, delta);
+            clearFaceSides();
+            return result;
         }
 
         Vec3f::List Brush::moveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) {
+            assert(canMoveVertices(vertexPositions, delta));
+
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            const Vec3f::List newVertexPositions = m_geometry->moveVertices(m_worldBounds, vertexPositions, delta, newFaces, droppedFaces);
+            BrushGeometry geometry(m_geometry, m_faces);
+            const Vec3f::List newVertexPositions = geometry.moveVertices(m_worldBounds, vertexPositions, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -376,18 +543,25 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            setGeometry(geometry);
             return newVertexPositions;
         }
 
         bool Brush::canMoveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) const {
-            return m_geometry->canMoveEdges(m_worldBounds, edgeInfos, delta);
+            BrushGeometry testGeometry(m_geometry, m_faces);
+            const bool result = testGeometry.canMoveEdges(m_worldBounds, edgeInfos, delta);
+            clearFaceSides();
+            return result;
         }
 
         EdgeInfoList Brush::moveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) {
+            assert(canMoveEdges(edgeInfos, delta));
+
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            const EdgeInfoList newEdgeInfos = m_geometry->moveEdges(m_worldBounds, edgeInfos, delta, newFaces, droppedFaces);
+            BrushGeometry geometry(m_geometry, m_faces);
+            const EdgeInfoList newEdgeInfos = geometry.moveEdges(m_worldBounds, edgeInfos, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -408,18 +582,25 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            setGeometry(geometry);
             return newEdgeInfos;
         }
 
         bool Brush::canMoveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) const {
-            return m_geometry->canMoveFaces(m_worldBounds, faceInfos, delta);
+            BrushGeometry testGeometry(m_geometry, m_faces);
+            const bool result = testGeometry.canMoveFaces(m_worldBounds, faceInfos, delta);
+            clearFaceSides();
+            return result;
         }
 
         FaceInfoList Brush::moveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) {
+            assert(canMoveFaces(faceInfos, delta));
+
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            const FaceInfoList newFaceInfos = m_geometry->moveFaces(m_worldBounds, faceInfos, delta, newFaces, droppedFaces);
+            BrushGeometry geometry(m_geometry, m_faces);
+            const FaceInfoList newFaceInfos = geometry.moveFaces(m_worldBounds, faceInfos, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -440,18 +621,25 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            setGeometry(geometry);
             return newFaceInfos;
         }
 
         bool Brush::canSplitEdge(const EdgeInfo& edge, const Vec3f& delta) const {
-            return m_geometry->canSplitEdge(m_worldBounds, edge, delta);
+            BrushGeometry testGeometry(m_geometry, m_faces);
+            const bool result = testGeometry.canSplitEdge(m_worldBounds, edge, delta);
+            clearFaceSides();
+            return result;
         }
 
         Vec3f Brush::splitEdge(const EdgeInfo& edge, const Vec3f& delta) {
+            assert(canSplitEdge(edge, delta));
+
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            Vec3f newVertexPosition = m_geometry->splitEdge(m_worldBounds, edge, delta, newFaces, droppedFaces);
+            BrushGeometry geometry(m_geometry, m_faces);
+            Vec3f newVertexPosition = geometry.splitEdge(m_worldBounds, edge, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
@@ -472,18 +660,25 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            setGeometry(geometry);
             return newVertexPosition;
         }
 
         bool Brush::canSplitFace(const FaceInfo& faceInfo, const Vec3f& delta) const {
-            return m_geometry->canSplitFace(m_worldBounds, faceInfo, delta);
+            BrushGeometry testGeometry(m_geometry, m_faces);
+            const bool result = testGeometry.canSplitFace(m_worldBounds, faceInfo, delta);
+            clearFaceSides();
+            return result;
         }
 
         Vec3f Brush::splitFace(const FaceInfo& faceInfo, const Vec3f& delta) {
+            assert(canSplitFace(faceInfo, delta));
+
             FaceSet newFaces;
             FaceSet droppedFaces;
 
-            Vec3f newVertexPosition = m_geometry->splitFace(m_worldBounds, faceInfo, delta, newFaces, droppedFaces);
+            BrushGeometry geometry(m_geometry, m_faces);
+            Vec3f newVertexPosition = geometry.splitFace(m_worldBounds, faceInfo, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* dropFace = *it;
@@ -504,6 +699,7 @@ namespace TrenchBroom {
                 m_faces.push_back(newFace);
             }
 
+            setGeometry(geometry);
             return newVertexPosition;
         }
 
@@ -513,16 +709,19 @@ namespace TrenchBroom {
                 return;
 
             dist = Math<float>::nan();
-            Side* side = NULL;
-            for (unsigned int i = 0; i < m_geometry->sides.size() && Math<float>::isnan(dist); i++) {
-                side = m_geometry->sides[i];
-                dist = side->intersectWithRay(ray);
+            Face* face = NULL;
+            const IndexedBrushGeometry::SideList& sides = m_geometry.sides();
+            for (size_t i = 0; i < sides.size() && Math<float>::isnan(dist); i++) {
+                if (sides[i].face != IndexedBrushGeometry::NoIndex) {
+                    face = m_faces[sides[i].face];
+                    dist = m_geometry.intersectSideWithRay(i, face->boundary(), ray);
+                }
             }
 
             if (!Math<float>::isnan(dist)) {
-                assert(side != NULL);
+                assert(face != NULL);
                 Vec3f hitPoint = ray.pointAtDistance(dist);
-                FaceHit* hit = new FaceHit(*(side->face), hitPoint, dist);
+                FaceHit* hit = new FaceHit(*face, hitPoint, dist);
                 pickResults.add(hit);
             }
         }
@@ -550,35 +749,38 @@ namespace TrenchBroom {
 
             FaceList::const_iterator faceIt, faceEnd;
 
-            const VertexList& myVertices = vertices();
+            // the vertices are tested against many axes, so their positions are gathered only once
+            PointBuffer myVertices;
+            PointBuffer theirVertices;
+            collectVertexPositions(vertices(), myVertices);
+            collectVertexPositions(brush.vertices(), theirVertices);
+
             const FaceList& theirFaces = brush.faces();
             for (faceIt = theirFaces.begin(), faceEnd = theirFaces.end(); faceIt != faceEnd; ++faceIt) {
                 const Face& theirFace = **faceIt;
-                const Vec3f& origin = theirFace.vertices().front()->position;
+                const Vec3f& origin = theirFace.vertices().front();
                 const Vec3f& direction = theirFace.boundary().normal;
                 if (vertexStatusFromRay(origin, direction, myVertices) == PointStatus::PSAbove)
                     return false;
             }
 
-            const VertexList& theirVertices = brush.vertices();
             for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
                 const Face& myFace = **faceIt;
-                const Vec3f& origin = myFace.vertices().front()->position;
+                const Vec3f& origin = myFace.vertices().front();
                 const Vec3f& direction = myFace.boundary().normal;
                 if (vertexStatusFromRay(origin, direction, theirVertices) == PointStatus::PSAbove)
                     return false;
             }
 
-            const EdgeList& myEdges = edges();
-            const EdgeList& theirEdges = brush.edges();
-            EdgeList::const_iterator myEdgeIt, myEdgeEnd, theirEdgeIt, theirEdgeEnd;
-            for (myEdgeIt = myEdges.begin(), myEdgeEnd = myEdges.end(); myEdgeIt != myEdgeEnd; ++myEdgeIt) {
-                const Edge& myEdge = **myEdgeIt;
-                for (theirEdgeIt = theirEdges.begin(), theirEdgeEnd = theirEdges.end(); theirEdgeIt != theirEdgeEnd; ++theirEdgeIt) {
-                    const Edge& theirEdge = **theirEdgeIt;
+            const BrushEdgeList myEdges = edges();
+            const BrushEdgeList theirEdges = brush.edges();
+            for (size_t i = 0; i < myEdges.size(); i++) {
+                const BrushEdge myEdge = myEdges[i];
+                for (size_t j = 0; j < theirEdges.size(); j++) {
+                    const BrushEdge theirEdge = theirEdges[j];
                     const Vec3f myEdgeVec = myEdge.vector();
                     const Vec3f theirEdgeVec = theirEdge.vector();
-                    const Vec3f& origin = myEdge.start->position;
+                    const Vec3f& origin = myEdge.start();
                     const Vec3f direction = crossed(myEdgeVec, theirEdgeVec);
 
                     PointStatus::Type myStatus = vertexStatusFromRay(origin, direction, myVertices);
@@ -599,11 +801,11 @@ namespace TrenchBroom {
             if (bounds().contains(brush.bounds()))
                 return false;
 
-            const VertexList& theirVertices = brush.vertices();
-            VertexList::const_iterator vertexIt, vertexEnd;
+            const Vec3f::List& theirVertices = brush.vertices();
+            Vec3f::List::const_iterator vertexIt, vertexEnd;
             for (vertexIt = theirVertices.begin(), vertexEnd = theirVertices.end(); vertexIt != vertexEnd; ++vertexIt) {
-                const Vertex& vertex = **vertexIt;
-                if (!containsPoint(vertex.position))
+                const Vec3f& vertex = *vertexIt;
+                if (!containsPoint(vertex))
                     return false;
             }
 
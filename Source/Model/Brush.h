@@ -24,6 +24,7 @@
 #include "Model/BrushGeometry.h"
 #include "Model/EditState.h"
 #include "Model/FaceTypes.h"
+#include "Model/IndexedBrushGeometry.h"
 #include "Model/MapObject.h"
 #include "Utility/Allocator.h"
 #include "Utility/VecMath.h"
@@ -44,7 +45,7 @@ namespace TrenchBroom {
         protected:
             class Entity* m_entity;
             FaceList m_faces;
-            BrushGeometry* m_geometry;
+            IndexedBrushGeometry m_geometry;
 
             unsigned int m_selectedFaceCount;
 
@@ -52,14 +53,21 @@ namespace TrenchBroom {
             bool m_forceIntegerFacePoints;
 
             void init();
+            void setGeometry(const BrushGeometry& geometry);
+            void updateFaceSides();
+            void clearFaceSides() const;
         public:
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const BBoxf& brushBounds, Texture* texture);
+            // the sides of the given geometry must refer to the given faces by their index
+            Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, const IndexedBrushGeometry& geometry);
             ~Brush();
 
             void restore(const Brush& brushTemplate, bool checkId = false);
             void restore(const FaceList& faces);
+            // restores the given faces and a geometry which was stored together with them
+            void restore(const FaceList& faces, const IndexedBrushGeometry& geometry);
 
             inline MapObject::Type objectType() const {
                 return MapObject::BrushObject;
@@ -99,38 +107,30 @@ namespace TrenchBroom {
             
             void setForceIntegerFacePoints(bool forceIntegerFacePoints);
             
+            inline const IndexedBrushGeometry& geometry() const {
+                return m_geometry;
+            }
+
             inline const Vec3f& center() const {
-                return m_geometry->center;
+                return m_geometry.center();
             }
 
             inline const BBoxf& bounds() const {
-                return m_geometry->bounds;
+                return m_geometry.bounds();
             }
 
-            inline const VertexList& vertices() const {
-                return m_geometry->vertices;
+            inline const Vec3f::List& vertices() const {
+                return m_geometry.vertices();
             }
 
-            inline const FaceList incidentFaces(const Vertex& vertex) const {
-                const SideList sides = m_geometry->incidentSides(&vertex);
-                FaceList result;
-                result.reserve(sides.size());
-
-                SideList::const_iterator it, end;
-                for (it = sides.begin(), end = sides.end(); it != end; ++it) {
-                    const Side& side = **it;
-                    result.push_back(side.face);
-                }
-
-                return result;
-            }
+            const FaceList incidentFaces(const Vec3f& vertexPosition) const;
 
-            inline const EdgeList& edges() const {
-                return m_geometry->edges;
+            inline BrushEdgeList edges() const {
+                return BrushEdgeList(m_geometry, m_faces);
             }
 
             inline bool closed() const {
-                return m_geometry->closed();
+                return m_geometry.closed();
             }
 
             void rebuildGeometry();
@@ -20,10 +20,13 @@
 #include "BrushGeometry.h"
 
 #include "Model/Face.h"
+#include "Model/IndexedBrushGeometry.h"
 #include "Utility/List.h"
 
+#include <algorithm>
 #include <map>
 #include <cstdio>
+#include <functional>
 
 namespace TrenchBroom {
     namespace Model {
@@ -150,76 +153,6 @@ namespace TrenchBroom {
 			mark = Side::Drop;
 		}
 
-        float Side::intersectWithRay(const Rayf& ray) {
-            if (face == NULL)
-                return Math<float>::nan();
-
-            const Planef& boundary = face->boundary();
-            float dot = boundary.normal.dot(ray.direction);
-            if (!Math<float>::neg(dot))
-                return Math<float>::nan();
-
-            float dist = boundary.intersectWithRay(ray);
-            if (Math<float>::isnan(dist))
-                return Math<float>::nan();
-
-            const CoordinatePlanef& cPlane = CoordinatePlanef::plane(boundary.normal);
-
-            const Vec3f hit = ray.pointAtDistance(dist);
-            const Vec3f projectedHit = cPlane.swizzle(hit);
-
-            const Vertex* vertex = vertices.back();
-            Vec3f v0 = cPlane.swizzle(vertex->position) - projectedHit;
-
-            int c = 0;
-            for (unsigned int i = 0; i < vertices.size(); i++) {
-                vertex = vertices[i];
-                Vec3f v1 = cPlane.swizzle(vertex->position) - projectedHit;
-
-                if ((Math<float>::zero(v0.x()) && Math<float>::zero(v0.y())) ||
-                    (Math<float>::zero(v1.x()) && Math<float>::zero(v1.y()))) {
-                    // the point is identical to a polygon vertex, cancel search
-                    c = 1;
-                    break;
-                }
-
-                /*
-                 * A polygon edge intersects with the positive X axis if the
-                 * following conditions are met: The Y coordinates of its
-                 * vertices must have different signs (we assign a negative sign
-                 * to 0 here in order to count it as a negative number) and one
-                 * of the following two conditions must be met: Either the X
-                 * coordinates of the vertices are both positive or the X
-                 * coordinates of the edge have different signs (again, we
-                 * assign a negative sign to 0 here). In the latter case, we
-                 * must calculate the point of intersection between the edge and
-                 * the X axis and determine whether its X coordinate is positive
-                 * or zero.
-                 */
-
-                // do the Y coordinates have different signs?
-                if ((v0.y() > 0.0f && v1.y() <= 0.0f) || (v0.y() <= 0.0f && v1.y() > 0.0f)) {
-                    // Is segment entirely on the positive side of the X axis?
-                    if (v0.x() > 0.0f && v1.x() > 0.0f) {
-                        c += 1; // edge intersects with the X axis
-                        // if not, do the X coordinates have different signs?
-                    } else if ((v0.x() > 0.0f && v1.x() <= 0.0f) || (v0.x() <= 0.0f && v1.x() > 0.0f)) {
-                        // calculate the point of intersection between the edge
-                        // and the X axis
-                        const float x = -v0.y() * (v1.x() - v0.x()) / (v1.y() - v0.y()) + v0.x();
-                        if (x >= 0)
-                            c += 1; // edge intersects with the X axis
-                    }
-                }
-
-                v0 = v1;
-            }
-
-            if (c % 2 == 0)
-                return Math<float>::nan();
-            return dist;
-        }
-
         void Side::replaceEdges(size_t index1, size_t index2, Edge* edge) {
             VertexList::iterator vIt1, vIt2;
             EdgeList::iterator eIt1, eIt2;
@@ -1036,58 +969,6 @@ namespace TrenchBroom {
             return newVertex;
         }
 
-        void BrushGeometry::copy(const BrushGeometry& original) {
-            std::map<Vertex*, Vertex*> vertexMap;
-            std::map<Edge*, Edge*> edgeMap;
-
-            Utility::deleteAll(vertices);
-            Utility::deleteAll(edges);
-            Utility::deleteAll(sides);
-
-            vertices.reserve(original.vertices.size());
-            edges.reserve(original.edges.size());
-            sides.reserve(original.sides.size());
-
-            for (size_t i = 0; i < original.vertices.size(); i++) {
-                Vertex* originalVertex = original.vertices[i];
-                Vertex* copyVertex = new Vertex(*originalVertex);
-                vertexMap[originalVertex] = copyVertex;
-                vertices.push_back(copyVertex);
-            }
-
-            for (size_t i = 0; i < original.edges.size(); i++) {
-                Edge* originalEdge = original.edges[i];
-                Edge* copyEdge = new Edge(*originalEdge);
-                copyEdge->start = vertexMap[originalEdge->start];
-                copyEdge->end = vertexMap[originalEdge->end];
-                edgeMap[originalEdge] = copyEdge;
-                edges.push_back(copyEdge);
-            }
-
-            for (size_t i = 0; i < original.sides.size(); i++) {
-                Side* originalSide = original.sides[i];
-                Side* copySide = new Side(*originalSide);
-                copySide->vertices.clear();
-                copySide->edges.clear();
-
-                for (size_t j = 0; j < originalSide->edges.size(); j++) {
-                    Edge* originalEdge = originalSide->edges[j];
-                    Edge* copyEdge = edgeMap[originalEdge];
-
-                    if (originalEdge->left == originalSide)
-                        copyEdge->left = copySide;
-                    else
-                        copyEdge->right = copySide;
-                    copySide->edges.push_back(copyEdge);
-                    copySide->vertices.push_back(copyEdge->startVertex(copySide));
-                }
-
-                sides.push_back(copySide);
-            }
-
-            bounds = original.bounds;
-        }
-
         bool BrushGeometry::sanityCheck() {
             // check Euler characteristic http://en.wikipedia.org/wiki/Euler_characteristic
             unsigned int sideCount = 0;
@@ -1184,7 +1065,7 @@ namespace TrenchBroom {
             return true;
         }
 
-        BrushGeometry::BrushGeometry(const BBoxf& i_bounds) {
+        void BrushGeometry::initBox(const BBoxf& i_bounds) {
             Vertex* lfd = new Vertex(i_bounds.min.x(), i_bounds.min.y(), i_bounds.min.z());
             Vertex* lfu = new Vertex(i_bounds.min.x(), i_bounds.min.y(), i_bounds.max.z());
             Vertex* lbd = new Vertex(i_bounds.min.x(), i_bounds.max.y(), i_bounds.min.z());
@@ -1265,16 +1146,123 @@ namespace TrenchBroom {
             this->center = centerOfVertices(vertices);
         }
 
-        BrushGeometry::BrushGeometry(const BrushGeometry& original) {
-            copy(original);
+        bool BrushGeometry::findBoxFaces(const FaceList& faces, const BBoxf& worldBounds, Face* boxFaces[6], BBoxf& boxBounds) {
+            if (faces.size() != 6)
+                return false;
+
+            for (size_t i = 0; i < 6; i++)
+                boxFaces[i] = NULL;
+
+            for (size_t i = 0; i < 6; i++) {
+                Face* face = faces[i];
+                const Planef& boundary = face->boundary();
+                const Vec3f& normal = boundary.normal;
+
+                size_t axis = 3;
+                for (size_t j = 0; j < 3; j++) {
+                    if (normal[j] == 1.0f || normal[j] == -1.0f)
+                        axis = j;
+                    else if (normal[j] != 0.0f)
+                        return false;
+                }
+                if (axis == 3)
+                    return false;
+
+                // the box sides are ordered left, right, front, back, top, down
+                const bool positive = normal[axis] > 0.0f;
+                size_t index;
+                if (axis == 2)
+                    index = positive ? 4 : 5;
+                else
+                    index = 2 * axis + (positive ? 1 : 0);
+                if (boxFaces[index] != NULL)
+                    return false;
+                boxFaces[index] = face;
+
+                if (positive)
+                    boxBounds.max[axis] = boundary.distance;
+                else
+                    boxBounds.min[axis] = -boundary.distance;
+            }
+
+            for (size_t i = 0; i < 3; i++) {
+                if (boxBounds.min[i] >= boxBounds.max[i] ||
+                    boxBounds.min[i] <= worldBounds.min[i] ||
+                    boxBounds.max[i] >= worldBounds.max[i])
+                    return false;
+            }
+            return true;
         }
 
-        BrushGeometry::BrushGeometry(const Model::VertexList& i_vertices, const Model::EdgeList& i_edges, const Model::SideList& i_sides) :
-        vertices(i_vertices),
-        edges(i_edges),
-        sides(i_sides) {
+        BrushGeometry::BrushGeometry(const BBoxf& i_bounds) {
+            initBox(i_bounds);
+        }
+
+        BrushGeometry::BrushGeometry(const BBoxf& boxBounds, Face* boxFaces[6]) {
+            initBox(boxBounds);
+            for (size_t i = 0; i < vertices.size(); i++)
+                vertices[i]->position.correct();
             bounds = boundsOfVertices(vertices);
             center = centerOfVertices(vertices);
+
+            for (size_t i = 0; i < 6; i++) {
+                sides[i]->face = boxFaces[i];
+                boxFaces[i]->setSide(sides[i]);
+            }
+        }
+
+        BrushGeometry::BrushGeometry(const IndexedBrushGeometry& geometry, const FaceList& faces) {
+            const Vec3f::List& positions = geometry.vertices();
+            const IndexedBrushGeometry::EdgeList& indexedEdges = geometry.edges();
+            const IndexedBrushGeometry::SideList& indexedSides = geometry.sides();
+
+            vertices.reserve(positions.size());
+            edges.reserve(indexedEdges.size());
+            sides.reserve(indexedSides.size());
+
+            for (size_t i = 0; i < positions.size(); i++) {
+                Vertex* vertex = new Vertex();
+                vertex->position = positions[i];
+                vertex->mark = Vertex::Unknown;
+                vertices.push_back(vertex);
+            }
+
+            for (size_t i = 0; i < indexedSides.size(); i++) {
+                Side* side = new Side();
+                side->mark = Side::Unknown;
+                sides.push_back(side);
+            }
+
+            for (size_t i = 0; i < indexedEdges.size(); i++) {
+                const IndexedBrushGeometry::IndexedEdge& indexedEdge = indexedEdges[i];
+                Edge* edge = new Edge(vertices[indexedEdge.start], vertices[indexedEdge.end]);
+                edge->left = indexedEdge.left != IndexedBrushGeometry::NoIndex ? sides[indexedEdge.left] : NULL;
+                edge->right = indexedEdge.right != IndexedBrushGeometry::NoIndex ? sides[indexedEdge.right] : NULL;
+                edge->mark = Edge::Unknown;
+                edges.push_back(edge);
+            }
+
+            for (size_t i = 0; i < indexedSides.size(); i++) {
+                const IndexedBrushGeometry::IndexedSide& indexedSide = indexedSides[i];
+                const uint32_t* sideEdges = geometry.sideEdges(i);
+                const SideVertexList sideVertices = geometry.sideVertices(i);
+
+                Side* side = sides[i];
+                side->edges.reserve(indexedSide.edgeCount);
+                side->vertices.reserve(indexedSide.edgeCount);
+                for (size_t j = 0; j < indexedSide.edgeCount; j++) {
+                    side->edges.push_back(edges[sideEdges[j]]);
+                    side->vertices.push_back(vertices[sideVertices.vertexIndex(j)]);
+                }
+
+                if (indexedSide.face != IndexedBrushGeometry::NoIndex) {
+                    side->face = faces[indexedSide.face];
+                    side->face->setSide(side);
+                }
+            }
+
+            center = geometry.center();
+            bounds = geometry.bounds();
         }
 
         BrushGeometry::~BrushGeometry() {
@@ -1290,12 +1278,39 @@ namespace TrenchBroom {
             return true;
         }
 
-        void BrushGeometry::restoreFaceSides() {
-            for (unsigned int i = 0; i < sides.size(); i++)
-                sides[i]->face->setSide(sides[i]);
+        void BrushGeometry::transform(const Mat4f& pointTransform, bool invertOrientation) {
+            for (unsigned int i = 0; i < vertices.size(); i++) {
+                Vertex& vertex = *vertices[i];
+                vertex.position = pointTransform * vertex.position;
+                vertex.position.correct();
+            }
+
+            if (invertOrientation) {
+                // a mirrored side's vertices appear in clockwise order, so every edge changes its sides and every
+                // side reverses its edges
+                for (unsigned int i = 0; i < edges.size(); i++) {
+                    Edge& edge = *edges[i];
+                    std::swap(edge.left, edge.right);
+                }
+
+                for (unsigned int i = 0; i < sides.size(); i++) {
+                    Side& side = *sides[i];
+                    std::reverse(side.edges.begin(), side.edges.end());
+                    for (unsigned int j = 0; j < side.edges.size(); j++)
+                        side.vertices[j] = side.edges[j]->startVertex(&side);
+                }
+            }
+
+            bounds = boundsOfVertices(vertices);
+            center = centerOfVertices(vertices);
         }
 
         BrushGeometry::CutResult BrushGeometry::addFace(Face& face, FaceSet& droppedFaces) {
+            AddFaceBuffers buffers;
+            return addFace(face, droppedFaces, buffers);
+        }
+
+        BrushGeometry::CutResult BrushGeometry::addFace(Face& face, FaceSet& droppedFaces, AddFaceBuffers& buffers) {
             // if all of the face's points are on a previous face, it's a duplicate
             for (size_t i = 0; i < sides.size(); i++) {
                 const Side& side = *sides[i];
@@ -1314,30 +1329,27 @@ namespace TrenchBroom {
             
             Planef boundary = face.boundary();
 
-            unsigned int keep = 0;
-            unsigned int drop = 0;
-            unsigned int undecided = 0;
-
             // mark vertices
+            PointBuffer& positions = buffers.positions;
+            collectVertexPositions(vertices, positions);
+
+            std::vector<PointStatus::Type>& statuses = buffers.statuses;
+            statuses.resize(vertices.size());
+            const PointBuffer::Counts counts = positions.classify(boundary, 0.1f, &statuses[0]);
             for (size_t i = 0; i < vertices.size(); i++) {
                 Vertex& vertex = *vertices[i];
-                PointStatus::Type vs = boundary.pointStatus(vertex.position, 0.1f);
-                if (vs == PointStatus::PSAbove) {
+                if (statuses[i] == PointStatus::PSAbove)
                     vertex.mark = Vertex::Drop;
-                    drop++;
-                } else if (vs == PointStatus::PSBelow) {
-                    vertex.mark  = Vertex::Keep;
-                    keep++;
-                } else {
+                else if (statuses[i] == PointStatus::PSBelow)
+                    vertex.mark = Vertex::Keep;
+                else
                     vertex.mark = Vertex::Undecided;
-                    undecided++;
-                }
             }
 
-            if (keep + undecided == vertices.size())
+            if (counts.above == 0)
                 return Redundant;
 
-            if (drop + undecided == vertices.size())
+            if (counts.below == 0)
                 return Null;
 
             // mark and split edges
@@ -1448,8 +1460,9 @@ namespace TrenchBroom {
         }
 
         bool BrushGeometry::addFaces(const FaceList& faces, FaceSet& droppedFaces) {
+            AddFaceBuffers buffers;
             for (size_t i = 0; i < faces.size(); i++) {
-                CutResult result = addFace(*faces[i], droppedFaces);
+                CutResult result = addFace(*faces[i], droppedFaces, buffers);
                 if (result == Redundant)
                     droppedFaces.insert(faces[i]);
                 else if (result == Null)
@@ -1547,9 +1560,6 @@ namespace TrenchBroom {
         bool BrushGeometry::canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) {
             FaceManager faceManager;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
-
             Vec3f::List sortedVertexPositions = vertexPositions;
             std::sort(sortedVertexPositions.begin(), sortedVertexPositions.end(), Vec3f::InverseDotOrder(delta));
 
@@ -1557,26 +1567,23 @@ namespace TrenchBroom {
             Vec3f::List::const_iterator vertexIt, vertexEnd;
             for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd && canMove; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
+                Vertex* vertex = findVertex(vertices, vertexPosition);
                 assert(vertex != NULL);
 
                 const Vec3f start = vertex->position;
                 const Vec3f end = start + delta;
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, true, start, end, faceManager);
+                MoveVertexResult result = moveVertex(vertex, true, start, end, faceManager);
                 canMove = result.type != MoveVertexResult::VertexUnchanged;
             }
 
-            canMove &= testGeometry.sides.size() >= 3;
-            canMove &= worldBounds.contains(testGeometry.bounds);
+            canMove &= sides.size() >= 3;
+            canMove &= worldBounds.contains(bounds);
 
-            restoreFaceSides();
             return canMove;
         }
 
         Vec3f::List BrushGeometry::moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveVertices(worldBounds, vertexPositions, delta));
-
             FaceManager faceManager;
             VertexList movedVertices;
             Vec3f::List sortedVertexPositions = vertexPositions;
@@ -1609,9 +1616,6 @@ namespace TrenchBroom {
         bool BrushGeometry::canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta) {
             FaceManager faceManager;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
-
             Vec3f::List sortedVertexPositions;
             EdgeInfoList::const_iterator edgeIt, edgeEnd;
             for (edgeIt = edgeInfos.begin(), edgeEnd = edgeInfos.end(); edgeIt != edgeEnd; ++edgeIt) {
@@ -1625,7 +1629,7 @@ namespace TrenchBroom {
             Vec3f::List::const_iterator vertexIt, vertexEnd;
             for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
+                Vertex* vertex = findVertex(vertices, vertexPosition);
                 if (vertex == NULL) {
                     canMove = false;
                     break;
@@ -1634,7 +1638,7 @@ namespace TrenchBroom {
                 const Vec3f start = vertex->position;
                 const Vec3f end = start + delta;
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, faceManager);
+                MoveVertexResult result = moveVertex(vertex, false, start, end, faceManager);
                 if (result.type != MoveVertexResult::VertexMoved) {
                     canMove = false;
                     break;
@@ -1643,19 +1647,16 @@ namespace TrenchBroom {
 
             for (edgeIt = edgeInfos.begin(), edgeEnd = edgeInfos.end(); edgeIt != edgeEnd && canMove; ++edgeIt) {
                 const EdgeInfo& edgeInfo = *edgeIt;
-                canMove = findEdge(testGeometry.edges, edgeInfo.start + delta, edgeInfo.end + delta) != NULL;
+                canMove = findEdge(edges, edgeInfo.start + delta, edgeInfo.end + delta) != NULL;
             }
 
-            canMove &= testGeometry.sides.size() >= 3;
-            canMove &= worldBounds.contains(testGeometry.bounds);
+            canMove &= sides.size() >= 3;
+            canMove &= worldBounds.contains(bounds);
 
-            restoreFaceSides();
             return canMove;
         }
 
         EdgeInfoList BrushGeometry::moveEdges(const BBoxf& worldBounds, const EdgeInfoList& i_edges, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveEdges(worldBounds, i_edges, delta));
-
             FaceManager faceManager;
             Vec3f::List sortedVertexPositions;
             EdgeInfoList::const_iterator edgeIt, edgeEnd;
@@ -1696,9 +1697,6 @@ namespace TrenchBroom {
         bool BrushGeometry::canMoveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta) {
             FaceManager faceManager;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
-
             Vec3f::List sortedVertexPositions;
             FaceInfoList::const_iterator faceIt, faceEnd;
             for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd; ++faceIt) {
@@ -1713,7 +1711,7 @@ namespace TrenchBroom {
             Vec3f::List::const_iterator vertexIt, vertexEnd;
             for (vertexIt = sortedVertexPositions.begin(), vertexEnd = sortedVertexPositions.end(); vertexIt != vertexEnd; ++vertexIt) {
                 const Vec3f& vertexPosition = *vertexIt;
-                Vertex* vertex = findVertex(testGeometry.vertices, vertexPosition);
+                Vertex* vertex = findVertex(vertices, vertexPosition);
                 if (vertex == NULL) {
                     canMove = false;
                     break;
@@ -1722,29 +1720,26 @@ namespace TrenchBroom {
                 const Vec3f start = vertex->position;
                 const Vec3f end = start + delta;
 
-                MoveVertexResult result = testGeometry.moveVertex(vertex, false, start, end, faceManager);
+                MoveVertexResult result = moveVertex(vertex, false, start, end, faceManager);
                 if (result.type != MoveVertexResult::VertexMoved) {
                     canMove = false;
                     break;
                 }
             }
 
-            canMove &= testGeometry.sides.size() >= 3;
-            canMove &= worldBounds.contains(testGeometry.bounds);
+            canMove &= sides.size() >= 3;
+            canMove &= worldBounds.contains(bounds);
 
             for (faceIt = faceInfos.begin(), faceEnd = faceInfos.end(); faceIt != faceEnd; ++faceIt) {
                 const FaceInfo& faceInfo = *faceIt;
                 const FaceInfo translated = faceInfo.translated(delta);
-                canMove = findSide(testGeometry.sides, translated.vertices) != NULL;
+                canMove = findSide(sides, translated.vertices) != NULL;
             }
 
-            restoreFaceSides();
             return canMove;
         }
 
         FaceInfoList BrushGeometry::moveFaces(const BBoxf& worldBounds, const FaceInfoList& faceInfos, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canMoveFaces(worldBounds, faceInfos, delta));
-
             FaceManager faceManager;
             Vec3f::List sortedVertexPositions;
             FaceInfoList::const_iterator faceIt, faceEnd;
@@ -1801,28 +1796,18 @@ namespace TrenchBroom {
 
             FaceManager faceManager;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
-
-            // The given edge is not an edge of testGeometry!
-            Edge* testEdge = findEdge(testGeometry.edges, edgeInfo.start, edgeInfo.end);
-            assert(testEdge != NULL);
-
-            Vertex* newVertex = testGeometry.splitEdge(testEdge);
+            Vertex* newVertex = splitEdge(edge);
             const Vec3f start = newVertex->position;
             const Vec3f end = start + delta;
-            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, faceManager);
+            MoveVertexResult result = moveVertex(newVertex, false, start, end, faceManager);
             bool canSplit = result.type == MoveVertexResult::VertexMoved;
-            canSplit &= testGeometry.sides.size() >= 3;
-            canSplit &= worldBounds.contains(testGeometry.bounds);
+            canSplit &= sides.size() >= 3;
+            canSplit &= worldBounds.contains(bounds);
 
-            restoreFaceSides();
             return canSplit;
         }
 
         Vec3f BrushGeometry::splitEdge(const BBoxf& worldBounds, const EdgeInfo& edgeInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canSplitEdge(worldBounds, edgeInfo, delta));
-
             Edge* edge = findEdge(edges, edgeInfo.start, edgeInfo.end);
 
             FaceManager faceManager;
@@ -1852,24 +1837,18 @@ namespace TrenchBroom {
 
             FaceManager faceManager;
 
-            BrushGeometry testGeometry(*this);
-            testGeometry.restoreFaceSides();
-
-            Vertex* newVertex = testGeometry.splitFace(face, faceManager);
+            Vertex* newVertex = splitFace(face, faceManager);
             const Vec3f start = newVertex->position;
             const Vec3f end = start + delta;
-            MoveVertexResult result = testGeometry.moveVertex(newVertex, false, start, end, faceManager);
+            MoveVertexResult result = moveVertex(newVertex, false, start, end, faceManager);
             bool canSplit = result.type == MoveVertexResult::VertexMoved;
-            canSplit &= testGeometry.sides.size() >= 3;
-            canSplit &= worldBounds.contains(testGeometry.bounds);
+            canSplit &= sides.size() >= 3;
+            canSplit &= worldBounds.contains(bounds);
 
-            restoreFaceSides();
             return canSplit;
         }
 
         Vec3f BrushGeometry::splitFace(const BBoxf& worldBounds, const FaceInfo& faceInfo, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces) {
-            assert(canSplitFace(worldBounds, faceInfo, delta));
-
             Side* side = findSide(sides, faceInfo.vertices);
             assert(side != NULL);
 
@@ -1953,5 +1932,26 @@ namespace TrenchBroom {
 
             return above > 0 ? PointStatus::PSAbove : PointStatus::PSBelow;
         }
+
+        PointStatus::Type vertexStatusFromRay(const Vec3f& origin, const Vec3f& direction, const PointBuffer& positions) {
+            const PointBuffer::Counts counts = positions.classify(Rayf(origin, direction));
+            if (counts.above > 0 && counts.below > 0)
+                return PointStatus::PSInside;
+            return counts.above > 0 ? PointStatus::PSAbove : PointStatus::PSBelow;
+        }
+
+        void collectVertexPositions(const VertexList& vertices, PointBuffer& positions) {
+            positions.clear();
+            positions.reserve(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+                positions.add(vertices[i]->position);
+        }
+        
+        void collectVertexPositions(const Vec3f::List& vertices, PointBuffer& positions) {
+            positions.clear();
+            positions.reserve(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+                positions.add(vertices[i]);
+        }
     }
 }
@@ -25,6 +25,7 @@
 #include "Model/FaceTypes.h"
 #include "Model/MapExceptions.h"
 #include "Utility/Allocator.h"
+#include "Utility/PointBuffer.h"
 #include "Utility/VecMath.h"
 
 #include <iostream>
@@ -33,6 +34,8 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
+        class IndexedBrushGeometry;
+
         class Vertex : public Utility::Allocator<Vertex> {
         public:
             enum Mark {
@@ -140,24 +143,6 @@ namespace TrenchBroom {
                 return start == edge->start || start == edge->end || end == edge->start || end == edge->end;
             }
 
-            inline bool contains(const Vec3f& point, float maxDistance = Math<float>::AlmostZero) const {
-                const Vec3f edgeVec = vector();
-                const Vec3f edgeDir = edgeVec.normalized();
-                const float dot = (point - start->position).dot(edgeDir);
-
-                // determine the closest point on the edge
-                Vec3f closestPoint;
-                if (dot < 0.0f)
-                    closestPoint = start->position;
-                else if ((dot * dot) > edgeVec.lengthSquared())
-                    closestPoint = end->position;
-                else
-                    closestPoint = start->position + edgeDir * dot;
-
-                const float distance2 = (point - closestPoint).lengthSquared();
-                return distance2 <= (maxDistance * maxDistance);
-            }
-
             inline bool connects(const Vertex* vertex1, const Vertex* vertex2) const {
                 return (start == vertex1 && end == vertex2) || (start == vertex2 && end == vertex1);
             }
@@ -220,10 +205,6 @@ namespace TrenchBroom {
 
                 return true;
             }
-
-            inline EdgeInfo info() const {
-                return EdgeInfo(start->position, end->position);
-            }
         };
 
         class Face;
@@ -250,7 +231,6 @@ namespace TrenchBroom {
             Side(Face& face, EdgeList& newEdges);
 			~Side();
 
-            float intersectWithRay(const Rayf& ray);
             void replaceEdges(size_t index1, size_t index2, Edge* edge);
             Edge* split();
             void chop(size_t index, Side*& newSide, Edge*& newEdge);
@@ -274,13 +254,6 @@ namespace TrenchBroom {
                 }
                 return false;
             }
-
-            inline FaceInfo info() const {
-                FaceInfo result;
-                for (size_t i = 0; i < vertices.size(); i++)
-                    result.vertices.push_back(vertices[i]->position);
-                return result;
-            }
         };
 
         struct MoveVertexResult {
@@ -305,6 +278,14 @@ namespace TrenchBroom {
                 Null,       // the given face has nullified the entire brush
                 Split       // the given face has split the brush
             };
+
+            // Scratch buffers for the vertex positions and statuses of addFace. Callers which add several faces pass
+            // the same buffers to every call so that they are only allocated once.
+            class AddFaceBuffers {
+            public:
+                PointBuffer positions;
+                std::vector<PointStatus::Type> statuses;
+            };
         private:
             class FaceManager {
             private:
@@ -328,8 +309,12 @@ namespace TrenchBroom {
             Vertex* splitEdge(Edge* edge);
             Vertex* splitFace(Face* face, FaceManager& faceManager);
 
-            void copy(const BrushGeometry& original);
+            void initBox(const BBoxf& bounds);
             bool sanityCheck();
+
+            // not implemented, a brush copies its IndexedBrushGeometry instead
+            BrushGeometry(const BrushGeometry& original);
+            void operator= (const BrushGeometry& original);
         public:
             VertexList vertices;
             EdgeList edges;
@@ -337,15 +322,24 @@ namespace TrenchBroom {
             Vec3f center;
             BBoxf bounds;
 
+            // If the given faces bound an axis aligned box inside the world bounds, stores the face of each side of the
+            // box in the order left, right, front, back, top, down and returns the bounds of the box.
+            static bool findBoxFaces(const FaceList& faces, const BBoxf& worldBounds, Face* boxFaces[6], BBoxf& boxBounds);
+
             BrushGeometry(const BBoxf& bounds);
-            BrushGeometry(const BrushGeometry& original);
-            BrushGeometry(const Model::VertexList& i_vertices, const Model::EdgeList& i_edges, const Model::SideList& i_sides);
+            // builds the geometry of a box found by findBoxFaces directly instead of clipping the world bounds
+            BrushGeometry(const BBoxf& boxBounds, Face* boxFaces[6]);
+            // expands the given geometry and links its sides to the given faces
+            BrushGeometry(const IndexedBrushGeometry& geometry, const FaceList& faces);
             ~BrushGeometry();
 
             bool closed() const;
-            void restoreFaceSides();
+            
+            // moves the vertices without changing the topology, only valid for transformations which preserve the convexity and the face planes
+            void transform(const Mat4f& pointTransform, bool invertOrientation);
 
             CutResult addFace(Face& face, FaceSet& droppedFaces);
+            CutResult addFace(Face& face, FaceSet& droppedFaces, AddFaceBuffers& buffers);
             bool addFaces(const FaceList& faces, FaceSet& droppedFaces);
 
             void updateFacePoints(FaceManager& faceManager);
@@ -355,6 +349,8 @@ namespace TrenchBroom {
 
             SideList incidentSides(const Vertex* vertex);
 
+            // The can* methods try the operation on this geometry and return whether it succeeded. They leave this
+            // geometry in an undefined state, so they must be called on a scratch copy that is discarded afterwards.
             bool canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta);
             Vec3f::List moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
             bool canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta);
@@ -401,6 +397,10 @@ namespace TrenchBroom {
         Vec3f centerOfVertices(const VertexList& vertices);
         BBoxf boundsOfVertices(const VertexList& vertices);
         PointStatus::Type vertexStatusFromRay(const Vec3f& origin, const Vec3f& direction, const VertexList& vertices);
+        // same as above, but classifies all positions at once; use when testing the same vertices against many rays
+        PointStatus::Type vertexStatusFromRay(const Vec3f& origin, const Vec3f& direction, const PointBuffer& positions);
+        void collectVertexPositions(const VertexList& vertices, PointBuffer& positions);
+        void collectVertexPositions(const Vec3f::List& vertices, PointBuffer& positions);
     }
 }
 
@@ -104,7 +104,6 @@ namespace TrenchBroom {
         typedef std::vector<FaceInfo> FaceInfoList;
 
         typedef std::map<Vec3f, Model::BrushList, Vec3f::LexicographicOrder> VertexToBrushesMap;
-        typedef std::map<Vec3f, Model::EdgeList, Vec3f::LexicographicOrder> VertexToEdgesMap;
         typedef std::map<Vec3f, Model::FaceList, Vec3f::LexicographicOrder> VertexToFacesMap;
 
         typedef std::map<Model::Brush*, Model::EdgeInfoList> BrushEdgesMap;
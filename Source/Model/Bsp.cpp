@@ -286,6 +286,7 @@ namespace TrenchBroom {
         BspManager* BspManager::sharedManager = NULL;
 
         const Bsp* BspManager::bsp(const String& name, const StringList& paths, Utility::Console& console) {
+            wxCriticalSectionLocker lock(m_lock);
             String pathList = Utility::join(paths, ",");
             String key = pathList + ":" + name;
 
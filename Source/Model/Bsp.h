@@ -28,6 +28,8 @@
 #include <map>
 #include <vector>
 
+#include <wx/thread.h>
+
 #if defined _MSC_VER
 #include <cstdint>
 #elif defined __GNUC__
@@ -205,10 +207,12 @@ namespace TrenchBroom {
             }
         };
         
+        // The entity model loaders of all open documents use the shared manager, so its lookups are serialized.
         class BspManager {
         private:
             typedef std::map<String, Bsp*> BspMap;
             
+            wxCriticalSection m_lock;
             BspMap m_bsps;
         public:
             static BspManager* sharedManager;
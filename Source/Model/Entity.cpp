@@ -99,7 +99,7 @@ namespace TrenchBroom {
             EntityList::iterator it = m_linkTargets.begin();
             while (it != m_linkTargets.end()) {
                 Entity& target = **it;
-                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKey);
+                const PropertyValue* currentTargetname = target.propertyForKey(PropertyKeyTable::TargetnameId);
                 if (currentTargetname == NULL) { // gracefully remove this one
                     it = m_linkTargets.erase(it);
                     continue;
@@ -129,7 +129,7 @@ namespace TrenchBroom {
             EntityList::iterator it = m_killTargets.begin();
             while (it != m_killTargets.end()) {
                 Entity& target = **it;
-                const PropertyValue* currentTargetname = target.propertyForKey(TargetnameKey);
+                const PropertyValue* currentTargetname = target.propertyForKey(PropertyKeyTable::TargetnameId);
                 if (currentTargetname == NULL) { // gracefully remove this one
                     it = m_killTargets.erase(it);
                     continue;
@@ -282,13 +282,13 @@ namespace TrenchBroom {
             const String* classn = classname();
             if (classn != NULL) {
                 if (Utility::startsWith(*classn, "light")) {
-                    if (propertyForKey(MangleKey) != NULL) {
+                    if (propertyForKey(PropertyKeyTable::MangleId) != NULL) {
                         // spotlight without a target, update mangle
                         type = RTEulerAngles;
                         property = MangleKey;
-                    } else if (propertyForKey(TargetKey) == NULL) {
+                    } else if (propertyForKey(PropertyKeyTable::TargetId) == NULL) {
                         // not a spotlight, but might have a rotatable model, so change angle or angles
-                        if (propertyForKey(AnglesKey) != NULL) {
+                        if (propertyForKey(PropertyKeyTable::AnglesId) != NULL) {
                             type = RTEulerAngles;
                             property = AnglesKey;
                         } else {
@@ -301,10 +301,10 @@ namespace TrenchBroom {
                 } else {
                     bool brushEntity = !m_brushes.empty() || (m_definition != NULL && m_definition->type() == EntityDefinition::BrushEntity);
                     if (brushEntity) {
-                        if (propertyForKey(AnglesKey) != NULL) {
+                        if (propertyForKey(PropertyKeyTable::AnglesId) != NULL) {
                             type = RTEulerAngles;
                             property = AnglesKey;
-                        } else if (propertyForKey(AngleKey) != NULL) {
+                        } else if (propertyForKey(PropertyKeyTable::AngleId) != NULL) {
                             type = RTZAngleWithUpDown;
                             property = AngleKey;
                         }
@@ -314,7 +314,7 @@ namespace TrenchBroom {
                         // if the origin of the definition's bounding box is not in its center, don't apply the rotation
                         const Vec3f offset = origin() - center();
                         if (offset.x() == 0.0f && offset.y() == 0.0f) {
-                            if (propertyForKey(AnglesKey) != NULL) {
+                            if (propertyForKey(PropertyKeyTable::AnglesId) != NULL) {
                                 type = RTEulerAngles;
                                 property = AnglesKey;
                             } else {
@@ -461,7 +461,7 @@ namespace TrenchBroom {
             addAllLinkTargets();
             addAllKillTargets();
 
-            const PropertyValue* targetname = propertyForKey(TargetnameKey);
+            const PropertyValue* targetname = propertyForKey(PropertyKeyTable::TargetnameId);
             if (targetname != NULL && !targetname->empty()) {
                 addAllLinkSources(*targetname);
                 addAllKillSources(*targetname);
@@ -500,8 +500,13 @@ namespace TrenchBroom {
 
         void Entity::renameProperty(const PropertyKey& oldKey, const PropertyKey& newKey) {
             const PropertyValue* value = propertyForKey(oldKey);
+            if (value == NULL)
+                return;
+            
+            // copy the value because removing the property destroys it
+            const PropertyValue valueCopy = *value;
             removeProperty(oldKey);
-            setProperty(newKey, *value);
+            setProperty(newKey, valueCopy);
         }
         
         void Entity::removeProperty(const PropertyKey& key) {
@@ -514,6 +519,8 @@ namespace TrenchBroom {
         
         void Entity::setProperties(const PropertyList& properties, bool replace) {
             if (replace) {
+                if (m_map != NULL)
+                    m_map->removeEntityProperties(*this);
                 m_propertyStore.clear();
                 setProperty(SpawnFlagsKey, "0");
             }
@@ -586,11 +593,15 @@ namespace TrenchBroom {
                     m_map->updateEntityTargetname(*this, value, oldValue);
             }
             
+            if (m_map != NULL)
+                m_map->updateEntityProperty(*this, key, value, oldValue);
+            
             if (value == NULL)
                 m_propertyStore.removeProperty(key);
             else
                 m_propertyStore.setPropertyValue(key, *value);
             invalidateGeometry();
+            setModified(true);
         }
         
         StringList Entity::linkTargetnames() const {
@@ -655,23 +666,28 @@ namespace TrenchBroom {
 
         void Entity::addBrush(Brush& brush) {
             brush.setEntity(this);
+            brush.setModified(true);
             m_brushes.push_back(&brush);
             invalidateGeometry();
+            setModified(true);
         }
         
         void Entity::addBrushes(const BrushList& brushes) {
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush* brush = brushes[i];
                 brush->setEntity(this);
+                brush->setModified(true);
                 m_brushes.push_back(brush);
             }
             invalidateGeometry();
+            setModified(true);
         }
         
         void Entity::removeBrush(Brush& brush) {
             brush.setEntity(NULL);
             m_brushes.erase(std::remove(m_brushes.begin(), m_brushes.end(), &brush), m_brushes.end());
             invalidateGeometry();
+            setModified(true);
         }
 
         void Entity::setDefinition(EntityDefinition* definition) {
@@ -162,6 +162,10 @@ namespace TrenchBroom {
                 return m_propertyStore.propertyValue(key);
             }
 
+            inline const PropertyValue* propertyForKey(PropertyKeyId keyId) const {
+                return m_propertyStore.propertyValue(keyId);
+            }
+
             static bool propertyIsMutable(const PropertyKey& key);
             static bool propertyKeyIsMutable(const PropertyKey& key);
 
@@ -195,7 +199,7 @@ namespace TrenchBroom {
             }
 
             inline const PropertyValue* classname() const {
-                return propertyForKey(ClassnameKey);
+                return propertyForKey(PropertyKeyTable::ClassnameId);
             }
             
             inline const PropertyValue& safeClassname() const {
@@ -210,7 +214,7 @@ namespace TrenchBroom {
             }
 
             inline const Vec3f origin() const {
-                const PropertyValue* value = propertyForKey(OriginKey);
+                const PropertyValue* value = propertyForKey(PropertyKeyTable::OriginId);
                 if (value == NULL)
                     return Vec3f::Null;
                 return Vec3f(*value);
@@ -220,12 +224,12 @@ namespace TrenchBroom {
                 if (classname() == NULL)
                     return false;
                 if (Utility::startsWith(*classname(), "light")) {
-                    if (propertyForKey(MangleKey) != NULL)
+                    if (propertyForKey(PropertyKeyTable::MangleId) != NULL)
                         return true;
                 } else {
-                    if (propertyForKey(AngleKey) != NULL)
+                    if (propertyForKey(PropertyKeyTable::AngleId) != NULL)
                         return true;
-                    if (propertyForKey(AnglesKey) != NULL)
+                    if (propertyForKey(PropertyKeyTable::AnglesId) != NULL)
                         return true;
                 }
                 return false;
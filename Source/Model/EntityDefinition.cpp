@@ -24,14 +24,14 @@
 namespace TrenchBroom {
     namespace Model {
         ModelDefinitionPropertyEvaluator::ModelDefinitionPropertyEvaluator(const PropertyKey& propertyKey, const PropertyValue& propertyValue) :
-        m_propertyKey(propertyKey),
+        m_propertyKeyId(PropertyKeyTable::intern(propertyKey)),
         m_propertyValue(propertyValue) {}
         
         bool ModelDefinitionPropertyEvaluator::evaluate(const PropertyList& properties) const {
             PropertyList::const_iterator it, end;
             for (it = properties.begin(), end = properties.end(); it != end; ++it) {
                 const Property& property = *it;
-                if (property.key() == m_propertyKey) {
+                if (property.keyId() == m_propertyKeyId) {
                     if (property.value() == m_propertyValue)
                         return true;
                     break;
@@ -41,14 +41,14 @@ namespace TrenchBroom {
         }
 
         ModelDefinitionFlagEvaluator::ModelDefinitionFlagEvaluator(const PropertyKey& propertyKey, int flagValue) :
-        m_propertyKey(propertyKey),
+        m_propertyKeyId(PropertyKeyTable::intern(propertyKey)),
         m_flagValue(flagValue) {}
         
         bool ModelDefinitionFlagEvaluator::evaluate(const PropertyList& properties) const {
             PropertyList::const_iterator it, end;
             for (it = properties.begin(), end = properties.end(); it != end; ++it) {
                 const Property& property = *it;
-                if (property.key() == m_propertyKey) {
+                if (property.keyId() == m_propertyKeyId) {
                     if ((std::atoi(property.value().c_str()) & m_flagValue) != 0)
                         return true;
                     break;
@@ -48,7 +48,7 @@ namespace TrenchBroom {
         
         class ModelDefinitionPropertyEvaluator : public ModelDefinitionEvaluator {
         private:
-            PropertyKey m_propertyKey;
+            PropertyKeyId m_propertyKeyId;
             PropertyValue m_propertyValue;
         public:
             ModelDefinitionPropertyEvaluator(const PropertyKey& propertyKey, const PropertyValue& propertyValue);
@@ -58,7 +58,7 @@ namespace TrenchBroom {
         
         class ModelDefinitionFlagEvaluator : public ModelDefinitionEvaluator {
         private:
-            PropertyKey m_propertyKey;
+            PropertyKeyId m_propertyKeyId;
             int m_flagValue;
         public:
             ModelDefinitionFlagEvaluator(const PropertyKey& propertyKey, int flagValue);
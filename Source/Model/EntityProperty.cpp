@@ -23,26 +23,65 @@
 
 namespace TrenchBroom {
     namespace Model {
+        PropertyKeyTable::PropertyKeyTable() {
+            // the order must match the ids declared in the header
+            add("classname");
+            add("origin");
+            add("angle");
+            add("angles");
+            add("mangle");
+            add("target");
+            add("killtarget");
+            add("targetname");
+            add("spawnflags");
+        }
+        
+        PropertyKeyTable& PropertyKeyTable::table() {
+            static PropertyKeyTable instance;
+            return instance;
+        }
+        
+        PropertyKeyId PropertyKeyTable::add(const PropertyKey& key) {
+            const PropertyKeyId id = static_cast<PropertyKeyId>(m_keys.size());
+            std::pair<IdMap::iterator, bool> result = m_ids.insert(IdMap::value_type(key, id));
+            if (!result.second)
+                return result.first->second;
+            m_keys.push_back(&result.first->first);
+            return id;
+        }
+        
+        PropertyKeyId PropertyKeyTable::intern(const PropertyKey& key) {
+            return table().add(key);
+        }
+        
+        PropertyKeyId PropertyKeyTable::find(const PropertyKey& key) {
+            PropertyKeyTable& instance = table();
+            IdMap::const_iterator it = instance.m_ids.find(key);
+            if (it == instance.m_ids.end())
+                return NoId;
+            return it->second;
+        }
+        
         bool PropertyStore::hasDuplicates() const {
-            PropertyKeySet keys;
+            std::set<PropertyKeyId> keys;
             PropertyList::const_iterator propIt, propEnd;
             for (propIt = m_properties.begin(), propEnd = m_properties.end(); propIt != propEnd; ++propIt) {
                 const Property& property = *propIt;
-                PropertyKeySetInsertResult result = keys.insert(property.key());
-                if (!result.second)
+                if (!keys.insert(property.keyId()).second)
                     return true;
             }
             return false;
         }
 
         bool PropertyStore::setPropertyKey(const PropertyKey& oldKey, const PropertyKey& newKey) {
-            if (containsProperty(newKey))
+            const PropertyKeyId oldKeyId = PropertyKeyTable::find(oldKey);
+            if (oldKeyId == PropertyKeyTable::NoId || containsProperty(newKey))
                 return false;
             
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == oldKey) {
+                if (property.keyId() == oldKeyId) {
                     property.setKey(newKey);
                     assert(!hasDuplicates());
                     return true;
@@ -53,24 +92,29 @@ namespace TrenchBroom {
         }
 
         void PropertyStore::setPropertyValue(const PropertyKey& key, const PropertyValue& value) {
+            const PropertyKeyId keyId = PropertyKeyTable::intern(key);
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == key) {
+                if (property.keyId() == keyId) {
                     property.setValue(value);
                     return;
                 }
             }
             
-            m_properties.push_back(Property(key, value));
+            m_properties.push_back(Property(keyId, value));
             assert(!hasDuplicates());
         }
         
         bool PropertyStore::removeProperty(const PropertyKey& key) {
+            const PropertyKeyId keyId = PropertyKeyTable::find(key);
+            if (keyId == PropertyKeyTable::NoId)
+                return false;
+            
             PropertyList::iterator it, end;
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
-                if (property.key() == key) {
+                if (property.keyId() == keyId) {
                     m_properties.erase(it);
                     return true;
                 }
@@ -22,10 +22,17 @@
 
 #include "Utility/String.h"
 
+#include <cassert>
 #include <map>
 #include <set>
 #include <vector>
 
+#if defined _WIN32
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
+
 namespace TrenchBroom {
     namespace Model {
         typedef String PropertyKey;
@@ -34,24 +41,71 @@ namespace TrenchBroom {
         typedef std::set<PropertyKey> PropertyKeySet;
         typedef std::pair<PropertyKeySet::iterator, bool> PropertyKeySetInsertResult;
         typedef std::vector<PropertyValue> PropertyValueList;
+        typedef unsigned int PropertyKeyId;
 
+        // Interns property keys so that every distinct key is stored once and properties can be compared by id. Some
+        // common keys are registered in advance and have fixed ids. The table is only used from the main thread.
+        class PropertyKeyTable {
+        public:
+            static const PropertyKeyId ClassnameId      = 0;
+            static const PropertyKeyId OriginId         = 1;
+            static const PropertyKeyId AngleId          = 2;
+            static const PropertyKeyId AnglesId         = 3;
+            static const PropertyKeyId MangleId         = 4;
+            static const PropertyKeyId TargetId         = 5;
+            static const PropertyKeyId KillTargetId     = 6;
+            static const PropertyKeyId TargetnameId     = 7;
+            static const PropertyKeyId SpawnFlagsId     = 8;
+            static const PropertyKeyId NoId             = 0xFFFFFFFF;
+        private:
+            typedef std::tr1::unordered_map<PropertyKey, PropertyKeyId> IdMap;
+            typedef std::vector<const PropertyKey*> KeyList;
+            
+            IdMap m_ids;
+            KeyList m_keys; // points to the keys of m_ids, which stay where they are when the map grows
+            
+            PropertyKeyTable();
+            
+            static PropertyKeyTable& table();
+            PropertyKeyId add(const PropertyKey& key);
+        public:
+            static PropertyKeyId intern(const PropertyKey& key);
+            // returns NoId if the key was never interned, which means that no property has it
+            static PropertyKeyId find(const PropertyKey& key);
+            
+            inline static const PropertyKey& key(PropertyKeyId id) {
+                PropertyKeyTable& instance = table();
+                assert(id < instance.m_keys.size());
+                return *instance.m_keys[id];
+            }
+        };
+        
         class Property {
         private:
-            PropertyKey m_key;
+            PropertyKeyId m_keyId;
             PropertyValue m_value;
         public:
-            Property() {}
+            Property() :
+            m_keyId(PropertyKeyTable::intern("")) {}
             
             Property(const PropertyKey& key, const PropertyValue& value) :
-            m_key(key),
+            m_keyId(PropertyKeyTable::intern(key)),
+            m_value(value) {}
+            
+            Property(PropertyKeyId keyId, const PropertyValue& value) :
+            m_keyId(keyId),
             m_value(value) {}
             
+            inline PropertyKeyId keyId() const {
+                return m_keyId;
+            }
+            
             inline const PropertyKey& key() const {
-                return m_key;
+                return PropertyKeyTable::key(m_keyId);
             }
             
             inline void setKey(const PropertyKey& key) {
-                m_key = key;
+                m_keyId = PropertyKeyTable::intern(key);
             }
             
             inline const PropertyValue& value() const {
@@ -75,28 +129,39 @@ namespace TrenchBroom {
             
             bool hasDuplicates() const;
         public:
-            inline bool containsProperty(const PropertyKey& key) const {
-                PropertyList::const_iterator it, end;
-                for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
-                    const Property& property = *it;
-                    if (property.key() == key)
-                        return true;
-                }
-                
-                return false;
-            }
-
-            inline const Property* property(const PropertyKey& key) const {
+            inline const Property* property(PropertyKeyId keyId) const {
                 PropertyList::const_iterator it, end;
                 for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                     const Property& property = *it;
-                    if (property.key() == key)
+                    if (property.keyId() == keyId)
                         return &property;
                 }
                 
                 return NULL;
             }
             
+            inline const Property* property(const PropertyKey& key) const {
+                const PropertyKeyId keyId = PropertyKeyTable::find(key);
+                if (keyId == PropertyKeyTable::NoId)
+                    return NULL;
+                return property(keyId);
+            }
+            
+            inline bool containsProperty(PropertyKeyId keyId) const {
+                return property(keyId) != NULL;
+            }
+            
+            inline bool containsProperty(const PropertyKey& key) const {
+                return property(key) != NULL;
+            }
+
+            inline const PropertyValue* propertyValue(PropertyKeyId keyId) const {
+                const Property* prop = property(keyId);
+                if (prop == NULL)
+                    return NULL;
+                return &prop->value();
+            }
+            
             inline const PropertyValue* propertyValue(const PropertyKey& key) const {
                 const Property* prop = property(key);
                 if (prop == NULL)
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "EntityPropertyIndex.h"
+
+#include "Model/Entity.h"
+#include "Utility/List.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        void EntityPropertyIndex::addEntity(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it)
+                addProperty(entity, it->keyId(), it->value());
+        }
+        
+        void EntityPropertyIndex::removeEntity(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it)
+                removeProperty(entity, it->keyId(), it->value());
+        }
+        
+        void EntityPropertyIndex::addProperty(Entity& entity, PropertyKeyId keyId, const PropertyValue& value) {
+            m_keys[keyId][value].insert(&entity);
+        }
+        
+        void EntityPropertyIndex::removeProperty(Entity& entity, PropertyKeyId keyId, const PropertyValue& value) {
+            KeyMap::iterator keyIt = m_keys.find(keyId);
+            if (keyIt == m_keys.end())
+                return;
+            
+            ValueMap& values = keyIt->second;
+            ValueMap::iterator valueIt = values.find(value);
+            if (valueIt == values.end())
+                return;
+            
+            valueIt->second.erase(&entity);
+            if (valueIt->second.empty()) {
+                values.erase(valueIt);
+                if (values.empty())
+                    m_keys.erase(keyIt);
+            }
+        }
+        
+        void EntityPropertyIndex::clear() {
+            m_keys.clear();
+        }
+        
+        EntityList EntityPropertyIndex::entities(const PropertyKey& key) const {
+            KeyMap::const_iterator keyIt = m_keys.find(PropertyKeyTable::find(key));
+            if (keyIt == m_keys.end())
+                return EmptyEntityList;
+            
+            const ValueMap& values = keyIt->second;
+            if (values.size() == 1)
+                return Utility::makeList(values.begin()->second);
+            
+            // an entity has at most one value per key, so the sets are disjoint
+            EntityList result;
+            ValueMap::const_iterator valueIt, valueEnd;
+            for (valueIt = values.begin(), valueEnd = values.end(); valueIt != valueEnd; ++valueIt)
+                result.insert(result.end(), valueIt->second.begin(), valueIt->second.end());
+            return result;
+        }
+        
+        EntityList EntityPropertyIndex::entities(const PropertyKey& key, const PropertyValue& value) const {
+            KeyMap::const_iterator keyIt = m_keys.find(PropertyKeyTable::find(key));
+            if (keyIt == m_keys.end())
+                return EmptyEntityList;
+            
+            ValueMap::const_iterator valueIt = keyIt->second.find(value);
+            if (valueIt == keyIt->second.end())
+                return EmptyEntityList;
+            return Utility::makeList(valueIt->second);
+        }
+        
+        size_t EntityPropertyIndex::entityCount(const PropertyKey& key, const PropertyValue& value) const {
+            KeyMap::const_iterator keyIt = m_keys.find(PropertyKeyTable::find(key));
+            if (keyIt == m_keys.end())
+                return 0;
+            
+            ValueMap::const_iterator valueIt = keyIt->second.find(value);
+            if (valueIt == keyIt->second.end())
+                return 0;
+            return valueIt->second.size();
+        }
+        
+        PropertyKeyList EntityPropertyIndex::keys() const {
+            PropertyKeyList result;
+            result.reserve(m_keys.size());
+            
+            KeyMap::const_iterator it, end;
+            for (it = m_keys.begin(), end = m_keys.end(); it != end; ++it)
+                result.push_back(PropertyKeyTable::key(it->first));
+            return result;
+        }
+        
+        PropertyValueList EntityPropertyIndex::values(const PropertyKey& key) const {
+            PropertyValueList result;
+            KeyMap::const_iterator keyIt = m_keys.find(PropertyKeyTable::find(key));
+            if (keyIt == m_keys.end())
+                return result;
+            
+            const ValueMap& values = keyIt->second;
+            result.reserve(values.size());
+            
+            ValueMap::const_iterator it, end;
+            for (it = values.begin(), end = values.end(); it != end; ++it)
+                result.push_back(it->first);
+            return result;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__EntityPropertyIndex__
+#define __TrenchBroom__EntityPropertyIndex__
+
+#include "Model/EntityProperty.h"
+#include "Model/EntityTypes.h"
+
+#include <map>
+
+namespace TrenchBroom {
+    namespace Model {
+        // Maps each property key to the values it has in the map, and each value to the entities that have it. The
+        // index is kept up to date by Map whenever an entity is added or removed or one of its properties changes.
+        class EntityPropertyIndex {
+        private:
+            typedef std::map<PropertyValue, EntitySet> ValueMap;
+            typedef std::map<PropertyKeyId, ValueMap> KeyMap;
+            
+            KeyMap m_keys;
+        public:
+            void addEntity(Entity& entity);
+            void removeEntity(Entity& entity);
+            void addProperty(Entity& entity, PropertyKeyId keyId, const PropertyValue& value);
+            void removeProperty(Entity& entity, PropertyKeyId keyId, const PropertyValue& value);
+            void clear();
+            
+            // all entities that have the given key, regardless of its value
+            EntityList entities(const PropertyKey& key) const;
+            EntityList entities(const PropertyKey& key, const PropertyValue& value) const;
+            size_t entityCount(const PropertyKey& key, const PropertyValue& value) const;
+            
+            PropertyKeyList keys() const;
+            PropertyValueList values(const PropertyKey& key) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityPropertyIndex__) */
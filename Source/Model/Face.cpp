@@ -21,10 +21,14 @@
 
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
+#include "Model/IntegerPlanePointCache.h"
 #include "Model/Texture.h"
+#include "Utility/MemoryRegistry.h"
 
 namespace TrenchBroom {
     namespace Model {
+        static Utility::MemoryTag VertexCacheMemory("Face vertex caches", Utility::MemoryTag::Unshared);
+
         inline void FindFacePoints::operator()(const Face& face, FacePoints& points) const {
             size_t numPoints = selectInitialPoints(face, points);
             findPoints(face.boundary(), points, numPoints);
@@ -72,7 +76,11 @@ namespace TrenchBroom {
         }
         
         inline void FindIntegerFacePoints::findPoints(const Planef& plane, FacePoints& points, size_t numPoints) const {
-            m_findPoints(plane, points, numPoints);
+            // without initial points, the result only depends on the plane
+            if (numPoints == 0)
+                IntegerPlanePointCache::sharedCache().findPoints(m_findPoints, plane, points);
+            else
+                m_findPoints(plane, points, numPoints);
         }
 
         const FindIntegerFacePoints FindIntegerFacePoints::Instance = FindIntegerFacePoints();
@@ -108,6 +116,8 @@ namespace TrenchBroom {
             m_xScale = 1.0f;
             m_yScale = 1.0f;
             m_brush = NULL;
+            m_side = NULL;
+            m_sideIndex = IndexedBrushGeometry::NoIndex;
             m_texture = NULL;
             m_filePosition = 0;
             m_selected = false;
@@ -160,7 +170,8 @@ namespace TrenchBroom {
         }
 
         void Face::validateVertexCache() const {
-            assert(m_side != NULL);
+            const SideVertexList vertices = this->vertices();
+            assert(!vertices.empty());
             
             if (!m_texAxesValid)
                 validateTexAxes(m_boundary.normal);
@@ -168,26 +179,32 @@ namespace TrenchBroom {
             unsigned int width = m_texture != NULL ? m_texture->width() : 1;
             unsigned int height = m_texture != NULL ? m_texture->height() : 1;
             
-            size_t vertexCount = m_side->vertices.size();
+            size_t vertexCount = vertices.size();
+            const size_t oldBytes = m_vertexCache.capacity() * sizeof(Renderer::FaceVertex);
             m_vertexCache.resize(3 * (vertexCount - 2));
+            const size_t newBytes = m_vertexCache.capacity() * sizeof(Renderer::FaceVertex);
+            if (oldBytes == 0)
+                VertexCacheMemory.allocate(newBytes);
+            else
+                VertexCacheMemory.resize(oldBytes, newBytes);
             
             Vec2f texCoords;
             size_t j = 0;
             for (size_t i = 1; i < vertexCount - 1; i++) {
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[0]->position,
+                m_vertexCache[j++] = Renderer::FaceVertex(vertices[0],
                                                           m_boundary.normal,
-                                                          Vec2f((m_side->vertices[0]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[0]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
+                                                          Vec2f((vertices[0].dot(m_scaledTexAxisX) + m_xOffset) / width,
+                                                                (vertices[0].dot(m_scaledTexAxisY) + m_yOffset) / height)
                                                           );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i]->position,
+                m_vertexCache[j++] = Renderer::FaceVertex(vertices[i],
                                                           m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
+                                                          Vec2f((vertices[i].dot(m_scaledTexAxisX) + m_xOffset) / width,
+                                                                (vertices[i].dot(m_scaledTexAxisY) + m_yOffset) / height)
                                                           );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i+1]->position,
+                m_vertexCache[j++] = Renderer::FaceVertex(vertices[i+1],
                                                           m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i+1]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i+1]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
+                                                          Vec2f((vertices[i+1].dot(m_scaledTexAxisX) + m_xOffset) / width,
+                                                                (vertices[i+1].dot(m_scaledTexAxisY) + m_yOffset) / height)
                                                           );
             }
             
@@ -199,7 +216,7 @@ namespace TrenchBroom {
                 validateTexAxes(m_boundary.normal);
             
             // calculate the current texture coordinates of the face's center
-            const Vec3f curCenter = centerOfVertices(m_side->vertices);
+            const Vec3f curCenter = center();
             const Vec2f curCenterTexCoords(curCenter.dot(m_scaledTexAxisX) + m_xOffset,
                                            curCenter.dot(m_scaledTexAxisY) + m_yOffset);
             
@@ -370,8 +387,21 @@ namespace TrenchBroom {
             restore(faceTemplate);
         }
         
+        Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FacePoints& points, const Planef& boundary, const String& textureName) :
+        m_boundary(boundary),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints),
+        m_textureName(textureName) {
+            init();
+            for (size_t i = 0; i < 3; i++)
+                m_points[i] = points[i];
+            updateContentType();
+        }
+        
         Face::Face(const Face& face) :
+        m_brush(NULL),
         m_side(NULL),
+        m_sideIndex(IndexedBrushGeometry::NoIndex),
         m_faceId(face.faceId()),
         m_boundary(face.boundary()),
         m_worldBounds(face.worldBounds()),
@@ -419,6 +449,9 @@ namespace TrenchBroom {
 			m_selected = false;
 			m_vertexCacheValid = false;
 			m_texAxesValid = false;
+
+            if (m_vertexCache.capacity() > 0)
+                VertexCacheMemory.deallocate(m_vertexCache.capacity() * sizeof(Renderer::FaceVertex));
 		}
         
         void Face::restore(const Face& faceTemplate) {
@@ -443,10 +476,44 @@ namespace TrenchBroom {
             if (m_brush != NULL && m_selected)
                 m_brush->decSelectedFaceCount();
             m_brush = brush;
+            m_sideIndex = IndexedBrushGeometry::NoIndex;
             if (m_brush != NULL && m_selected)
                 m_brush->incSelectedFaceCount();
         }
         
+        FaceInfo Face::faceInfo() const {
+            const SideVertexList vertices = this->vertices();
+            assert(!vertices.empty());
+
+            FaceInfo result;
+            for (size_t i = 0; i < vertices.size(); i++)
+                result.vertices.push_back(vertices[i]);
+            return result;
+        }
+
+        SideVertexList Face::vertices() const {
+            if (m_brush == NULL || m_sideIndex == IndexedBrushGeometry::NoIndex)
+                return SideVertexList();
+            return m_brush->geometry().sideVertices(m_sideIndex);
+        }
+
+        BrushEdgeList Face::edges() const {
+            if (m_brush == NULL || m_sideIndex == IndexedBrushGeometry::NoIndex)
+                return BrushEdgeList();
+            return BrushEdgeList(m_brush->geometry(), m_brush->faces(), m_sideIndex);
+        }
+
+        Vec3f Face::center() const {
+            const SideVertexList vertices = this->vertices();
+            assert(!vertices.empty());
+
+            Vec3f center = vertices[0];
+            for (size_t i = 1; i < vertices.size(); i++)
+                center += vertices[i];
+            center /= static_cast<float>(vertices.size());
+            return center;
+        }
+
         void Face::updatePointsFromVertices() {
             Vec3f v1, v2;
             
@@ -22,6 +22,7 @@
 
 #include "Model/BrushGeometry.h"
 #include "Model/FaceTypes.h"
+#include "Model/IndexedBrushGeometry.h"
 #include "Renderer/FaceVertex.h"
 #include "Utility/Allocator.h"
 #include "Utility/FindPlanePoints.h"
@@ -93,7 +94,10 @@ namespace TrenchBroom {
             static const Vec3f BaseAxes[18];
 
             Brush* m_brush;
+            // the side of the brush geometry which is being edited, only valid during an edit
             Side* m_side;
+            // the side of the brush's indexed geometry
+            uint32_t m_sideIndex;
 
             unsigned int m_faceId;
 
@@ -157,6 +161,8 @@ namespace TrenchBroom {
         public:
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName);
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Face& faceTemplate);
+            // restores a face whose points have already been derived from its boundary, such as a face read from the map cache
+            Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FacePoints& points, const Planef& boundary, const String& textureName);
             Face(const Face& face);
 			~Face();
 
@@ -176,11 +182,16 @@ namespace TrenchBroom {
                 m_side = side;
             }
 
-            inline FaceInfo faceInfo() const {
-                assert(m_side != NULL);
-                return m_side->info();
+            inline uint32_t sideIndex() const {
+                return m_sideIndex;
             }
 
+            inline void setSideIndex(uint32_t sideIndex) {
+                m_sideIndex = sideIndex;
+            }
+
+            FaceInfo faceInfo() const;
+
             inline unsigned int faceId() const {
                 return m_faceId;
             }
@@ -215,17 +226,9 @@ namespace TrenchBroom {
 
             void setForceIntegerFacePoints(bool forceIntegerFacePoints);
             
-            inline const VertexList& vertices() const {
-                return m_side->vertices;
-            }
-
-            inline const EdgeList& edges() const {
-                return m_side->edges;
-            }
-
-            inline Vec3f center() const {
-                return centerOfVertices(m_side->vertices);
-            }
+            SideVertexList vertices() const;
+            BrushEdgeList edges() const;
+            Vec3f center() const;
 
             inline ContentType contentType() const {
                 return m_contentType;
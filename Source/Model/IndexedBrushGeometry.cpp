@@ -0,0 +1,308 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IndexedBrushGeometry.h"
+
+#include "Model/BrushGeometry.h"
+#include "Utility/MemoryRegistry.h"
+
+#include <algorithm>
+
+namespace TrenchBroom {
+    namespace Model {
+        static Utility::MemoryTag BrushGeometryMemory("Brush geometries", Utility::MemoryTag::Unshared);
+
+        // Maps the elements of a list to their positions in it without allocating a node per element.
+        template <typename T>
+        class PointerIndex {
+        private:
+            typedef std::pair<const T*, uint32_t> Entry;
+
+            struct EntryOrder {
+                inline bool operator()(const Entry& lhs, const Entry& rhs) const {
+                    return std::less<const T*>()(lhs.first, rhs.first);
+                }
+            };
+
+            std::vector<Entry> m_entries;
+        public:
+            PointerIndex(const std::vector<T*>& list) {
+                m_entries.reserve(list.size());
+                for (size_t i = 0; i < list.size(); i++)
+                    m_entries.push_back(Entry(list[i], static_cast<uint32_t>(i)));
+                std::sort(m_entries.begin(), m_entries.end(), EntryOrder());
+            }
+
+            inline uint32_t operator()(const T* t) const {
+                if (t == NULL)
+                    return IndexedBrushGeometry::NoIndex;
+                typename std::vector<Entry>::const_iterator it = std::lower_bound(m_entries.begin(), m_entries.end(), Entry(t, 0), EntryOrder());
+                assert(it != m_entries.end() && it->first == t);
+                return it->second;
+            }
+        };
+
+        void IndexedBrushGeometry::updateMemory() {
+            const size_t bytes = memorySize();
+            BrushGeometryMemory.resize(m_trackedBytes, bytes);
+            m_trackedBytes = bytes;
+        }
+
+        IndexedBrushGeometry::IndexedBrushGeometry() :
+        m_trackedBytes(0) {
+            BrushGeometryMemory.allocate(0);
+        }
+
+        IndexedBrushGeometry::IndexedBrushGeometry(const IndexedBrushGeometry& other) :
+        m_vertices(other.m_vertices),
+        m_edges(other.m_edges),
+        m_sides(other.m_sides),
+        m_sideEdges(other.m_sideEdges),
+        m_sideVertices(other.m_sideVertices),
+        m_center(other.m_center),
+        m_bounds(other.m_bounds),
+        m_trackedBytes(0) {
+            BrushGeometryMemory.allocate(0);
+            updateMemory();
+        }
+
+        IndexedBrushGeometry::~IndexedBrushGeometry() {
+            BrushGeometryMemory.deallocate(m_trackedBytes);
+        }
+
+        IndexedBrushGeometry& IndexedBrushGeometry::operator= (const IndexedBrushGeometry& other) {
+            if (this != &other) {
+                m_vertices = other.m_vertices;
+                m_edges = other.m_edges;
+                m_sides = other.m_sides;
+                m_sideEdges = other.m_sideEdges;
+                m_sideVertices = other.m_sideVertices;
+                m_center = other.m_center;
+                m_bounds = other.m_bounds;
+                updateMemory();
+            }
+            return *this;
+        }
+
+        void IndexedBrushGeometry::compact(const BrushGeometry& geometry, const FaceList& faces) {
+            const PointerIndex<Vertex> vertexIndex(geometry.vertices);
+            const PointerIndex<Edge> edgeIndex(geometry.edges);
+            const PointerIndex<Side> sideIndex(geometry.sides);
+            const PointerIndex<Face> faceIndex(faces);
+
+            // the arrays are built anew and swapped in so that they don't keep the capacity of a larger geometry
+            Vec3f::List vertices;
+            vertices.reserve(geometry.vertices.size());
+            for (size_t i = 0; i < geometry.vertices.size(); i++)
+                vertices.push_back(geometry.vertices[i]->position);
+
+            EdgeList edges;
+            edges.reserve(geometry.edges.size());
+            for (size_t i = 0; i < geometry.edges.size(); i++) {
+                const Edge& edge = *geometry.edges[i];
+                edges.push_back(IndexedEdge(vertexIndex(edge.start), vertexIndex(edge.end), sideIndex(edge.left), sideIndex(edge.right)));
+            }
+
+            size_t sideEdgeCount = 0;
+            for (size_t i = 0; i < geometry.sides.size(); i++)
+                sideEdgeCount += geometry.sides[i]->edges.size();
+
+            SideList sides;
+            std::vector<uint32_t> sideEdges;
+            std::vector<uint32_t> sideVertices;
+            sides.reserve(geometry.sides.size());
+            sideEdges.reserve(sideEdgeCount);
+            sideVertices.reserve(sideEdgeCount);
+            for (size_t i = 0; i < geometry.sides.size(); i++) {
+                const Side& side = *geometry.sides[i];
+                sides.push_back(IndexedSide(faceIndex(side.face), static_cast<uint32_t>(sideEdges.size()), static_cast<uint32_t>(side.edges.size())));
+                for (size_t j = 0; j < side.edges.size(); j++) {
+                    sideEdges.push_back(edgeIndex(side.edges[j]));
+                    sideVertices.push_back(vertexIndex(side.vertices[j]));
+                }
+            }
+
+            m_vertices.swap(vertices);
+            m_edges.swap(edges);
+            m_sides.swap(sides);
+            m_sideEdges.swap(sideEdges);
+            m_sideVertices.swap(sideVertices);
+            m_center = geometry.center;
+            m_bounds = geometry.bounds;
+            updateMemory();
+        }
+
+        void IndexedBrushGeometry::clear() {
+            Vec3f::List().swap(m_vertices);
+            EdgeList().swap(m_edges);
+            SideList().swap(m_sides);
+            std::vector<uint32_t>().swap(m_sideEdges);
+            std::vector<uint32_t>().swap(m_sideVertices);
+            updateMemory();
+        }
+
+        uint32_t IndexedBrushGeometry::addVertex(const Vec3f& position) {
+            m_vertices.push_back(position);
+            return static_cast<uint32_t>(m_vertices.size() - 1);
+        }
+
+        uint32_t IndexedBrushGeometry::addEdge(uint32_t start, uint32_t end, uint32_t left, uint32_t right) {
+            assert(start < m_vertices.size() && end < m_vertices.size());
+            m_edges.push_back(IndexedEdge(start, end, left, right));
+            return static_cast<uint32_t>(m_edges.size() - 1);
+        }
+
+        uint32_t IndexedBrushGeometry::addSide(uint32_t face) {
+            m_sides.push_back(IndexedSide(face, static_cast<uint32_t>(m_sideEdges.size()), 0));
+            return static_cast<uint32_t>(m_sides.size() - 1);
+        }
+
+        bool IndexedBrushGeometry::addSideEdge(uint32_t edge) {
+            assert(!m_sides.empty());
+            assert(edge < m_edges.size());
+
+            IndexedSide& side = m_sides.back();
+            const uint32_t vertex = m_edges[edge].startVertex(static_cast<uint32_t>(m_sides.size() - 1));
+            if (vertex == NoIndex)
+                return false;
+
+            m_sideEdges.push_back(edge);
+            m_sideVertices.push_back(vertex);
+            side.edgeCount++;
+            return true;
+        }
+
+        void IndexedBrushGeometry::finish() {
+            if (!m_vertices.empty()) {
+                m_bounds.min = m_bounds.max = m_vertices[0];
+                m_center = m_vertices[0];
+                for (size_t i = 1; i < m_vertices.size(); i++) {
+                    m_bounds.mergeWith(m_vertices[i]);
+                    m_center += m_vertices[i];
+                }
+                m_center /= static_cast<float>(m_vertices.size());
+            }
+            updateMemory();
+        }
+
+        void IndexedBrushGeometry::transform(const Mat4f& pointTransform, bool invertOrientation) {
+            for (size_t i = 0; i < m_vertices.size(); i++) {
+                Vec3f& position = m_vertices[i];
+                position = pointTransform * position;
+                position.correct();
+            }
+
+            if (invertOrientation) {
+                // a mirrored side's vertices appear in clockwise order, so every edge changes its sides and every
+                // side reverses its edges
+                for (size_t i = 0; i < m_edges.size(); i++) {
+                    IndexedEdge& edge = m_edges[i];
+                    std::swap(edge.left, edge.right);
+                }
+
+                for (size_t i = 0; i < m_sides.size(); i++) {
+                    const IndexedSide& side = m_sides[i];
+                    const size_t first = side.firstEdge;
+                    const size_t last = first + side.edgeCount;
+                    std::reverse(m_sideEdges.begin() + first, m_sideEdges.begin() + last);
+                    for (size_t j = first; j < last; j++)
+                        m_sideVertices[j] = m_edges[m_sideEdges[j]].startVertex(static_cast<uint32_t>(i));
+                }
+            }
+
+            finish();
+        }
+
+        float IndexedBrushGeometry::intersectSideWithRay(size_t side, const Planef& boundary, const Rayf& ray) const {
+            float dot = boundary.normal.dot(ray.direction);
+            if (!Math<float>::neg(dot))
+                return Math<float>::nan();
+
+            float dist = boundary.intersectWithRay(ray);
+            if (Math<float>::isnan(dist))
+                return Math<float>::nan();
+
+            const SideVertexList vertices = sideVertices(side);
+            if (vertices.empty())
+                return Math<float>::nan();
+
+            const CoordinatePlanef& cPlane = CoordinatePlanef::plane(boundary.normal);
+
+            const Vec3f hit = ray.pointAtDistance(dist);
+            const Vec3f projectedHit = cPlane.swizzle(hit);
+
+            Vec3f v0 = cPlane.swizzle(vertices.back()) - projectedHit;
+
+            int c = 0;
+            for (size_t i = 0; i < vertices.size(); i++) {
+                Vec3f v1 = cPlane.swizzle(vertices[i]) - projectedHit;
+
+                if ((Math<float>::zero(v0.x()) && Math<float>::zero(v0.y())) ||
+                    (Math<float>::zero(v1.x()) && Math<float>::zero(v1.y()))) {
+                    // the point is identical to a polygon vertex, cancel search
+                    c = 1;
+                    break;
+                }
+
+                /*
+                 * A polygon edge intersects with the positive X axis if the
+                 * following conditions are met: The Y coordinates of its
+                 * vertices must have different signs (we assign a negative sign
+                 * to 0 here in order to count it as a negative number) and one
+                 * of the following two conditions must be met: Either the X
+                 * coordinates of the vertices are both positive or the X
+                 * coordinates of the edge have different signs (again, we
+                 * assign a negative sign to 0 here). In the latter case, we
+                 * must calculate the point of intersection between the edge and
+                 * the X axis and determine whether its X coordinate is positive
+                 * or zero.
+                 */
+
+                // do the Y coordinates have different signs?
+                if ((v0.y() > 0.0f && v1.y() <= 0.0f) || (v0.y() <= 0.0f && v1.y() > 0.0f)) {
+                    // Is segment entirely on the positive side of the X axis?
+                    if (v0.x() > 0.0f && v1.x() > 0.0f) {
+                        c += 1; // edge intersects with the X axis
+                        // if not, do the X coordinates have different signs?
+                    } else if ((v0.x() > 0.0f && v1.x() <= 0.0f) || (v0.x() <= 0.0f && v1.x() > 0.0f)) {
+                        // calculate the point of intersection between the edge
+                        // and the X axis
+                        const float x = -v0.y() * (v1.x() - v0.x()) / (v1.y() - v0.y()) + v0.x();
+                        if (x >= 0)
+                            c += 1; // edge intersects with the X axis
+                    }
+                }
+
+                v0 = v1;
+            }
+
+            if (c % 2 == 0)
+                return Math<float>::nan();
+            return dist;
+        }
+
+        size_t IndexedBrushGeometry::memorySize() const {
+            return (m_vertices.capacity() * sizeof(Vec3f) +
+                    m_edges.capacity() * sizeof(IndexedEdge) +
+                    m_sides.capacity() * sizeof(IndexedSide) +
+                    m_sideEdges.capacity() * sizeof(uint32_t) +
+                    m_sideVertices.capacity() * sizeof(uint32_t));
+        }
+    }
+}
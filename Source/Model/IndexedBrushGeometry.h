@@ -0,0 +1,359 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__IndexedBrushGeometry__
+#define __TrenchBroom__IndexedBrushGeometry__
+
+#include "Model/BrushGeometryTypes.h"
+#include "Model/FaceTypes.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <functional>
+#include <map>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushGeometry;
+        class Face;
+
+        // The vertex positions of one side of a brush, in counter clockwise order when looking at the side from
+        // outside the brush.
+        class SideVertexList {
+        private:
+            const Vec3f::List* m_positions;
+            const uint32_t* m_indices;
+            size_t m_count;
+        public:
+            SideVertexList() :
+            m_positions(NULL),
+            m_indices(NULL),
+            m_count(0) {}
+
+            SideVertexList(const Vec3f::List& positions, const uint32_t* indices, size_t count) :
+            m_positions(&positions),
+            m_indices(indices),
+            m_count(count) {}
+
+            inline size_t size() const {
+                return m_count;
+            }
+
+            inline bool empty() const {
+                return m_count == 0;
+            }
+
+            inline const Vec3f& operator[] (size_t index) const {
+                assert(index < m_count);
+                return (*m_positions)[m_indices[index]];
+            }
+
+            inline const Vec3f& front() const {
+                return (*this)[0];
+            }
+
+            inline const Vec3f& back() const {
+                return (*this)[m_count - 1];
+            }
+
+            inline uint32_t vertexIndex(size_t index) const {
+                assert(index < m_count);
+                return m_indices[index];
+            }
+
+            inline bool contains(uint32_t vertexIndex) const {
+                for (size_t i = 0; i < m_count; i++)
+                    if (m_indices[i] == vertexIndex)
+                        return true;
+                return false;
+            }
+        };
+
+        // Stores the vertices, edges and sides of a brush in flat arrays which refer to each other by index. This is
+        // the persistent form of a brush's geometry: copying it copies a handful of arrays, and it takes far less
+        // memory than the linked form. Operations which change the topology expand it into a BrushGeometry, edit
+        // that, and compact the result back into this form.
+        class IndexedBrushGeometry {
+        public:
+            static const uint32_t NoIndex = 0xFFFFFFFF;
+
+            // the edge runs from start to end when seen from its right side
+            struct IndexedEdge {
+                uint32_t start;
+                uint32_t end;
+                uint32_t left;
+                uint32_t right;
+
+                IndexedEdge(uint32_t i_start, uint32_t i_end, uint32_t i_left, uint32_t i_right) :
+                start(i_start),
+                end(i_end),
+                left(i_left),
+                right(i_right) {}
+
+                inline uint32_t startVertex(uint32_t side) const {
+                    if (left == side)
+                        return end;
+                    if (right == side)
+                        return start;
+                    return NoIndex;
+                }
+            };
+
+            // the edges of a side are stored in the range [firstEdge, firstEdge + edgeCount) of the side edges
+            struct IndexedSide {
+                uint32_t face;
+                uint32_t firstEdge;
+                uint32_t edgeCount;
+
+                IndexedSide(uint32_t i_face, uint32_t i_firstEdge, uint32_t i_edgeCount) :
+                face(i_face),
+                firstEdge(i_firstEdge),
+                edgeCount(i_edgeCount) {}
+            };
+
+            typedef std::vector<IndexedEdge> EdgeList;
+            typedef std::vector<IndexedSide> SideList;
+        private:
+            Vec3f::List m_vertices;
+            EdgeList m_edges;
+            SideList m_sides;
+            // the edges of every side and the start vertex of each of these edges, in the same order
+            std::vector<uint32_t> m_sideEdges;
+            std::vector<uint32_t> m_sideVertices;
+            Vec3f m_center;
+            BBoxf m_bounds;
+            size_t m_trackedBytes;
+
+            void updateMemory();
+        public:
+            IndexedBrushGeometry();
+            IndexedBrushGeometry(const IndexedBrushGeometry& other);
+            ~IndexedBrushGeometry();
+
+            IndexedBrushGeometry& operator= (const IndexedBrushGeometry& other);
+
+            // stores the given geometry, whose sides must refer to the given faces or to no face at all
+            void compact(const BrushGeometry& geometry, const FaceList& faces);
+            void clear();
+
+            // Builds a geometry element by element. The edges may refer to sides which have not been added yet, but
+            // every edge of a side must have the side on its left or right. Call finish when all elements are added.
+            uint32_t addVertex(const Vec3f& position);
+            uint32_t addEdge(uint32_t start, uint32_t end, uint32_t left, uint32_t right);
+            uint32_t addSide(uint32_t face);
+            // adds the given edge to the last side, returns false if the edge does not border that side
+            bool addSideEdge(uint32_t edge);
+            void finish();
+
+            // moves the vertices without changing the topology, see BrushGeometry::transform
+            void transform(const Mat4f& pointTransform, bool invertOrientation);
+
+            // returns the distance of the intersection of the given side with the given ray, or NaN if they don't intersect
+            float intersectSideWithRay(size_t side, const Planef& boundary, const Rayf& ray) const;
+
+            inline bool empty() const {
+                return m_sides.empty();
+            }
+
+            inline const Vec3f::List& vertices() const {
+                return m_vertices;
+            }
+
+            inline const EdgeList& edges() const {
+                return m_edges;
+            }
+
+            inline const SideList& sides() const {
+                return m_sides;
+            }
+
+            inline SideVertexList sideVertices(size_t side) const {
+                assert(side < m_sides.size());
+                const IndexedSide& indexedSide = m_sides[side];
+                if (indexedSide.edgeCount == 0)
+                    return SideVertexList();
+                return SideVertexList(m_vertices, &m_sideVertices[indexedSide.firstEdge], indexedSide.edgeCount);
+            }
+
+            inline const uint32_t* sideEdges(size_t side) const {
+                assert(side < m_sides.size());
+                const IndexedSide& indexedSide = m_sides[side];
+                return indexedSide.edgeCount > 0 ? &m_sideEdges[indexedSide.firstEdge] : NULL;
+            }
+
+            inline const Vec3f& center() const {
+                return m_center;
+            }
+
+            inline const BBoxf& bounds() const {
+                return m_bounds;
+            }
+
+            inline bool closed() const {
+                for (size_t i = 0; i < m_sides.size(); i++)
+                    if (m_sides[i].face == NoIndex)
+                        return false;
+                return true;
+            }
+
+            size_t memorySize() const;
+        };
+
+        // An edge of a brush, valid as long as the brush's geometry and faces are not changed.
+        class BrushEdge {
+        private:
+            const IndexedBrushGeometry* m_geometry;
+            const FaceList* m_faces;
+            uint32_t m_index;
+
+            inline Face* face(uint32_t side) const {
+                if (side == IndexedBrushGeometry::NoIndex)
+                    return NULL;
+                const uint32_t faceIndex = m_geometry->sides()[side].face;
+                return faceIndex != IndexedBrushGeometry::NoIndex ? (*m_faces)[faceIndex] : NULL;
+            }
+        public:
+            typedef std::vector<BrushEdge> List;
+
+            BrushEdge(const IndexedBrushGeometry& geometry, const FaceList& faces, uint32_t index) :
+            m_geometry(&geometry),
+            m_faces(&faces),
+            m_index(index) {}
+
+            inline uint32_t startIndex() const {
+                return m_geometry->edges()[m_index].start;
+            }
+
+            inline uint32_t endIndex() const {
+                return m_geometry->edges()[m_index].end;
+            }
+
+            inline const Vec3f& start() const {
+                return m_geometry->vertices()[startIndex()];
+            }
+
+            inline const Vec3f& end() const {
+                return m_geometry->vertices()[endIndex()];
+            }
+
+            inline Face* leftFace() const {
+                return face(m_geometry->edges()[m_index].left);
+            }
+
+            inline Face* rightFace() const {
+                return face(m_geometry->edges()[m_index].right);
+            }
+
+            inline Vec3f vector() const {
+                return end() - start();
+            }
+
+            inline Vec3f center() const {
+                return (start() + end()) / 2.0f;
+            }
+
+            inline EdgeInfo info() const {
+                return EdgeInfo(start(), end());
+            }
+
+            inline bool contains(const Vec3f& point, float maxDistance = Math<float>::AlmostZero) const {
+                const Vec3f edgeVec = vector();
+                const Vec3f edgeDir = edgeVec.normalized();
+                const float dot = (point - start()).dot(edgeDir);
+
+                // determine the closest point on the edge
+                Vec3f closestPoint;
+                if (dot < 0.0f)
+                    closestPoint = start();
+                else if ((dot * dot) > edgeVec.lengthSquared())
+                    closestPoint = end();
+                else
+                    closestPoint = start() + edgeDir * dot;
+
+                const float distance2 = (point - closestPoint).lengthSquared();
+                return distance2 <= (maxDistance * maxDistance);
+            }
+
+            inline bool operator== (const BrushEdge& other) const {
+                return m_geometry == other.m_geometry && m_index == other.m_index;
+            }
+
+            inline bool operator< (const BrushEdge& other) const {
+                if (m_geometry != other.m_geometry)
+                    return std::less<const IndexedBrushGeometry*>()(m_geometry, other.m_geometry);
+                return m_index < other.m_index;
+            }
+        };
+
+        // The edges of a whole brush or of one of its sides.
+        class BrushEdgeList {
+        private:
+            const IndexedBrushGeometry* m_geometry;
+            const FaceList* m_faces;
+            const uint32_t* m_indices;
+            size_t m_count;
+        public:
+            BrushEdgeList() :
+            m_geometry(NULL),
+            m_faces(NULL),
+            m_indices(NULL),
+            m_count(0) {}
+
+            BrushEdgeList(const IndexedBrushGeometry& geometry, const FaceList& faces) :
+            m_geometry(&geometry),
+            m_faces(&faces),
+            m_indices(NULL),
+            m_count(geometry.edges().size()) {}
+
+            BrushEdgeList(const IndexedBrushGeometry& geometry, const FaceList& faces, size_t side) :
+            m_geometry(&geometry),
+            m_faces(&faces),
+            m_indices(geometry.sideEdges(side)),
+            m_count(geometry.sides()[side].edgeCount) {}
+
+            inline size_t size() const {
+                return m_count;
+            }
+
+            inline bool empty() const {
+                return m_count == 0;
+            }
+
+            inline BrushEdge operator[] (size_t index) const {
+                assert(index < m_count);
+                return BrushEdge(*m_geometry, *m_faces, m_indices != NULL ? m_indices[index] : static_cast<uint32_t>(index));
+            }
+        };
+
+        static const BrushEdge::List EmptyBrushEdgeList;
+
+        typedef std::map<Vec3f, BrushEdge::List, Vec3f::LexicographicOrder> VertexToEdgesMap;
+    }
+}
+
+#endif /* defined(__TrenchBroom__IndexedBrushGeometry__) */
@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "IntegerPlanePointCache.h"
+
+#include "Utility/CoordinatePlane.h"
+
+#include <algorithm>
+#include <set>
+
+namespace TrenchBroom {
+    namespace Model {
+        // Hands out the planes of a list to the threads which search their points.
+        class IntegerPlanePointQueue {
+        private:
+            IntegerPlanePointCache& m_cache;
+            const std::vector<Planef>& m_planes;
+            wxCriticalSection m_lock;
+            size_t m_next;
+        public:
+            IntegerPlanePointQueue(IntegerPlanePointCache& cache, const std::vector<Planef>& planes) :
+            m_cache(cache),
+            m_planes(planes),
+            m_next(0) {}
+
+            void run() {
+                FindIntegerPlanePoints search;
+                while (true) {
+                    size_t index;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_next >= m_planes.size())
+                            return;
+                        index = m_next++;
+                    }
+
+                    FacePoints points;
+                    m_cache.findPoints(search, m_planes[index], points);
+                }
+            }
+        };
+
+        class IntegerPlanePointSearch : public wxThread {
+        private:
+            IntegerPlanePointQueue& m_queue;
+        public:
+            IntegerPlanePointSearch(IntegerPlanePointQueue& queue) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_queue(queue) {}
+
+            ExitCode Entry() {
+                m_queue.run();
+                return (wxThread::ExitCode)0;
+            }
+        };
+
+        IntegerPlanePointCache& IntegerPlanePointCache::sharedCache() {
+            static IntegerPlanePointCache cache;
+            return cache;
+        }
+
+        void IntegerPlanePointCache::findPoints(const FindIntegerPlanePoints& search, const Planef& plane, FacePoints& points) {
+            const PlaneKey key(plane);
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                PointsMap::const_iterator it = m_points.find(key);
+                if (it != m_points.end()) {
+                    for (size_t i = 0; i < 3; i++)
+                        points[i] = it->second.points[i];
+                    m_statistics.hits++;
+                    return;
+                }
+            }
+
+            // search without holding the lock so that other threads can search at the same time
+            search(plane, points, 0);
+
+            Points entry;
+            for (size_t i = 0; i < 3; i++)
+                entry.points[i] = points[i];
+
+            wxCriticalSectionLocker lock(m_lock);
+            if (m_points.size() >= MaxEntries)
+                m_points.clear();
+            m_points[key] = entry;
+            m_statistics.misses++;
+        }
+
+        void IntegerPlanePointCache::precompute(const std::vector<Planef>& planes, size_t threadCount) {
+            std::vector<Planef> missing;
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                std::set<PlaneKey> found;
+                for (size_t i = 0; i < planes.size(); i++) {
+                    const PlaneKey key(planes[i]);
+                    if (m_points.find(key) == m_points.end() && found.insert(key).second)
+                        missing.push_back(planes[i]);
+                }
+            }
+
+            if (missing.empty())
+                return;
+
+            // the first search initializes function statics, which not all compilers do in a thread safe way
+            FindIntegerPlanePoints search;
+            CoordinatePlanef::plane(Vec3f::PosZ);
+            FacePoints points;
+            findPoints(search, missing.back(), points);
+            missing.pop_back();
+
+            IntegerPlanePointQueue queue(*this, missing);
+            std::vector<IntegerPlanePointSearch*> workers;
+            const size_t workerCount = threadCount > 1 ? std::min(threadCount - 1, missing.size()) : 0;
+            for (size_t i = 0; i < workerCount; i++) {
+                IntegerPlanePointSearch* worker = new IntegerPlanePointSearch(queue);
+                if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+                    workers.push_back(worker);
+                else
+                    delete worker;
+            }
+
+            // the calling thread searches too, so all planes are searched even if no worker could be started
+            queue.run();
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+        }
+
+        IntegerPlanePointCache::Statistics IntegerPlanePointCache::statistics() {
+            wxCriticalSectionLocker lock(m_lock);
+            return m_statistics;
+        }
+
+        void IntegerPlanePointCache::clear() {
+            wxCriticalSectionLocker lock(m_lock);
+            m_points.clear();
+            m_statistics = Statistics();
+        }
+    }
+}
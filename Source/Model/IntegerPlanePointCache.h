@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__IntegerPlanePointCache__
+#define __TrenchBroom__IntegerPlanePointCache__
+
+#include "Model/FaceTypes.h"
+#include "Utility/FindPlanePoints.h"
+#include "Utility/VecMath.h"
+
+#include <map>
+#include <vector>
+
+#include <wx/thread.h>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        // Remembers the integer points found for a plane so that the search runs only once for all faces on the same
+        // plane. The cache is shared by all brushes and may be filled by several threads at once.
+        class IntegerPlanePointCache {
+        public:
+            struct Statistics {
+                size_t hits;
+                size_t misses;
+
+                Statistics() : hits(0), misses(0) {}
+            };
+        private:
+            // the points of neighbouring planes differ, so planes are only equal if all their components are equal
+            struct PlaneKey {
+                float values[4];
+
+                PlaneKey(const Planef& plane) {
+                    values[0] = plane.normal.x();
+                    values[1] = plane.normal.y();
+                    values[2] = plane.normal.z();
+                    values[3] = plane.distance;
+                }
+
+                inline bool operator<(const PlaneKey& other) const {
+                    for (size_t i = 0; i < 4; i++) {
+                        if (values[i] < other.values[i])
+                            return true;
+                        if (values[i] > other.values[i])
+                            return false;
+                    }
+                    return false;
+                }
+            };
+
+            struct Points {
+                Vec3f points[3];
+            };
+
+            typedef std::map<PlaneKey, Points> PointsMap;
+
+            static const size_t MaxEntries = 1 << 16;
+
+            wxCriticalSection m_lock;
+            PointsMap m_points;
+            Statistics m_statistics;
+
+            IntegerPlanePointCache() {}
+        public:
+            static IntegerPlanePointCache& sharedCache();
+
+            // finds the integer points for the given plane, either in the cache or by searching them
+            void findPoints(const FindIntegerPlanePoints& search, const Planef& plane, FacePoints& points);
+
+            // searches the points of all planes which are not cached yet on the given number of worker threads
+            void precompute(const std::vector<Planef>& planes, size_t threadCount);
+
+            Statistics statistics();
+            void clear();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__IntegerPlanePointCache__) */
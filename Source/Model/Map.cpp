@@ -21,6 +21,8 @@
 
 #include "Model/Brush.h"
 #include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/IntegerPlanePointCache.h"
 #include "Utility/List.h"
 
 namespace TrenchBroom {
@@ -115,6 +117,27 @@ namespace TrenchBroom {
 
         void Map::setForceIntegerFacePoints(bool forceIntegerFacePoints) {
             EntityList::const_iterator entityIt, entityEnd;
+
+            if (forceIntegerFacePoints) {
+                // search the points of all faces in parallel so that the brushes below find them in the cache
+                std::vector<Planef> planes;
+                for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
+                    const BrushList& brushes = (*entityIt)->brushes();
+                    for (size_t i = 0; i < brushes.size(); i++) {
+                        const FaceList& faces = brushes[i]->faces();
+                        for (size_t j = 0; j < faces.size(); j++) {
+                            Vec3f p1, p2, p3;
+                            faces[j]->getPoints(p1, p2, p3);
+                            if (!p1.isInteger() || !p2.isInteger() || !p3.isInteger())
+                                planes.push_back(faces[j]->boundary());
+                        }
+                    }
+                }
+
+                const int cpuCount = wxThread::GetCPUCount();
+                IntegerPlanePointCache::sharedCache().precompute(planes, cpuCount > 0 ? static_cast<size_t>(cpuCount) : 1);
+            }
+
             for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& entity = **entityIt;
                 const Model::BrushList& brushes = entity.brushes();
@@ -131,10 +154,17 @@ namespace TrenchBroom {
         void Map::addEntity(Entity& entity) {
             if (!entity.worldspawn() || worldspawn() == NULL) {
                 m_entities.push_back(&entity);
-                addEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
+                addEntityTargetname(entity, entity.propertyForKey(PropertyKeyTable::TargetnameId));
                 addEntityTargets(entity);
                 addEntityKillTargets(entity);
+                m_propertyIndex.addEntity(entity);
                 entity.setMap(this);
+                
+                // an entity that is added again may have been removed before the map file was last saved
+                entity.setModified(true);
+                const BrushList& brushes = entity.brushes();
+                for (size_t i = 0; i < brushes.size(); i++)
+                    brushes[i]->setModified(true);
             }
         }
         
@@ -142,9 +172,10 @@ namespace TrenchBroom {
             if (entity.worldspawn())
                 m_worldspawn = NULL;
             entity.setMap(NULL);
-            removeEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
+            removeEntityTargetname(entity, entity.propertyForKey(PropertyKeyTable::TargetnameId));
             removeEntityTargets(entity);
             removeEntityKillTargets(entity);
+            m_propertyIndex.removeEntity(entity);
             Utility::erase(m_entities, &entity);
         }
 
@@ -188,6 +219,18 @@ namespace TrenchBroom {
             addEntityKillTarget(entity, newTargetname);
         }
 
+        void Map::updateEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue* newValue, const PropertyValue* oldValue) {
+            const PropertyKeyId keyId = PropertyKeyTable::intern(key);
+            if (oldValue != NULL)
+                m_propertyIndex.removeProperty(entity, keyId, *oldValue);
+            if (newValue != NULL)
+                m_propertyIndex.addProperty(entity, keyId, *newValue);
+        }
+        
+        void Map::removeEntityProperties(Entity& entity) {
+            m_propertyIndex.removeEntity(entity);
+        }
+
         Entity* Map::worldspawn() {
             for (unsigned int i = 0; i < m_entities.size() && m_worldspawn == NULL; i++) {
                 Entity* entity = m_entities[i];
@@ -202,6 +245,7 @@ namespace TrenchBroom {
             m_entitiesWithTargetname.clear();
             m_entitiesWithTarget.clear();
             m_entitiesWithKillTarget.clear();
+            m_propertyIndex.clear();
             Utility::deleteAll(m_entities);
             m_worldspawn = NULL;
         }
@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__Map__
 #define __TrenchBroom__Map__
 
+#include "Model/EntityPropertyIndex.h"
 #include "Model/EntityTypes.h"
 #include "Utility/VecMath.h"
 
@@ -41,6 +42,7 @@ namespace TrenchBroom {
             TargetnameEntityMap m_entitiesWithTargetname;
             TargetnameEntityMap m_entitiesWithTarget;
             TargetnameEntityMap m_entitiesWithKillTarget;
+            EntityPropertyIndex m_propertyIndex;
             Entity* m_worldspawn;
             
             void addEntityTargetname(Entity& entity, const String* targetname);
@@ -81,6 +83,14 @@ namespace TrenchBroom {
             EntityList entitiesWithKillTarget(const String& targetname) const;
             void updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
+            inline const EntityPropertyIndex& propertyIndex() const {
+                return m_propertyIndex;
+            }
+            
+            // must be called before the property is changed
+            void updateEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue* newValue, const PropertyValue* oldValue);
+            void removeEntityProperties(Entity& entity);
+            
             inline const EntityList& entities() const {
                 return m_entities;
             }
@@ -23,6 +23,7 @@
 #include "Controller/Command.h"
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
+#include "IO/MapCache.h"
 #include "IO/MapParser.h"
 #include "IO/MapWriter.h"
 #include "IO/Wad.h"
@@ -30,6 +31,7 @@
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinitionManager.h"
+#include "Model/IntegerPlanePointCache.h"
 #include "Model/Face.h"
 #include "Model/Map.h"
 #include "Model/Octree.h"
@@ -43,6 +45,7 @@
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
 #include "Utility/String.h"
+#include "Utility/Tracer.h"
 #include "Utility/VecMath.h"
 #include "View/EditorView.h"
 #include "View/FaceInspector.h"
@@ -76,7 +79,8 @@ namespace TrenchBroom {
                 console().info("Loading file %s", file.mbc_str().data());
                 
                 View::ProgressIndicatorDialog progressIndicator;
-                loadMap(mappedFile->begin(), mappedFile->end(), progressIndicator);
+                loadMap(path, mappedFile->begin(), mappedFile->end(), progressIndicator);
+                m_mapFile = mappedFile;
                 loadTextures();
                 loadEntityDefinitionFile();
 
@@ -94,12 +98,37 @@ namespace TrenchBroom {
             return false;
         }
 
+        void MapDocument::setAllModified(const EntityList& entities) {
+            for (size_t i = 0; i < entities.size(); i++) {
+                Entity& entity = *entities[i];
+                entity.setModified(true);
+                const BrushList& brushes = entity.brushes();
+                for (size_t j = 0; j < brushes.size(); j++)
+                    brushes[j]->setModified(true);
+            }
+        }
+
         bool MapDocument::DoSaveDocument(const wxString& file) {
             try {
                 wxStopWatch watch;
+                const String path = file.ToStdString();
+                IO::FileManager fileManager;
+                
+                // write to a temporary file first so that a failed save leaves the existing file intact
+                const String tempPath = fileManager.appendExtension(path, "tmp");
                 IO::MapWriter mapWriter;
-                mapWriter.writeToFileAtPath(*m_map, file.ToStdString(), true);
-                console().info("Saved map file to %s in %f seconds", file.ToStdString().c_str(), watch.Time() / 1000.0f);
+                mapWriter.writeToFileAtPath(*m_map, tempPath, true, m_mapFile.get(), true);
+                
+                m_mapFile.reset();
+                if (!fileManager.moveFile(tempPath, path, true)) {
+                    // the byte ranges refer to the temporary file now
+                    setAllModified(m_map->entities());
+                    throw IO::IOException("Unable to move %s to %s", tempPath.c_str(), path.c_str());
+                }
+                m_mapFile = fileManager.mapFile(path);
+                
+                console().info("Saved map file to %s in %f seconds", path.c_str(), watch.Time() / 1000.0f);
+                writeMapCache(path);
                 return true;
             } catch (IO::IOException& e) {
                 console().error(e.what());
@@ -108,10 +137,12 @@ namespace TrenchBroom {
         }
 
         void MapDocument::clear() {
+            m_mapFile.reset();
             m_sharedResources->textureRendererManager().invalidate();
             m_editStateManager->clear();
             m_map->clear();
             m_octree->clear();
+            m_picker->invalidateCandidates();
             m_textureManager->clear();
             m_definitionManager->clear();
             unloadPointFile();
@@ -128,14 +159,64 @@ namespace TrenchBroom {
             m_sharedResources->loadPalette(palettePath);
         }
 
-        void MapDocument::loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator) {
+        void MapDocument::loadMap(const String& path, char* begin, char* end, Utility::ProgressIndicator& progressIndicator) {
+            TRACE_ZONE("MapDocument::loadMap");
             progressIndicator.setText("Loading map file...");
             
             wxStopWatch watch;
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const bool useCache = prefs.getBool(Preferences::UseMapCache);
+            
+            IO::MapCache mapCache;
+            if (useCache && mapCache.readMap(IO::MapCache::cachePath(path), begin, end, *m_map)) {
+                console().info("Loaded map file from cache in %f seconds", watch.Time() / 1000.0f);
+                return;
+            }
+            
             IO::MapParser parser(begin, end, console());
             parser.parseMap(*m_map, &progressIndicator);
             
             console().info("Loaded map file in %f seconds", watch.Time() / 1000.0f);
+            
+            size_t brushCount = 0;
+            size_t boxCount = 0;
+            const EntityList& entities = m_map->entities();
+            for (size_t i = 0; i < entities.size(); i++) {
+                const BrushList& brushes = entities[i]->brushes();
+                for (size_t j = 0; j < brushes.size(); j++) {
+                    Face* boxFaces[6];
+                    BBoxf boxBounds;
+                    if (BrushGeometry::findBoxFaces(brushes[j]->faces(), m_map->worldBounds(), boxFaces, boxBounds))
+                        boxCount++;
+                    brushCount++;
+                }
+            }
+            console().debug("%u of %u brushes were built as axis aligned boxes", static_cast<unsigned int>(boxCount), static_cast<unsigned int>(brushCount));
+            
+            if (useCache) {
+                try {
+                    mapCache.writeMap(IO::MapCache::cachePath(path), begin, end, *m_map);
+                } catch (IO::IOException& e) {
+                    console().warn("Could not write map cache: %s", e.what());
+                }
+            }
+        }
+
+        void MapDocument::writeMapCache(const String& path) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            if (!prefs.getBool(Preferences::UseMapCache))
+                return;
+            
+            // the cache is keyed by the contents of the file that was just written
+            if (m_mapFile.get() == NULL)
+                return;
+            
+            try {
+                IO::MapCache mapCache;
+                mapCache.writeMap(IO::MapCache::cachePath(path), m_mapFile->begin(), m_mapFile->end(), *m_map);
+            } catch (IO::IOException& e) {
+                console().warn("Could not write map cache: %s", e.what());
+            }
         }
 
         void MapDocument::setAllTexturesToNull() {
@@ -316,6 +397,7 @@ namespace TrenchBroom {
         }
 
         void MapDocument::entityWillChange(Entity& entity) {
+            entity.setModified(true);
             m_octree->removeObject(entity);
         }
 
@@ -324,6 +406,9 @@ namespace TrenchBroom {
         }
 
         void MapDocument::entitiesWillChange(const EntityList& entities) {
+            for (size_t i = 0; i < entities.size(); i++)
+                entities[i]->setModified(true);
+            
             MapObjectList objects;
             objects.insert(objects.begin(), entities.begin(), entities.end());
             m_octree->removeObjects(objects);
@@ -384,6 +469,7 @@ namespace TrenchBroom {
         }
         
         void MapDocument::brushWillChange(Brush& brush) {
+            brush.setModified(true);
             Entity* entity = brush.entity();
             if (entity != NULL && !entity->worldspawn())
                 m_octree->removeObject(*entity);
@@ -404,6 +490,7 @@ namespace TrenchBroom {
             BrushList::const_iterator it, end;
             for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
                 Brush* brush = *it;
+                brush->setModified(true);
                 Entity* entity = brush->entity();
                 if (entity != NULL && !entity->worldspawn())
                     objects.insert(entity);
@@ -427,6 +514,15 @@ namespace TrenchBroom {
             m_octree->addObjects(Utility::makeList(objects));
         }
 
+        void MapDocument::facesWillChange(const FaceList& faces) {
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Brush* brush = (*it)->brush();
+                if (brush != NULL)
+                    brush->setModified(true);
+            }
+        }
+
         void MapDocument::setForceIntegerCoordinates(bool forceIntegerCoordinates) {
             if (forceIntegerCoordinates)
                 console().info("Converting face plane points to integer coordinates...");
@@ -435,7 +531,18 @@ namespace TrenchBroom {
             
             GetCommandProcessor()->ClearCommands();
             
+            IntegerPlanePointCache& planePointCache = IntegerPlanePointCache::sharedCache();
+            const IntegerPlanePointCache::Statistics before = planePointCache.statistics();
+            wxStopWatch watch;
             m_map->setForceIntegerFacePoints(forceIntegerCoordinates);
+            if (forceIntegerCoordinates) {
+                const IntegerPlanePointCache::Statistics after = planePointCache.statistics();
+                const size_t hits = after.hits - before.hits;
+                const size_t misses = after.misses - before.misses;
+                const float hitRate = hits + misses > 0 ? 100.0f * static_cast<float>(hits) / static_cast<float>(hits + misses) : 0.0f;
+                console().info("Found integer face points in %f seconds with %u plane searches (%.0f%% cache hits)", watch.Time() / 1000.0f, static_cast<unsigned int>(misses), hitRate);
+            }
+            setAllModified(m_map->entities());
             worldspawn().setProperty(Entity::FacePointFormatKey, forceIntegerCoordinates);
             incModificationCount();
 
@@ -455,6 +562,14 @@ namespace TrenchBroom {
             return *m_map;
         }
 
+        const Octree& MapDocument::octree() const {
+            return *m_octree;
+        }
+
+        const IO::MappedFile* MapDocument::mapFile() const {
+            return m_mapFile.get();
+        }
+
         EntityDefinitionManager& MapDocument::definitionManager() const {
             return *m_definitionManager;
         }
@@ -20,8 +20,10 @@
 #ifndef __TrenchBroom__MapDocument__
 #define __TrenchBroom__MapDocument__
 
+#include "IO/AbstractFileManager.h"
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
 #include "Utility/String.h"
 
 #include <wx/docview.h>
@@ -64,6 +66,7 @@ namespace TrenchBroom {
             Utility::Console* m_console;
             Renderer::SharedResources* m_sharedResources;
             Map* m_map;
+            IO::MappedFile::Ptr m_mapFile; // the file that the byte ranges of the unmodified entities refer to
             EditStateManager* m_editStateManager;
             Octree* m_octree;
             Picker* m_picker;
@@ -86,7 +89,10 @@ namespace TrenchBroom {
             void clear();
 
             void loadPalette();
-            void loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator);
+            void loadMap(const String& path, char* begin, char* end, Utility::ProgressIndicator& progressIndicator);
+            void writeMapCache(const String& path);
+            // forces the given entities and their brushes to be written instead of copied from the map file
+            void setAllModified(const EntityList& entities);
 
             void setAllTexturesToNull();
             void refreshAllTextures();
@@ -113,11 +119,14 @@ namespace TrenchBroom {
             void brushDidChange(Brush& brush);
             void brushesWillChange(const BrushList& brushes);
             void brushesDidChange(const BrushList& brushes);
+            void facesWillChange(const FaceList& faces);
             void setForceIntegerCoordinates(bool forceIntegerCoordinates);
             
             Utility::Console& console() const;
             Renderer::SharedResources& sharedResources() const;
             Map& map() const;
+            const Octree& octree() const;
+            const IO::MappedFile* mapFile() const;
             EntityDefinitionManager& definitionManager() const;
             EditStateManager& editStateManager() const;
             TextureManager& textureManager() const;
@@ -41,6 +41,9 @@ namespace TrenchBroom {
             
             size_t m_fileFirstLine;
             size_t m_fileLineCount;
+            size_t m_fileOffset;
+            size_t m_fileLength;
+            bool m_modified;
         public:
             enum Type {
                 EntityObject,
@@ -51,7 +54,10 @@ namespace TrenchBroom {
             m_editState(EditState::Default),
             m_previouslyLocked(false),
             m_fileFirstLine(0),
-            m_fileLineCount(0) {
+            m_fileLineCount(0),
+            m_fileOffset(0),
+            m_fileLength(0),
+            m_modified(true) {
                 static unsigned int currentId = 1;
                 m_uniqueId = currentId++;
             }
@@ -144,6 +150,10 @@ namespace TrenchBroom {
                 return m_fileFirstLine;
             }
             
+            inline size_t fileLineCount() const {
+                return m_fileLineCount;
+            }
+            
             inline bool occupiesFileLine(size_t line) const {
                 return line >= m_fileFirstLine && line < m_fileFirstLine + m_fileLineCount;
             }
@@ -152,6 +162,30 @@ namespace TrenchBroom {
                 m_fileFirstLine = firstLine;
                 m_fileLineCount = lineCount;
             }
+            
+            // the byte range of this object in the map file it was last read from or saved to
+            inline size_t fileOffset() const {
+                return m_fileOffset;
+            }
+            
+            inline size_t fileLength() const {
+                return m_fileLength;
+            }
+            
+            inline void setFileRange(size_t offset, size_t length) {
+                m_fileOffset = offset;
+                m_fileLength = length;
+            }
+            
+            // modified objects cannot be copied from the map file when saving, for an entity this only refers to its
+            // properties and the list of its brushes, each brush tracks its own modifications
+            inline bool modified() const {
+                return m_modified;
+            }
+            
+            inline void setModified(bool modified) {
+                m_modified = modified;
+            }
         };
     }
 }
@@ -0,0 +1,224 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MapValidator.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Model/Octree.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace Model {
+        String MapIssue::description() const {
+            StringStream message;
+            message << "Brush at line " << m_brush->fileLine();
+            switch (m_type) {
+                case NonClosedBrush:
+                    message << " is not closed";
+                    break;
+                case BrushOutsideWorld:
+                    message << " exceeds the world bounds";
+                    break;
+                case DuplicateBrush:
+                    message << " is a duplicate of another brush";
+                    break;
+                case DegenerateFace:
+                    message << " has a degenerate face (face " << (m_faceIndex + 1) << ")";
+                    break;
+                case DuplicateFace:
+                    message << " has a duplicate face (face " << (m_faceIndex + 1) << ")";
+                    break;
+                case ColinearFacePoints:
+                    message << " has nearly colinear plane points (face " << (m_faceIndex + 1) << ")";
+                    break;
+                case NonIntegerFacePoints:
+                    message << " has non-integer plane points (face " << (m_faceIndex + 1) << ")";
+                    break;
+            }
+            return message.str();
+        }
+
+        // Hands out chunks of the brush list to the threads which validate them. Each chunk has its own issue list, so
+        // the threads only synchronize when they take the next chunk.
+        class MapValidatorQueue {
+        private:
+            static const size_t ChunkSize = 256;
+
+            const MapValidator& m_validator;
+            const BrushList& m_brushes;
+            std::vector<MapIssue::List>& m_chunkIssues;
+            wxCriticalSection m_lock;
+            size_t m_nextChunk;
+        public:
+            MapValidatorQueue(const MapValidator& validator, const BrushList& brushes, std::vector<MapIssue::List>& chunkIssues) :
+            m_validator(validator),
+            m_brushes(brushes),
+            m_chunkIssues(chunkIssues),
+            m_nextChunk(0) {
+                m_chunkIssues.resize((m_brushes.size() + ChunkSize - 1) / ChunkSize);
+            }
+
+            inline size_t chunkCount() const {
+                return m_chunkIssues.size();
+            }
+
+            void run() {
+                while (true) {
+                    size_t chunk;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_nextChunk >= m_chunkIssues.size())
+                            return;
+                        chunk = m_nextChunk++;
+                    }
+
+                    const size_t end = std::min((chunk + 1) * ChunkSize, m_brushes.size());
+                    for (size_t i = chunk * ChunkSize; i < end; i++)
+                        m_validator.validateBrush(*m_brushes[i], m_chunkIssues[chunk]);
+                }
+            }
+        };
+
+        class MapValidatorThread : public wxThread {
+        private:
+            MapValidatorQueue& m_queue;
+        public:
+            MapValidatorThread(MapValidatorQueue& queue) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_queue(queue) {}
+
+            ExitCode Entry() {
+                m_queue.run();
+                return (wxThread::ExitCode)0;
+            }
+        };
+
+        void MapValidator::validateBrush(Brush& brush, MapIssue::List& issues) const {
+            if (!brush.closed())
+                issues.push_back(MapIssue(MapIssue::NonClosedBrush, brush));
+            if (!m_map.worldBounds().contains(brush.bounds()))
+                issues.push_back(MapIssue(MapIssue::BrushOutsideWorld, brush));
+
+            const FaceList& faces = brush.faces();
+            for (size_t i = 0; i < faces.size(); i++) {
+                const Face& face = *faces[i];
+                if (face.vertices().size() < 3)
+                    issues.push_back(MapIssue(MapIssue::DegenerateFace, brush, i));
+
+                for (size_t j = 0; j < i; j++) {
+                    if (faces[j]->boundary().equals(face.boundary())) {
+                        issues.push_back(MapIssue(MapIssue::DuplicateFace, brush, i));
+                        break;
+                    }
+                }
+
+                Vec3f p1, p2, p3;
+                face.getPoints(p1, p2, p3);
+
+                // the face plane is imprecise if the angle between the plane points is very small; the vectors are
+                // not normalized so that coincident points, whose cross product is null, are reported too
+                const Vec3f v1 = p2 - p1;
+                const Vec3f v2 = p3 - p1;
+                if (crossed(v1, v2).lengthSquared() <= 1e-6f * v1.lengthSquared() * v2.lengthSquared())
+                    issues.push_back(MapIssue(MapIssue::ColinearFacePoints, brush, i));
+
+                if (m_map.forceIntegerFacePoints() && (!p1.isInteger() || !p2.isInteger() || !p3.isInteger()))
+                    issues.push_back(MapIssue(MapIssue::NonIntegerFacePoints, brush, i));
+            }
+
+            // only the later of two duplicates is reported, so that deleting all reported brushes keeps one copy
+            const MapObjectList candidates = m_octree.intersect(brush.bounds());
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (candidates[i]->objectType() != MapObject::BrushObject || candidates[i] == &brush)
+                    continue;
+                const Brush& other = *static_cast<const Brush*>(candidates[i]);
+                const bool otherFirst = other.fileLine() < brush.fileLine() || (other.fileLine() == brush.fileLine() && std::less<const Brush*>()(&other, &brush));
+                if (otherFirst && isDuplicate(brush, other)) {
+                    issues.push_back(MapIssue(MapIssue::DuplicateBrush, brush));
+                    break;
+                }
+            }
+        }
+
+        bool MapValidator::isDuplicate(const Brush& brush, const Brush& other) const {
+            if (brush.faces().size() != other.faces().size())
+                return false;
+            if (!brush.bounds().min.equals(other.bounds().min) || !brush.bounds().max.equals(other.bounds().max))
+                return false;
+
+            const FaceList& faces = brush.faces();
+            const FaceList& otherFaces = other.faces();
+            for (size_t i = 0; i < faces.size(); i++) {
+                bool found = false;
+                for (size_t j = 0; j < otherFaces.size() && !found; j++)
+                    found = faces[i]->boundary().equals(otherFaces[j]->boundary());
+                if (!found)
+                    return false;
+            }
+            return true;
+        }
+
+        MapValidator::MapValidator(const Map& map, const Octree& octree) :
+        m_map(map),
+        m_octree(octree) {}
+
+        MapIssue::List MapValidator::validate(size_t threadCount) const {
+            BrushList brushes;
+            const EntityList& entities = m_map.entities();
+            for (size_t i = 0; i < entities.size(); i++) {
+                const BrushList& entityBrushes = entities[i]->brushes();
+                brushes.insert(brushes.end(), entityBrushes.begin(), entityBrushes.end());
+            }
+
+            std::vector<MapIssue::List> chunkIssues;
+            MapValidatorQueue queue(*this, brushes, chunkIssues);
+
+            std::vector<MapValidatorThread*> workers;
+            const size_t workerCount = threadCount > 1 ? std::min(threadCount - 1, queue.chunkCount()) : 0;
+            for (size_t i = 0; i < workerCount; i++) {
+                MapValidatorThread* worker = new MapValidatorThread(queue);
+                if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+                    workers.push_back(worker);
+                else
+                    delete worker;
+            }
+
+            // the calling thread validates too, so all brushes are checked even if no worker could be started
+            queue.run();
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+
+            MapIssue::List issues;
+            for (size_t i = 0; i < chunkIssues.size(); i++)
+                issues.insert(issues.end(), chunkIssues[i].begin(), chunkIssues[i].end());
+            return issues;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__MapValidator__
+#define __TrenchBroom__MapValidator__
+
+#include "Model/BrushTypes.h"
+#include "Utility/String.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Map;
+        class MapValidatorQueue;
+        class Octree;
+
+        class MapIssue {
+        public:
+            typedef std::vector<MapIssue> List;
+
+            typedef enum {
+                NonClosedBrush,
+                BrushOutsideWorld,
+                DuplicateBrush,
+                DegenerateFace,
+                DuplicateFace,
+                ColinearFacePoints,
+                NonIntegerFacePoints
+            } Type;
+        private:
+            Type m_type;
+            Brush* m_brush;
+            size_t m_faceIndex;
+        public:
+            MapIssue(Type type, Brush& brush, size_t faceIndex = 0) :
+            m_type(type),
+            m_brush(&brush),
+            m_faceIndex(faceIndex) {}
+
+            inline Type type() const {
+                return m_type;
+            }
+
+            inline Brush& brush() const {
+                return *m_brush;
+            }
+
+            String description() const;
+        };
+
+        // Checks every brush of a map for problems which usually come from broken or hand edited map files. The
+        // brushes are checked on several threads, so the map must not change while the validator runs.
+        class MapValidator {
+        private:
+            friend class MapValidatorQueue;
+
+            const Map& m_map;
+            const Octree& m_octree;
+
+            void validateBrush(Brush& brush, MapIssue::List& issues) const;
+            bool isDuplicate(const Brush& brush, const Brush& other) const;
+        public:
+            MapValidator(const Map& map, const Octree& octree);
+
+            // the issues are ordered like the brushes in the map
+            MapIssue::List validate(size_t threadCount) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapValidator__) */
@@ -171,10 +171,36 @@ namespace TrenchBroom {
             }
         }
         
+        void OctreeNode::intersect(const Rayf& ray, float tolerance, MapObjectList& objects) {
+            // any ray within the given tolerance deviates from the given ray by at most tolerance * t at
+            // distance t, so we expand the node bounds by the deviation at the node's farthest corner
+            Vec3f farthest;
+            for (unsigned int i = 0; i < 3; i++)
+                farthest[i] = std::max(std::abs(m_bounds.min[i] - ray.origin[i]), std::abs(m_bounds.max[i] - ray.origin[i]));
+            const BBoxf bounds = m_bounds.expanded(tolerance * farthest.length());
+            
+            if (bounds.contains(ray.origin) || !Math<float>::isnan(bounds.intersectWithRay(ray))) {
+                objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+                for (unsigned int i = 0; i < 8; i++)
+                    if (m_children[i] != NULL)
+                        m_children[i]->intersect(ray, tolerance, objects);
+            }
+        }
+        
+        void OctreeNode::intersect(const BBoxf& bounds, MapObjectList& objects) const {
+            if (m_bounds.intersects(bounds)) {
+                objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+                for (unsigned int i = 0; i < 8; i++)
+                    if (m_children[i] != NULL)
+                        m_children[i]->intersect(bounds, objects);
+            }
+        }
+
         Octree::Octree(Map& map, unsigned int minSize) :
         m_minSize(minSize),
         m_map(map),
-        m_root(new OctreeNode(map.worldBounds(), minSize)) {}
+        m_root(new OctreeNode(map.worldBounds(), minSize)),
+        m_revision(0) {}
         
         Octree::~Octree() {
             delete m_root;
@@ -192,16 +218,19 @@ namespace TrenchBroom {
                     m_root->addObject(*brush);
                 }
             }
+            m_revision++;
         }
         
         void Octree::clear() {
             delete m_root;
             m_root = new OctreeNode(m_map.worldBounds(), m_minSize);
+            m_revision++;
         }
         
         void Octree::addObject(MapObject& object) {
             bool result = m_root->addObject(object);
             assert(result);
+            m_revision++;
         }
 
         void Octree::addObjects(const MapObjectList& objects) {
@@ -211,11 +240,13 @@ namespace TrenchBroom {
                 result = m_root->addObject(*object);
                 assert(result);
             }
+            m_revision++;
         }
         
         void Octree::removeObject(MapObject& object) {
             bool result = m_root->removeObject(object);
             assert(result);
+            m_revision++;
         }
         
         void Octree::removeObjects(const MapObjectList& objects) {
@@ -225,6 +256,7 @@ namespace TrenchBroom {
                 result = m_root->removeObject(*object);
                 assert(result);
             }
+            m_revision++;
         }
         
         size_t Octree::count() const {
@@ -236,5 +268,17 @@ namespace TrenchBroom {
             m_root->intersect(ray, result);
             return result;
         }
+
+        MapObjectList Octree::intersect(const Rayf& ray, float tolerance) {
+            MapObjectList result;
+            m_root->intersect(ray, tolerance, result);
+            return result;
+        }
+
+        MapObjectList Octree::intersect(const BBoxf& bounds) const {
+            MapObjectList result;
+            m_root->intersect(bounds, result);
+            return result;
+        }
     }
 }
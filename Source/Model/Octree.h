@@ -58,6 +58,8 @@ namespace TrenchBroom {
             bool empty() const;
             size_t count() const;
             void intersect(const Rayf& ray, MapObjectList& objects);
+            void intersect(const Rayf& ray, float tolerance, MapObjectList& objects);
+            void intersect(const BBoxf& bounds, MapObjectList& objects) const;
         };
         
         class Octree {
@@ -65,6 +67,7 @@ namespace TrenchBroom {
             unsigned int m_minSize;
             Map& m_map;
             OctreeNode* m_root;
+            unsigned int m_revision;
         public:
             Octree(Map& map, unsigned int minSize = 64);
             ~Octree();
@@ -78,7 +81,19 @@ namespace TrenchBroom {
             
             size_t count() const;
 
+            // incremented whenever an object is added or removed, which includes every geometry change
+            inline unsigned int revision() const {
+                return m_revision;
+            }
+
             MapObjectList intersect(const Rayf& ray);
+
+            // returns every object that may be hit by a ray with the same origin whose direction differs
+            // from the given ray's direction by at most the given tolerance
+            MapObjectList intersect(const Rayf& ray, float tolerance);
+
+            // returns every object whose node intersects the given bounds, does not modify the tree
+            MapObjectList intersect(const BBoxf& bounds) const;
         };
     }
 }
@@ -21,6 +21,7 @@
 #include "Model/Face.h"
 #include "Model/MapObject.h"
 #include "Model/Octree.h"
+#include "Utility/Tracer.h"
 
 #include <algorithm>
 
@@ -111,17 +112,49 @@ namespace TrenchBroom {
             return hits(HitType::Any, filter);
         }
 
-        Picker::Picker(Octree& octree) : m_octree(octree) {}
+        bool Picker::candidatesValid(const Rayf& ray) const {
+            return (m_candidatesValid &&
+                    m_candidateRevision == m_octree.revision() &&
+                    m_candidateRay.origin == ray.origin &&
+                    m_candidateRay.direction.squaredDistanceTo(ray.direction) <= m_coherenceTolerance * m_coherenceTolerance);
+        }
+
+        void Picker::narrowPhase(const Rayf& ray, const MapObjectList& objects, PickResult& pickResults) {
+            for (unsigned int i = 0; i < objects.size(); i++)
+                objects[i]->pick(ray, pickResults);
+        }
+
+        Picker::Picker(Octree& octree) :
+        m_octree(octree),
+        m_candidateRevision(0),
+        m_candidatesValid(false),
+        m_coherenceTolerance(0.02f) {}
 
         PickResult* Picker::pick(const Rayf& ray) {
+            TRACE_ZONE("Picker::pick");
             PickResult* pickResults = new PickResult();
+            narrowPhase(ray, m_octree.intersect(ray), *pickResults);
+            return pickResults;
+        }
 
-            MapObjectList objects = m_octree.intersect(ray);
-            for (unsigned int i = 0; i < objects.size(); i++)
-                objects[i]->pick(ray, *pickResults);
-
+        PickResult* Picker::pickCoherent(const Rayf& ray) {
+            TRACE_ZONE("Picker::pickCoherent");
+            if (!candidatesValid(ray)) {
+                m_candidates = m_octree.intersect(ray, m_coherenceTolerance);
+                m_candidateRay = ray;
+                m_candidateRevision = m_octree.revision();
+                m_candidatesValid = true;
+            }
+            
+            PickResult* pickResults = new PickResult();
+            narrowPhase(ray, m_candidates, *pickResults);
             return pickResults;
         }
 
+        void Picker::invalidateCandidates() {
+            m_candidates.clear();
+            m_candidatesValid = false;
+        }
+
     }
 }
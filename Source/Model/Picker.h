@@ -21,6 +21,7 @@
 #define TrenchBroom_Picker_h
 
 #include "Model/Filter.h"
+#include "Model/MapObjectTypes.h"
 #include "Utility/VecMath.h"
 
 using namespace TrenchBroom::VecMath;
@@ -136,9 +137,25 @@ namespace TrenchBroom {
         class Picker {
         private:
             Octree& m_octree;
+            
+            // candidates from the last coherent pick, valid while the octree revision and the ray origin
+            // stay the same and the ray direction stays within the tolerance
+            MapObjectList m_candidates;
+            Rayf m_candidateRay;
+            unsigned int m_candidateRevision;
+            bool m_candidatesValid;
+            float m_coherenceTolerance;
+            
+            bool candidatesValid(const Rayf& ray) const;
+            void narrowPhase(const Rayf& ray, const MapObjectList& objects, PickResult& pickResults);
         public:
             Picker(Octree& octree);
             PickResult* pick(const Rayf& ray);
+            
+            // for rays that move only slightly from one pick to the next, such as the mouse ray while the camera
+            // stands still; reuses the previous candidate objects and only performs the narrow phase
+            PickResult* pickCoherent(const Rayf& ray);
+            void invalidateCandidates();
         };
     }
 }
@@ -21,6 +21,7 @@
 
 #include "Renderer/Palette.h"
 #include "Utility/List.h"
+#include "Utility/Tracer.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -28,6 +29,7 @@ namespace TrenchBroom {
         m_wad(path) {}
 
         unsigned char* TextureCollectionLoader::load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException) {
+            TRACE_ZONE("TextureCollectionLoader::load");
             IO::Mip* mip = NULL;
             try {
                 mip = m_wad.loadMip(texture.name(), 1);
@@ -49,6 +51,7 @@ namespace TrenchBroom {
         TextureCollection::TextureCollection(const String& name, const String& path) throw (IO::IOException) :
         m_name(name),
         m_path(path) {
+            TRACE_ZONE("TextureCollection::load");
             IO::Mip::List mips;
             try {
                 IO::Wad wad(m_path);
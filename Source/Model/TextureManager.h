@@ -99,6 +99,10 @@ namespace TrenchBroom {
                 return m_name;
             }
             
+            inline const String& path() const {
+                return m_path;
+            }
+            
             inline void update(const String& name, const String& path) {
                 m_name = name;
                 m_path = path;
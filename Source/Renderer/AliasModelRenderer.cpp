@@ -27,20 +27,30 @@
 #include "Renderer/RenderContext.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/Shader/Shader.h"
+#include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/Vbo.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace AliasModelUniforms {
+            static const Uniform Texture("Texture");
+        }
+
         AliasModelRenderer::AliasModelRenderer(const Model::Alias& alias, unsigned int frameIndex, unsigned int skinIndex, Vbo& vbo, const Palette& palette) :
         m_alias(alias),
         m_frameIndex(frameIndex),
         m_skinIndex(skinIndex),
-        m_palette(palette),
         m_texture(NULL),
         m_vbo(vbo),
-        m_vertexArray(NULL) {}
+        m_vertexArray(NULL) {
+            assert(m_skinIndex < m_alias.skins().size());
+            
+            // the skin is converted right away so that no palette is needed on the GL thread
+            Model::AliasSkin& skin = *m_alias.skins()[m_skinIndex];
+            m_texture = TextureRendererPtr(new TextureRenderer(skin, 0, palette));
+        }
 
         AliasModelRenderer::~AliasModelRenderer() {
             m_frameIndex = 0;
@@ -51,28 +61,23 @@ namespace TrenchBroom {
 
         void AliasModelRenderer::render(ShaderProgram& shaderProgram) {
             if (m_vertexArray == NULL) {
-                assert(m_skinIndex < m_alias.skins().size());
                 assert(m_frameIndex < m_alias.frames().size());
                 
-                Model::AliasSkin& skin = *m_alias.skins()[m_skinIndex];
-                m_texture = TextureRendererPtr(new TextureRenderer(skin, 0, m_palette));
-
-                Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
-                const Model::AliasFrameTriangleList& triangles = frame.triangles();
-                unsigned int vertexCount = static_cast<unsigned int>(3 * triangles.size());
+                const Model::AliasVertexLayout& layout = m_alias.layout();
+                const Model::AliasVertexLayout::IndexList& indices = layout.indices();
+                const Vec2f::List& texCoords = layout.texCoords();
+                const Vec3f::List& positions = m_alias.frame(m_frameIndex).positions();
+                unsigned int vertexCount = static_cast<unsigned int>(indices.size());
                 
                 m_vertexArray = new VertexArray(m_vbo, GL_TRIANGLES, vertexCount,
                                                 Attribute::position3f(),
                                                 Attribute::texCoord02f());
 
                 SetVboState mapVbo(m_vbo, Vbo::VboMapped);
-                for (unsigned int i = 0; i < triangles.size(); i++) {
-                    Model::AliasFrameTriangle& triangle = *triangles[i];
-                    for (unsigned int j = 0; j < 3; j++) {
-                        Model::AliasFrameVertex& vertex = triangle[j];
-                        m_vertexArray->addAttribute(vertex.position());
-                        m_vertexArray->addAttribute(vertex.texCoords());
-                    }
+                for (unsigned int i = 0; i < indices.size(); i++) {
+                    const unsigned int index = indices[i];
+                    m_vertexArray->addAttribute(positions[index]);
+                    m_vertexArray->addAttribute(texCoords[index]);
                 }
             }
 
@@ -80,7 +85,7 @@ namespace TrenchBroom {
             
             glActiveTexture(GL_TEXTURE0);
             m_texture->activate();
-            shaderProgram.setUniformVariable("Texture", 0);
+            shaderProgram.setUniformVariable(AliasModelUniforms::Texture, 0);
             m_vertexArray->render();
             m_texture->deactivate();
         }
@@ -94,19 +99,13 @@ namespace TrenchBroom {
         }
 
         BBoxf AliasModelRenderer::boundsAfterTransformation(const Mat4f& transformation) const {
-            Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
-            const Model::AliasFrameTriangleList& triangles = frame.triangles();
+            const Vec3f::List& positions = m_alias.frame(m_frameIndex).positions();
 
             BBoxf bounds;
-            bounds.min = bounds.max = transformation * (*triangles[0])[0].position();
+            bounds.min = bounds.max = transformation * positions[0];
             
-            for (unsigned int i = 1; i < triangles.size(); i++) {
-                Model::AliasFrameTriangle& triangle = *triangles[i];
-                for (unsigned int j = 0; j < 3; j++) {
-                    Model::AliasFrameVertex& vertex = triangle[j];
-                    bounds.mergeWith(transformation * vertex.position());
-                }
-            }
+            for (unsigned int i = 1; i < positions.size(); i++)
+                bounds.mergeWith(transformation * positions[i]);
             
             return bounds;
         }
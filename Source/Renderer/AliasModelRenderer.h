@@ -43,7 +43,6 @@ namespace TrenchBroom {
             unsigned int m_frameIndex;
             unsigned int m_skinIndex;
 
-            const Palette& m_palette;
             TextureRendererPtr m_texture;
 
             Vbo& m_vbo;
@@ -93,6 +93,16 @@ namespace TrenchBroom {
                 return attr;
             }
             
+            static const Attribute& texCoord11f() {
+                static const Attribute attr = Attribute(1, GL_FLOAT, TexCoord1);
+                return attr;
+            }
+            
+            static const Attribute& texCoord12f() {
+                static const Attribute attr = Attribute(2, GL_FLOAT, TexCoord1);
+                return attr;
+            }
+            
             inline GLint size() const {
                 return m_size;
             }
@@ -460,6 +470,16 @@ namespace TrenchBroom {
                 attributesAdded();
             }
             
+            // adds vertices whose values are already interleaved in the order of the attributes
+            inline void addVertices(const float* values, size_t vertexCount) {
+                assert(m_specIndex == 0);
+                assert(m_padBy == 0);
+                assert(m_vertexCount + vertexCount <= m_vertexCapacity);
+                
+                m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(values), m_writeOffset, vertexCount * m_vertexSize);
+                m_vertexCount += vertexCount;
+            }
+            
             inline void addAttributes(const FaceVertex::List& cachedVertices) {
                 assert(m_attributes[0].attributeType() == Attribute::Position);
                 assert(m_attributes[0].valueType() == GL_FLOAT);
@@ -477,6 +497,24 @@ namespace TrenchBroom {
                 attributesAdded(static_cast<size_t>(cachedVertices.size()));
             }
             
+            inline void addAttributes(const FaceVertex::List& cachedVertices, float texCoord1) {
+                assert(m_attributes.size() == 4);
+                assert(m_attributes[0].attributeType() == Attribute::Position);
+                assert(m_attributes[1].attributeType() == Attribute::Normal);
+                assert(m_attributes[2].attributeType() == Attribute::TexCoord0);
+                assert(m_attributes[3].attributeType() == Attribute::TexCoord1);
+                assert(m_attributes[3].valueType() == GL_FLOAT);
+                assert(m_attributes[3].size() == 1);
+                assert(m_padBy == 0);
+                assert(m_vertexCount + cachedVertices.size() <= m_vertexCapacity);
+                
+                for (size_t i = 0; i < cachedVertices.size(); i++) {
+                    m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&cachedVertices[i]), m_writeOffset, sizeof(FaceVertex));
+                    m_writeOffset = m_block->writeFloat(texCoord1, m_writeOffset);
+                }
+                attributesAdded(static_cast<size_t>(cachedVertices.size()));
+            }
+            
             inline void bindAttributes(const ShaderProgram& program) {
                 for (size_t i = 0; i < m_attributes.size(); i++) {
                     Attribute& attribute = m_attributes[i];
@@ -493,6 +531,7 @@ namespace TrenchBroom {
             inline void setup() {
                 assert(m_specIndex == 0);
                 
+                m_block->bind();
                 size_t offset = m_block->address();
                 for (size_t i = 0; i < m_attributes.size(); i++) {
                     Attribute& attribute = m_attributes[i];
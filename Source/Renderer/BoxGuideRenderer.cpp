@@ -28,6 +28,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace BoxGuideUniforms {
+            static const Uniform Color("Color");
+        }
+
         void BoxGuideRenderer::addSpike(const Vec3f& startPoint, const Vec3f& direction, Vec3f::List& hitPoints) {
             float maxLength = 512.0f;
             Vec3f endPoint = startPoint + maxLength * direction;
@@ -216,7 +220,7 @@ namespace TrenchBroom {
             
             if (m_pointArray != NULL) {
                 ActivateShader pointShader(context.shaderManager(), Shaders::EdgeShader);
-                pointShader.setUniformVariable("Color", Color(m_color, 1.0f));
+                pointShader.setUniformVariable(BoxGuideUniforms::Color, Color(m_color, 1.0f));
                 glEnable(GL_POINT_SMOOTH);
                 glPointSize(3.0f);
                 m_pointArray->render();
@@ -0,0 +1,232 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushStateBuffer.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        void BrushStateBuffer::writeState(size_t slot, bool selected, bool locked, bool hidden) {
+            assert(4 * slot + 3 < m_states.size());
+            unsigned char* texel = &m_states[4 * slot];
+            texel[0] = selected ? 0xFF : 0;
+            texel[1] = locked ? 0xFF : 0;
+            texel[2] = hidden ? 0xFF : 0;
+            texel[3] = 0xFF;
+        }
+
+        void BrushStateBuffer::hideSlots(const SlotRange& range) {
+            for (size_t i = 0; i < range.second; i++)
+                writeState(range.first + i, false, false, true);
+            m_dirtyRanges.push_back(range);
+        }
+
+        BrushStateBuffer::SlotRange BrushStateBuffer::allocateSlots(size_t count) {
+            // take the smallest free range that fits and return the rest of it to the free list
+            FreeSlotMap::iterator it = m_freeSlots.lower_bound(count);
+            if (it != m_freeSlots.end()) {
+                const SlotRange range(it->second, count);
+                if (it->first > count)
+                    m_freeSlots.insert(FreeSlotMap::value_type(it->first - count, it->second + count));
+                m_freeSlots.erase(it);
+                return range;
+            }
+
+            const SlotRange range(m_slotCount, count);
+            m_slotCount += count;
+            if (4 * m_slotCount > m_states.size()) {
+                size_t rows = m_states.size() / (4 * Width);
+                while (4 * Width * rows < 4 * m_slotCount)
+                    rows *= 2;
+                m_states.resize(4 * Width * rows, 0);
+            }
+            return range;
+        }
+
+        void BrushStateBuffer::freeSlots(const SlotRange& range) {
+            hideSlots(range);
+            if (range.first >= m_staticSlotCount && range.second > 0)
+                m_freeSlots.insert(FreeSlotMap::value_type(range.second, range.first));
+        }
+
+        void BrushStateBuffer::upload() {
+            const size_t height = m_states.size() / (4 * Width);
+            if (m_textureHeight != height) {
+                glBindTexture(GL_TEXTURE_2D, m_textureId);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(Width), static_cast<GLsizei>(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, &m_states.front());
+                m_textureHeight = height;
+                m_dirtyRanges.clear();
+                return;
+            }
+
+            if (m_dirtyRanges.empty())
+                return;
+
+            glBindTexture(GL_TEXTURE_2D, m_textureId);
+            if (m_dirtyRanges.size() > MaxDirtyRanges) {
+                // too many small uploads, update all rows touched by the changed slots at once
+                size_t first = m_slotCount;
+                size_t last = 0;
+                for (size_t i = 0; i < m_dirtyRanges.size(); i++) {
+                    first = std::min(first, m_dirtyRanges[i].first);
+                    last = std::max(last, m_dirtyRanges[i].first + m_dirtyRanges[i].second);
+                }
+                if (last > first) {
+                    const size_t firstRow = first / Width;
+                    const size_t lastRow = (last - 1) / Width;
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(firstRow), static_cast<GLsizei>(Width), static_cast<GLsizei>(lastRow - firstRow + 1), GL_RGBA, GL_UNSIGNED_BYTE, &m_states[4 * firstRow * Width]);
+                }
+            } else {
+                for (size_t i = 0; i < m_dirtyRanges.size(); i++) {
+                    size_t slot = m_dirtyRanges[i].first;
+                    size_t remaining = m_dirtyRanges[i].second;
+                    while (remaining > 0) {
+                        const size_t x = slot % Width;
+                        const size_t count = std::min(remaining, Width - x);
+                        glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(x), static_cast<GLint>(slot / Width), static_cast<GLsizei>(count), 1, GL_RGBA, GL_UNSIGNED_BYTE, &m_states[4 * slot]);
+                        slot += count;
+                        remaining -= count;
+                    }
+                }
+            }
+            m_dirtyRanges.clear();
+        }
+
+        BrushStateBuffer::BrushStateBuffer() :
+        m_slotCount(0),
+        m_staticSlotCount(0),
+        m_states(4 * Width, 0),
+        m_textureId(0),
+        m_textureHeight(0) {}
+
+        BrushStateBuffer::~BrushStateBuffer() {
+            if (m_textureId != 0) {
+                glDeleteTextures(1, &m_textureId);
+                m_textureId = 0;
+            }
+        }
+
+        bool BrushStateBuffer::hasSlots(const Model::Brush& brush) const {
+            SlotMap::const_iterator it = m_slots.find(&brush);
+            return it != m_slots.end() && it->second.second == brush.faces().size();
+        }
+
+        void BrushStateBuffer::addBrush(const Model::Brush& brush) {
+            const size_t faceCount = brush.faces().size();
+
+            SlotMap::iterator it = m_slots.find(&brush);
+            if (it == m_slots.end()) {
+                m_slots[&brush] = allocateSlots(faceCount);
+                return;
+            }
+
+            const SlotRange oldRange = it->second;
+            if (oldRange.first >= m_staticSlotCount && oldRange.second == faceCount)
+                return;
+
+            freeSlots(oldRange);
+            it->second = allocateSlots(faceCount);
+        }
+
+        void BrushStateBuffer::fixSlots() {
+            m_staticSlotCount = m_slotCount;
+            m_freeSlots.clear();
+        }
+
+        void BrushStateBuffer::retainBrushes(const Model::BrushSet& brushes) {
+            SlotMap::iterator it = m_slots.begin();
+            while (it != m_slots.end()) {
+                if (brushes.count(const_cast<Model::Brush*>(it->first)) == 0) {
+                    freeSlots(it->second);
+                    m_slots.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        
+        void BrushStateBuffer::clear() {
+            m_slots.clear();
+            m_slotCount = 0;
+            m_staticSlotCount = 0;
+            m_freeSlots.clear();
+            m_dirtyRanges.clear();
+            // force a full upload of the rewritten states
+            m_textureHeight = 0;
+        }
+
+        float BrushStateBuffer::slot(const Model::Face& face) const {
+            const Model::Brush* brush = face.brush();
+            SlotMap::const_iterator it = m_slots.find(brush);
+            assert(it != m_slots.end());
+
+            const Model::FaceList& faces = brush->faces();
+            size_t index = 0;
+            while (index < faces.size() && faces[index] != &face)
+                index++;
+            assert(index < it->second.second);
+
+            return static_cast<float>(it->second.first + index);
+        }
+
+        void BrushStateBuffer::update(const Model::Brush& brush, bool visible) {
+            SlotMap::const_iterator it = m_slots.find(&brush);
+            if (it == m_slots.end())
+                return;
+
+            const Model::Entity* entity = brush.entity();
+            const bool brushSelected = brush.selected() || (entity != NULL && entity->selected());
+            const bool locked = !brushSelected && (brush.locked() || (entity != NULL && entity->locked()));
+
+            const SlotRange& range = it->second;
+            const Model::FaceList& faces = brush.faces();
+            assert(faces.size() == range.second);
+            for (size_t i = 0; i < range.second; i++)
+                writeState(range.first + i, brushSelected || faces[i]->selected(), locked, !visible);
+            m_dirtyRanges.push_back(range);
+        }
+
+        void BrushStateBuffer::activate() {
+            glActiveTexture(GL_TEXTURE1);
+            if (m_textureId == 0) {
+                glGenTextures(1, &m_textureId);
+                glBindTexture(GL_TEXTURE_2D, m_textureId);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            }
+            upload();
+            glBindTexture(GL_TEXTURE_2D, m_textureId);
+            glActiveTexture(GL_TEXTURE0);
+        }
+
+        void BrushStateBuffer::deactivate() {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glActiveTexture(GL_TEXTURE0);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BrushStateBuffer__
+#define __TrenchBroom__BrushStateBuffer__
+
+#include <GL/glew.h>
+#include "Model/BrushTypes.h"
+#include "Utility/VecMath.h"
+
+#include <map>
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Face;
+    }
+
+    namespace Renderer {
+        // Stores the edit state of the rendered faces in a texture. Face and edge vertices only refer to a slot in
+        // this texture, so changing the state of a brush only rewrites the texels of its faces. Each slot is an RGBA
+        // texel where red means selected, green means locked and blue means hidden. The faces of a brush occupy
+        // consecutive slots in the order of Brush::faces().
+        class BrushStateBuffer {
+        private:
+            typedef std::pair<size_t, size_t> SlotRange;
+            typedef std::vector<SlotRange> SlotRangeList;
+            typedef std::map<const Model::Brush*, SlotRange> SlotMap;
+            typedef std::multimap<size_t, size_t> FreeSlotMap;
+
+            static const size_t Width = 1024;
+            static const size_t MaxDirtyRanges = 64;
+
+            SlotMap m_slots;
+            size_t m_slotCount;
+            size_t m_staticSlotCount;
+            FreeSlotMap m_freeSlots;
+            std::vector<unsigned char> m_states;
+            SlotRangeList m_dirtyRanges;
+
+            GLuint m_textureId;
+            size_t m_textureHeight;
+
+            void writeState(size_t slot, bool selected, bool locked, bool hidden);
+            void hideSlots(const SlotRange& range);
+            SlotRange allocateSlots(size_t count);
+            void freeSlots(const SlotRange& range);
+            void upload();
+
+            // prevent copying
+            BrushStateBuffer(const BrushStateBuffer& other);
+            void operator= (const BrushStateBuffer& other);
+        public:
+            BrushStateBuffer();
+            ~BrushStateBuffer();
+
+            inline Vec2f size() const {
+                return Vec2f(static_cast<float>(Width), static_cast<float>(m_textureHeight));
+            }
+
+            // returns whether the brush has a slot for each of its current faces
+            bool hasSlots(const Model::Brush& brush) const;
+            // if the brush already had static slots, they are hidden so that stale vertex data referring to them
+            // disappears, other slots are kept if the number of faces is unchanged and recycled otherwise
+            void addBrush(const Model::Brush& brush);
+            // the slots assigned so far are referenced by the static geometry and are never recycled
+            void fixSlots();
+            // hides and forgets the brushes that are not in the given set
+            void retainBrushes(const Model::BrushSet& brushes);
+            void clear();
+
+            float slot(const Model::Face& face) const;
+
+            void update(const Model::Brush& brush, bool visible);
+
+            // uploads the changed states and binds the texture to texture unit 1
+            void activate();
+            void deactivate();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BrushStateBuffer__) */
@@ -24,6 +24,7 @@
 #include "Renderer/MapRenderer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/Shader.h"
+#include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/Vbo.h"
@@ -31,6 +32,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace BspModelUniforms {
+            static const Uniform Texture("Texture");
+        }
+
         void BspModelRenderer::buildVertexArrays() {
             typedef TexturedPolygonSorter<const Model::BspTexture, Model::BspFace*> FaceSorter;
             typedef FaceSorter::PolygonCollection FaceCollection;
@@ -42,16 +47,7 @@ namespace TrenchBroom {
             const Model::BspFaceList& faces = model.faces();
             for (unsigned int i = 0; i < faces.size(); i++) {
                 Model::BspFace* face = faces[i];
-                const Model::BspTexture& texture = face->texture();
-                TextureRenderer* textureRenderer = NULL;
-                
-                TextureCache::iterator textureIt = m_textures.find(&texture);
-                if (textureIt == m_textures.end()) {
-                    textureRenderer = new TextureRenderer(texture, m_palette);
-                    m_textures[&texture] = textureRenderer;
-                }
-                
-                faceSorter.addPolygon(&texture, face, face->vertices().size());
+                faceSorter.addPolygon(&face->texture(), face, face->vertices().size());
             }
             
             const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
@@ -95,8 +91,15 @@ namespace TrenchBroom {
         
         BspModelRenderer::BspModelRenderer(const Model::Bsp& bsp, Vbo& vbo, const Palette& palette) :
         m_bsp(bsp),
-        m_palette(palette),
-        m_vbo(vbo) {}
+        m_vbo(vbo) {
+            // the textures are converted right away so that no palette is needed on the GL thread
+            const Model::BspFaceList& faces = m_bsp.models()[0]->faces();
+            for (unsigned int i = 0; i < faces.size(); i++) {
+                const Model::BspTexture& texture = faces[i]->texture();
+                if (m_textures.find(&texture) == m_textures.end())
+                    m_textures[&texture] = new TextureRenderer(texture, palette);
+            }
+        }
         
         BspModelRenderer::~BspModelRenderer() {
             TextureCache::iterator it, end;
@@ -113,7 +116,7 @@ namespace TrenchBroom {
             for (unsigned int i = 0; i < m_vertexArrays.size(); i++) {
                 TextureVertexArray& textureVertexArray = m_vertexArrays[i];
                 textureVertexArray.texture->activate();
-                shaderProgram.setUniformVariable("Texture", 0);
+                shaderProgram.setUniformVariable(BspModelUniforms::Texture, 0);
                 textureVertexArray.vertexArray->render();
                 textureVertexArray.texture->deactivate();
             }
@@ -46,8 +46,6 @@ namespace TrenchBroom {
             typedef std::map<const Model::BspTexture*, TextureRenderer*> TextureCache;
 
             const Model::Bsp& m_bsp;
-
-            const Palette& m_palette;
             TextureCache m_textures;
 
             Vbo& m_vbo;
@@ -35,6 +35,19 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace CompassUniforms {
+            static const Uniform CameraPosition("CameraPosition");
+            static const Uniform LightDirection("LightDirection");
+            static const Uniform LightDiffuse("LightDiffuse");
+            static const Uniform LightSpecular("LightSpecular");
+            static const Uniform GlobalAmbient("GlobalAmbient");
+            static const Uniform MaterialShininess("MaterialShininess");
+            static const Uniform MaterialDiffuse("MaterialDiffuse");
+            static const Uniform MaterialAmbient("MaterialAmbient");
+            static const Uniform MaterialSpecular("MaterialSpecular");
+            static const Uniform Color("Color");
+        }
+
         const float CompassRenderer::m_shaftLength = 28.0f;
         const float CompassRenderer::m_shaftRadius = 1.2f;
         const float CompassRenderer::m_headLength = 7.0f;
@@ -112,30 +125,30 @@ namespace TrenchBroom {
 
         void CompassRenderer::renderColoredAxis(RenderContext& context, const Mat4f& rotation, const Color& color) {
             ActivateShader compassShader(context.shaderManager(), Shaders::CompassShader);
-            compassShader.setUniformVariable("CameraPosition", Vec3f(0.0f, 500.0f, 0.0f));
-            compassShader.setUniformVariable("LightDirection", Vec3f(0.0f, 0.5f, 1.0f).normalized());
-            compassShader.setUniformVariable("LightDiffuse", Color(1.0f, 1.0f, 1.0f, 1.0f));
-            compassShader.setUniformVariable("LightSpecular", Color(0.3f, 0.3f, 0.3f, 1.0f));
-            compassShader.setUniformVariable("GlobalAmbient", Color(0.2f, 0.2f, 0.2f, 1.0f));
-            compassShader.setUniformVariable("MaterialShininess", 32.0f);
+            compassShader.setUniformVariable(CompassUniforms::CameraPosition, Vec3f(0.0f, 500.0f, 0.0f));
+            compassShader.setUniformVariable(CompassUniforms::LightDirection, Vec3f(0.0f, 0.5f, 1.0f).normalized());
+            compassShader.setUniformVariable(CompassUniforms::LightDiffuse, Color(1.0f, 1.0f, 1.0f, 1.0f));
+            compassShader.setUniformVariable(CompassUniforms::LightSpecular, Color(0.3f, 0.3f, 0.3f, 1.0f));
+            compassShader.setUniformVariable(CompassUniforms::GlobalAmbient, Color(0.2f, 0.2f, 0.2f, 1.0f));
+            compassShader.setUniformVariable(CompassUniforms::MaterialShininess, 32.0f);
 
-            compassShader.setUniformVariable("MaterialDiffuse", color);
-            compassShader.setUniformVariable("MaterialAmbient", color);
-            compassShader.setUniformVariable("MaterialSpecular", color);
+            compassShader.setUniformVariable(CompassUniforms::MaterialDiffuse, color);
+            compassShader.setUniformVariable(CompassUniforms::MaterialAmbient, color);
+            compassShader.setUniformVariable(CompassUniforms::MaterialSpecular, color);
             
             renderAxis(context, rotation);
         }
         
         void CompassRenderer::renderOutlinedAxis(RenderContext& context, const Mat4f& rotation, const Color& color) {
-            glDepthMask(GL_FALSE);
+            context.renderState().setDepthMask(false);
             glLineWidth(3.0f);
             glPolygonMode(GL_FRONT, GL_LINE);
             
             ActivateShader compassOutlineShader(context.shaderManager(), Shaders::CompassOutlineShader);
-            compassOutlineShader.setUniformVariable("Color", color);
+            compassOutlineShader.setUniformVariable(CompassUniforms::Color, color);
             renderAxis(context, rotation);
             
-            glDepthMask(GL_TRUE);
+            context.renderState().setDepthMask(true);
             glLineWidth(1.0f);
             glPolygonMode(GL_FRONT, GL_FILL);
         }
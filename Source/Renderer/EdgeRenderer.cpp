@@ -24,6 +24,7 @@
 #include "Model/Entity.h"
 #include "Model/EntityDefinition.h"
 #include "Model/Face.h"
+#include "Renderer/BrushStateBuffer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/ShaderManager.h"
@@ -31,6 +32,15 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace EdgeUniforms {
+            static const Uniform Color("Color");
+            static const Uniform UseColor("UseColor");
+            static const Uniform StateTexture("StateTexture");
+            static const Uniform StateTextureSize("StateTextureSize");
+            static const Uniform RenderSelected("RenderSelected");
+            static const Uniform RenderLocked("RenderLocked");
+        }
+        
         unsigned int EdgeRenderer::vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces) {
             Model::BrushList::const_iterator brushIt, brushEnd;
             Model::FaceList::const_iterator faceIt, faceEnd;
@@ -56,24 +66,22 @@ namespace TrenchBroom {
             Model::BrushList::const_iterator brushIt, brushEnd;
             for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                 const Model::Brush& brush = **brushIt;
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
+                const Model::BrushEdgeList edges = brush.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    m_vertexArray->addAttribute(edge.start());
+                    m_vertexArray->addAttribute(edge.end());
                 }
             }
             
             Model::FaceList::const_iterator faceIt, faceEnd;
             for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                 const Model::Face& face = **faceIt;
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
+                const Model::BrushEdgeList edges = face.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    m_vertexArray->addAttribute(edge.start());
+                    m_vertexArray->addAttribute(edge.end());
                 }
             }
         }
@@ -90,13 +98,12 @@ namespace TrenchBroom {
                 const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
                 const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
                 
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
+                const Model::BrushEdgeList edges = brush.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    m_vertexArray->addAttribute(edge.start());
                     m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
+                    m_vertexArray->addAttribute(edge.end());
                     m_vertexArray->addAttribute(color);
                 }
             }
@@ -109,27 +116,92 @@ namespace TrenchBroom {
                 const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
                 const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
                 
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
+                const Model::BrushEdgeList edges = face.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    m_vertexArray->addAttribute(edge.start());
                     m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
+                    m_vertexArray->addAttribute(edge.end());
                     m_vertexArray->addAttribute(color);
                 }
             }
         }
 
+        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const BrushStateBuffer& states, const Color& defaultColor) {
+            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, Model::EmptyFaceList),
+                                            Attribute::position3f(),
+                                            Attribute::color4f(),
+                                            Attribute::texCoord12f());
+            
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                const Model::Brush& brush = **brushIt;
+                const Model::Entity* entity = brush.entity();
+                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
+                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+                
+                const Model::BrushEdgeList edges = brush.edges();
+                for (size_t i = 0; i < edges.size(); i++) {
+                    const Model::BrushEdge edge = edges[i];
+                    const Vec2f slots(states.slot(*edge.leftFace()), states.slot(*edge.rightFace()));
+                    m_vertexArray->addAttribute(edge.start());
+                    m_vertexArray->addAttribute(color);
+                    m_vertexArray->addAttribute(slots);
+                    m_vertexArray->addAttribute(edge.end());
+                    m_vertexArray->addAttribute(color);
+                    m_vertexArray->addAttribute(slots);
+                }
+            }
+        }
+        
+        void EdgeRenderer::renderStates(RenderContext& context, bool selected, bool locked, const Color* color) {
+            assert(m_vertexArray != NULL);
+            assert(m_states != NULL);
+            
+            ShaderManager& shaderManager = context.shaderManager();
+            ShaderProgram& brushEdgeProgram = shaderManager.shaderProgram(Shaders::BrushEdgeShader);
+            if (brushEdgeProgram.activate()) {
+                brushEdgeProgram.setUniformVariable(EdgeUniforms::UseColor, color != NULL);
+                if (color != NULL)
+                    brushEdgeProgram.setUniformVariable(EdgeUniforms::Color, *color);
+                brushEdgeProgram.setUniformVariable(EdgeUniforms::StateTexture, 1);
+                brushEdgeProgram.setUniformVariable(EdgeUniforms::StateTextureSize, m_states->size());
+                brushEdgeProgram.setUniformVariable(EdgeUniforms::RenderSelected, selected);
+                brushEdgeProgram.setUniformVariable(EdgeUniforms::RenderLocked, locked);
+                m_vertexArray->render();
+                brushEdgeProgram.deactivate();
+            }
+        }
+        
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) :
-        m_vertexArray(NULL) {
+        m_vertexArray(NULL),
+        m_states(NULL) {
             writeEdgeData(vbo, brushes, faces);
         }
         
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) :
-        m_vertexArray(NULL) {
+        m_vertexArray(NULL),
+        m_states(NULL) {
             writeEdgeData(vbo, brushes, faces, defaultColor);
         }
+        
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const BrushStateBuffer& states, const Color& defaultColor) :
+        m_vertexArray(NULL),
+        m_states(&states) {
+            writeEdgeData(vbo, brushes, states, defaultColor);
+        }
+
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const std::vector<float>& vertices, size_t vertexCount, const BrushStateBuffer& states) :
+        m_vertexArray(NULL),
+        m_states(&states) {
+            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount,
+                                            Attribute::position3f(),
+                                            Attribute::color4f(),
+                                            Attribute::texCoord12f(),
+                                            0);
+            if (vertexCount > 0)
+                m_vertexArray->addVertices(&vertices.front(), vertexCount);
+        }
 
         EdgeRenderer::~EdgeRenderer() {
             delete m_vertexArray;
@@ -154,10 +226,22 @@ namespace TrenchBroom {
             ShaderManager& shaderManager = context.shaderManager();
             ShaderProgram& edgeProgram = shaderManager.shaderProgram(Shaders::EdgeShader);
             if (edgeProgram.activate()) {
-                edgeProgram.setUniformVariable("Color", color);
+                edgeProgram.setUniformVariable(EdgeUniforms::Color, color);
                 m_vertexArray->render();
                 edgeProgram.deactivate();
             }
         }
+        
+        void EdgeRenderer::renderDefault(RenderContext& context) {
+            renderStates(context, false, false, NULL);
+        }
+        
+        void EdgeRenderer::renderLocked(RenderContext& context, const Color& color) {
+            renderStates(context, false, true, &color);
+        }
+        
+        void EdgeRenderer::renderSelected(RenderContext& context, const Color& color) {
+            renderStates(context, true, false, &color);
+        }
     }
 }
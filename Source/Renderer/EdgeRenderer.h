@@ -24,8 +24,11 @@
 #include "Model/FaceTypes.h"
 #include "Utility/Color.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Renderer {
+        class BrushStateBuffer;
         class RenderContext;
         class Vbo;
         class VertexArray;
@@ -33,17 +36,29 @@ namespace TrenchBroom {
         class EdgeRenderer {
         protected:
             VertexArray* m_vertexArray;
+            const BrushStateBuffer* m_states;
             
             unsigned int vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces);
             void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
             void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const BrushStateBuffer& states, const Color& defaultColor);
+            void renderStates(RenderContext& context, bool selected, bool locked, const Color* color);
         public:
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            // the edges are filtered by the given states, which must be active when rendering
+            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const BrushStateBuffer& states, const Color& defaultColor);
+            // uploads edges that were prepared in advance, each vertex consists of its position, color and the state
+            // slots of the faces adjacent to its edge
+            EdgeRenderer(Vbo& vbo, const std::vector<float>& vertices, size_t vertexCount, const BrushStateBuffer& states);
             ~EdgeRenderer();
 
             void render(RenderContext& context);
             void render(RenderContext& context, const Color& color);
+            
+            void renderDefault(RenderContext& context);
+            void renderLocked(RenderContext& context, const Color& color);
+            void renderSelected(RenderContext& context, const Color& color);
         };
     }
 }
@@ -38,6 +38,12 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace EntityLinkDecoratorUniforms {
+            static const Uniform CameraPosition("CameraPosition");
+            static const Uniform MaxDistance("MaxDistance");
+            static const Uniform Color("Color");
+        }
+
         void EntityLinkDecorator::clear() {
             delete m_selectedLinkArray;
             m_selectedLinkArray = NULL;
@@ -164,57 +170,57 @@ namespace TrenchBroom {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
             ActivateShader shader(context.shaderManager(), Shaders::EntityLinkShader);
-            shader.setUniformVariable("CameraPosition", context.camera().position());
-            shader.setUniformVariable("MaxDistance", 512.0f);
+            shader.setUniformVariable(EntityLinkDecoratorUniforms::CameraPosition, context.camera().position());
+            shader.setUniformVariable(EntityLinkDecoratorUniforms::MaxDistance, 512.0f);
 
             // render the "occluded" portion without depth-test
             glLineWidth(2.0f);
-            glDepthMask(GL_FALSE);
+            context.renderState().setDepthMask(false);
             glDisable(GL_DEPTH_TEST);
 
             if (m_unselectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::OccludedEntityLinkColor));
                 m_unselectedLinkArray->render();
             }
             
             if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
                 m_selectedLinkArray->render();
             }
             
             if (m_unselectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityKillLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::OccludedEntityKillLinkColor));
                 m_unselectedKillLinkArray->render();
             }
             
             if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
                 m_selectedKillLinkArray->render();
             }
             
             glEnable(GL_DEPTH_TEST);
 
             if (m_unselectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::EntityLinkColor));
                 m_unselectedLinkArray->render();
             }
 
             if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::SelectedEntityLinkColor));
                 m_selectedLinkArray->render();
             }
             
             if (m_unselectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityKillLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::EntityKillLinkColor));
                 m_unselectedKillLinkArray->render();
             }
             
             if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityKillLinkColor));
+                shader.setUniformVariable(EntityLinkDecoratorUniforms::Color, prefs.getColor(Preferences::SelectedEntityKillLinkColor));
                 m_selectedKillLinkArray->render();
             }
 
-            glDepthMask(GL_TRUE);
+            context.renderState().setDepthMask(true);
             glLineWidth(1.0f);
         }
     }
@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "EntityModelLoader.h"
+
+#include "Model/Alias.h"
+#include "Model/Bsp.h"
+#include "Renderer/AliasModelRenderer.h"
+#include "Renderer/BspModelRenderer.h"
+#include "Renderer/Palette.h"
+#include "Utility/Tracer.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        EntityModelRenderer* EntityModelLoader::load(const Request& request, const Palette& palette) {
+            TRACE_ZONE("EntityModelLoader::load");
+            if (request.bsp) {
+                Model::BspManager& bspManager = *Model::BspManager::sharedManager;
+                const Model::Bsp* bsp = bspManager.bsp(request.modelName, request.searchPaths, m_console);
+                if (bsp != NULL)
+                    return new BspModelRenderer(*bsp, m_vbo, palette);
+            } else {
+                Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
+                const Model::Alias* alias = aliasManager.alias(request.modelName, request.searchPaths, m_console);
+                if (alias != NULL && request.skinIndex < alias->skins().size() && request.frameIndex < alias->frames().size()) {
+                    // decode the frame here rather than when it is first rendered
+                    alias->frame(request.frameIndex).positions();
+                    return new AliasModelRenderer(*alias, request.frameIndex, request.skinIndex, m_vbo, palette);
+                }
+            }
+            return NULL;
+        }
+        
+        wxThread::ExitCode EntityModelLoader::Entry() {
+            while (true) {
+                m_semaphore.Wait();
+                
+                while (true) {
+                    Request::List requests;
+                    PalettePtr palette;
+                    unsigned int generation;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_stopped)
+                            return (wxThread::ExitCode)0;
+                        if (m_requests.empty() || m_palette.get() == NULL)
+                            break;
+                        requests.push_back(m_requests.front());
+                        m_requests.pop_front();
+                        palette = m_palette;
+                        generation = m_generation;
+                    }
+                    
+                    const Request& request = requests.front();
+                    EntityModelRenderer* renderer = load(request, *palette);
+                    
+                    bool notify = false;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_stopped) {
+                            delete renderer;
+                            return (wxThread::ExitCode)0;
+                        }
+                        if (generation != m_generation) {
+                            delete renderer;
+                        } else {
+                            // failed requests are delivered too so that they are not requested again
+                            m_results.push_back(Result(request.key, renderer));
+                            notify = m_results.size() == 1;
+                        }
+                    }
+                    
+                    if (notify)
+                        m_handler.QueueEvent(new wxThreadEvent(wxEVT_COMMAND_THREAD));
+                }
+            }
+            
+            return (wxThread::ExitCode)0;
+        }
+        
+        EntityModelLoader::EntityModelLoader(wxEvtHandler& handler, Vbo& vbo, Utility::Console& console) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_handler(handler),
+        m_vbo(vbo),
+        m_console(console),
+        m_generation(0),
+        m_stopped(false) {
+            Create();
+            Run();
+        }
+        
+        EntityModelLoader::~EntityModelLoader() {
+            assert(m_stopped);
+            clear();
+        }
+        
+        void EntityModelLoader::setPalette(const Palette& palette) {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                m_palette = PalettePtr(new Palette(palette));
+            }
+            m_semaphore.Post();
+        }
+        
+        void EntityModelLoader::addRequest(const Request& request) {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                m_requests.push_back(request);
+            }
+            m_semaphore.Post();
+        }
+        
+        void EntityModelLoader::clear() {
+            wxCriticalSectionLocker lock(m_lock);
+            m_requests.clear();
+            for (size_t i = 0; i < m_results.size(); i++)
+                delete m_results[i].renderer;
+            m_results.clear();
+            m_generation++;
+        }
+        
+        EntityModelLoader::Result::List EntityModelLoader::takeResults() {
+            Result::List results;
+            wxCriticalSectionLocker lock(m_lock);
+            results.swap(m_results);
+            return results;
+        }
+        
+        void EntityModelLoader::stop() {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                if (m_stopped)
+                    return;
+                m_stopped = true;
+            }
+            m_semaphore.Post();
+            Wait();
+        }
+    }
+}
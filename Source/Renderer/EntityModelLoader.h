@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__EntityModelLoader__
+#define __TrenchBroom__EntityModelLoader__
+
+#include "Utility/SharedPointer.h"
+#include "Utility/String.h"
+
+#include <deque>
+#include <vector>
+
+#include <wx/event.h>
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class Console;
+    }
+    
+    namespace Renderer {
+        class EntityModelRenderer;
+        class Palette;
+        class Vbo;
+        
+        // Loads entity models on a worker thread. The worker resolves the model file, parses it, decodes the requested
+        // frame and converts the skins with the palette, so that the resulting renderers only have to upload their
+        // data when they are first rendered on the GL thread. Every document has its own loader, but the alias, bsp and
+        // pak managers and the alias frames are shared by all of them and synchronize themselves. Whenever new results
+        // are available, a wxThreadEvent is queued to the given handler, which should then collect them using
+        // takeResults.
+        class EntityModelLoader : public wxThread {
+        public:
+            class Request {
+            public:
+                typedef std::deque<Request> List;
+                
+                String key;
+                String modelName;
+                StringList searchPaths;
+                bool bsp;
+                unsigned int skinIndex;
+                unsigned int frameIndex;
+                
+                Request(const String& i_key, const String& i_modelName, const StringList& i_searchPaths, bool i_bsp, unsigned int i_skinIndex, unsigned int i_frameIndex) :
+                key(i_key),
+                modelName(i_modelName),
+                searchPaths(i_searchPaths),
+                bsp(i_bsp),
+                skinIndex(i_skinIndex),
+                frameIndex(i_frameIndex) {}
+            };
+            
+            class Result {
+            public:
+                typedef std::vector<Result> List;
+                
+                String key;
+                EntityModelRenderer* renderer; // NULL if the model could not be loaded
+                
+                Result(const String& i_key, EntityModelRenderer* i_renderer) :
+                key(i_key),
+                renderer(i_renderer) {}
+            };
+        private:
+            typedef std::tr1::shared_ptr<Palette> PalettePtr;
+            
+            wxEvtHandler& m_handler;
+            Vbo& m_vbo;
+            Utility::Console& m_console;
+            wxCriticalSection m_lock;
+            wxSemaphore m_semaphore;
+            Request::List m_requests;
+            Result::List m_results;
+            PalettePtr m_palette;
+            unsigned int m_generation;
+            bool m_stopped;
+            
+            EntityModelRenderer* load(const Request& request, const Palette& palette);
+            ExitCode Entry();
+        public:
+            EntityModelLoader(wxEvtHandler& handler, Vbo& vbo, Utility::Console& console);
+            ~EntityModelLoader();
+            
+            // the palette is copied because the caller may delete it while a model is being converted
+            void setPalette(const Palette& palette);
+            void addRequest(const Request& request);
+            void clear();
+            Result::List takeResults();
+            
+            // stops and joins the worker thread, must be called before the loader is deleted
+            void stop();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityModelLoader__) */
@@ -20,12 +20,9 @@
 #include "EntityModelRendererManager.h"
 
 #include <GL/glew.h>
-#include "Model/Alias.h"
-#include "Model/Bsp.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinition.h"
-#include "Renderer/AliasModelRenderer.h"
-#include "Renderer/BspModelRenderer.h"
+#include "Renderer/EntityModelLoader.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/Palette.h"
 #include "Renderer/Vbo.h"
@@ -34,6 +31,9 @@
 #include "Utility/Map.h"
 #include "Utility/Preferences.h"
 
+#include <wx/window.h>
+
+#include <algorithm>
 #include <cassert>
 
 namespace TrenchBroom {
@@ -64,32 +64,18 @@ namespace TrenchBroom {
             if (rendererIt != m_modelRenderers.end())
                 return rendererIt->second;
 
+            if (m_pending.count(key) > 0)
+                return NULL;
+            
             String modelName = Utility::toLower(modelDefinition.name().substr(1));
             String ext = Utility::toLower(fileManager.pathExtension(modelName));
-            if (ext == "mdl") {
-                unsigned int skinIndex = modelDefinition.skinIndex();
-                unsigned int frameIndex = modelDefinition.frameIndex();
-
-                Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
-                const Model::Alias* alias = aliasManager.alias(modelName, searchPaths, m_console);
-
-                if (alias != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
-                    Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(*alias, frameIndex, skinIndex, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
-            } else if (ext == "bsp") {
-                Model::BspManager& bspManager = *Model::BspManager::sharedManager;
-                const Model::Bsp* bsp = bspManager.bsp(modelName, searchPaths, m_console);
-                if (bsp != NULL) {
-                    Renderer::EntityModelRenderer* renderer = new BspModelRenderer(*bsp, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
-            } else {
-                m_console.warn("Unknown model type '%s'", ext.c_str());
+            if (ext == "mdl" || ext == "bsp") {
+                m_pending.insert(key);
+                m_loader->addRequest(EntityModelLoader::Request(key, modelName, searchPaths, ext == "bsp", modelDefinition.skinIndex(), modelDefinition.frameIndex()));
+                return NULL;
             }
-
+            
+            m_console.warn("Unknown model type '%s'", ext.c_str());
             m_mismatches.insert(key);
             return NULL;
         }
@@ -97,11 +83,18 @@ namespace TrenchBroom {
         EntityModelRendererManager::EntityModelRendererManager(Utility::Console& console) :
         m_palette(NULL),
         m_console(console),
+        m_loader(NULL),
+        m_loadGeneration(0),
         m_valid(true) {
             m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            m_loader = new EntityModelLoader(*this, *m_vbo, m_console);
+            Bind(wxEVT_COMMAND_THREAD, &EntityModelRendererManager::OnModelsLoaded, this);
         }
 
         EntityModelRendererManager::~EntityModelRendererManager() {
+            m_loader->stop();
+            delete m_loader;
+            m_loader = NULL;
             clear();
             delete m_vbo;
             m_vbo = NULL;
@@ -126,6 +119,9 @@ namespace TrenchBroom {
         }
 
         void EntityModelRendererManager::clear() {
+            if (m_loader != NULL)
+                m_loader->clear();
+            m_pending.clear();
             clearMismatches();
             Utility::deleteAll(m_modelRenderers);
         }
@@ -138,9 +134,20 @@ namespace TrenchBroom {
             if (&palette == m_palette)
                 return;
             m_palette = &palette;
+            m_loader->setPalette(palette);
             m_valid = false;
         }
 
+        void EntityModelRendererManager::addView(wxWindow* view) {
+            m_views.push_back(view);
+        }
+        
+        void EntityModelRendererManager::removeView(wxWindow* view) {
+            ViewList::iterator it = std::find(m_views.begin(), m_views.end(), view);
+            if (it != m_views.end())
+                m_views.erase(it);
+        }
+
         void EntityModelRendererManager::activate() {
             m_vbo->activate();
         }
@@ -148,5 +155,27 @@ namespace TrenchBroom {
         void EntityModelRendererManager::deactivate() {
             m_vbo->deactivate();
         }
+
+        void EntityModelRendererManager::OnModelsLoaded(wxThreadEvent& event) {
+            EntityModelLoader::Result::List results = m_loader->takeResults();
+            if (results.empty())
+                return;
+            
+            for (size_t i = 0; i < results.size(); i++) {
+                const EntityModelLoader::Result& result = results[i];
+                m_pending.erase(result.key);
+                if (result.renderer != NULL)
+                    m_modelRenderers[result.key] = result.renderer;
+                else
+                    m_mismatches.insert(result.key);
+            }
+            
+            m_loadGeneration++;
+            for (size_t i = 0; i < m_views.size(); i++) {
+                wxThreadEvent viewEvent(wxEVT_COMMAND_THREAD);
+                if (!m_views[i]->GetEventHandler()->ProcessEvent(viewEvent))
+                    m_views[i]->Refresh();
+            }
+        }
     }
 }
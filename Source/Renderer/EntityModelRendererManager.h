@@ -26,6 +26,10 @@
 #include <vector>
 #include <set>
 
+#include <wx/event.h>
+
+class wxWindow;
+
 namespace TrenchBroom {
     namespace Model {
         class Entity;
@@ -38,21 +42,32 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class EntityModelLoader;
         class EntityModelRenderer;
         class Palette;
         class Vbo;
         
-        class EntityModelRendererManager {
+        // Models are loaded asynchronously. Until a model is ready, modelRenderer returns NULL and the entity should
+        // be rendered as a bounding box. Once new models are available, the load generation is incremented and a
+        // wxThreadEvent is sent to all registered views, views that do not handle it are refreshed so that they can ask
+        // for the models again.
+        class EntityModelRendererManager : public wxEvtHandler {
         private:
             typedef std::map<String, EntityModelRenderer*> EntityModelRendererCache;
             typedef std::set<String> MismatchCache;
+            typedef std::set<String> PendingSet;
+            typedef std::vector<wxWindow*> ViewList;
             
             const Palette* m_palette;
             Utility::Console& m_console;
             
             Vbo* m_vbo;
+            EntityModelLoader* m_loader;
             EntityModelRendererCache m_modelRenderers;
             MismatchCache m_mismatches;
+            PendingSet m_pending;
+            unsigned int m_loadGeneration;
+            ViewList m_views;
             bool m_valid;
 
             const String modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
@@ -72,8 +87,17 @@ namespace TrenchBroom {
             
             void setPalette(const Palette& palette);
             
+            inline unsigned int loadGeneration() const {
+                return m_loadGeneration;
+            }
+            
+            void addView(wxWindow* view);
+            void removeView(wxWindow* view);
+            
             void activate();
             void deactivate();
+            
+            void OnModelsLoaded(wxThreadEvent& event);
         };
     }
 }
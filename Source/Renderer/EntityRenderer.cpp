@@ -22,16 +22,27 @@
 #include "Model/MapDocument.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/OcclusionCuller.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/Text/FontManager.h"
 #include "Utility/Preferences.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace EntityUniforms {
+            static const Uniform Color("Color");
+            static const Uniform Brightness("Brightness");
+            static const Uniform ApplyTinting("ApplyTinting");
+            static const Uniform TintColor("TintColor");
+            static const Uniform GrayScale("GrayScale");
+        }
+        
         EntityRenderer::EntityClassnameAnchor::EntityClassnameAnchor(Model::Entity& entity, Renderer::EntityModelRenderer* renderer) :
         m_entity(&entity),
         m_renderer(renderer) {}
@@ -130,8 +141,11 @@ namespace TrenchBroom {
 
         void EntityRenderer::validateModels(RenderContext& context) {
             m_modelRenderers.clear();
+            m_pendingModels.clear();
 
             EntityModelRendererManager& modelRendererManager = m_document.sharedResources().modelRendererManager();
+            m_modelLoadGeneration = modelRendererManager.loadGeneration();
+            
             Model::EntitySet::iterator entityIt, entityEnd;
             for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity* entity = *entityIt;
@@ -140,12 +154,35 @@ namespace TrenchBroom {
                     EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPaths());
                     if (renderer != NULL)
                         m_modelRenderers[entity] = CachedEntityModelRenderer(renderer, *classname);
+                    else
+                        m_pendingModels.insert(entity);
                 }
             }
 
             m_modelRendererCacheValid = true;
         }
 
+        void EntityRenderer::validatePendingModels(RenderContext& context) {
+            EntityModelRendererManager& modelRendererManager = m_document.sharedResources().modelRendererManager();
+            m_modelLoadGeneration = modelRendererManager.loadGeneration();
+            
+            Model::EntitySet::iterator entityIt = m_pendingModels.begin();
+            while (entityIt != m_pendingModels.end()) {
+                Model::Entity* entity = *entityIt;
+                EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPaths());
+                if (renderer != NULL) {
+                    const String* classname = entity->classname();
+                    if (classname == NULL)
+                        classname = &Model::Entity::NoClassnameValue;
+                    m_modelRenderers[entity] = CachedEntityModelRenderer(renderer, *classname);
+                    m_classnameRenderer->addString(entity, *classname, Text::TextAnchor::Ptr(new EntityClassnameAnchor(*entity, renderer)));
+                    m_pendingModels.erase(entityIt++);
+                } else {
+                    ++entityIt;
+                }
+            }
+        }
+
         void EntityRenderer::renderBounds(RenderContext& context) {
             if (m_boundsVertexArray == NULL)
                 return;
@@ -158,11 +195,11 @@ namespace TrenchBroom {
                 if (edgeProgram.activate()) {
                     if (m_renderOccludedBounds) {
                         glDisable(GL_DEPTH_TEST);
-                        edgeProgram.setUniformVariable("Color", m_occludedBoundsColor);
+                        edgeProgram.setUniformVariable(EntityUniforms::Color, m_occludedBoundsColor);
                         m_boundsVertexArray->render();
                         glEnable(GL_DEPTH_TEST);
                     }
-                    edgeProgram.setUniformVariable("Color", m_boundsColor);
+                    edgeProgram.setUniformVariable(EntityUniforms::Color, m_boundsColor);
                     m_boundsVertexArray->render();
                     edgeProgram.deactivate();
                 }
@@ -199,6 +236,18 @@ namespace TrenchBroom {
 
         }
 
+        BBoxf EntityRenderer::modelBounds(const Model::Entity& entity, const EntityModelRenderer& renderer) const {
+            // the model is rotated about the entity origin, so it stays within the sphere enclosing its bounds
+            const BBoxf& bounds = renderer.bounds();
+            const Vec3f corner(std::max(std::abs(bounds.min.x()), std::abs(bounds.max.x())),
+                               std::max(std::abs(bounds.min.y()), std::abs(bounds.max.y())),
+                               std::max(std::abs(bounds.min.z()), std::abs(bounds.max.z())));
+            
+            BBoxf result(entity.origin(), corner.length());
+            result.mergeWith(entity.bounds());
+            return result;
+        }
+        
         void EntityRenderer::renderModels(RenderContext& context) {
             if (m_modelRenderers.empty())
                 return;
@@ -211,16 +260,18 @@ namespace TrenchBroom {
 
             if (entityModelProgram.activate()) {
                 modelRendererManager.activate();
-                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                entityModelProgram.setUniformVariable("ApplyTinting", m_applyTinting);
-                entityModelProgram.setUniformVariable("TintColor", m_tintColor);
-                entityModelProgram.setUniformVariable("GrayScale", m_grayscale);
+                entityModelProgram.setUniformVariable(EntityUniforms::Brightness, prefs.getFloat(Preferences::RendererBrightness));
+                entityModelProgram.setUniformVariable(EntityUniforms::ApplyTinting, m_applyTinting);
+                entityModelProgram.setUniformVariable(EntityUniforms::TintColor, m_tintColor);
+                entityModelProgram.setUniformVariable(EntityUniforms::GrayScale, m_grayscale);
 
                 EntityModelRenderers::iterator it, end;
                 for (it = m_modelRenderers.begin(), end = m_modelRenderers.end(); it != end; ++it) {
                     Model::Entity* entity = it->first;
                     if (context.filter().entityVisible(*entity)) {
                         EntityModelRenderer* renderer = it->second.renderer;
+                        if (m_occlusionCuller != NULL && !m_occlusionCuller->visible(modelBounds(*entity, *renderer)))
+                            continue;
                         renderer->render(entityModelProgram, context.transformation(), *entity);
                     }
                 }
@@ -236,7 +287,9 @@ namespace TrenchBroom {
         m_boundsVertexArray(NULL),
         m_boundsValid(true),
         m_modelRendererCacheValid(true),
+        m_modelLoadGeneration(0),
         m_classnameRenderer(NULL),
+        m_occlusionCuller(NULL),
         m_classnameColor(1.0f, 1.0f, 1.0f, 1.0f),
         m_classnameBackgroundColor(0.0f, 0.0f, 0.0f, 0.6f),
         m_renderOccludedClassnames(false),
@@ -281,6 +334,8 @@ namespace TrenchBroom {
                 EntityModelRenderer* renderer = modelRendererManager.modelRenderer(entity, m_document.searchPaths());
                 if (renderer != NULL)
                     m_modelRenderers[&entity] = CachedEntityModelRenderer(renderer, *classname);
+                else
+                    m_pendingModels.insert(&entity);
 
                 m_classnameRenderer->addString(&entity, *classname, Text::TextAnchor::Ptr(new EntityClassnameAnchor(entity, renderer)));
             }
@@ -305,6 +360,8 @@ namespace TrenchBroom {
                     EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPaths());
                     if (renderer != NULL)
                         m_modelRenderers[entity] = CachedEntityModelRenderer(renderer, *classname);
+                    else
+                        m_pendingModels.insert(entity);
 
                     m_classnameRenderer->addString(entity, *classname, Text::TextAnchor::Ptr(new EntityClassnameAnchor(*entity, renderer)));
                 }
@@ -316,6 +373,7 @@ namespace TrenchBroom {
 
         void EntityRenderer::invalidateBounds() {
             m_boundsValid = false;
+            m_classnameRenderer->invalidatePositions();
         }
 
         void EntityRenderer::invalidateModels() {
@@ -326,12 +384,14 @@ namespace TrenchBroom {
             m_entities.clear();
             m_boundsValid = false;
             m_modelRenderers.clear();
+            m_pendingModels.clear();
             m_modelRendererCacheValid = true;
             m_classnameRenderer->clear();
         }
 
         void EntityRenderer::removeEntity(Model::Entity& entity) {
             m_modelRenderers.erase(&entity);
+            m_pendingModels.erase(&entity);
             m_classnameRenderer->removeString(&entity);
             m_entities.erase(&entity);
             m_boundsValid = false;
@@ -344,6 +404,7 @@ namespace TrenchBroom {
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Model::Entity* entity = entities[i];
                 m_modelRenderers.erase(entity);
+                m_pendingModels.erase(entity);
                 m_classnameRenderer->removeString(entity);
                 m_entities.erase(entity);
             }
@@ -355,6 +416,8 @@ namespace TrenchBroom {
                 validateBounds(context);
             if (!m_modelRendererCacheValid)
                 validateModels(context);
+            else if (!m_pendingModels.empty() && m_modelLoadGeneration != m_document.sharedResources().modelRendererManager().loadGeneration())
+                validatePendingModels(context);
 
             if (context.viewOptions().showEntityModels())
                 renderModels(context);
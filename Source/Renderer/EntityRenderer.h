@@ -39,6 +39,7 @@ namespace TrenchBroom {
     
     namespace Renderer {
         class EntityModelRenderer;
+        class OcclusionCuller;
         class Vbo;
         class VertexArray;
         
@@ -84,7 +85,10 @@ namespace TrenchBroom {
             bool m_boundsValid;
             EntityModelRenderers m_modelRenderers;
             bool m_modelRendererCacheValid;
+            Model::EntitySet m_pendingModels; // entities whose models may still be loading
+            unsigned int m_modelLoadGeneration;
             EntityClassnameRenderer* m_classnameRenderer;
+            const OcclusionCuller* m_occlusionCuller;
             
             Color m_classnameColor;
             Color m_classnameBackgroundColor;
@@ -103,6 +107,9 @@ namespace TrenchBroom {
             void writeBounds(RenderContext& context, const Model::EntityList& entities);
             void validateBounds(RenderContext& context);
             void validateModels(RenderContext& context);
+            void validatePendingModels(RenderContext& context);
+            
+            BBoxf modelBounds(const Model::Entity& entity, const EntityModelRenderer& renderer) const;
             
             void renderBounds(RenderContext& context);
             void renderClassnames(RenderContext& context);
@@ -163,6 +170,11 @@ namespace TrenchBroom {
             inline void setGrayscale(bool grayscale) {
                 m_grayscale = grayscale;
             }
+            
+            // skips the models that the given culler reports as occluded
+            inline void setOcclusionCuller(const OcclusionCuller* occlusionCuller) {
+                m_occlusionCuller = occlusionCuller;
+            }
 
             void addEntity(Model::Entity& entity);
             void addEntities(const Model::EntityList& entities);
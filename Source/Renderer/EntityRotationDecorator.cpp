@@ -39,6 +39,10 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace EntityRotationDecoratorUniforms {
+            static const Uniform Color("Color");
+        }
+
         EntityRotationDecorator::EntityRotationDecorator(const Model::MapDocument& document, const Color& fillColor, const Color& outlineColor) :
         EntityDecorator(document),
         m_fillColor(fillColor),
@@ -99,15 +103,15 @@ namespace TrenchBroom {
             SetVboState activateVbo(vbo, Vbo::VboActive);
             ActivateShader shader(context.shaderManager(), Shaders::HandleShader);
             
-            glDepthMask(GL_FALSE);
+            context.renderState().setDepthMask(false);
             glDisable(GL_DEPTH_TEST);
             glPolygonMode(GL_FRONT, GL_LINE);
-            shader.setUniformVariable("Color", Color(m_outlineColor));
+            shader.setUniformVariable(EntityRotationDecoratorUniforms::Color, Color(m_outlineColor));
             vertexArray.render();
             glPolygonMode(GL_FRONT, GL_FILL);
-            shader.setUniformVariable("Color", Color(m_fillColor));
+            shader.setUniformVariable(EntityRotationDecoratorUniforms::Color, Color(m_fillColor));
             vertexArray.render();
-            glDepthMask(GL_TRUE);
+            context.renderState().setDepthMask(true);
         }
     }
 }
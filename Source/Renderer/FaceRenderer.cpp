@@ -20,6 +20,8 @@
 #include "FaceRenderer.h"
 
 #include "Model/Face.h"
+#include "Renderer/BrushStateBuffer.h"
+#include "Renderer/OcclusionCuller.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
@@ -36,6 +38,62 @@ namespace TrenchBroom {
     namespace Renderer {
         String FaceRenderer::AlphaBlendedTextures[] = {"clip", "hint", /*"skip",*/ "hintskip", "trigger"};
 
+        namespace FaceUniforms {
+            static const Uniform Brightness("Brightness");
+            static const Uniform Alpha("Alpha");
+            static const Uniform RenderGrid("RenderGrid");
+            static const Uniform GridSize("GridSize");
+            static const Uniform GridAlpha("GridAlpha");
+            static const Uniform GridCheckerboard("GridCheckerboard");
+            static const Uniform ApplyTexture("ApplyTexture");
+            static const Uniform ApplyTinting("ApplyTinting");
+            static const Uniform TintColor("TintColor");
+            static const Uniform GrayScale("GrayScale");
+            static const Uniform CameraPosition("CameraPosition");
+            static const Uniform ShadeFaces("ShadeFaces");
+            static const Uniform UseFog("UseFog");
+            static const Uniform FaceTexture("FaceTexture");
+            static const Uniform Color("Color");
+            static const Uniform ApplyStates("ApplyStates");
+            static const Uniform StateTexture("StateTexture");
+            static const Uniform StateTextureSize("StateTextureSize");
+            static const Uniform RenderSelection("RenderSelection");
+            static const Uniform SelectedTintColor("SelectedTintColor");
+            static const Uniform LockedTintColor("LockedTintColor");
+        }
+
+        void FaceRenderer::addChunkRange(ChunkRangeList& ranges, size_t chunk, size_t index, size_t count) {
+            if (!ranges.empty() && ranges.back().chunk == chunk && ranges.back().index + ranges.back().count == index)
+                ranges.back().count += count;
+            else
+                ranges.push_back(ChunkRange(chunk, index, count));
+        }
+        
+        void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const FaceBatch::List& batches) {
+            for (size_t i = 0; i < batches.size(); i++) {
+                const FaceBatch& batch = batches[i];
+                if (batch.vertexCount == 0)
+                    continue;
+                
+                TextureRenderer* textureRenderer = batch.texture != NULL ? &textureRendererManager.renderer(batch.texture) : NULL;
+                VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, batch.vertexCount,
+                                                           Attribute::position3f(),
+                                                           Attribute::normal3f(),
+                                                           Attribute::texCoord02f(),
+                                                           Attribute::texCoord11f(),
+                                                           0);
+                vertexArray->addVertices(&batch.vertices.front(), batch.vertexCount);
+                
+                if (batch.transparent) {
+                    m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                    m_transparentChunkRanges.push_back(batch.chunkRanges);
+                } else {
+                    m_vertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                    m_chunkRanges.push_back(batch.chunkRanges);
+                }
+            }
+        }
+        
         void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter) {
             const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
             if (faceCollectionMap.empty())
@@ -48,25 +106,43 @@ namespace TrenchBroom {
                 const FaceCollection& faceCollection = it->second;
                 const Model::FaceList& faces = faceCollection.polygons();
                 const size_t vertexCount = 3 * faceCollection.vertexCount() - 6 * faces.size();
-                VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
-                                                           Attribute::position3f(),
-                                                           Attribute::normal3f(),
-                                                           Attribute::texCoord02f(),
-                                                           0);
+                VertexArray* vertexArray = NULL;
                 
-                for (size_t i = 0; i < faces.size(); i++) {
-                    Model::Face* face = faces[i];
-                    vertexArray->addAttributes(face->cachedVertices());
+                if (m_states != NULL) {
+                    vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
+                                                  Attribute::position3f(),
+                                                  Attribute::normal3f(),
+                                                  Attribute::texCoord02f(),
+                                                  Attribute::texCoord11f(),
+                                                  0);
+                    for (size_t i = 0; i < faces.size(); i++) {
+                        Model::Face* face = faces[i];
+                        vertexArray->addAttributes(face->cachedVertices(), m_states->slot(*face));
+                    }
+                } else {
+                    vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
+                                                  Attribute::position3f(),
+                                                  Attribute::normal3f(),
+                                                  Attribute::texCoord02f(),
+                                                  0);
+                    for (size_t i = 0; i < faces.size(); i++) {
+                        Model::Face* face = faces[i];
+                        vertexArray->addAttributes(face->cachedVertices());
+                    }
                 }
                 
-                if (texture != NULL && alphaBlend(texture->name()))
+                // these faces are never culled, so they have no chunk ranges
+                if (texture != NULL && alphaBlend(texture->name())) {
                     m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
-                else
+                    m_transparentChunkRanges.push_back(ChunkRangeList());
+                } else {
                     m_vertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                    m_chunkRanges.push_back(ChunkRangeList());
+                }
             }
         }
 
-        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor) {
+        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor, const Color* selectedTintColor, const Color* lockedTintColor) {
             if (m_vertexArrays.empty() && m_transparentVertexArrays.empty())
                 return;
             
@@ -80,70 +156,134 @@ namespace TrenchBroom {
                 glActiveTexture(GL_TEXTURE0);
                 
                 const bool applyTexture = context.viewOptions().faceRenderMode() == View::ViewOptions::Textured;
-                faceProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                faceProgram.setUniformVariable("Alpha", 1.0f);
-                faceProgram.setUniformVariable("RenderGrid", grid.visible());
-                faceProgram.setUniformVariable("GridSize", static_cast<float>(grid.actualSize()));
-                faceProgram.setUniformVariable("GridAlpha", prefs.getFloat(Preferences::GridAlpha));
-                faceProgram.setUniformVariable("GridCheckerboard", prefs.getBool(Preferences::GridCheckerboard));
-                faceProgram.setUniformVariable("ApplyTexture", applyTexture);
-                faceProgram.setUniformVariable("ApplyTinting", tintColor != NULL);
+                faceProgram.setUniformVariable(FaceUniforms::Brightness, prefs.getFloat(Preferences::RendererBrightness));
+                faceProgram.setUniformVariable(FaceUniforms::Alpha, 1.0f);
+                faceProgram.setUniformVariable(FaceUniforms::RenderGrid, grid.visible());
+                faceProgram.setUniformVariable(FaceUniforms::GridSize, static_cast<float>(grid.actualSize()));
+                faceProgram.setUniformVariable(FaceUniforms::GridAlpha, prefs.getFloat(Preferences::GridAlpha));
+                faceProgram.setUniformVariable(FaceUniforms::GridCheckerboard, prefs.getBool(Preferences::GridCheckerboard));
+                faceProgram.setUniformVariable(FaceUniforms::ApplyTexture, applyTexture);
+                faceProgram.setUniformVariable(FaceUniforms::ApplyTinting, tintColor != NULL);
                 if (tintColor != NULL)
-                    faceProgram.setUniformVariable("TintColor", *tintColor);
-                faceProgram.setUniformVariable("GrayScale", grayScale);
-                faceProgram.setUniformVariable("CameraPosition", context.camera().position());
-                faceProgram.setUniformVariable("ShadeFaces", context.viewOptions().shadeFaces() );
-                faceProgram.setUniformVariable("UseFog", context.viewOptions().useFog() );
+                    faceProgram.setUniformVariable(FaceUniforms::TintColor, *tintColor);
+                faceProgram.setUniformVariable(FaceUniforms::GrayScale, grayScale);
+                faceProgram.setUniformVariable(FaceUniforms::CameraPosition, context.camera().position());
+                faceProgram.setUniformVariable(FaceUniforms::ShadeFaces, context.viewOptions().shadeFaces() );
+                faceProgram.setUniformVariable(FaceUniforms::UseFog, context.viewOptions().useFog() );
+                faceProgram.setUniformVariable(FaceUniforms::FaceTexture, 0);
+                faceProgram.setUniformVariable(FaceUniforms::ApplyStates, m_states != NULL);
+                if (m_states != NULL) {
+                    assert(selectedTintColor != NULL && lockedTintColor != NULL);
+                    faceProgram.setUniformVariable(FaceUniforms::StateTexture, 1);
+                    faceProgram.setUniformVariable(FaceUniforms::StateTextureSize, m_states->size());
+                    faceProgram.setUniformVariable(FaceUniforms::RenderSelection, context.viewOptions().renderSelection());
+                    faceProgram.setUniformVariable(FaceUniforms::SelectedTintColor, *selectedTintColor);
+                    faceProgram.setUniformVariable(FaceUniforms::LockedTintColor, *lockedTintColor);
+                }
                 
-                renderOpaqueFaces(faceProgram, applyTexture);
-                glDepthMask(GL_FALSE);
-                faceProgram.setUniformVariable("Alpha", prefs.getFloat(Preferences::TransparentFaceAlpha));
-                renderTransparentFaces(faceProgram, applyTexture);
-                glDepthMask(GL_TRUE);
+                RenderState& renderState = context.renderState();
+                renderOpaqueFaces(renderState, faceProgram, applyTexture);
+                renderState.setDepthMask(false);
+                faceProgram.setUniformVariable(FaceUniforms::Alpha, prefs.getFloat(Preferences::TransparentFaceAlpha));
+                renderTransparentFaces(renderState, faceProgram, applyTexture);
+                renderState.setDepthMask(true);
+                renderState.bindTexture(0);
 
                 faceProgram.deactivate();
             }
         }
 
-        void FaceRenderer::renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture) {
-            renderFaces(m_vertexArrays, shader, applyTexture);
+        void FaceRenderer::renderOpaqueFaces(RenderState& renderState, ShaderProgram& shader, const bool applyTexture) {
+            renderFaces(renderState, m_vertexArrays, m_chunkRanges, shader, applyTexture);
         }
         
-        void FaceRenderer::renderTransparentFaces(ShaderProgram& shader, const bool applyTexture) {
-            renderFaces(m_transparentVertexArrays, shader, applyTexture);
+        void FaceRenderer::renderTransparentFaces(RenderState& renderState, ShaderProgram& shader, const bool applyTexture) {
+            renderFaces(renderState, m_transparentVertexArrays, m_transparentChunkRanges, shader, applyTexture);
         }
 
-        void FaceRenderer::renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture) {
+        void FaceRenderer::renderFaces(RenderState& renderState, const TextureVertexArrayList& vertexArrays, const std::vector<ChunkRangeList>& chunkRanges, ShaderProgram& shader, const bool applyTexture) {
+            const bool cull = m_culler != NULL && m_culler->active();
+            ChunkRangeList visibleRanges;
+            
+            // the texture is left bound between batches, the caller unbinds it when all faces are rendered
             for (size_t i = 0; i < vertexArrays.size(); i++) {
                 const TextureVertexArray& textureVertexArray = vertexArrays[i];
+                if (cull) {
+                    // merge the ranges of the visible chunks so that adjacent ones are drawn at once
+                    visibleRanges.clear();
+                    const ChunkRangeList& ranges = chunkRanges[i];
+                    for (size_t j = 0; j < ranges.size(); j++) {
+                        const ChunkRange& range = ranges[j];
+                        if (!m_culler->chunkVisible(range.chunk))
+                            continue;
+                        if (!visibleRanges.empty() && visibleRanges.back().index + visibleRanges.back().count == range.index)
+                            visibleRanges.back().count += range.count;
+                        else
+                            visibleRanges.push_back(range);
+                    }
+                    if (visibleRanges.empty())
+                        continue;
+                }
+                
                 if (textureVertexArray.texture != NULL) {
-                    textureVertexArray.texture->activate();
-                    shader.setUniformVariable("ApplyTexture", applyTexture);
-                    shader.setUniformVariable("FaceTexture", 0);
-                    shader.setUniformVariable("Color", textureVertexArray.texture->averageColor());
+                    textureVertexArray.texture->activate(renderState);
+                    shader.setUniformVariable(FaceUniforms::ApplyTexture, applyTexture);
+                    shader.setUniformVariable(FaceUniforms::Color, textureVertexArray.texture->averageColor());
                 } else {
-                    shader.setUniformVariable("ApplyTexture", false);
-                    shader.setUniformVariable("Color", m_faceColor);
+                    shader.setUniformVariable(FaceUniforms::ApplyTexture, false);
+                    shader.setUniformVariable(FaceUniforms::Color, m_faceColor);
                 }
                 
-                textureVertexArray.vertexArray->render();
-                
-                if (textureVertexArray.texture != NULL)
-                    textureVertexArray.texture->deactivate();
+                if (cull) {
+                    VertexArray& vertexArray = *textureVertexArray.vertexArray;
+                    vertexArray.setup();
+                    for (size_t j = 0; j < visibleRanges.size(); j++)
+                        vertexArray.renderPrimitives(visibleRanges[j].index, visibleRanges[j].count);
+                    vertexArray.cleanup();
+                } else {
+                    textureVertexArray.vertexArray->render();
+                }
             }
         }
 
         FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor) :
-        m_faceColor(faceColor) {
+        m_faceColor(faceColor),
+        m_states(NULL),
+        m_culler(NULL) {
             writeFaceData(vbo, textureRendererManager, faceSorter);
         }
         
+        FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor, const BrushStateBuffer& states) :
+        m_faceColor(faceColor),
+        m_states(&states),
+        m_culler(NULL) {
+            writeFaceData(vbo, textureRendererManager, faceSorter);
+        }
+        
+        FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const FaceBatch::List& batches, const Color& faceColor, const BrushStateBuffer& states, const OcclusionCuller& culler) :
+        m_faceColor(faceColor),
+        m_states(&states),
+        m_culler(&culler) {
+            writeFaceData(vbo, textureRendererManager, batches);
+        }
+        
         void FaceRenderer::render(RenderContext& context, bool grayScale) {
-            render(context, grayScale, NULL);
+            render(context, grayScale, NULL, NULL, NULL);
         }
         
         void FaceRenderer::render(RenderContext& context, bool grayScale, const Color& tintColor) {
-            render(context, grayScale, &tintColor);
+            render(context, grayScale, &tintColor, NULL, NULL);
+        }
+        
+        void FaceRenderer::render(RenderContext& context, const Color& selectedTintColor, const Color& lockedTintColor) {
+            render(context, false, NULL, &selectedTintColor, &lockedTintColor);
+        }
+        
+        void FaceRenderer::clearTextures() {
+            for (size_t i = 0; i < m_vertexArrays.size(); i++)
+                m_vertexArrays[i].texture = NULL;
+            for (size_t i = 0; i < m_transparentVertexArrays.size(); i++)
+                m_transparentVertexArrays[i].texture = NULL;
         }
     }
 }
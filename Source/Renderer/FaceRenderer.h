@@ -24,6 +24,8 @@
 #include "Renderer/TextureVertexArray.h"
 #include "Utility/Color.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class Face;
@@ -31,23 +33,70 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class BrushStateBuffer;
+        class OcclusionCuller;
         class RenderContext;
+        class RenderState;
         class TextureRendererManager;
         class Vbo;
         
         class FaceRenderer {
         public:
             typedef TexturedPolygonSorter<Model::Texture, Model::Face*> Sorter;
+            
+            // the consecutive vertices of each vertex array that belong to the same chunk of the occlusion culler
+            class ChunkRange {
+            public:
+                size_t chunk;
+                size_t index;
+                size_t count;
+                
+                ChunkRange(size_t i_chunk, size_t i_index, size_t i_count) :
+                chunk(i_chunk),
+                index(i_index),
+                count(i_count) {}
+            };
+            typedef std::vector<ChunkRange> ChunkRangeList;
+            
+            // the vertices of the faces with the same texture, interleaved in the layout of the vertex arrays
+            class FaceBatch {
+            public:
+                typedef std::vector<FaceBatch> List;
+                
+                Model::Texture* texture;
+                bool transparent;
+                std::vector<float> vertices;
+                size_t vertexCount;
+                ChunkRangeList chunkRanges;
+                
+                FaceBatch(Model::Texture* i_texture, bool i_transparent) :
+                texture(i_texture),
+                transparent(i_transparent),
+                vertexCount(0) {}
+            };
         protected:
             typedef Sorter::PolygonCollection FaceCollection;
             typedef Sorter::PolygonCollectionMap FaceCollectionMap;
 
             Color m_faceColor;
+            const BrushStateBuffer* m_states;
+            const OcclusionCuller* m_culler;
             TextureVertexArrayList m_vertexArrays;
             TextureVertexArrayList m_transparentVertexArrays;
+            std::vector<ChunkRangeList> m_chunkRanges;
+            std::vector<ChunkRangeList> m_transparentChunkRanges;
             
             static String AlphaBlendedTextures[];
             
+            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const FaceBatch::List& batches);
+            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
+            void render(RenderContext& context, bool grayScale, const Color* tintColor, const Color* selectedTintColor, const Color* lockedTintColor);
+            void renderOpaqueFaces(RenderState& renderState, ShaderProgram& shader, const bool applyTexture);
+            void renderTransparentFaces(RenderState& renderState, ShaderProgram& shader, const bool applyTexture);
+            void renderFaces(RenderState& renderState, const TextureVertexArrayList& vertexArrays, const std::vector<ChunkRangeList>& chunkRanges, ShaderProgram& shader, const bool applyTexture);
+        public:
+            static void addChunkRange(ChunkRangeList& ranges, size_t chunk, size_t index, size_t count);
+            
             inline static bool alphaBlend(const String& textureName) {
                 if (textureName.empty())
                     return false;
@@ -59,16 +108,21 @@ namespace TrenchBroom {
                 return false;
             }
             
-            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
-            void render(RenderContext& context, bool grayScale, const Color* tintColor);
-            void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
-            void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
-            void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
-        public:
             FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
+            // the faces take their tint and visibility from the given states, which must be active when rendering
+            FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor, const BrushStateBuffer& states);
+            // uploads vertices that were prepared in advance, each batch must contain the vertex positions, normals,
+            // texture coordinates and state slots of its faces, and the faces of the chunks that the culler reports
+            // as occluded are skipped
+            FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const FaceBatch::List& batches, const Color& faceColor, const BrushStateBuffer& states, const OcclusionCuller& culler);
             
             void render(RenderContext& context, bool grayScale);
             void render(RenderContext& context, bool grayScale, const Color& tintColor);
+            void render(RenderContext& context, const Color& selectedTintColor, const Color& lockedTintColor);
+            
+            // forgets the texture renderers, which must be done before they are recreated, the faces are rendered
+            // untextured afterwards
+            void clearTextures();
         };
     }
 }
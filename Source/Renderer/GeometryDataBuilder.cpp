@@ -0,0 +1,184 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "GeometryDataBuilder.h"
+
+#include "Renderer/TexturedPolygonSorter.h"
+#include "Utility/Tracer.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        void GeometryDataBuilder::writeFaceData(const Snapshot& snapshot, Result& result) {
+            typedef TexturedPolygonSorter<Model::Texture, const FaceSnapshot*> Sorter;
+
+            Sorter sorter;
+            for (size_t i = 0; i < snapshot.faces.size(); i++) {
+                const FaceSnapshot& face = snapshot.faces[i];
+                sorter.addPolygon(face.texture, &face, face.vertexCount);
+            }
+
+            const Sorter::PolygonCollectionMap& collections = sorter.collections();
+            Sorter::PolygonCollectionMap::const_iterator it, end;
+            for (it = collections.begin(), end = collections.end(); it != end; ++it) {
+                const Sorter::PolygonList& faces = it->second.polygons();
+                assert(!faces.empty());
+
+                result.faceBatches.push_back(FaceRenderer::FaceBatch(it->first, faces.front()->transparent));
+                FaceRenderer::FaceBatch& batch = result.faceBatches.back();
+                batch.vertices.reserve(9 * it->second.vertexCount());
+
+                for (size_t i = 0; i < faces.size(); i++) {
+                    const FaceSnapshot& face = *faces[i];
+                    FaceRenderer::addChunkRange(batch.chunkRanges, face.chunk, batch.vertexCount, face.vertexCount);
+                    for (size_t j = 0; j < face.vertexCount; j++) {
+                        const FaceVertex& vertex = snapshot.vertices[face.firstVertex + j];
+                        const float values[] = {vertex.px, vertex.py, vertex.pz, vertex.nx, vertex.ny, vertex.nz, vertex.ts, vertex.tt, face.slot};
+                        batch.vertices.insert(batch.vertices.end(), values, values + 9);
+                    }
+                    batch.vertexCount += face.vertexCount;
+                }
+                result.faceVertexCount += batch.vertexCount;
+            }
+        }
+
+        void GeometryDataBuilder::writeEdgeData(const Snapshot& snapshot, Result& result) {
+            const EdgeSnapshot::List& edges = snapshot.edges;
+            result.edgeVertices.reserve(2 * 9 * edges.size());
+            for (size_t i = 0; i < edges.size(); i++) {
+                const EdgeSnapshot& edge = edges[i];
+                const float start[] = {edge.start.x(), edge.start.y(), edge.start.z(), edge.color.x(), edge.color.y(), edge.color.z(), edge.color.w(), edge.slots.x(), edge.slots.y()};
+                const float end[] = {edge.end.x(), edge.end.y(), edge.end.z(), edge.color.x(), edge.color.y(), edge.color.z(), edge.color.w(), edge.slots.x(), edge.slots.y()};
+                result.edgeVertices.insert(result.edgeVertices.end(), start, start + 9);
+                result.edgeVertices.insert(result.edgeVertices.end(), end, end + 9);
+            }
+            result.edgeVertexCount = 2 * edges.size();
+        }
+
+        GeometryDataBuilder::Result* GeometryDataBuilder::process(const Snapshot& snapshot) {
+            TRACE_ZONE("GeometryDataBuilder::process");
+            Result* result = new Result();
+            writeFaceData(snapshot, *result);
+            writeEdgeData(snapshot, *result);
+            return result;
+        }
+
+        wxThread::ExitCode GeometryDataBuilder::Entry() {
+            while (true) {
+                m_semaphore.Wait();
+
+                Snapshot* snapshot = NULL;
+                unsigned int generation;
+                {
+                    wxCriticalSectionLocker lock(m_lock);
+                    if (m_stopped)
+                        return (wxThread::ExitCode)0;
+                    // a snapshot may have been taken by an earlier wakeup
+                    if (m_snapshot == NULL)
+                        continue;
+                    snapshot = m_snapshot;
+                    m_snapshot = NULL;
+                    generation = m_generation;
+                }
+
+                Result* result = process(*snapshot);
+                delete snapshot;
+
+                bool notify = false;
+                {
+                    wxCriticalSectionLocker lock(m_lock);
+                    if (m_stopped) {
+                        delete result;
+                        return (wxThread::ExitCode)0;
+                    }
+                    if (generation != m_generation) {
+                        delete result;
+                    } else {
+                        delete m_result;
+                        m_result = result;
+                        notify = true;
+                    }
+                }
+
+                if (notify)
+                    m_handler.QueueEvent(new wxThreadEvent(wxEVT_COMMAND_THREAD));
+            }
+
+            return (wxThread::ExitCode)0;
+        }
+
+        GeometryDataBuilder::GeometryDataBuilder(wxEvtHandler& handler) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_handler(handler),
+        m_snapshot(NULL),
+        m_result(NULL),
+        m_generation(0),
+        m_stopped(false) {
+            Create();
+            Run();
+        }
+
+        GeometryDataBuilder::~GeometryDataBuilder() {
+            assert(m_stopped);
+            clear();
+        }
+
+        void GeometryDataBuilder::build(Snapshot* snapshot) {
+            assert(snapshot != NULL);
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                delete m_snapshot;
+                m_snapshot = snapshot;
+                delete m_result;
+                m_result = NULL;
+                m_generation++;
+            }
+            m_semaphore.Post();
+        }
+
+        void GeometryDataBuilder::clear() {
+            wxCriticalSectionLocker lock(m_lock);
+            delete m_snapshot;
+            m_snapshot = NULL;
+            delete m_result;
+            m_result = NULL;
+            m_generation++;
+        }
+
+        GeometryDataBuilder::Result* GeometryDataBuilder::takeResult() {
+            wxCriticalSectionLocker lock(m_lock);
+            Result* result = m_result;
+            m_result = NULL;
+            return result;
+        }
+
+        void GeometryDataBuilder::stop() {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                if (m_stopped)
+                    return;
+                m_stopped = true;
+            }
+            m_semaphore.Post();
+            Wait();
+        }
+    }
+}
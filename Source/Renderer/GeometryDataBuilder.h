@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__GeometryDataBuilder__
+#define __TrenchBroom__GeometryDataBuilder__
+
+#include "Renderer/FaceRenderer.h"
+#include "Renderer/FaceVertex.h"
+#include "Utility/Color.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+#include <wx/event.h>
+#include <wx/thread.h>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Texture;
+    }
+
+    namespace Renderer {
+        // Prepares the vertex data of the level geometry on a worker thread. The render thread copies everything the
+        // worker needs from the brushes into a snapshot, and the worker sorts the faces by texture and interleaves
+        // the face and edge vertices into staging buffers in the layout of the vertex arrays. When the data of the
+        // latest snapshot is ready, a wxThreadEvent is queued to the given handler, which should then collect it
+        // using takeResult and upload it on the render thread. A snapshot that is superseded by a newer one is
+        // discarded. The textures in a snapshot are only used to group the faces and are never dereferenced.
+        class GeometryDataBuilder : public wxThread {
+        public:
+            // the vertices of a face are stored in the vertex list of its snapshot
+            class FaceSnapshot {
+            public:
+                typedef std::vector<FaceSnapshot> List;
+
+                Model::Texture* texture;
+                bool transparent;
+                float slot;
+                size_t chunk;
+                size_t firstVertex;
+                size_t vertexCount;
+
+                FaceSnapshot(Model::Texture* i_texture, bool i_transparent, float i_slot, size_t i_chunk, size_t i_firstVertex, size_t i_vertexCount) :
+                texture(i_texture),
+                transparent(i_transparent),
+                slot(i_slot),
+                chunk(i_chunk),
+                firstVertex(i_firstVertex),
+                vertexCount(i_vertexCount) {}
+            };
+
+            class EdgeSnapshot {
+            public:
+                typedef std::vector<EdgeSnapshot> List;
+
+                Vec3f start;
+                Vec3f end;
+                Color color;
+                Vec2f slots;
+
+                EdgeSnapshot(const Vec3f& i_start, const Vec3f& i_end, const Color& i_color, const Vec2f& i_slots) :
+                start(i_start),
+                end(i_end),
+                color(i_color),
+                slots(i_slots) {}
+            };
+
+            // the faces must be sorted by chunk
+            class Snapshot {
+            public:
+                FaceSnapshot::List faces;
+                FaceVertex::List vertices;
+                EdgeSnapshot::List edges;
+
+                inline void addFace(Model::Texture* texture, bool transparent, float slot, size_t chunk, const FaceVertex::List& faceVertices) {
+                    faces.push_back(FaceSnapshot(texture, transparent, slot, chunk, vertices.size(), faceVertices.size()));
+                    vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
+                }
+            };
+
+            class Result {
+            public:
+                FaceRenderer::FaceBatch::List faceBatches;
+                size_t faceVertexCount;
+                std::vector<float> edgeVertices;
+                size_t edgeVertexCount;
+
+                Result() :
+                faceVertexCount(0),
+                edgeVertexCount(0) {}
+            };
+        private:
+            wxEvtHandler& m_handler;
+            wxCriticalSection m_lock;
+            wxSemaphore m_semaphore;
+            Snapshot* m_snapshot;
+            Result* m_result;
+            unsigned int m_generation;
+            bool m_stopped;
+
+            void writeFaceData(const Snapshot& snapshot, Result& result);
+            void writeEdgeData(const Snapshot& snapshot, Result& result);
+            Result* process(const Snapshot& snapshot);
+            ExitCode Entry();
+        public:
+            GeometryDataBuilder(wxEvtHandler& handler);
+            ~GeometryDataBuilder();
+
+            // takes ownership of the given snapshot and discards the data of any previous snapshot
+            void build(Snapshot* snapshot);
+            void clear();
+            // returns NULL if the data of the latest snapshot is not ready yet, the caller takes ownership of the result
+            Result* takeResult();
+
+            // stops and joins the worker thread, must be called before the builder is deleted
+            void stop();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__GeometryDataBuilder__) */
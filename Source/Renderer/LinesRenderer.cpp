@@ -28,6 +28,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace LinesUniforms {
+            static const Uniform Color("Color");
+        }
+
         LinesRenderer::LinesRenderer() :
         m_vertexArray(NULL),
         m_valid(false) {}
@@ -60,11 +64,11 @@ namespace TrenchBroom {
                 Renderer::ActivateShader handleShader(context.shaderManager(), Renderer::Shaders::HandleShader);
                 
                 glDisable(GL_DEPTH_TEST);
-                handleShader.setUniformVariable("Color", m_occludedColor);
+                handleShader.setUniformVariable(LinesUniforms::Color, m_occludedColor);
                 m_vertexArray->render();
                 glEnable(GL_DEPTH_TEST);
                 
-                handleShader.setUniformVariable("Color", m_color);
+                handleShader.setUniformVariable(LinesUniforms::Color, m_color);
                 m_vertexArray->render();
                 
                 Renderer::glResetEdgeOffset();
@@ -34,11 +34,14 @@
 #include "Model/Filter.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
+#include "Renderer/BrushStateBuffer.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/EntityRenderer.h"
 #include "Renderer/EntityRotationDecorator.h"
 #include "Renderer/EntityLinkDecorator.h"
 #include "Renderer/FaceRenderer.h"
+#include "Renderer/GeometryDataBuilder.h"
+#include "Renderer/OcclusionCuller.h"
 #include "Renderer/PointHandleRenderer.h"
 #include "Renderer/PointTraceRenderer.h"
 #include "Renderer/RenderContext.h"
@@ -54,6 +57,7 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Tracer.h"
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -65,148 +69,277 @@ namespace TrenchBroom {
         static const int FaceVertexSize = VertexSize + NormalSize + TexCoordSize;
         static const int EdgeVertexSize = VertexSize;
         static const int EntityBoundsVertexSize = ColorSize + VertexSize;
+        static const int SlotSize = sizeof(GLfloat);
+        static const int EdgeColorSize = 4 * sizeof(GLfloat);
+        static const int EdgeSlotsSize = 2 * sizeof(GLfloat);
+        
+        // every edit rewrites all detached brushes, so they are merged back into the static geometry by a full
+        // rebuild once there are too many of them
+        static const size_t MaxDetachedBrushes = 512;
 
-        void MapRenderer::rebuildGeometryData(RenderContext& context) {
-            if (!m_geometryDataValid) {
-                delete m_faceRenderer;
-                m_faceRenderer = NULL;
-                delete m_edgeRenderer;
-                m_edgeRenderer = NULL;
-            }
-            if (!m_selectedGeometryDataValid) {
-                delete m_selectedFaceRenderer;
-                m_selectedFaceRenderer = NULL;
-                delete m_selectedEdgeRenderer;
-                m_selectedEdgeRenderer = NULL;
-            }
-            if (!m_lockedGeometryDataValid) {
-                delete m_lockedFaceRenderer;
-                m_lockedFaceRenderer = NULL;
-                delete m_lockedEdgeRenderer;
-                m_lockedEdgeRenderer = NULL;
-            }
-            
-            FaceSorter unselectedFaceSorter;
-            FaceSorter selectedFaceSorter;
-            FaceSorter lockedFaceSorter;
+        void MapRenderer::writeGeometryData(const FaceSorter& faceSorter, const Model::BrushList& brushes, FaceRenderer*& faceRenderer, EdgeRenderer*& edgeRenderer) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             
-            Model::BrushList unselectedWorldBrushes;
-            Model::BrushList unselectedEntityBrushes;
-            Model::BrushList selectedBrushes;
-            Model::BrushList lockedBrushes;
-            Model::FaceList partiallySelectedBrushFaces;
+            // write face triangles
+            if (!faceSorter.empty()) {
+                m_faceVbo->activate();
+                m_faceVbo->map();
+                
+                // make sure that the VBO is sufficiently large
+                size_t triangleVertexCount = 3 * faceSorter.vertexCount() - 6 * faceSorter.polygonCount();
+                m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(triangleVertexCount) * FaceVertexSize);
+                
+                TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+                const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+                faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, faceSorter, faceColor, *m_brushStates);
+                
+                m_faceVbo->unmap();
+                m_faceVbo->deactivate();
+            }
             
-            // collect all visible faces and brushes
+            // write edges
+            if (!brushes.empty()) {
+                m_edgeVbo->activate();
+                m_edgeVbo->map();
+                
+                const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
+                edgeRenderer = new EdgeRenderer(*m_edgeVbo, brushes, *m_brushStates, edgeColor);
+                
+                m_edgeVbo->unmap();
+                m_edgeVbo->deactivate();
+            }
+        }
+        
+        void MapRenderer::requestGeometryData(RenderContext& context) {
+            TRACE_ZONE("MapRenderer::requestGeometryData");
+            // the current geometry is rendered until the new data is ready
+            delete m_pendingBrushStates;
+            m_pendingBrushStates = new BrushStateBuffer();
+            delete m_pendingOcclusionCuller;
+            m_pendingOcclusionCuller = new OcclusionCuller();
+            
+            const Model::Filter& filter = context.filter();
+            Model::BrushSet mapBrushes;
+            Model::BrushList worldBrushes;
+            Model::BrushList entityBrushes;
+            Model::BrushList chunkedBrushes;
+            size_t faceCount = 0;
+            size_t faceVertexCount = 0;
+            size_t edgeCount = 0;
+            
+            // collect all visible brushes and the hidden ones, which are only made invisible by their state
             const Model::EntityList& entities = m_document.map().entities();
             for (size_t i = 0; i < entities.size(); i++) {
                 Model::Entity* entity = entities[i];
                 const Model::BrushList& brushes = entity->brushes();
                 for (size_t j = 0; j < brushes.size(); j++) {
                     Model::Brush* brush = brushes[j];
-                    if (context.filter().brushVisible(*brush)) {
-                        if (entity->selected() || brush->selected()) {
-                            selectedBrushes.push_back(brush);
-                        } else if (entity->locked() || brush->locked()) {
-                            lockedBrushes.push_back(brush);
-                        } else {
-                            if (entity->worldspawn())
-                                unselectedWorldBrushes.push_back(brush);
-                            else
-                                unselectedEntityBrushes.push_back(brush);
-                            if (brush->partiallySelected()) {
-                                const Model::FaceList& faces = brush->faces();
-                                for (size_t k = 0; k < faces.size(); k++) {
-                                    Model::Face* face = faces[k];
-                                    if (face->selected()) {
-                                        partiallySelectedBrushFaces.push_back(face);
-                                    }
-                                }
-                            }
-                        }
+                    mapBrushes.insert(brush);
+                    
+                    const bool visible = filter.brushVisible(*brush);
+                    if (visible || brush->hidden()) {
+                        m_pendingBrushStates->addBrush(*brush);
+                        m_pendingBrushStates->update(*brush, visible);
                         
-                        const Model::FaceList& faces = brush->faces();
-                        for (size_t k = 0; k < faces.size(); k++) {
-                            Model::Face* face = faces[k];
-                            Model::Texture* texture = face->texture();
-                            if (entity->selected() || brush->selected() || face->selected())
-                                selectedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else if (entity->locked() || brush->locked())
-                                lockedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else
-                                unselectedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                        }
+                        if (entity->worldspawn())
+                            worldBrushes.push_back(brush);
+                        else
+                            entityBrushes.push_back(brush);
+                        chunkedBrushes.push_back(brush);
+
+                        // the faces are triangulated, and every edge borders two faces, so a closed brush with e edges
+                        // and f faces has 3 * (2e - 2f) face vertices
+                        const size_t brushFaceCount = brush->faces().size();
+                        const size_t brushEdgeCount = brush->edges().size();
+                        faceCount += brushFaceCount;
+                        if (brushEdgeCount > brushFaceCount)
+                            faceVertexCount += 6 * (brushEdgeCount - brushFaceCount);
+                        edgeCount += brushEdgeCount;
                     }
                 }
             }
-            
-            // merge the collected brushes
-            Model::BrushList unselectedBrushes(unselectedWorldBrushes);
-            unselectedBrushes.insert(unselectedBrushes.end(), unselectedEntityBrushes.begin(), unselectedEntityBrushes.end());
-
-            // write face triangles
-            m_faceVbo->activate();
-            m_faceVbo->map();
-            
-            // make sure that the VBO is sufficiently large
-            size_t totalFaceVertexCount = unselectedFaceSorter.vertexCount() + selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
-            size_t totalPolygonCount = unselectedFaceSorter.polygonCount() + selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
-            size_t totalTriangleVertexCount = 3 * totalFaceVertexCount - 6 * totalPolygonCount;
-            m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(totalTriangleVertexCount) * FaceVertexSize);
+            m_pendingBrushStates->fixSlots();
+            
+            // the faces are copied in chunk order so that the faces of each chunk are consecutive in every vertex array
+            GeometryDataBuilder::Snapshot* snapshot = new GeometryDataBuilder::Snapshot();
+            snapshot->faces.reserve(faceCount);
+            snapshot->vertices.reserve(faceVertexCount);
+            snapshot->edges.reserve(edgeCount);
+            m_pendingOcclusionCuller->setBrushes(chunkedBrushes);
+            for (size_t i = 0; i < chunkedBrushes.size(); i++) {
+                const Model::Brush& brush = *chunkedBrushes[i];
+                const size_t chunk = m_pendingOcclusionCuller->chunk(brush);
+                const Model::FaceList& faces = brush.faces();
+                for (size_t j = 0; j < faces.size(); j++) {
+                    Model::Face* face = faces[j];
+                    Model::Texture* texture = face->texture();
+                    const bool transparent = texture != NULL && FaceRenderer::alphaBlend(texture->name());
+                    snapshot->addFace(texture, transparent, m_pendingBrushStates->slot(*face), chunk, face->cachedVertices());
+                }
+            }
             
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
-            const Color& faceColor = prefs.getColor(Preferences::FaceColor);
-
-            if (!m_geometryDataValid && !unselectedFaceSorter.empty()) {
-                assert(m_faceRenderer == NULL);
-                m_faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, unselectedFaceSorter, faceColor);
+            const Color& defaultEdgeColor = prefs.getColor(Preferences::EdgeColor);
+            Model::BrushList brushes(worldBrushes);
+            brushes.insert(brushes.end(), entityBrushes.begin(), entityBrushes.end());
+            for (size_t i = 0; i < brushes.size(); i++) {
+                const Model::Brush& brush = *brushes[i];
+                const Model::Entity* entity = brush.entity();
+                const Model::EntityDefinition* definition = entity->definition();
+                const Color& color = (!entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultEdgeColor;
+                
+                const Model::BrushEdgeList edges = brush.edges();
+                for (size_t j = 0; j < edges.size(); j++) {
+                    const Model::BrushEdge edge = edges[j];
+                    const Vec2f slots(m_pendingBrushStates->slot(*edge.leftFace()), m_pendingBrushStates->slot(*edge.rightFace()));
+                    snapshot->edges.push_back(GeometryDataBuilder::EdgeSnapshot(edge.start(), edge.end(), color, slots));
+                }
             }
             
-            if (!m_selectedGeometryDataValid && !selectedFaceSorter.empty()) {
-                assert(m_selectedFaceRenderer == NULL);
-                m_selectedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, selectedFaceSorter, faceColor);
+            m_geometryDataBuilder->build(snapshot);
+            
+            // the snapshot contains the current geometry of every brush, the renderers only need to know which brushes
+            // have changed since then, and removed brushes must neither be rendered nor referenced any longer
+            m_brushesChangedSinceSnapshot.clear();
+            Model::BrushSet::iterator it = m_detachedBrushes.begin();
+            while (it != m_detachedBrushes.end()) {
+                if (mapBrushes.count(*it) == 0) {
+                    m_detachedBrushes.erase(it++);
+                    m_detachedGeometryDataValid = false;
+                } else {
+                    ++it;
+                }
             }
-            
-            if (!m_lockedGeometryDataValid && !lockedFaceSorter.empty()) {
-                assert(m_lockedFaceRenderer == NULL);
-                m_lockedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, lockedFaceSorter, faceColor);
+            it = m_changedBrushes.begin();
+            while (it != m_changedBrushes.end()) {
+                if (mapBrushes.count(*it) == 0)
+                    m_changedBrushes.erase(it++);
+                else
+                    ++it;
             }
+            m_brushStates->retainBrushes(mapBrushes);
+            m_occlusionCuller->retainBrushes(mapBrushes);
             
-            m_faceVbo->unmap();
-            m_faceVbo->deactivate();
+            m_geometryDataValid = true;
+        }
+        
+        void MapRenderer::uploadGeometryData() {
+            if (m_pendingBrushStates == NULL)
+                return;
+            GeometryDataBuilder::Result* result = m_geometryDataBuilder->takeResult();
+            if (result == NULL)
+                return;
             
-            // write edges
-            m_edgeVbo->activate();
-            m_edgeVbo->map();
+            TRACE_ZONE("MapRenderer::uploadGeometryData");
+            delete m_faceRenderer;
+            m_faceRenderer = NULL;
+            delete m_edgeRenderer;
+            m_edgeRenderer = NULL;
+            delete m_detachedFaceRenderer;
+            m_detachedFaceRenderer = NULL;
+            delete m_detachedEdgeRenderer;
+            m_detachedEdgeRenderer = NULL;
+            
+            delete m_brushStates;
+            m_brushStates = m_pendingBrushStates;
+            m_pendingBrushStates = NULL;
+            delete m_occlusionCuller;
+            m_occlusionCuller = m_pendingOcclusionCuller;
+            m_pendingOcclusionCuller = NULL;
+            m_entityRenderer->setOcclusionCuller(m_occlusionCuller);
             
-            const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
-
-            if (!m_geometryDataValid && !unselectedBrushes.empty()) {
-                assert(m_edgeRenderer == NULL);
-                m_edgeRenderer = new EdgeRenderer(*m_edgeVbo, unselectedBrushes, Model::EmptyFaceList, edgeColor);
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            if (!result->faceBatches.empty()) {
+                m_faceVbo->activate();
+                m_faceVbo->map();
+                
+                // make sure that the VBO is sufficiently large
+                m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(result->faceVertexCount) * (FaceVertexSize + SlotSize));
+                
+                TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+                const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+                m_faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, result->faceBatches, faceColor, *m_brushStates, *m_occlusionCuller);
+                
+                m_faceVbo->unmap();
+                m_faceVbo->deactivate();
             }
             
-            if (!m_selectedGeometryDataValid && (!selectedBrushes.empty() || !partiallySelectedBrushFaces.empty())) {
-                assert(m_selectedEdgeRenderer == NULL);
-                m_selectedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, selectedBrushes, partiallySelectedBrushFaces);
+            if (result->edgeVertexCount > 0) {
+                m_edgeVbo->activate();
+                m_edgeVbo->map();
+                
+                m_edgeVbo->ensureFreeCapacity(static_cast<unsigned int>(result->edgeVertexCount) * (EdgeVertexSize + EdgeColorSize + EdgeSlotsSize));
+                m_edgeRenderer = new EdgeRenderer(*m_edgeVbo, result->edgeVertices, result->edgeVertexCount, *m_brushStates);
+                
+                m_edgeVbo->unmap();
+                m_edgeVbo->deactivate();
             }
-            
-            if (!m_lockedGeometryDataValid && !lockedBrushes.empty()) {
-                assert(m_lockedEdgeRenderer == NULL);
-                m_lockedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, lockedBrushes, Model::EmptyFaceList);
+            delete result;
+            
+            // brushes that changed after the snapshot was taken are rendered separately again
+            m_detachedBrushes.swap(m_brushesChangedSinceSnapshot);
+            m_brushesChangedSinceSnapshot.clear();
+            Model::BrushSet::const_iterator it, end;
+            for (it = m_detachedBrushes.begin(), end = m_detachedBrushes.end(); it != end; ++it)
+                m_brushStates->addBrush(**it);
+            m_detachedGeometryDataValid = m_detachedBrushes.empty();
+        }
+        
+        void MapRenderer::rebuildDetachedGeometryData(RenderContext& context) {
+            TRACE_ZONE("MapRenderer::rebuildDetachedGeometryData");
+            delete m_detachedFaceRenderer;
+            m_detachedFaceRenderer = NULL;
+            delete m_detachedEdgeRenderer;
+            m_detachedEdgeRenderer = NULL;
+            
+            const Model::Filter& filter = context.filter();
+            FaceSorter faceSorter;
+            Model::BrushList brushes;
+            
+            Model::BrushSet::const_iterator it, end;
+            for (it = m_detachedBrushes.begin(), end = m_detachedBrushes.end(); it != end; ++it) {
+                Model::Brush* brush = *it;
+                // the slots are only reassigned if the number of faces changed
+                if (!m_brushStates->hasSlots(*brush))
+                    m_brushStates->addBrush(*brush);
+                m_brushStates->update(*brush, filter.brushVisible(*brush));
+                brushes.push_back(brush);
+                
+                const Model::FaceList& faces = brush->faces();
+                for (size_t i = 0; i < faces.size(); i++) {
+                    Model::Face* face = faces[i];
+                    faceSorter.addPolygon(face->texture(), face, face->vertices().size());
+                }
             }
             
-            m_edgeVbo->unmap();
-            m_edgeVbo->deactivate();
+            writeGeometryData(faceSorter, brushes, m_detachedFaceRenderer, m_detachedEdgeRenderer);
             
-            m_geometryDataValid = true;
-            m_selectedGeometryDataValid = true;
-            m_lockedGeometryDataValid = true;
+            m_detachedGeometryDataValid = true;
+        }
+        
+        void MapRenderer::updateBrushStates(RenderContext& context) {
+            if (m_changedBrushes.empty())
+                return;
+            
+            const Model::Filter& filter = context.filter();
+            Model::BrushSet::const_iterator it, end;
+            for (it = m_changedBrushes.begin(), end = m_changedBrushes.end(); it != end; ++it) {
+                Model::Brush& brush = **it;
+                const bool visible = filter.brushVisible(brush);
+                m_brushStates->update(brush, visible);
+                if (m_pendingBrushStates != NULL)
+                    m_pendingBrushStates->update(brush, visible);
+            }
+            m_changedBrushes.clear();
         }
         
         void MapRenderer::validate(RenderContext& context) {
-            if (!m_geometryDataValid || !m_selectedGeometryDataValid || !m_lockedGeometryDataValid)
-                rebuildGeometryData(context);
+            if (!m_geometryDataValid)
+                requestGeometryData(context);
+            uploadGeometryData();
+            if (!m_detachedGeometryDataValid)
+                rebuildDetachedGeometryData(context);
+            updateBrushStates(context);
         }
         
         void MapRenderer::invalidateDecorators() {
@@ -218,46 +351,54 @@ namespace TrenchBroom {
         }
 
         void MapRenderer::renderFaces(RenderContext& context) {
+            TRACE_ZONE("MapRenderer::renderFaces");
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const Color& selectedColor = m_overrideSelectionColors ? m_selectedFaceColor : prefs.getColor(Preferences::SelectedFaceColor);
+            const Color& lockedColor = prefs.getColor(Preferences::LockedFaceColor);
             
             m_faceVbo->activate();
+            m_brushStates->activate();
             if (m_faceRenderer != NULL)
-                m_faceRenderer->render(context, false);
-            if (context.viewOptions().renderSelection() && m_selectedFaceRenderer != NULL) {
-                const Color& color = m_overrideSelectionColors ? m_selectedFaceColor : prefs.getColor(Preferences::SelectedFaceColor);
-                m_selectedFaceRenderer->render(context, false, color);
-            }
-            if (m_lockedFaceRenderer != NULL)
-                m_lockedFaceRenderer->render(context, true, prefs.getColor(Preferences::LockedFaceColor));
+                m_faceRenderer->render(context, selectedColor, lockedColor);
+            if (m_detachedFaceRenderer != NULL)
+                m_detachedFaceRenderer->render(context, selectedColor, lockedColor);
+            m_brushStates->deactivate();
             m_faceVbo->deactivate();
         }
         
         void MapRenderer::renderEdges(RenderContext& context) {
+            TRACE_ZONE("MapRenderer::renderEdges");
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            EdgeRenderer* edgeRenderers[] = {m_edgeRenderer, m_detachedEdgeRenderer};
             
             m_edgeVbo->activate();
+            m_brushStates->activate();
             if (context.viewOptions().renderEdges()) {
-                if (m_edgeRenderer != NULL) {
-                    glSetEdgeOffset(0.02f);
-                    m_edgeRenderer->render(context);
-                }
-                if (m_lockedEdgeRenderer != NULL) {
-                    glSetEdgeOffset(0.02f);
-                    m_lockedEdgeRenderer->render(context, prefs.getColor(Preferences::LockedEdgeColor));
+                const Color& lockedEdgeColor = prefs.getColor(Preferences::LockedEdgeColor);
+                glSetEdgeOffset(0.02f);
+                for (size_t i = 0; i < 2; i++) {
+                    if (edgeRenderers[i] != NULL) {
+                        edgeRenderers[i]->renderDefault(context);
+                        edgeRenderers[i]->renderLocked(context, lockedEdgeColor);
+                    }
                 }
             }
-            if (context.viewOptions().renderSelection() && m_selectedEdgeRenderer != NULL) {
+            if (context.viewOptions().renderSelection()) {
                 const Color& edgeColor = m_overrideSelectionColors ? m_selectedEdgeColor : prefs.getColor(Preferences::SelectedEdgeColor);
                 const Color& occludedEdgeColor = m_overrideSelectionColors ? m_occludedSelectedEdgeColor : prefs.getColor(Preferences::OccludedSelectedEdgeColor);
                 
-                
                 glDisable(GL_DEPTH_TEST);
                 glSetEdgeOffset(0.02f);
-                m_selectedEdgeRenderer->render(context, occludedEdgeColor);
+                for (size_t i = 0; i < 2; i++)
+                    if (edgeRenderers[i] != NULL)
+                        edgeRenderers[i]->renderSelected(context, occludedEdgeColor);
                 glEnable(GL_DEPTH_TEST);
                 glSetEdgeOffset(0.025f);
-                m_selectedEdgeRenderer->render(context, edgeColor);
+                for (size_t i = 0; i < 2; i++)
+                    if (edgeRenderers[i] != NULL)
+                        edgeRenderers[i]->renderSelected(context, edgeColor);
             }
+            m_brushStates->deactivate();
             m_edgeVbo->deactivate();
             glResetEdgeOffset();
         }
@@ -278,18 +419,34 @@ namespace TrenchBroom {
             m_lockedEntityRenderer->addEntities(changeSet.entitiesTo(Model::EditState::Locked));
             m_lockedEntityRenderer->removeEntities(changeSet.entitiesFrom(Model::EditState::Locked));
             
+            // only the states of the affected brushes are rewritten, the geometry stays as it is
+            for (unsigned int i = 0; i < Model::EditState::Count; i++) {
+                const Model::EditState::Type state = static_cast<Model::EditState::Type>(i);
+                const Model::BrushList& brushes = changeSet.brushesTo(state);
+                m_changedBrushes.insert(brushes.begin(), brushes.end());
+                
+                const Model::EntityList& entities = changeSet.entitiesTo(state);
+                for (size_t j = 0; j < entities.size(); j++) {
+                    const Model::BrushList& entityBrushes = entities[j]->brushes();
+                    m_changedBrushes.insert(entityBrushes.begin(), entityBrushes.end());
+                }
+            }
+            
+            for (unsigned int i = 0; i < 2; i++) {
+                const Model::FaceList& faces = changeSet.faces(i == 0);
+                for (size_t j = 0; j < faces.size(); j++)
+                    m_changedBrushes.insert(faces[j]->brush());
+            }
+            
             if (changeSet.brushStateChangedFrom(Model::EditState::Default) ||
                 changeSet.brushStateChangedTo(Model::EditState::Default) ||
                 changeSet.faceSelectionChanged()) {
-                m_geometryDataValid = false;
                 invalidateDecorators();
             }
             
             if (changeSet.brushStateChangedFrom(Model::EditState::Selected) ||
                 changeSet.brushStateChangedTo(Model::EditState::Selected) ||
                 changeSet.faceSelectionChanged()) {
-                m_selectedGeometryDataValid = false;
-                
                 const Model::BrushList& selectedBrushes = changeSet.brushesTo(Model::EditState::Selected);
                 for (unsigned int i = 0; i < selectedBrushes.size(); i++) {
                     Model::Brush* brush = selectedBrushes[i];
@@ -337,11 +494,6 @@ namespace TrenchBroom {
                 
                 invalidateDecorators();
             }
-            
-            if (changeSet.brushStateChangedFrom(Model::EditState::Locked) ||
-                changeSet.brushStateChangedTo(Model::EditState::Locked)) {
-                m_lockedGeometryDataValid = false;
-            }
         }
         
         void MapRenderer::invalidateEntities() {
@@ -358,12 +510,49 @@ namespace TrenchBroom {
         
         void MapRenderer::invalidateBrushes() {
             m_geometryDataValid = false;
-            m_selectedGeometryDataValid = false;
-            m_lockedGeometryDataValid = false;
         }
         
         void MapRenderer::invalidateSelectedBrushes() {
-            m_selectedGeometryDataValid = false;
+            // a full rebuild picks up the changes anyway
+            if (!m_geometryDataValid)
+                return;
+            
+            // detach the selected brushes from the static geometry, their new geometry is written separately
+            Model::EditStateManager& editStateManager = m_document.editStateManager();
+            Model::BrushList brushes = editStateManager.selectedBrushes();
+            
+            const Model::EntityList& entities = editStateManager.selectedEntities();
+            for (size_t i = 0; i < entities.size(); i++) {
+                const Model::BrushList& entityBrushes = entities[i]->brushes();
+                brushes.insert(brushes.end(), entityBrushes.begin(), entityBrushes.end());
+            }
+            
+            const Model::FaceList& faces = editStateManager.selectedFaces();
+            for (size_t i = 0; i < faces.size(); i++)
+                brushes.push_back(faces[i]->brush());
+            
+            for (size_t i = 0; i < brushes.size(); i++) {
+                Model::Brush* brush = brushes[i];
+                if (m_detachedBrushes.insert(brush).second)
+                    m_brushStates->addBrush(*brush);
+                if (m_pendingBrushStates != NULL)
+                    m_brushesChangedSinceSnapshot.insert(brush);
+            }
+            
+            m_detachedGeometryDataValid = false;
+            if (m_pendingBrushStates == NULL && m_detachedBrushes.size() > MaxDetachedBrushes)
+                m_geometryDataValid = false;
+        }
+        
+        void MapRenderer::invalidateTextures() {
+            // the texture renderers are recreated when they are used next, but the current face renderers are still
+            // rendered until the rebuilt geometry is uploaded
+            if (m_faceRenderer != NULL)
+                m_faceRenderer->clearTextures();
+            if (m_detachedFaceRenderer != NULL)
+                m_detachedFaceRenderer->clearTextures();
+            m_geometryDataValid = false;
+            m_detachedGeometryDataValid = false;
         }
         
         void MapRenderer::invalidateAll() {
@@ -384,17 +573,25 @@ namespace TrenchBroom {
         void MapRenderer::clear() {
             delete m_faceRenderer;
             m_faceRenderer = NULL;
-            delete m_selectedFaceRenderer;
-            m_selectedFaceRenderer = NULL;
-            delete m_lockedFaceRenderer;
-            m_lockedFaceRenderer = NULL;
+            delete m_detachedFaceRenderer;
+            m_detachedFaceRenderer = NULL;
             
             delete m_edgeRenderer;
             m_edgeRenderer = NULL;
-            delete m_selectedEdgeRenderer;
-            m_selectedEdgeRenderer = NULL;
-            delete m_lockedEdgeRenderer;
-            m_lockedEdgeRenderer = NULL;
+            delete m_detachedEdgeRenderer;
+            m_detachedEdgeRenderer = NULL;
+            
+            m_detachedBrushes.clear();
+            m_changedBrushes.clear();
+            m_brushesChangedSinceSnapshot.clear();
+            m_occlusionCuller->clear();
+            
+            // discard the data of any pending snapshot
+            m_geometryDataBuilder->clear();
+            delete m_pendingBrushStates;
+            m_pendingBrushStates = NULL;
+            delete m_pendingOcclusionCuller;
+            m_pendingOcclusionCuller = NULL;
             
             m_entityRenderer->clear();
             m_selectedEntityRenderer->clear();
@@ -408,12 +605,15 @@ namespace TrenchBroom {
         m_document(document),
         m_faceVbo(NULL),
         m_faceRenderer(NULL),
-        m_selectedFaceRenderer(NULL),
-        m_lockedFaceRenderer(NULL),
+        m_detachedFaceRenderer(NULL),
         m_edgeVbo(NULL),
         m_edgeRenderer(NULL),
-        m_selectedEdgeRenderer(NULL),
-        m_lockedEdgeRenderer(NULL),
+        m_detachedEdgeRenderer(NULL),
+        m_brushStates(NULL),
+        m_occlusionCuller(NULL),
+        m_pendingBrushStates(NULL),
+        m_pendingOcclusionCuller(NULL),
+        m_geometryDataBuilder(NULL),
         m_entityVbo(NULL),
         m_entityRenderer(NULL),
         m_selectedEntityRenderer(NULL),
@@ -423,16 +623,20 @@ namespace TrenchBroom {
         m_overrideSelectionColors(false),
         m_rendering(false),
         m_geometryDataValid(false),
-        m_selectedGeometryDataValid(false),
-        m_lockedGeometryDataValid(false) {
+        m_detachedGeometryDataValid(false) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
             m_faceVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_edgeVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_entityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_utilityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            m_brushStates = new BrushStateBuffer();
+            m_occlusionCuller = new OcclusionCuller();
+            m_geometryDataBuilder = new GeometryDataBuilder(*this);
+            Bind(wxEVT_COMMAND_THREAD, &MapRenderer::OnGeometryDataReady, this);
             
             m_entityRenderer = new EntityRenderer(*m_entityVbo, m_document);
+            m_entityRenderer->setOcclusionCuller(m_occlusionCuller);
             m_entityRenderer->setClassnameFadeDistance(prefs.getFloat(Preferences::InfoOverlayFadeDistance));
             m_entityRenderer->setClassnameColor(prefs.getColor(Preferences::InfoOverlayTextColor), prefs.getColor(Preferences::InfoOverlayBackgroundColor));
             
@@ -457,6 +661,10 @@ namespace TrenchBroom {
         }
         
         MapRenderer::~MapRenderer() {
+            m_geometryDataBuilder->stop();
+            delete m_geometryDataBuilder;
+            m_geometryDataBuilder = NULL;
+            
             Utility::deleteAll(m_entityDecorators);
             removePointTrace();
             
@@ -468,22 +676,26 @@ namespace TrenchBroom {
             m_entityRenderer = NULL;
             delete m_entityVbo;
             m_entityVbo = NULL;
-            delete m_lockedEdgeRenderer;
-            m_lockedEdgeRenderer = NULL;
-            delete m_selectedEdgeRenderer;
-            m_selectedEdgeRenderer = NULL;
+            delete m_detachedEdgeRenderer;
+            m_detachedEdgeRenderer = NULL;
             delete m_edgeRenderer;
             m_edgeRenderer = NULL;
             delete m_edgeVbo;
             m_edgeVbo = NULL;
-            delete m_lockedFaceRenderer;
-            m_lockedFaceRenderer = NULL;
-            delete m_selectedFaceRenderer;
-            m_selectedFaceRenderer = NULL;
+            delete m_detachedFaceRenderer;
+            m_detachedFaceRenderer = NULL;
             delete m_faceRenderer;
             m_faceRenderer = NULL;
             delete m_faceVbo;
             m_faceVbo = NULL;
+            delete m_brushStates;
+            m_brushStates = NULL;
+            delete m_occlusionCuller;
+            m_occlusionCuller = NULL;
+            delete m_pendingBrushStates;
+            m_pendingBrushStates = NULL;
+            delete m_pendingOcclusionCuller;
+            m_pendingOcclusionCuller = NULL;
             delete m_utilityVbo;
             m_utilityVbo = NULL;
         }
@@ -528,7 +740,7 @@ namespace TrenchBroom {
                     const Controller::EntityPropertyCommand& entityPropertyCommand = static_cast<const Controller::EntityPropertyCommand&>(command);
                     if (entityPropertyCommand.isEntityAffected(m_document.worldspawn()) &&
                         entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey))
-                            invalidateBrushes();
+                            invalidateTextures();
                     invalidateEntities();
                     invalidateSelectedEntityModelRendererCache();
                     break;
@@ -584,15 +796,30 @@ namespace TrenchBroom {
             m_pointTraceRenderer = NULL;
         }
 
+        void MapRenderer::OnGeometryDataReady(wxThreadEvent& event) {
+            // the data is uploaded when the views are rendered next
+            m_document.UpdateAllViews();
+        }
+        
         void MapRenderer::render(RenderContext& context) {
             if (m_rendering)
                 return;
             m_rendering = true;
+            TRACE_ZONE("MapRenderer::render");
+
+            {
+                TRACE_ZONE("MapRenderer::validate");
+                validate(context);
+            }
             
-            validate(context);
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            if (prefs.getBool(Preferences::RendererOcclusionCulling))
+                m_occlusionCuller->update(context.camera(), context.filter());
+            else
+                m_occlusionCuller->disable();
             
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            context.renderState().setBlend(true);
+            context.renderState().setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             glFrontFace(GL_CW);
             glEnable(GL_CULL_FACE);
             glEnable(GL_DEPTH_TEST);
@@ -607,6 +834,7 @@ namespace TrenchBroom {
                 renderEdges(context);
             
             if (context.viewOptions().showEntities()) {
+                TRACE_ZONE("MapRenderer::renderEntities");
                 m_entityRenderer->render(context);
                 if (context.viewOptions().renderSelection())
                     m_selectedEntityRenderer->render(context);
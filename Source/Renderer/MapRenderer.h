@@ -37,6 +37,8 @@
 #include <map>
 #include <vector>
 
+#include <wx/event.h>
+
 namespace TrenchBroom {
     namespace Controller {
         class Command;
@@ -48,10 +50,13 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class BrushStateBuffer;
         class EdgeRenderer;
         class EntityRenderer;
         class FaceRenderer;
         class Figure;
+        class GeometryDataBuilder;
+        class OcclusionCuller;
         class PointTraceRenderer;
         class RenderContext;
         class Shader;
@@ -63,7 +68,7 @@ namespace TrenchBroom {
             class StringManager;
         }
         
-        class MapRenderer {
+        class MapRenderer : public wxEvtHandler {
         private:
             typedef TexturedPolygonSorter<Model::Texture, Model::Face*> FaceSorter;
             typedef FaceSorter::PolygonCollection FaceCollection;
@@ -71,16 +76,27 @@ namespace TrenchBroom {
         private:
             Model::MapDocument& m_document;
             
-            // level geometry rendering
+            // level geometry rendering, brushes whose geometry changed since the last full rebuild are detached
+            // from the static renderers and rendered by the detached renderers instead
             Vbo* m_faceVbo;
             FaceRenderer* m_faceRenderer;
-            FaceRenderer* m_selectedFaceRenderer;
-            FaceRenderer* m_lockedFaceRenderer;
+            FaceRenderer* m_detachedFaceRenderer;
             
             Vbo* m_edgeVbo;
             EdgeRenderer* m_edgeRenderer;
-            EdgeRenderer* m_selectedEdgeRenderer;
-            EdgeRenderer* m_lockedEdgeRenderer;
+            EdgeRenderer* m_detachedEdgeRenderer;
+            
+            BrushStateBuffer* m_brushStates;
+            Model::BrushSet m_detachedBrushes;
+            Model::BrushSet m_changedBrushes;
+            OcclusionCuller* m_occlusionCuller;
+            
+            // the vertex data of the level geometry is prepared on a worker thread, the states and chunks of the brushes
+            // in the snapshot it is prepared from are kept until the data is uploaded
+            BrushStateBuffer* m_pendingBrushStates;
+            OcclusionCuller* m_pendingOcclusionCuller;
+            Model::BrushSet m_brushesChangedSinceSnapshot;
+            GeometryDataBuilder* m_geometryDataBuilder;
             
             Vbo* m_entityVbo;
             EntityRenderer* m_entityRenderer;
@@ -99,10 +115,13 @@ namespace TrenchBroom {
             // state
             bool m_rendering;
             bool m_geometryDataValid;
-            bool m_selectedGeometryDataValid;
-            bool m_lockedGeometryDataValid;
+            bool m_detachedGeometryDataValid;
             
-            void rebuildGeometryData(RenderContext& context);
+            void writeGeometryData(const FaceSorter& faceSorter, const Model::BrushList& brushes, FaceRenderer*& faceRenderer, EdgeRenderer*& edgeRenderer);
+            void requestGeometryData(RenderContext& context);
+            void uploadGeometryData();
+            void rebuildDetachedGeometryData(RenderContext& context);
+            void updateBrushStates(RenderContext& context);
             
             void validate(RenderContext& context);
             
@@ -115,6 +134,7 @@ namespace TrenchBroom {
             void invalidateSelectedEntities();
             void invalidateBrushes();
             void invalidateSelectedBrushes();
+            void invalidateTextures();
             void invalidateAll();
             void invalidateEntityModelRendererCache();
             void invalidateSelectedEntityModelRendererCache();
@@ -141,6 +161,8 @@ namespace TrenchBroom {
             void removePointTrace();
             
             void render(RenderContext& context);
+            
+            void OnGeometryDataReady(wxThreadEvent& event);
         };
     }
 }
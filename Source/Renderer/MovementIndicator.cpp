@@ -32,6 +32,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace MovementIndicatorUniforms {
+            static const Uniform Color("Color");
+        }
+
         const float MovementIndicator::Width2 = 1.5f;
         const float MovementIndicator::Height = 5.0f;
         
@@ -144,9 +148,9 @@ namespace TrenchBroom {
 
         void MovementIndicator::renderArrow(const Mat4f& matrix, ActivateShader& shader, RenderContext& context) const {
             ApplyModelMatrix applyMatrix(context.transformation(), matrix);
-            shader.setUniformVariable("Color", m_outlineColor);
+            shader.setUniformVariable(MovementIndicatorUniforms::Color, m_outlineColor);
             m_outline->render();
-            shader.setUniformVariable("Color", m_fillColor);
+            shader.setUniformVariable(MovementIndicatorUniforms::Color, m_fillColor);
             m_triangles->render();
         }
     }
@@ -0,0 +1,249 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#ifdef TB_OCCLUSIONBUFFER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // points closer to the camera than this are not projected
+        static const float MinClipW = 0.1f;
+
+        bool OcclusionBuffer::project(const Vec3f& point, ScreenPoint& result) const {
+            const float w = m_rowW[0] * point.x() + m_rowW[1] * point.y() + m_rowW[2] * point.z() + m_rowW[3];
+            if (w < MinClipW)
+                return false;
+
+            const float x = m_rowX[0] * point.x() + m_rowX[1] * point.y() + m_rowX[2] * point.z() + m_rowX[3];
+            const float y = m_rowY[0] * point.x() + m_rowY[1] * point.y() + m_rowY[2] * point.z() + m_rowY[3];
+            const float invW = 1.0f / w;
+            result.x = (x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+            result.y = (y * invW * 0.5f + 0.5f) * static_cast<float>(m_height);
+            result.z = invW;
+            return true;
+        }
+
+        void OcclusionBuffer::rasterizeRowScalar(float* row, int x0, int x1, float dzdx, float rowZ) const {
+            const size_t count = m_edges.size();
+            for (int x = x0; x <= x1; x++) {
+                const float cx = static_cast<float>(x) + 0.5f;
+                bool inside = true;
+                for (size_t i = 0; i < count && inside; i++)
+                    inside = m_edges[i].a * cx + m_rowEdges[i] >= 0.0f;
+                if (inside)
+                    row[x] = std::max(row[x], dzdx * cx + rowZ);
+            }
+        }
+
+#ifdef TB_OCCLUSIONBUFFER_SSE
+        void OcclusionBuffer::rasterizeRowVectorized(float* row, int x0, int x1, float dzdx, float rowZ) const {
+            // the width is a multiple of four, so all four pixels starting at an aligned x are in the row
+            const size_t count = m_edges.size();
+            const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 dzdx4 = _mm_set1_ps(dzdx);
+            const __m128 rowZ4 = _mm_set1_ps(rowZ);
+            for (int x = x0 & ~3; x <= x1; x += 4) {
+                const __m128 cx = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_edges[0].a), cx), _mm_set1_ps(m_rowEdges[0])), zero);
+                for (size_t i = 1; i < count; i++)
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_edges[i].a), cx), _mm_set1_ps(m_rowEdges[i])), zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 z = _mm_add_ps(_mm_mul_ps(dzdx4, cx), rowZ4);
+                const __m128 old = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_max_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+        }
+#endif
+
+        OcclusionBuffer::OcclusionBuffer() :
+        m_width(0),
+        m_height(0),
+        m_empty(true),
+        m_vectorized(vectorizationAvailable()) {
+            for (size_t i = 0; i < 4; i++)
+                m_rowX[i] = m_rowY[i] = m_rowW[i] = 0.0f;
+        }
+
+        void OcclusionBuffer::clear(const Mat4f& viewProjection, size_t width, size_t height) {
+            assert(width > 0 && height > 0);
+            m_width = (width + 3) & ~static_cast<size_t>(3);
+            m_height = height;
+            m_depths.assign(m_width * m_height, 0.0f);
+            m_empty = true;
+
+            // the matrix is stored in columns
+            for (size_t i = 0; i < 4; i++) {
+                m_rowX[i] = viewProjection[i][0];
+                m_rowY[i] = viewProjection[i][1];
+                m_rowW[i] = viewProjection[i][3];
+            }
+        }
+
+        void OcclusionBuffer::addOccluder(const Vec3f::List& polygon) {
+            const size_t count = polygon.size();
+            if (count < 3 || m_width == 0)
+                return;
+
+            m_points.resize(count);
+            for (size_t i = 0; i < count; i++)
+                if (!project(polygon[i], m_points[i]))
+                    return;
+
+            float minX = m_points[0].x;
+            float maxX = m_points[0].x;
+            float minY = m_points[0].y;
+            float maxY = m_points[0].y;
+            float area = 0.0f;
+            for (size_t i = 0; i < count; i++) {
+                const ScreenPoint& p = m_points[i];
+                const ScreenPoint& q = m_points[(i + 1) % count];
+                area += p.x * q.y - q.x * p.y;
+                minX = std::min(minX, p.x);
+                maxX = std::max(maxX, p.x);
+                minY = std::min(minY, p.y);
+                maxY = std::max(maxY, p.y);
+            }
+
+            // a polygon smaller than a pixel cannot cover one entirely
+            if (std::abs(area) < 2.0f)
+                return;
+
+            // the pixel centers are at i + 0.5
+            const float width = static_cast<float>(m_width);
+            const float height = static_cast<float>(m_height);
+            const int x0 = static_cast<int>(std::ceil(std::max(minX, 0.0f) - 0.5f));
+            const int x1 = static_cast<int>(std::floor(std::min(maxX, width) - 0.5f));
+            const int y0 = static_cast<int>(std::ceil(std::max(minY, 0.0f) - 0.5f));
+            const int y1 = static_cast<int>(std::floor(std::min(maxY, height) - 0.5f));
+            if (x0 > x1 || y0 > y1)
+                return;
+
+            // edge equations oriented so that the inside is positive, shifted by half a pixel so that they are only
+            // positive for pixels that are entirely inside
+            const float orientation = area > 0.0f ? 1.0f : -1.0f;
+            m_edges.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                const ScreenPoint& p = m_points[i];
+                const ScreenPoint& q = m_points[(i + 1) % count];
+                Edge& edge = m_edges[i];
+                edge.a = orientation * (p.y - q.y);
+                edge.b = orientation * (q.x - p.x);
+                edge.c = -(edge.a * p.x + edge.b * p.y) - 0.5f * (std::abs(edge.a) + std::abs(edge.b));
+            }
+
+            // the depth plane is taken from the largest triangle of the fan to keep it stable
+            const ScreenPoint& p0 = m_points[0];
+            size_t best = 1;
+            float bestDet = 0.0f;
+            for (size_t i = 1; i < count - 1; i++) {
+                const ScreenPoint& p1 = m_points[i];
+                const ScreenPoint& p2 = m_points[i + 1];
+                const float det = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+                if (std::abs(det) > std::abs(bestDet)) {
+                    bestDet = det;
+                    best = i;
+                }
+            }
+            if (std::abs(bestDet) < 1e-6f)
+                return;
+
+            const ScreenPoint& p1 = m_points[best];
+            const ScreenPoint& p2 = m_points[best + 1];
+            const float dzdx = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / bestDet;
+            const float dzdy = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / bestDet;
+            // the farthest depth of the polygon within each pixel
+            const float zOffset = p0.z - dzdx * p0.x - dzdy * p0.y - 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+
+            m_rowEdges.resize(count);
+            for (int y = y0; y <= y1; y++) {
+                const float cy = static_cast<float>(y) + 0.5f;
+                for (size_t i = 0; i < count; i++)
+                    m_rowEdges[i] = m_edges[i].b * cy + m_edges[i].c;
+                const float rowZ = dzdy * cy + zOffset;
+                float* row = &m_depths[static_cast<size_t>(y) * m_width];
+
+#ifdef TB_OCCLUSIONBUFFER_SSE
+                if (m_vectorized) {
+                    rasterizeRowVectorized(row, x0, x1, dzdx, rowZ);
+                    continue;
+                }
+#endif
+                rasterizeRowScalar(row, x0, x1, dzdx, rowZ);
+            }
+            m_empty = false;
+        }
+
+        bool OcclusionBuffer::visible(const BBoxf& bounds) const {
+            if (m_width == 0)
+                return true;
+
+            float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f, maxZ = 0.0f;
+            for (size_t i = 0; i < 8; i++) {
+                const Vec3f corner((i & 1) ? bounds.max.x() : bounds.min.x(),
+                                   (i & 2) ? bounds.max.y() : bounds.min.y(),
+                                   (i & 4) ? bounds.max.z() : bounds.min.z());
+                ScreenPoint screenPoint;
+                if (!project(corner, screenPoint))
+                    return true;
+                if (i == 0) {
+                    minX = maxX = screenPoint.x;
+                    minY = maxY = screenPoint.y;
+                    maxZ = screenPoint.z;
+                } else {
+                    minX = std::min(minX, screenPoint.x);
+                    maxX = std::max(maxX, screenPoint.x);
+                    minY = std::min(minY, screenPoint.y);
+                    maxY = std::max(maxY, screenPoint.y);
+                    maxZ = std::max(maxZ, screenPoint.z);
+                }
+            }
+
+            const float width = static_cast<float>(m_width);
+            const float height = static_cast<float>(m_height);
+            if (maxX < 0.0f || maxY < 0.0f || minX > width || minY > height)
+                return false;
+            if (m_empty)
+                return true;
+
+            const size_t x0 = static_cast<size_t>(std::max(minX, 0.0f));
+            const size_t x1 = std::min(static_cast<size_t>(std::max(maxX, 0.0f)), m_width - 1);
+            const size_t y0 = static_cast<size_t>(std::max(minY, 0.0f));
+            const size_t y1 = std::min(static_cast<size_t>(std::max(maxY, 0.0f)), m_height - 1);
+            for (size_t y = y0; y <= y1; y++) {
+                const float* row = &m_depths[y * m_width];
+                for (size_t x = x0; x <= x1; x++)
+                    if (row[x] <= maxZ)
+                        return true;
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__OcclusionBuffer__
+#define __TrenchBroom__OcclusionBuffer__
+
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+#if defined __SSE__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 1)
+#define TB_OCCLUSIONBUFFER_SSE
+#endif
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // A low resolution depth buffer that occluders are rasterized into on the CPU. Each pixel stores the reciprocal
+        // of the view depth of the occluders covering it because it can be interpolated linearly in screen space, so
+        // larger values are closer to the camera and zero means that nothing covers the pixel.
+        // Both rasterization and testing are conservative: an occluder only covers the pixels that it covers entirely,
+        // with the farthest depth it has within them, and a box is tested against every pixel it touches.
+        class OcclusionBuffer {
+        private:
+            struct ScreenPoint {
+                float x;
+                float y;
+                float z;
+            };
+
+            // a polygon edge as a line equation that is non-negative for pixels entirely on its inner side
+            struct Edge {
+                float a;
+                float b;
+                float c;
+            };
+
+            size_t m_width;
+            size_t m_height;
+            std::vector<float> m_depths;
+            std::vector<ScreenPoint> m_points;
+            std::vector<Edge> m_edges;
+            std::vector<float> m_rowEdges;
+            bool m_empty;
+            bool m_vectorized;
+
+            // the rows of the view projection matrix that yield x, y and w in clip space
+            float m_rowX[4];
+            float m_rowY[4];
+            float m_rowW[4];
+
+            // returns false if the point is too close to or behind the camera
+            bool project(const Vec3f& point, ScreenPoint& result) const;
+
+            // rasterize the pixels x0 to x1 of a row of the current polygon, whose edges are in m_edges and m_rowEdges
+            void rasterizeRowScalar(float* row, int x0, int x1, float dzdx, float rowZ) const;
+#ifdef TB_OCCLUSIONBUFFER_SSE
+            void rasterizeRowVectorized(float* row, int x0, int x1, float dzdx, float rowZ) const;
+#endif
+        public:
+            OcclusionBuffer();
+
+            inline static bool vectorizationAvailable() {
+#ifdef TB_OCCLUSIONBUFFER_SSE
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            inline bool vectorized() const {
+                return m_vectorized;
+            }
+
+            // the SSE rasterizer is used by default where it is available, the scalar one can be selected to compare them
+            inline void setVectorized(bool vectorized) {
+                m_vectorized = vectorized && vectorizationAvailable();
+            }
+
+            inline size_t width() const {
+                return m_width;
+            }
+
+            inline size_t height() const {
+                return m_height;
+            }
+
+            inline float depth(size_t x, size_t y) const {
+                return m_depths[y * m_width + x];
+            }
+
+            // the width is rounded up to a multiple of four, the matrix must be a perspective projection
+            void clear(const Mat4f& viewProjection, size_t width, size_t height);
+
+            // rasterizes a planar convex polygon, which is skipped if it is not entirely in front of the camera
+            void addOccluder(const Vec3f::List& polygon);
+
+            // returns whether any part of the box might be visible
+            bool visible(const BBoxf& bounds) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__OcclusionBuffer__) */
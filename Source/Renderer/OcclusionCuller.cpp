@@ -0,0 +1,174 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "OcclusionCuller.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Filter.h"
+#include "Renderer/Camera.h"
+#include "Renderer/FaceRenderer.h"
+#include "Utility/Tracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        const size_t OcclusionCuller::NoChunk = std::numeric_limits<size_t>::max();
+
+        // the edge length of the grid cells that the brushes are grouped by
+        static const float ChunkSize = 512.0f;
+        // world brushes must be at least this large along two axes to occlude anything worthwhile
+        static const float MinOccluderSize = 128.0f;
+
+        bool OcclusionCuller::occluderCandidate(const Model::Brush& brush) const {
+            const Model::Entity* entity = brush.entity();
+            if (entity == NULL || !entity->worldspawn())
+                return false;
+
+            const Vec3f size = brush.bounds().size();
+            size_t largeAxes = 0;
+            for (size_t i = 0; i < 3; i++)
+                if (size[i] >= MinOccluderSize)
+                    largeAxes++;
+            if (largeAxes < 2)
+                return false;
+
+            const Model::FaceList& faces = brush.faces();
+            for (size_t i = 0; i < faces.size(); i++)
+                if (FaceRenderer::alphaBlend(faces[i]->textureName()))
+                    return false;
+            return true;
+        }
+
+        void OcclusionCuller::addOccluder(const Model::Brush& brush, const Vec3f& cameraPosition) {
+            const Model::FaceList& faces = brush.faces();
+            for (size_t i = 0; i < faces.size(); i++) {
+                const Model::Face& face = *faces[i];
+                const Planef& boundary = face.boundary();
+                if (boundary.normal.dot(cameraPosition) <= boundary.distance)
+                    continue;
+
+                const Model::SideVertexList vertices = face.vertices();
+                m_polygon.resize(vertices.size());
+                for (size_t j = 0; j < vertices.size(); j++)
+                    m_polygon[j] = vertices[j];
+                m_buffer.addOccluder(m_polygon);
+            }
+        }
+
+        OcclusionCuller::OcclusionCuller() :
+        m_active(false) {}
+
+        void OcclusionCuller::setBrushes(Model::BrushList& brushes) {
+            clear();
+
+            ChunkIndexMap chunkIndices;
+            for (size_t i = 0; i < brushes.size(); i++) {
+                const Model::Brush* brush = brushes[i];
+                const BBoxf& bounds = brush->bounds();
+                const Vec3f center = bounds.center();
+                const Vec3f key(std::floor(center.x() / ChunkSize),
+                                std::floor(center.y() / ChunkSize),
+                                std::floor(center.z() / ChunkSize));
+
+                ChunkIndexMap::iterator it = chunkIndices.find(key);
+                if (it == chunkIndices.end()) {
+                    it = chunkIndices.insert(ChunkIndexMap::value_type(key, m_chunkBounds.size())).first;
+                    m_chunkBounds.push_back(bounds);
+                } else {
+                    m_chunkBounds[it->second].mergeWith(bounds);
+                }
+                m_brushChunks[brush] = it->second;
+
+                if (occluderCandidate(*brush))
+                    m_candidates.push_back(brushes[i]);
+            }
+
+            std::stable_sort(brushes.begin(), brushes.end(), CompareByChunk(m_brushChunks));
+            m_chunkVisible.resize(m_chunkBounds.size(), true);
+        }
+
+        void OcclusionCuller::retainBrushes(const Model::BrushSet& brushes) {
+            size_t count = 0;
+            for (size_t i = 0; i < m_candidates.size(); i++)
+                if (brushes.count(m_candidates[i]) > 0)
+                    m_candidates[count++] = m_candidates[i];
+            m_candidates.resize(count);
+        }
+
+        void OcclusionCuller::clear() {
+            m_brushChunks.clear();
+            m_chunkBounds.clear();
+            m_chunkVisible.clear();
+            m_candidates.clear();
+            m_active = false;
+        }
+
+        size_t OcclusionCuller::chunk(const Model::Brush& brush) const {
+            BrushChunkMap::const_iterator it = m_brushChunks.find(&brush);
+            if (it == m_brushChunks.end())
+                return NoChunk;
+            return it->second;
+        }
+
+        void OcclusionCuller::update(const Camera& camera, const Model::Filter& filter) {
+            TRACE_ZONE("OcclusionCuller::update");
+            const Camera::Viewport& viewport = camera.viewport();
+            if (camera.ortho() || viewport.width <= 0 || viewport.height <= 0 || m_candidates.empty()) {
+                disable();
+                return;
+            }
+
+            const size_t height = std::max(static_cast<size_t>(1), BufferWidth * static_cast<size_t>(viewport.height) / static_cast<size_t>(viewport.width));
+            m_buffer.clear(camera.projectionMatrix() * camera.viewMatrix(), BufferWidth, height);
+
+            // prefer the brushes that cover the largest part of the view
+            const Vec3f& position = camera.position();
+            m_scoredOccluders.clear();
+            for (size_t i = 0; i < m_candidates.size(); i++) {
+                Model::Brush* brush = m_candidates[i];
+                if (!filter.brushVisible(*brush))
+                    continue;
+                const BBoxf& bounds = brush->bounds();
+                const float distance2 = std::max((bounds.center() - position).lengthSquared(), 1.0f);
+                m_scoredOccluders.push_back(ScoredBrush(bounds.size().lengthSquared() / distance2, brush));
+            }
+
+            const size_t occluderCount = std::min(m_scoredOccluders.size(), MaxOccluders);
+            std::partial_sort(m_scoredOccluders.begin(), m_scoredOccluders.begin() + occluderCount, m_scoredOccluders.end(), std::greater<ScoredBrush>());
+            for (size_t i = 0; i < occluderCount; i++)
+                addOccluder(*m_scoredOccluders[i].second, position);
+
+            for (size_t i = 0; i < m_chunkBounds.size(); i++)
+                m_chunkVisible[i] = m_buffer.visible(m_chunkBounds[i]);
+            m_active = true;
+        }
+
+        void OcclusionCuller::disable() {
+            m_active = false;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__OcclusionCuller__
+#define __TrenchBroom__OcclusionCuller__
+
+#include "Model/BrushTypes.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Utility/VecMath.h"
+
+#include <map>
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Filter;
+    }
+
+    namespace Renderer {
+        class Camera;
+
+        // Groups the brushes into chunks of a coarse spatial grid and determines once per frame which chunks are
+        // hidden behind the largest nearby world brushes. The occluders are rasterized into a low resolution
+        // occlusion buffer on the CPU, and the chunks and entities are then tested against it by their bounds.
+        class OcclusionCuller {
+        public:
+            static const size_t NoChunk;
+        private:
+            typedef std::map<Vec3f, size_t, Vec3f::LexicographicOrder> ChunkIndexMap;
+            typedef std::map<const Model::Brush*, size_t> BrushChunkMap;
+            typedef std::pair<float, Model::Brush*> ScoredBrush;
+
+            static const size_t BufferWidth = 256;
+            static const size_t MaxOccluders = 128;
+
+            class CompareByChunk {
+            private:
+                const BrushChunkMap& m_brushChunks;
+            public:
+                CompareByChunk(const BrushChunkMap& brushChunks) :
+                m_brushChunks(brushChunks) {}
+
+                inline bool operator()(const Model::Brush* lhs, const Model::Brush* rhs) const {
+                    return m_brushChunks.find(lhs)->second < m_brushChunks.find(rhs)->second;
+                }
+            };
+
+            OcclusionBuffer m_buffer;
+            BrushChunkMap m_brushChunks;
+            std::vector<BBoxf> m_chunkBounds;
+            std::vector<bool> m_chunkVisible;
+            Model::BrushList m_candidates;
+            std::vector<ScoredBrush> m_scoredOccluders;
+            Vec3f::List m_polygon;
+            bool m_active;
+
+            bool occluderCandidate(const Model::Brush& brush) const;
+            void addOccluder(const Model::Brush& brush, const Vec3f& cameraPosition);
+        public:
+            OcclusionCuller();
+
+            // assigns the given brushes to chunks and sorts them so that the brushes of each chunk are consecutive
+            void setBrushes(Model::BrushList& brushes);
+            // stops using the brushes that are not in the given set as occluders
+            void retainBrushes(const Model::BrushSet& brushes);
+            void clear();
+
+            size_t chunk(const Model::Brush& brush) const;
+
+            // rebuilds the occlusion buffer for the given camera, culling is disabled for orthographic cameras
+            void update(const Camera& camera, const Model::Filter& filter);
+            void disable();
+
+            inline bool active() const {
+                return m_active;
+            }
+
+            inline size_t chunkCount() const {
+                return m_chunkBounds.size();
+            }
+
+            inline bool chunkVisible(size_t chunk) const {
+                return !m_active || chunk == NoChunk || m_chunkVisible[chunk];
+            }
+
+            inline bool visible(const BBoxf& bounds) const {
+                return !m_active || m_buffer.visible(bounds);
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__OcclusionCuller__) */
@@ -30,6 +30,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace PointGuideUniforms {
+            static const Uniform Color("Color");
+        }
+
         void PointGuideRenderer::addSpike(const Vec3f& direction, Vec3f::List& hitPoints) {
             float maxLength = 512.0f;
             const Vec3f endPoint = m_position + maxLength * direction;
@@ -108,7 +112,7 @@ namespace TrenchBroom {
             
             if (m_pointArray != NULL) {
                 ActivateShader pointShader(context.shaderManager(), Shaders::EdgeShader);
-                pointShader.setUniformVariable("Color", Color(m_color, 1.0f));
+                pointShader.setUniformVariable(PointGuideUniforms::Color, Color(m_color, 1.0f));
                 glEnable(GL_POINT_SMOOTH);
                 glPointSize(3.0f);
                 m_pointArray->render();
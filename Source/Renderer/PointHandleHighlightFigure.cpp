@@ -30,6 +30,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace PointHandleHighlightFigureUniforms {
+            static const Uniform Color("Color");
+        }
+
         PointHandleHighlightFigure::PointHandleHighlightFigure(const Vec3f& position, const Color& color, float radius, float scalingFactor) :
         m_color(color),
         m_radius(radius),
@@ -51,7 +55,7 @@ namespace TrenchBroom {
 
         void PointHandleHighlightFigure::render(Vbo& vbo, RenderContext& context) {
             ActivateShader shader(context.shaderManager(), Shaders::HandleShader);
-            shader.setUniformVariable("Color", m_color);
+            shader.setUniformVariable(PointHandleHighlightFigureUniforms::Color, m_color);
 
             Mat4f billboardMatrix = context.camera().billboardMatrix();
             CircleFigure circle(Axis::AZ, 0.0f, 2.0f * Math<float>::Pi, 2.0f * m_radius, 16, false);
@@ -35,6 +35,14 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace PointHandleUniforms {
+            static const Uniform Color("Color");
+            static const Uniform CameraPosition("CameraPosition");
+            static const Uniform ScalingFactor("ScalingFactor");
+            static const Uniform MaximumDistance("MaximumDistance");
+            static const Uniform Position("Position");
+        }
+        
         Vec3f::List PointHandleRenderer::sphere() const {
             return Renderer::sphere(m_radius, m_iterations);
         }
@@ -86,15 +94,15 @@ namespace TrenchBroom {
             }
             
             Renderer::ActivateShader shader(context.shaderManager(), Renderer::Shaders::PointHandleShader);
-            shader.setUniformVariable("Color", color());
-            shader.setUniformVariable("CameraPosition", context.camera().position());
-            shader.setUniformVariable("ScalingFactor", scalingFactor());
-            shader.setUniformVariable("MaximumDistance", maximumDistance());
+            shader.setUniformVariable(PointHandleUniforms::Color, color());
+            shader.setUniformVariable(PointHandleUniforms::CameraPosition, context.camera().position());
+            shader.setUniformVariable(PointHandleUniforms::ScalingFactor, scalingFactor());
+            shader.setUniformVariable(PointHandleUniforms::MaximumDistance, maximumDistance());
             
             Vec4f::List::const_iterator pIt, pEnd;
             for (pIt = positionList.begin(), pEnd = positionList.end(); pIt != pEnd; ++pIt) {
                 const Vec4f& position = *pIt;
-                shader.setUniformVariable("Position", position);
+                shader.setUniformVariable(PointHandleUniforms::Position, position);
                 m_vertexArray->render();
             }
         }
@@ -137,10 +145,10 @@ namespace TrenchBroom {
             
             if (m_vertexArray != NULL) {
                 Renderer::ActivateShader shader(context.shaderManager(), Renderer::Shaders::InstancedPointHandleShader);
-                shader.setUniformVariable("Color", color());
-                shader.setUniformVariable("CameraPosition", context.camera().position());
-                shader.setUniformVariable("ScalingFactor", scalingFactor());
-                shader.setUniformVariable("MaximumDistance", maximumDistance());
+                shader.setUniformVariable(PointHandleUniforms::Color, color());
+                shader.setUniformVariable(PointHandleUniforms::CameraPosition, context.camera().position());
+                shader.setUniformVariable(PointHandleUniforms::ScalingFactor, scalingFactor());
+                shader.setUniformVariable(PointHandleUniforms::MaximumDistance, maximumDistance());
                 m_vertexArray->render(shader.currentShader());
             }
         }
@@ -27,6 +27,10 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace PointTraceUniforms {
+            static const Uniform Color("Color");
+        }
+
         PointTraceRenderer::PointTraceRenderer(const Vec3f::List& points) :
         m_points(points),
         m_vertexArray(NULL) {}
@@ -48,10 +52,10 @@ namespace TrenchBroom {
             ActivateShader shader(context.shaderManager(), Shaders::HandleShader);
             
             glDisable(GL_DEPTH_TEST);
-            shader.setUniformVariable("Color", Color(m_color, 0.3f));
+            shader.setUniformVariable(PointTraceUniforms::Color, Color(m_color, 0.3f));
             m_vertexArray->render();
             glEnable(GL_DEPTH_TEST);
-            shader.setUniformVariable("Color", m_color);
+            shader.setUniformVariable(PointTraceUniforms::Color, m_color);
             m_vertexArray->render();
         }
     }
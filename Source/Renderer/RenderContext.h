@@ -20,7 +20,9 @@
 #ifndef __TrenchBroom__RenderContext__
 #define __TrenchBroom__RenderContext__
 
+#include "Renderer/RenderState.h"
 #include "Renderer/Transformation.h"
+#include "Renderer/Shader/ShaderManager.h"
 
 namespace TrenchBroom {
     namespace Controller {
@@ -42,7 +44,6 @@ namespace TrenchBroom {
 
     namespace Renderer {
         class Camera;
-        class ShaderManager;
 
         class RenderContext {
         private:
@@ -54,6 +55,7 @@ namespace TrenchBroom {
             View::ViewOptions& m_viewOptions;
             Controller::InputState& m_inputState;
             Utility::Console& m_console;
+            RenderState m_renderState;
         public:
             RenderContext(Camera& camera, Model::Filter& filter, ShaderManager& shaderManager, Utility::Grid& grid, View::ViewOptions& viewOptions, Controller::InputState& inputState, Utility::Console& console) :
             m_camera(camera),
@@ -63,7 +65,8 @@ namespace TrenchBroom {
             m_grid(grid),
             m_viewOptions(viewOptions),
             m_inputState(inputState),
-            m_console(console) {}
+            m_console(console),
+            m_renderState(shaderManager.statistics()) {}
 
             inline Camera& camera() const {
                 return m_camera;
@@ -96,6 +99,10 @@ namespace TrenchBroom {
             inline Utility::Console& console() const {
                 return m_console;
             }
+            
+            inline RenderState& renderState() {
+                return m_renderState;
+            }
         };
     }
 }
@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RenderState_h
+#define TrenchBroom_RenderState_h
+
+#include <GL/glew.h>
+#include "Renderer/RenderStatistics.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // Skips redundant changes to frequently toggled GL state. The state is unknown when an instance is
+        // created, and it is only valid while no one else changes the tracked state, i.e. for one frame.
+        class RenderState {
+        private:
+            RenderStatistics& m_statistics;
+            
+            bool m_blendKnown;
+            bool m_blend;
+            bool m_blendFuncKnown;
+            GLenum m_blendSrcFactor;
+            GLenum m_blendDestFactor;
+            bool m_depthMaskKnown;
+            bool m_depthMask;
+            bool m_textureKnown;
+            GLuint m_texture;
+            
+            inline bool changed(bool& known, bool isCurrent) {
+                if (known && isCurrent) {
+                    m_statistics.skippedGlCall();
+                    return false;
+                }
+                known = true;
+                m_statistics.glCall();
+                return true;
+            }
+        public:
+            RenderState(RenderStatistics& statistics) :
+            m_statistics(statistics),
+            m_blendKnown(false),
+            m_blend(false),
+            m_blendFuncKnown(false),
+            m_blendSrcFactor(GL_ONE),
+            m_blendDestFactor(GL_ZERO),
+            m_depthMaskKnown(false),
+            m_depthMask(true),
+            m_textureKnown(false),
+            m_texture(0) {}
+            
+            inline void setBlend(bool blend) {
+                if (changed(m_blendKnown, m_blend == blend)) {
+                    m_blend = blend;
+                    if (m_blend)
+                        glEnable(GL_BLEND);
+                    else
+                        glDisable(GL_BLEND);
+                }
+            }
+            
+            inline void setBlendFunc(GLenum srcFactor, GLenum destFactor) {
+                if (changed(m_blendFuncKnown, m_blendSrcFactor == srcFactor && m_blendDestFactor == destFactor)) {
+                    m_blendSrcFactor = srcFactor;
+                    m_blendDestFactor = destFactor;
+                    glBlendFunc(m_blendSrcFactor, m_blendDestFactor);
+                }
+            }
+            
+            inline void setDepthMask(bool depthMask) {
+                if (changed(m_depthMaskKnown, m_depthMask == depthMask)) {
+                    m_depthMask = depthMask;
+                    glDepthMask(m_depthMask ? GL_TRUE : GL_FALSE);
+                }
+            }
+            
+            // only tracks GL_TEXTURE_2D on the active texture unit, which is always unit 0 in the map view
+            inline void bindTexture(GLuint textureId) {
+                if (changed(m_textureKnown, m_texture == textureId)) {
+                    m_texture = textureId;
+                    glBindTexture(GL_TEXTURE_2D, m_texture);
+                }
+            }
+            
+            // must be called if a texture was bound without going through this object
+            inline void textureBound(GLuint textureId) {
+                m_textureKnown = true;
+                m_texture = textureId;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RenderStatistics_h
+#define TrenchBroom_RenderStatistics_h
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class RenderStatistics {
+        private:
+            size_t m_glCalls;
+            size_t m_skippedGlCalls;
+            size_t m_lastFrameGlCalls;
+            size_t m_lastFrameSkippedGlCalls;
+        public:
+            RenderStatistics() :
+            m_glCalls(0),
+            m_skippedGlCalls(0),
+            m_lastFrameGlCalls(0),
+            m_lastFrameSkippedGlCalls(0) {}
+            
+            inline void glCall() {
+                m_glCalls++;
+            }
+            
+            inline void skippedGlCall() {
+                m_skippedGlCalls++;
+            }
+            
+            inline void endFrame() {
+                m_lastFrameGlCalls = m_glCalls;
+                m_lastFrameSkippedGlCalls = m_skippedGlCalls;
+                m_glCalls = 0;
+                m_skippedGlCalls = 0;
+            }
+            
+            inline size_t lastFrameGlCalls() const {
+                return m_lastFrameGlCalls;
+            }
+            
+            inline size_t lastFrameSkippedGlCalls() const {
+                return m_lastFrameSkippedGlCalls;
+            }
+        };
+    }
+}
+
+#endif
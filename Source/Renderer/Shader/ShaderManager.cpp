@@ -28,6 +28,7 @@ namespace TrenchBroom {
         namespace Shaders {
             const ShaderConfig ColoredEdgeShader = ShaderConfig("Colored Edge Shader Program", "ColoredEdge.vertsh", "Edge.fragsh");
             const ShaderConfig EdgeShader = ShaderConfig("Edge Shader Program", "Edge.vertsh", "Edge.fragsh");
+            const ShaderConfig BrushEdgeShader = ShaderConfig("Brush Edge Shader Program", "BrushEdge.vertsh", "BrushEdge.fragsh");
             const ShaderConfig EntityModelShader = ShaderConfig("Entity Model Shader Program", "EntityModel.vertsh", "EntityModel.fragsh");
             const ShaderConfig FaceShader = ShaderConfig("Face Shader Program", "Face.vertsh", "Face.fragsh");
             const ShaderConfig TextShader = ShaderConfig("Text Shader Program", "Text.vertsh", "Text.fragsh");
@@ -76,7 +77,7 @@ namespace TrenchBroom {
             if (it != m_programs.end())
                 return *it->second;
             
-            ShaderProgram* program = new ShaderProgram(config.name(), m_console);
+            ShaderProgram* program = new ShaderProgram(config.name(), m_console, m_statistics);
             
             const StringList& vertexShaders = config.vertexShaders();
             const StringList& fragmentShaders = config.fragmentShaders();
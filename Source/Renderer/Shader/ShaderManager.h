@@ -21,6 +21,7 @@
 #define __TrenchBroom__ShaderManager__
 
 #include "GL/glew.h"
+#include "Renderer/RenderStatistics.h"
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Utility/String.h"
 
@@ -60,6 +61,7 @@ namespace TrenchBroom {
         namespace Shaders {
             extern const ShaderConfig ColoredEdgeShader;
             extern const ShaderConfig EdgeShader;
+            extern const ShaderConfig BrushEdgeShader;
             extern const ShaderConfig EntityModelShader;
             extern const ShaderConfig FaceShader;
             extern const ShaderConfig TextShader;
@@ -88,6 +90,7 @@ namespace TrenchBroom {
             Utility::Console& m_console;
             ShaderCache m_shaders;
             ShaderProgramCache m_programs;
+            RenderStatistics m_statistics;
             
             Shader& loadShader(const String& path, GLenum type);
         public:
@@ -95,6 +98,10 @@ namespace TrenchBroom {
             ~ShaderManager();
             
             ShaderProgram& shaderProgram(const ShaderConfig& config);
+            
+            inline RenderStatistics& statistics() {
+                return m_statistics;
+            }
         };
         
         class ActivateShader {
@@ -112,6 +119,11 @@ namespace TrenchBroom {
             bool setUniformVariable(const String& name, const T& value) {
                 return m_shaderProgram.setUniformVariable(name, value);
             }
+            
+            template <class T>
+            bool setUniformVariable(const Uniform& uniform, const T& value) {
+                return m_shaderProgram.setUniformVariable(uniform, value);
+            }
         };
     }
 }
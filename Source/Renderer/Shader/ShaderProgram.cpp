@@ -21,38 +21,120 @@
 
 #include "IO/FileManager.h"
 #include "Model/Texture.h"
+#include "Renderer/RenderStatistics.h"
 #include "Renderer/Shader/Shader.h"
 #include "Utility/Console.h"
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
 
 namespace TrenchBroom {
     namespace Renderer {
-        GLint ShaderProgram::uniformLocation(const String& name) {
-            UniformVariableMap::iterator it = m_uniformVariables.find(name);
-            if (it == m_uniformVariables.end()) {
-                GLint index = glGetUniformLocation(m_programId, name.c_str());
-                if (index == -1)
-                    m_console.warn("Location of uniform variable '%s' could not be found in %s", name.c_str(), m_name.c_str());
-                m_uniformVariables[name] = index;
-                return index;
+        namespace {
+            typedef std::map<String, size_t> UniformIndexMap;
+            
+            UniformIndexMap& uniformIndices() {
+                static UniformIndexMap indices;
+                return indices;
             }
-
-            return it->second;
+            
+            StringList& uniformNames() {
+                static StringList names;
+                return names;
+            }
+        }
+        
+        size_t Uniform::index(const String& name) {
+            UniformIndexMap& indices = uniformIndices();
+            UniformIndexMap::iterator it = indices.find(name);
+            if (it != indices.end())
+                return it->second;
+            
+            StringList& names = uniformNames();
+            const size_t index = names.size();
+            names.push_back(name);
+            indices[name] = index;
+            return index;
+        }
+        
+        const String& Uniform::name(const size_t index) {
+            const StringList& names = uniformNames();
+            assert(index < names.size());
+            return names[index];
         }
 
+        void ShaderProgram::resolveUniformVariables() {
+            m_uniformVariables.clear();
+            
+            GLint uniformCount = 0;
+            GLint maxNameLength = 0;
+            glGetProgramiv(m_programId, GL_ACTIVE_UNIFORMS, &uniformCount);
+            glGetProgramiv(m_programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+            if (uniformCount <= 0 || maxNameLength <= 0)
+                return;
+            
+            char* nameBuffer = new char[maxNameLength];
+            for (GLint i = 0; i < uniformCount; i++) {
+                GLsizei nameLength = 0;
+                GLint size = 0;
+                GLenum type = 0;
+                glGetActiveUniform(m_programId, static_cast<GLuint>(i), maxNameLength, &nameLength, &size, &type, nameBuffer);
+                
+                const String name(nameBuffer, static_cast<size_t>(nameLength));
+                const size_t index = Uniform::index(name);
+                if (index >= m_uniformVariables.size())
+                    m_uniformVariables.resize(index + 1);
+                
+                UniformVariable& variable = m_uniformVariables[index];
+                variable.location = glGetUniformLocation(m_programId, nameBuffer);
+                variable.resolved = true;
+            }
+            delete [] nameBuffer;
+        }
+        
+        ShaderProgram::UniformVariable* ShaderProgram::uniformVariable(const Uniform& uniform) {
+            const size_t index = uniform.index();
+            if (index >= m_uniformVariables.size())
+                m_uniformVariables.resize(index + 1);
+            
+            UniformVariable& variable = m_uniformVariables[index];
+            if (!variable.resolved) {
+                // not an active uniform of this program, warn only once
+                m_console.warn("Location of uniform variable '%s' could not be found in %s", Uniform::name(index).c_str(), m_name.c_str());
+                variable.resolved = true;
+            }
+            
+            if (variable.location == -1)
+                return NULL;
+            return &variable;
+        }
+        
+        bool ShaderProgram::updateValue(UniformVariable& variable, const void* value, const size_t size) {
+            assert(size <= sizeof(variable.value));
+            if (variable.size == size && std::memcmp(variable.value, value, size) == 0) {
+                m_statistics.skippedGlCall();
+                return false;
+            }
+            
+            std::memcpy(variable.value, value, size);
+            variable.size = size;
+            m_statistics.glCall();
+            return true;
+        }
+        
         bool ShaderProgram::checkActive() {
             GLint currentProgramId = -1;
             glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgramId);
             return static_cast<GLuint>(currentProgramId) == m_programId;
         }
 
-        ShaderProgram::ShaderProgram(const String& name, Utility::Console& console) :
+        ShaderProgram::ShaderProgram(const String& name, Utility::Console& console, RenderStatistics& statistics) :
         m_name(name),
         m_programId(0),
         m_needsLinking(true),
-        m_console(console) {
+        m_console(console),
+        m_statistics(statistics) {
             m_programId = glCreateProgram();
 
             if (m_programId != 0) {
@@ -86,8 +168,6 @@ namespace TrenchBroom {
                 return false;
 
             if (m_needsLinking) {
-                m_uniformVariables.clear();
-
                 glLinkProgram(m_programId);
 
                 GLint linkStatus = 0;
@@ -109,6 +189,9 @@ namespace TrenchBroom {
 					delete [] infoLog;
 				}
 
+                // linking resets all uniform values, so this also discards the shadow copies
+                resolveUniformVariables();
+                
                 // always set to false to prevent console spam
                 m_needsLinking = false;
             }
@@ -121,79 +204,87 @@ namespace TrenchBroom {
             glUseProgram(0);
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const bool value) {
-            return setUniformVariable(name, static_cast<int>(value));
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const bool value) {
+            return setUniformVariable(uniform, static_cast<int>(value));
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const int value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const int value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniform1i(location, value);
+            if (updateValue(*variable, &value, sizeof(int)))
+                glUniform1i(variable->location, value);
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const float value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const float value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniform1f(location, value);
+            if (updateValue(*variable, &value, sizeof(float)))
+                glUniform1f(variable->location, value);
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec2f& value) {
-            GLint location = uniformLocation(name);
-            if (location == -1)
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Vec2f& value) {
+            assert(checkActive());
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniform2f(location, value.x(), value.y());
+            if (updateValue(*variable, value.v, 2 * sizeof(float)))
+                glUniform2f(variable->location, value.x(), value.y());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec3f& value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Vec3f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniform3f(location, value.x(), value.y(), value.z());
+            if (updateValue(*variable, value.v, 3 * sizeof(float)))
+                glUniform3f(variable->location, value.x(), value.y(), value.z());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec4f& value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Vec4f& value) {
             assert(checkActive());
-            checkActive();
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniform4f(location, value.x(), value.y(), value.z(), value.w());
+            if (updateValue(*variable, value.v, 4 * sizeof(float)))
+                glUniform4f(variable->location, value.x(), value.y(), value.z(), value.w());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat2f& value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Mat2f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniformMatrix2fv(location, 1, false, reinterpret_cast<const float*>(value.v));
+            if (updateValue(*variable, value.v, 4 * sizeof(float)))
+                glUniformMatrix2fv(variable->location, 1, false, reinterpret_cast<const float*>(value.v));
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat3f& value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Mat3f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniformMatrix3fv(location, 1, false, reinterpret_cast<const float*>(value.v));
+            if (updateValue(*variable, value.v, 9 * sizeof(float)))
+                glUniformMatrix3fv(variable->location, 1, false, reinterpret_cast<const float*>(value.v));
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat4f& value) {
+        bool ShaderProgram::setUniformVariable(const Uniform& uniform, const Mat4f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
-            if (location == -1)
+            UniformVariable* variable = uniformVariable(uniform);
+            if (variable == NULL)
                 return false;
-            glUniformMatrix4fv(location, 1, false, reinterpret_cast<const float*>(value.v));
+            if (updateValue(*variable, value.v, 16 * sizeof(float)))
+                glUniformMatrix4fv(variable->location, 1, false, reinterpret_cast<const float*>(value.v));
             return true;
         }
     }
@@ -25,6 +25,7 @@
 #include "Utility/VecMath.h"
 
 #include <map>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -38,22 +39,58 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class RenderStatistics;
         class Shader;
         
+        // A handle to a uniform variable. The name is resolved to an index into a global table once, and every
+        // program maps that index to its uniform location when it is linked. Declare handles as static
+        // constants in the renderers that set uniforms every frame.
+        class Uniform {
+        private:
+            size_t m_index;
+        public:
+            static size_t index(const String& name);
+            static const String& name(size_t index);
+            
+            explicit Uniform(const String& name) :
+            m_index(index(name)) {}
+            
+            inline size_t index() const {
+                return m_index;
+            }
+        };
+        
         class ShaderProgram {
         private:
-            typedef std::map<String, GLint> UniformVariableMap;
+            // the last value set for a uniform variable, used to skip redundant glUniform* calls
+            class UniformVariable {
+            public:
+                GLint location;
+                bool resolved;
+                size_t size;
+                unsigned char value[16 * sizeof(float)];
+                
+                UniformVariable() :
+                location(-1),
+                resolved(false),
+                size(0) {}
+            };
+            
+            typedef std::vector<UniformVariable> UniformVariableList;
             
             String m_name;
             GLuint m_programId;
-            UniformVariableMap m_uniformVariables;
+            UniformVariableList m_uniformVariables;
             bool m_needsLinking;
             Utility::Console& m_console;
+            RenderStatistics& m_statistics;
             
-            GLint uniformLocation(const String& name);
+            void resolveUniformVariables();
+            UniformVariable* uniformVariable(const Uniform& uniform);
+            bool updateValue(UniformVariable& variable, const void* value, size_t size);
             bool checkActive();
         public:
-            ShaderProgram(const String& name, Utility::Console& console);
+            ShaderProgram(const String& name, Utility::Console& console, RenderStatistics& statistics);
             ~ShaderProgram();
             
             
@@ -67,15 +104,20 @@ namespace TrenchBroom {
             bool activate();
             void deactivate();
             
-            bool setUniformVariable(const String& name, bool value);
-            bool setUniformVariable(const String& name, int value);
-            bool setUniformVariable(const String& name, float value);
-            bool setUniformVariable(const String& name, const Vec2f& value);
-            bool setUniformVariable(const String& name, const Vec3f& value);
-            bool setUniformVariable(const String& name, const Vec4f& value);
-            bool setUniformVariable(const String& name, const Mat2f& value);
-            bool setUniformVariable(const String& name, const Mat3f& value);
-            bool setUniformVariable(const String& name, const Mat4f& value);
+            bool setUniformVariable(const Uniform& uniform, bool value);
+            bool setUniformVariable(const Uniform& uniform, int value);
+            bool setUniformVariable(const Uniform& uniform, float value);
+            bool setUniformVariable(const Uniform& uniform, const Vec2f& value);
+            bool setUniformVariable(const Uniform& uniform, const Vec3f& value);
+            bool setUniformVariable(const Uniform& uniform, const Vec4f& value);
+            bool setUniformVariable(const Uniform& uniform, const Mat2f& value);
+            bool setUniformVariable(const Uniform& uniform, const Mat3f& value);
+            bool setUniformVariable(const Uniform& uniform, const Mat4f& value);
+            
+            template <typename T>
+            inline bool setUniformVariable(const String& name, const T& value) {
+                return setUniformVariable(Uniform(name), value);
+            }
         };
     }
 }
@@ -26,6 +26,7 @@
 #include "Renderer/RenderUtils.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/Shader.h"
+#include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/Text/TexturedFont.h"
 #include "Utility/SharedPointer.h"
 #include "Utility/String.h"
@@ -33,7 +34,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <map>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -109,6 +112,12 @@ namespace TrenchBroom {
                 m_alignment(alignment) {}
             };
 
+            namespace TextUniforms {
+                static const Uniform Color("Color");
+                static const Uniform Texture("Texture");
+                static const Uniform Offset("Offset");
+            }
+            
             template <typename Key>
             class DefaultKeyComparator {
             public:
@@ -140,11 +149,21 @@ namespace TrenchBroom {
                     Vec2f::List m_vertices;
                     Vec2f m_size;
                     TextAnchor::Ptr m_textAnchor;
+                    
+                    // location of this entry's glyph quads and background rect in the renderer's vbo
+                    size_t m_textIndex;
+                    size_t m_textCount;
+                    size_t m_rectIndex;
+                    size_t m_rectCount;
                 public:
                     TextEntry(const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr textAnchor) :
                     m_vertices(vertices),
                     m_size(size),
-                    m_textAnchor(textAnchor) {}
+                    m_textAnchor(textAnchor),
+                    m_textIndex(0),
+                    m_textCount(0),
+                    m_rectIndex(0),
+                    m_rectCount(0) {}
                     
                     inline const Vec2f::List& vertices() const {
                         return m_vertices;
@@ -162,11 +181,73 @@ namespace TrenchBroom {
                     inline const TextAnchor& textAnchor() const {
                         return *m_textAnchor.get();
                     }
+                    
+                    inline TextAnchor::Ptr textAnchorPtr() const {
+                        return m_textAnchor;
+                    }
+                    
+                    inline void setTextRange(size_t index, size_t count) {
+                        m_textIndex = index;
+                        m_textCount = count;
+                    }
+                    
+                    inline void setRectRange(size_t index, size_t count) {
+                        m_rectIndex = index;
+                        m_rectCount = count;
+                    }
+                    
+                    inline size_t textIndex() const {
+                        return m_textIndex;
+                    }
+                    
+                    inline size_t textCount() const {
+                        return m_textCount;
+                    }
+                    
+                    inline size_t rectIndex() const {
+                        return m_rectIndex;
+                    }
+                    
+                    inline size_t rectCount() const {
+                        return m_rectCount;
+                    }
                 };
 
                 typedef std::map<Key, TextEntry, Comparator> TextMap;
                 typedef std::pair<Key, TextEntry> TextMapItem;
-                typedef std::vector<TextEntry> EntryList;
+                typedef typename TextMap::value_type* TextMapEntry;
+                typedef std::vector<TextMapEntry> TextMapEntryList;
+                
+                struct VisibleEntry {
+                    const TextEntry* entry;
+                    Vec3f offset;
+                    
+                    VisibleEntry(const TextEntry* i_entry, const Vec3f& i_offset) :
+                    entry(i_entry),
+                    offset(i_offset) {}
+                };
+                typedef std::vector<VisibleEntry> VisibleEntryList;
+                
+                // Buckets the entries by the position of their anchors so that only the entries near the camera
+                // need to be considered when rendering. Anchors may move a bit between rebuilds (i.e. they may
+                // depend on the camera), so every query looks one cell further than strictly necessary.
+                struct GridCell {
+                    int x, y, z;
+                    
+                    GridCell(int i_x, int i_y, int i_z) :
+                    x(i_x),
+                    y(i_y),
+                    z(i_z) {}
+                    
+                    inline bool operator<(const GridCell& other) const {
+                        if (x != other.x)
+                            return x < other.x;
+                        if (y != other.y)
+                            return y < other.y;
+                        return z < other.z;
+                    }
+                };
+                typedef std::map<GridCell, TextMapEntryList> Grid;
 
                 TexturedFont& m_font;
                 float m_fadeDistance;
@@ -175,27 +256,166 @@ namespace TrenchBroom {
 
                 TextMap m_entries;
                 Vbo* m_vbo;
+                VertexArray* m_textArray;
+                VertexArray* m_rectArray;
+                bool m_vboValid;
+                
+                Grid m_grid;
+                float m_cellSize;
+                bool m_gridValid;
+                
+                inline float cutoffDistance() const {
+                    return m_fadeDistance + 100.0f;
+                }
+                
+                inline int cellCoord(float value) const {
+                    return static_cast<int>(std::floor(value / m_cellSize));
+                }
+                
+                inline void invalidate() {
+                    m_vboValid = false;
+                    m_gridValid = false;
+                }
 
                 inline void addString(Key key, const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr anchor) {
                     removeString(key);
                     m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor)));
+                    invalidate();
                 }
-
-                EntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter) {
-                    float cutoff = (m_fadeDistance + 100) * (m_fadeDistance + 100);
-                    EntryList result;
-
+                
+                void validateGrid() {
+                    m_grid.clear();
+                    m_cellSize = std::max(cutoffDistance(), 64.0f);
+                    
+                    typename TextMap::iterator it, end;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+                        const Vec3f position = it->second.textAnchor().position();
+                        const GridCell cell(cellCoord(position.x()), cellCoord(position.y()), cellCoord(position.z()));
+                        m_grid[cell].push_back(&*it);
+                    }
+                    
+                    m_gridValid = true;
+                }
+                
+                void validateVbo() {
+                    delete m_textArray;
+                    m_textArray = NULL;
+                    delete m_rectArray;
+                    m_rectArray = NULL;
+                    
+                    if (m_vbo == NULL)
+                        m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+                    
+                    typedef std::vector<Vec2f::List> RectList;
+                    RectList rects;
+                    rects.reserve(m_entries.size());
+                    
+                    size_t textVertexCount = 0;
+                    size_t rectVertexCount = 0;
                     typename TextMap::iterator it, end;
                     for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
-                        Key key = it->first;
-                        if (filter.stringVisible(context, key)) {
-                            const TextEntry& entry = it->second;
-                            const TextAnchor& anchor = entry.textAnchor();
-                            const Vec3f position = anchor.position();
-
-                            float dist2 = context.camera().squaredDistanceTo(position);
-                            if (dist2 <= cutoff)
-                                result.push_back(entry);
+                        const TextEntry& entry = it->second;
+                        const Vec2f size = entry.size().rounded();
+                        textVertexCount += entry.vertices().size() / 2;
+
+                        // the background rect is stored relative to the lower left corner of the text
+                        rects.push_back(Vec2f::List());
+                        Vec2f::List& rectVertices = rects.back();
+                        rectVertices.reserve(3 * 16); // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
+                        roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
+                        for (size_t i = 0; i < rectVertices.size(); i++)
+                            rectVertices[i] += size / 2.0f;
+                        rectVertexCount += rectVertices.size();
+                    }
+                    
+                    if (textVertexCount > 0)
+                        m_textArray = new VertexArray(*m_vbo, GL_QUADS, textVertexCount,
+                                                      Attribute::position2f(),
+                                                      Attribute::texCoord02f(), 0);
+                    if (rectVertexCount > 0)
+                        m_rectArray = new VertexArray(*m_vbo, GL_TRIANGLES, rectVertexCount,
+                                                      Attribute::position2f(), 0);
+                    
+                    SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+                    size_t textIndex = 0;
+                    size_t rectIndex = 0;
+                    size_t rectNum = 0;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+                        TextEntry& entry = it->second;
+                        
+                        const Vec2f::List& textVertices = entry.vertices();
+                        const size_t textCount = textVertices.size() / 2;
+                        if (textCount > 0)
+                            m_textArray->addAttributes(textVertices);
+                        entry.setTextRange(textIndex, textCount);
+                        textIndex += textCount;
+                        
+                        const Vec2f::List& rectVertices = rects[rectNum++];
+                        if (!rectVertices.empty())
+                            m_rectArray->addAttributes(rectVertices);
+                        entry.setRectRange(rectIndex, rectVertices.size());
+                        rectIndex += rectVertices.size();
+                    }
+                    
+                    m_vboValid = true;
+                }
+
+                VisibleEntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter) {
+                    if (!m_gridValid)
+                        validateGrid();
+                    
+                    const Camera& camera = context.camera();
+                    const Camera::Viewport& viewport = camera.viewport();
+                    const Vec3f& cameraPosition = camera.position();
+                    const float cutoff = cutoffDistance();
+                    const float cutoff2 = cutoff * cutoff;
+                    const float cellRadius = 0.87f * m_cellSize; // half the diagonal of a cell
+                    
+                    const int minX = cellCoord(cameraPosition.x() - cutoff) - 1;
+                    const int minY = cellCoord(cameraPosition.y() - cutoff) - 1;
+                    const int minZ = cellCoord(cameraPosition.z() - cutoff) - 1;
+                    const int maxX = cellCoord(cameraPosition.x() + cutoff) + 1;
+                    const int maxY = cellCoord(cameraPosition.y() + cutoff) + 1;
+                    const int maxZ = cellCoord(cameraPosition.z() + cutoff) + 1;
+                    
+                    VisibleEntryList result;
+                    
+                    for (int x = minX; x <= maxX; x++) {
+                        for (int y = minY; y <= maxY; y++) {
+                            typename Grid::const_iterator cellIt = m_grid.lower_bound(GridCell(x, y, minZ));
+                            typename Grid::const_iterator cellEnd = m_grid.end();
+                            for (; cellIt != cellEnd && cellIt->first.x == x && cellIt->first.y == y && cellIt->first.z <= maxZ; ++cellIt) {
+                                const GridCell& cell = cellIt->first;
+
+                                // skip cells that lie entirely behind the camera
+                                const Vec3f cellCenter((cell.x + 0.5f) * m_cellSize, (cell.y + 0.5f) * m_cellSize, (cell.z + 0.5f) * m_cellSize);
+                                if (!camera.ortho() && (cellCenter - cameraPosition).dot(camera.direction()) < -cellRadius)
+                                    continue;
+
+                                const TextMapEntryList& cellEntries = cellIt->second;
+                                for (size_t i = 0; i < cellEntries.size(); i++) {
+                                    const Key& key = cellEntries[i]->first;
+                                    const TextEntry& entry = cellEntries[i]->second;
+                                    const TextAnchor& anchor = entry.textAnchor();
+                                    const Vec3f position = anchor.position();
+
+                                    if (camera.squaredDistanceTo(position) > cutoff2)
+                                        continue;
+                                    if (!camera.ortho() && (position - cameraPosition).dot(camera.direction()) < camera.nearPlane())
+                                        continue;
+
+                                    const Vec2f size = entry.size().rounded();
+                                    const Vec3f offset = anchor.offset(camera, size);
+                                    if (offset.x() + size.x() + m_hInset < viewport.x ||
+                                        offset.y() + size.y() + m_vInset < viewport.y ||
+                                        offset.x() - m_hInset > viewport.x + viewport.width ||
+                                        offset.y() - m_vInset > viewport.y + viewport.height)
+                                        continue;
+
+                                    if (filter.stringVisible(context, key))
+                                        result.push_back(VisibleEntry(&entry, offset));
+                                }
+                            }
                         }
                     }
 
@@ -207,10 +427,19 @@ namespace TrenchBroom {
                 m_fadeDistance(100.0f),
                 m_hInset(4.0f),
                 m_vInset(4.0f),
-                m_vbo(NULL) {}
+                m_vbo(NULL),
+                m_textArray(NULL),
+                m_rectArray(NULL),
+                m_vboValid(false),
+                m_cellSize(0.0f),
+                m_gridValid(false) {}
 
                 ~TextRenderer() {
                     clear();
+                    delete m_textArray;
+                    m_textArray = NULL;
+                    delete m_rectArray;
+                    m_rectArray = NULL;
                     delete m_vbo;
                     m_vbo = NULL;
                 }
@@ -225,6 +454,7 @@ namespace TrenchBroom {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
                         m_entries.erase(it);
+                        invalidate();
                     }
                 }
 
@@ -232,7 +462,8 @@ namespace TrenchBroom {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
                         TextEntry& entry = it->second;
-                        entry.setVertices(m_font.quads(string, true));
+                        entry.update(m_font.quads(string, true), m_font.measure(string));
+                        m_vboValid = false;
                     }
                 }
 
@@ -240,10 +471,16 @@ namespace TrenchBroom {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
                         TextEntry& entry = it->second;
-                        destination.addString(key, entry.vertices(), entry.textAnchor());
+                        destination.addString(key, entry.vertices(), entry.size(), entry.textAnchorPtr());
                         m_entries.erase(it);
+                        invalidate();
                     }
                 }
+                
+                // must be called when the anchors of the strings have moved, e.g. because the anchored objects were moved
+                inline void invalidatePositions() {
+                    m_gridValid = false;
+                }
 
                 inline bool empty() const {
                     return m_entries.empty();
@@ -251,61 +488,26 @@ namespace TrenchBroom {
 
                 inline void clear()  {
                     m_entries.clear();
+                    invalidate();
                 }
 
                 inline void setFadeDistance(float fadeDistance)  {
+                    if (fadeDistance == m_fadeDistance)
+                        return;
                     m_fadeDistance = fadeDistance;
+                    m_gridValid = false;
                 }
 
                 void render(RenderContext& context, const TextRendererFilter& filter, ShaderProgram& textProgram, const Color& textColor, ShaderProgram& backgroundProgram, const Color& backgroundColor) {
                     if (m_entries.empty())
                         return;
 
-                    EntryList entries = visibleEntries(context, filter);
+                    const VisibleEntryList entries = visibleEntries(context, filter);
                     if (entries.empty())
                         return;
 
-                    if (m_vbo == NULL)
-                        m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
-
-                    size_t textVertexCount = 0;
-                    for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        textVertexCount += entry.vertices().size() / 2;
-                    }
-
-                    VertexArray textArray(*m_vbo, GL_QUADS, static_cast<unsigned int>(textVertexCount),
-                                          Attribute::position3f(),
-                                          Attribute::texCoord02f());
-
-                    size_t rectVertexCount = 3 * 16 * entries.size(); // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
-                    VertexArray rectArray(*m_vbo, GL_TRIANGLES, static_cast<unsigned int>(rectVertexCount),
-                                          Attribute::position3f());
-
-                    SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
-                    for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        const Vec2f& size = entry.size().rounded();
-                        const TextAnchor& anchor = entry.textAnchor();
-                        const Vec3f offset = anchor.offset(context.camera(), size);
-
-                        const Vec2f::List& textVertices = entry.vertices();
-                        for (size_t j = 0; j < textVertices.size() / 2; j++) {
-                            const Vec2f& vertex = textVertices[2 * j];
-                            const Vec2f& texCoords = textVertices[2 * j + 1];
-
-                            textArray.addAttribute(Vec3f(vertex.x() + offset.x(), vertex.y() + offset.y(), -offset.z()));
-                            textArray.addAttribute(texCoords);
-                        }
-
-                        Vec2f::List rectVertices;
-                        rectVertices.reserve(3 * 16);
-                        roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
-                        for (size_t j = 0; j < rectVertices.size(); j++) {
-                            const Vec2f& vertex = rectVertices[j];
-                            rectArray.addAttribute(Vec3f(vertex.x() + offset.x() + size.x() / 2.0f, vertex.y() + offset.y() + size.y() / 2.0f, -offset.z()));
-                        }
-                    }
+                    if (!m_vboValid)
+                        validateVbo();
 
                     const Camera::Viewport& viewport = context.camera().viewport();
 
@@ -319,24 +521,40 @@ namespace TrenchBroom {
                     ApplyTransformation ortho(context.transformation(), projection, view);
 
                     SetVboState activateVbo(*m_vbo, Vbo::VboActive);
-                    glDepthMask(GL_FALSE);
-
-                    if (backgroundProgram.activate()) {
-                        backgroundProgram.setUniformVariable("Color", backgroundColor);
-                        rectArray.render();
+                    context.renderState().setDepthMask(false);
+
+                    if (m_rectArray != NULL && backgroundProgram.activate()) {
+                        backgroundProgram.setUniformVariable(TextUniforms::Color, backgroundColor);
+                        m_rectArray->setup();
+                        for (size_t i = 0; i < entries.size(); i++) {
+                            const VisibleEntry& visibleEntry = entries[i];
+                            const Vec3f& offset = visibleEntry.offset;
+                            backgroundProgram.setUniformVariable(TextUniforms::Offset, Vec3f(offset.x(), offset.y(), -offset.z()));
+                            m_rectArray->renderPrimitives(visibleEntry.entry->rectIndex(), visibleEntry.entry->rectCount());
+                        }
+                        m_rectArray->cleanup();
                         backgroundProgram.deactivate();
                     }
 
-                    if (textProgram.activate()) {
-                        textProgram.setUniformVariable("Color", textColor);
-                        textProgram.setUniformVariable("Texture", 0);
+                    if (m_textArray != NULL && textProgram.activate()) {
+                        textProgram.setUniformVariable(TextUniforms::Color, textColor);
+                        textProgram.setUniformVariable(TextUniforms::Texture, 0);
                         m_font.activate();
-                        textArray.render();
+                        m_textArray->setup();
+                        for (size_t i = 0; i < entries.size(); i++) {
+                            const VisibleEntry& visibleEntry = entries[i];
+                            if (visibleEntry.entry->textCount() == 0)
+                                continue;
+                            const Vec3f& offset = visibleEntry.offset;
+                            textProgram.setUniformVariable(TextUniforms::Offset, Vec3f(offset.x(), offset.y(), -offset.z()));
+                            m_textArray->renderPrimitives(visibleEntry.entry->textIndex(), visibleEntry.entry->textCount());
+                        }
+                        m_textArray->cleanup();
                         m_font.deactivate();
                         textProgram.deactivate();
                     }
 
-                    glDepthMask(GL_TRUE);
+                    context.renderState().setDepthMask(true);
                 }
             };
         }
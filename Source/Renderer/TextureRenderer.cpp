@@ -23,9 +23,15 @@
 #include "Model/Bsp.h"
 #include "Model/Alias.h"
 #include "Renderer/Palette.h"
+#include "Renderer/RenderState.h"
+#include "Utility/MemoryRegistry.h"
 
 namespace TrenchBroom {
     namespace Renderer {
+        // decoded images waiting to be uploaded, and the estimated size of the uploaded textures
+        static Utility::MemoryTag TextureBufferMemory("Texture buffers", Utility::MemoryTag::Shared);
+        static Utility::MemoryTag TextureMemory("Textures", Utility::MemoryTag::Shared);
+
         void TextureRenderer::init(unsigned int width, unsigned int height) {
             m_width = width;
             m_height = height;
@@ -36,6 +42,8 @@ namespace TrenchBroom {
         void TextureRenderer::init(unsigned char* rgbImage, unsigned int width, unsigned int height) {
             init(width, height);
             m_textureBuffer = rgbImage;
+            if (m_textureBuffer != NULL)
+                TextureBufferMemory.allocate(bufferSize());
         }
         
         TextureRenderer::TextureRenderer(unsigned char* rgbImage, const Color& averageColor, unsigned int width, unsigned int height) :
@@ -45,31 +53,38 @@ namespace TrenchBroom {
         
         TextureRenderer::TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette) {
             init(skin.width(), skin.height());
-            m_textureBuffer = new unsigned char[m_width * m_height * 3];
+            m_textureBuffer = new unsigned char[bufferSize()];
             palette.indexedToRgb(skin.pictures()[skinIndex], m_textureBuffer, m_width * m_height, m_averageColor);
+            TextureBufferMemory.allocate(bufferSize());
         }
         
         TextureRenderer::TextureRenderer(const Model::BspTexture& texture, const Palette& palette) {
             init(texture.width(), texture.height());
-            m_textureBuffer = new unsigned char[m_width * m_height * 3];
+            m_textureBuffer = new unsigned char[bufferSize()];
             palette.indexedToRgb(texture.image(), m_textureBuffer, m_width * m_height, m_averageColor);
+            TextureBufferMemory.allocate(bufferSize());
         }
         
         TextureRenderer::TextureRenderer() {
             init(1, 1);
-            m_textureBuffer = new unsigned char[4];
-            for (int i = 0; i < 4; i++)
+            m_textureBuffer = new unsigned char[bufferSize()];
+            for (size_t i = 0; i < bufferSize(); i++)
                 m_textureBuffer[i] = 0;
+            TextureBufferMemory.allocate(bufferSize());
         }
         
         TextureRenderer::~TextureRenderer() {
-            if (m_textureId > 0)
+            if (m_textureId > 0) {
                 glDeleteTextures(1, &m_textureId);
-            if (m_textureBuffer != NULL)
+                TextureMemory.deallocate(4 * m_width * m_height);
+            }
+            if (m_textureBuffer != NULL) {
                 delete [] m_textureBuffer;
+                TextureBufferMemory.deallocate(bufferSize());
+            }
         }
 
-        void TextureRenderer::activate() {
+        void TextureRenderer::upload() {
             if (m_textureId == 0) {
                 if (m_textureBuffer != NULL) {
                     glGenTextures(1, &m_textureId);
@@ -81,12 +96,25 @@ namespace TrenchBroom {
                     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, GL_RGB, GL_UNSIGNED_BYTE, m_textureBuffer);
                     delete [] m_textureBuffer;
                     m_textureBuffer = NULL;
+                    TextureBufferMemory.deallocate(bufferSize());
+                    TextureMemory.allocate(4 * m_width * m_height);
                 }
             }
-            
+        }
+        
+        void TextureRenderer::activate() {
+            upload();
             glBindTexture(GL_TEXTURE_2D, m_textureId);
         }
         
+        void TextureRenderer::activate(RenderState& renderState) {
+            if (m_textureId == 0 && m_textureBuffer != NULL) {
+                upload();
+                renderState.textureBound(m_textureId);
+            }
+            renderState.bindTexture(m_textureId);
+        }
+        
         void TextureRenderer::deactivate() {
             glBindTexture(GL_TEXTURE_2D, 0);
         }
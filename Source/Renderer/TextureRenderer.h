@@ -35,6 +35,7 @@ namespace TrenchBroom {
     
     namespace Renderer {
         class Palette;
+        class RenderState;
         
         class TextureRenderer {
         protected:
@@ -46,6 +47,11 @@ namespace TrenchBroom {
             
             void init(unsigned int width, unsigned int height);
             void init(unsigned char* rgbImage, unsigned int width, unsigned int height);
+            void upload();
+
+            inline size_t bufferSize() const {
+                return 3 * m_width * m_height;
+            }
 
             // prevent copying
             TextureRenderer(const TextureRenderer& other);
@@ -62,6 +68,7 @@ namespace TrenchBroom {
             }
             
             void activate();
+            void activate(RenderState& renderState);
             void deactivate();
         };
     }
@@ -18,10 +18,15 @@
  */
 
 #include "Vbo.h"
+
+#include "Utility/MemoryRegistry.h"
+
 #include <algorithm>
 
 namespace TrenchBroom {
     namespace Renderer {
+        static Utility::MemoryTag VboMemory("VBOs", Utility::MemoryTag::Unshared);
+
         void VboBlock::insertBetween(VboBlock* previousBlock, VboBlock* nextBlock) {
             if (previousBlock != NULL) previousBlock->m_next = this;
             m_previous = previousBlock;
@@ -33,212 +38,156 @@ namespace TrenchBroom {
             m_vbo.freeBlock(*this);
         }
         
-        size_t Vbo::findFreeBlockInRange(size_t address, size_t capacity, size_t start, size_t length) {
-            assert(length > 0);
-            
-            size_t pivot = start + length / 2;
-            VboBlock* block = m_freeBlocks[pivot];
-
-            int order = block->compare(address, capacity);
-            if (order == 0)
-                return pivot;
-            if (length == 1) {
-                if (order > 0)
-                    return pivot;
-                return pivot + 1;
+        size_t Vbo::sizeClass(size_t capacity) const {
+            assert(capacity > 0);
+            size_t result = 0;
+            while (capacity > 1) {
+                capacity >>= 1;
+                result++;
             }
-            
-            if (order > 0)
-                return findFreeBlockInRange(address, capacity, start, length / 2);
-            return findFreeBlockInRange(address, capacity, pivot, (length + 1) / 2);
-        }
-        
-        size_t Vbo::findFreeBlock(size_t address, size_t capacity) {
-            if (m_freeBlocks.empty()) return 0;
-            size_t index = findFreeBlockInRange(address, capacity, 0, static_cast<size_t>(m_freeBlocks.size()));
-            assert(index == m_freeBlocks.size() ||
-                   capacity < m_freeBlocks[index]->capacity() ||
-                   (capacity == m_freeBlocks[index]->capacity() && address <= m_freeBlocks[index]->address()));
-            return index;
+            return result;
         }
 
         void Vbo::insertFreeBlock(VboBlock& block) {
             assert(block.free());
-            size_t index = findFreeBlock(block.address(), block.capacity());
-            assert(index <= m_freeBlocks.size());
-            if (index < m_freeBlocks.size()) {
-                std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-                std::advance(it, index);
-                m_freeBlocks.insert(it, &block);
-            } else {
-                m_freeBlocks.push_back(&block);
-            }
-#ifdef _DEBUG_VBO
-            checkFreeBlocks();
-#endif
+            VboBlock*& head = m_freeLists[sizeClass(block.capacity())];
+            block.m_previousFree = NULL;
+            block.m_nextFree = head;
+            if (head != NULL)
+                head->m_previousFree = &block;
+            head = &block;
         }
         
         void Vbo::removeFreeBlock(VboBlock& block) {
             assert(block.free());
-            size_t index = findFreeBlock(block.address(), block.capacity());
-            assert(index < m_freeBlocks.size());
-            assert(m_freeBlocks[index] == &block);
-            std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-            std::advance(it, index);
-            m_freeBlocks.erase(it);
-#ifdef _DEBUG_VBO
-            checkFreeBlocks();
-#endif
+            if (block.m_previousFree != NULL) {
+                block.m_previousFree->m_nextFree = block.m_nextFree;
+            } else {
+                VboBlock*& head = m_freeLists[sizeClass(block.capacity())];
+                assert(head == &block);
+                head = block.m_nextFree;
+            }
+            if (block.m_nextFree != NULL)
+                block.m_nextFree->m_previousFree = block.m_previousFree;
+            block.m_previousFree = NULL;
+            block.m_nextFree = NULL;
         }
         
-        void Vbo::resizeVbo(size_t newCapacity) {
-            VboState oldState = m_state;
+        VboBlock* Vbo::findFreeBlock(size_t capacity) {
+            // blocks in the size class of the requested capacity may still be too small
+            const size_t first = sizeClass(capacity);
+            VboBlock* block = m_freeLists[first];
+            while (block != NULL && block->capacity() < capacity)
+                block = block->m_nextFree;
+            if (block != NULL)
+                return block;
             
-            unsigned char* temp = NULL;
-            MemBlock::List memBlocks;
-            if (m_vboId != 0 && m_freeCapacity < m_totalCapacity) {
-                VboBlock* currentBlock = m_first;
-                size_t totalLength = 0;
-                
-                while (currentBlock != NULL) {
-                    while (currentBlock != NULL && currentBlock->free())
-                        currentBlock = currentBlock->m_next;
-                    if (currentBlock != NULL) {
-                        size_t start = currentBlock->address();
-                        size_t length = 0;
-                        while (currentBlock != NULL && !currentBlock->free()) {
-                            length += currentBlock->capacity();
-                            currentBlock = currentBlock->m_next;
-                        }
-                        memBlocks.push_back(MemBlock(start, length));
-                        totalLength += length;
-                    }
-                }
-                
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
-                    map();
+            for (size_t i = first + 1; i < SizeClassCount; i++)
+                if (m_freeLists[i] != NULL)
+                    return m_freeLists[i];
+            return NULL;
+        }
 
-                temp = new unsigned char[totalLength];
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(temp + offset, m_buffer + memBlock.start, memBlock.length);
-                    offset += memBlock.length;
-                }
-            }
-            
-            size_t addedCapacity = newCapacity - m_totalCapacity;
-            m_freeCapacity = newCapacity - (m_totalCapacity - m_freeCapacity);
-            m_totalCapacity = newCapacity;
-            
-            if (m_last->free()) {
-                resizeBlock(*m_last, m_last->capacity() + addedCapacity);
-            } else {
-                VboBlock* block = new VboBlock(*this, m_last->address() + m_last->capacity(), addedCapacity);
-                block->insertBetween(m_last, NULL);
-                insertFreeBlock(*block);
-            }
-            
-            if (m_vboId != 0) {
-                if (m_state == VboMapped)
-                    unmap();
-                if (m_state == VboActive)
-                    deactivate();
-                glDeleteBuffers(1, &m_vboId);
-                m_vboId = 0;
-            }
-            
-            if (temp != NULL) {
-                assert(!memBlocks.empty());
-                
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
-                    map();
-                
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(m_buffer + memBlock.start, temp + offset, memBlock.length);
-                }
-                
-                delete [] temp;
-                temp = NULL;
-                memBlocks.clear();
-                
-                if (oldState < VboMapped)
-                    unmap();
-                if (oldState < VboActive)
-                    deactivate();
-            } else {
-                if (oldState > VboInactive && m_state < VboActive)
-                    activate();
-                if (oldState > VboActive && m_state < VboMapped)
-                    map();
+        void Vbo::unlinkBlock(VboBlock& block) {
+            if (block.m_previous != NULL)
+                block.m_previous->m_next = block.m_next;
+            else
+                m_first = block.m_next;
+            if (block.m_next != NULL)
+                block.m_next->m_previous = block.m_previous;
+            else
+                m_last = block.m_previous;
+            block.m_previous = NULL;
+            block.m_next = NULL;
+        }
+
+        void Vbo::deleteBlocks() {
+            VboBlock* block = m_first;
+            while (block != NULL) {
+                VboBlock* next = block->m_next;
+                delete block;
+                block = next;
             }
+            m_first = m_last = NULL;
+            for (size_t i = 0; i < SizeClassCount; i++)
+                m_freeLists[i] = NULL;
+        }
+
+        void Vbo::addPage(size_t capacity) {
+            assert(capacity > 0);
             
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
+            m_pages.push_back(Page(capacity));
+            VboBlock* block = new VboBlock(*this, m_pages.size() - 1, 0, capacity);
+            block->insertBetween(m_last, NULL);
+            if (m_first == NULL)
+                m_first = block;
+            m_last = block;
+            insertFreeBlock(*block);
+
+            // the memory tag counts the VBO as one object however many pages it has
+            VboMemory.allocate(capacity, m_pages.size() == 1 ? 1 : 0);
+            m_totalCapacity += capacity;
+            m_freeCapacity += capacity;
         }
-        
-        void Vbo::resizeBlock(VboBlock& block, size_t newCapacity) {
-            if (block.capacity() == newCapacity) return;
-            if (block.free()) {
-                removeFreeBlock(block);
-                block.m_capacity = newCapacity;
-                insertFreeBlock(block);
+
+        void Vbo::createPageBuffer(Page& page) {
+            assert(page.vboId == 0);
+            glGenBuffers(1, &page.vboId);
+            glBindBuffer(m_type, page.vboId);
+            glBufferData(m_type, static_cast<GLsizeiptr>(page.capacity), NULL, GL_DYNAMIC_DRAW);
+        }
+
+        void Vbo::deletePageBuffers() {
+            for (size_t i = 0; i < m_pages.size(); i++) {
+                if (m_pages[i].vboId != 0) {
+                    glDeleteBuffers(1, &m_pages[i].vboId);
+                    m_pages[i].vboId = 0;
+                }
             }
         }
-        
-        VboBlock* Vbo::packBlock(VboBlock& block) {
-            VboBlock* first = block.m_next;
-            if (first == NULL)
-                return NULL;
-            
-            VboBlock* previous = NULL;
-            VboBlock* last = first;
-            size_t size = 0;
-            size_t address = first->address();
-            
-            do {
-                last->m_address -= block.capacity();
-                size += last->capacity();
-                previous = last;
-                last = last->m_next;
-            } while (last != NULL && !last->free());
-            
-            memmove(m_buffer + block.address(), m_buffer + address, size);
-            
-            if (last != NULL) {
-                last->m_address -= block.capacity();
-                resizeBlock(*last, last->capacity() + block.capacity());
-            } else {
-                VboBlock* newBlock = new VboBlock(*this, previous->address() + previous->capacity(), block.capacity());
-                insertFreeBlock(*newBlock);
-                newBlock->insertBetween(previous, NULL);
-                m_last = newBlock;
+
+        void Vbo::uploadStagedRanges() {
+            size_t boundPage = m_pages.size();
+            for (size_t i = 0; i < m_stagedRanges.size(); i++) {
+                const StagedRange& range = m_stagedRanges[i];
+                if (boundPage != range.page) {
+                    bindPage(range.page);
+                    boundPage = range.page;
+                }
+                glBufferSubData(m_type, static_cast<GLintptr>(range.address), static_cast<GLsizeiptr>(range.length), &m_staging[range.offset]);
             }
             
-            if (m_first == &block) m_first = block.m_next;
+            m_stagedRanges.clear();
+            if (m_staging.capacity() > MaxRetainedStagingSize)
+                std::vector<unsigned char>().swap(m_staging);
+            else
+                m_staging.clear();
             
-            removeFreeBlock(block);
-            if (block.m_previous != NULL) block.m_previous->m_next = block.m_next;
-            if (block.m_next != NULL) block.m_next->m_previous = block.m_previous;
-            delete &block;
+            if (boundPage != 0)
+                bindPage(0);
+        }
 
-            return last;
+        void Vbo::uploadDirectly(size_t page, size_t address, const unsigned char* buffer, size_t length) {
+            assert(m_state == VboMapped);
+            if (!m_stagedRanges.empty())
+                uploadStagedRanges();
+
+            bindPage(page);
+            glBufferSubData(m_type, static_cast<GLintptr>(address), static_cast<GLsizeiptr>(length), buffer);
+            if (page != 0)
+                bindPage(0);
         }
         
-        Vbo::Vbo(GLenum type, size_t capacity) : m_type(type), m_totalCapacity(capacity), m_freeCapacity(capacity), m_buffer(NULL), m_vboId(0), m_state(VboInactive) {
-            m_first = new VboBlock(*this, 0, m_totalCapacity);
-            m_last = m_first;
-            m_freeBlocks.push_back(m_first);
+        Vbo::Vbo(GLenum type, size_t capacity) :
+        m_type(type),
+        m_totalCapacity(0),
+        m_freeCapacity(0),
+        m_first(NULL),
+        m_last(NULL),
+        m_state(VboInactive) {
+            for (size_t i = 0; i < SizeClassCount; i++)
+                m_freeLists[i] = NULL;
+            addPage(capacity);
 #ifdef _DEBUG_VBO
             checkBlockChain();
             checkFreeBlocks();
@@ -254,27 +203,15 @@ namespace TrenchBroom {
                 unmap();
             if (m_state == VboActive)
                 deactivate();
-            if (m_vboId != 0)
-                glDeleteBuffers(1, &m_vboId);
-            m_freeBlocks.clear();
-            VboBlock* block = m_first;
-            while (block != NULL) {
-                VboBlock* next = block->m_next;
-                delete block;
-                block = next;
-            }
+            deletePageBuffers();
+            deleteBlocks();
+            VboMemory.deallocate(m_totalCapacity);
         }
         
         void Vbo::activate() {
             assert(m_state != VboActive);
             
-            if (m_vboId == 0) {
-                glGenBuffers(1, &m_vboId);
-                glBindBuffer(m_type, m_vboId);
-                glBufferData(m_type, static_cast<GLsizeiptr>(m_totalCapacity), NULL, GL_DYNAMIC_DRAW);
-            } else {
-                glBindBuffer(m_type, m_vboId);
-            }
+            bindPage(0);
 
             GLenum error = glGetError();
 			if (error != GL_NO_ERROR)
@@ -292,32 +229,27 @@ namespace TrenchBroom {
         
         void Vbo::map() {
             assert(m_state == VboActive);
+            assert(m_stagedRanges.empty());
             
-            m_buffer = (unsigned char *)glMapBuffer(m_type, GL_WRITE_ONLY);
-            GLenum error = glGetError();
-			if (m_buffer == NULL || error != GL_NO_ERROR)
-				throw VboException(*this, "Vbo could not be mapped", error);
-
+            // nothing is mapped, writes are staged until the buffer is unmapped
             m_state = VboMapped;
         }
         
         void Vbo::unmap() {
             assert(m_state == VboMapped);
             
-            glUnmapBuffer(m_type);
+            uploadStagedRanges();
 
             GLenum error = glGetError();
 			if (error != GL_NO_ERROR)
 				throw VboException(*this, "Vbo could not be unmapped", error);
 
-			m_buffer = NULL;
             m_state = VboActive;
         }
         
         void Vbo::ensureFreeCapacity(size_t capacity) {
-            pack();
             if (m_freeCapacity < capacity)
-                resizeVbo(m_totalCapacity + (capacity - m_freeCapacity));
+                addPage(capacity - m_freeCapacity);
         }
 
         VboBlock* Vbo::allocBlock(size_t capacity) {
@@ -328,34 +260,19 @@ namespace TrenchBroom {
             checkFreeBlocks();
 #endif
 
-            size_t index = findFreeBlock(0, capacity);
-            if (index >= m_freeBlocks.size()) {
-                SetVboState mapVbo(*this, VboMapped);
-                pack();
-
-                if (capacity > m_freeCapacity) {
-                    const size_t usedCapacity = m_totalCapacity - m_freeCapacity;
-                    size_t newCapacity = m_totalCapacity;
-                    size_t newFreeCapacity = m_freeCapacity;
-                    while (capacity > newFreeCapacity) {
-                        newCapacity *= 2;
-                        newFreeCapacity = newCapacity - usedCapacity;
-                    }
-                    resizeVbo(newCapacity);
-                }
-                
-                index = findFreeBlock(0, capacity);
-                assert(index < m_freeBlocks.size());
+            VboBlock* block = findFreeBlock(capacity);
+            if (block == NULL) {
+                // double the total capacity without touching the existing pages
+                addPage(std::max(capacity, m_totalCapacity));
+                block = findFreeBlock(capacity);
+                assert(block != NULL);
             }
             
-            VboBlock* block = m_freeBlocks[index];
-            std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-            std::advance(it, index);
-            m_freeBlocks.erase(it);
+            removeFreeBlock(*block);
             
             // split block
             if (capacity < block->capacity()) {
-                VboBlock* remainder = new VboBlock(*this, block->address() + capacity, block->capacity() - capacity);
+                VboBlock* remainder = new VboBlock(*this, block->m_page, block->address() + capacity, block->capacity() - capacity);
                 remainder->insertBetween(block, block->m_next);
                 block->m_capacity = capacity;
                 insertFreeBlock(*remainder);
@@ -378,86 +295,61 @@ namespace TrenchBroom {
             checkBlockChain();
             checkFreeBlocks();
 #endif
+            assert(!block.free());
 
-            VboBlock* previous = block.m_previous;
-            VboBlock* next = block.m_next;
-            
             m_freeCapacity += block.capacity();
             block.m_free = true;
             
-            if (previous != NULL && previous->free() && next != NULL && next->free()) {
-                resizeBlock(*previous, previous->capacity() + block.capacity() + next->capacity());
-                if (m_last == next) m_last = previous;
-                removeFreeBlock(*next);
-                previous->insertBetween(previous->m_previous, next->m_next);
-                delete &block;
-                delete next;
-                return previous;
-            }
-            
-            if (previous != NULL && previous->free()) {
-                resizeBlock(*previous, previous->capacity() + block.capacity());
-                if (m_last == &block) m_last = previous;
-                previous->insertBetween(previous->m_previous, next);
+            // only merge with neighbours in the same page
+            VboBlock* result = &block;
+            VboBlock* previous = block.m_previous;
+            if (previous != NULL && previous->free() && previous->m_page == block.m_page) {
+                removeFreeBlock(*previous);
+                previous->m_capacity += block.capacity();
+                unlinkBlock(block);
                 delete &block;
-                return previous;
+                result = previous;
             }
             
-            if (next != NULL && next->free()) {
-                if (m_last == next) m_last = &block;
+            VboBlock* next = result->m_next;
+            if (next != NULL && next->free() && next->m_page == result->m_page) {
                 removeFreeBlock(*next);
-                block.m_capacity += next->capacity();
-                block.m_free = true;
-                block.insertBetween(previous, next->m_next);
-                insertFreeBlock(block);
+                result->m_capacity += next->capacity();
+                unlinkBlock(*next);
                 delete next;
-                return &block;
             }
             
-            insertFreeBlock(block);
+            insertFreeBlock(*result);
 
 #ifdef _DEBUG_VBO
             checkBlockChain();
             checkFreeBlocks();
 #endif
 
-            return &block;
+            return result;
         }
 
         void Vbo::freeAllBlocks() {
-            m_freeBlocks.clear();
-            VboBlock* block = m_first;
-            while (block != NULL) {
-                VboBlock* next = block->m_next;
-                delete block;
-                block = next;
-            }
-            m_first = m_last = new VboBlock(*this, 0, m_totalCapacity);
-            m_freeBlocks.push_back(m_first);
+            deleteBlocks();
+            m_stagedRanges.clear();
+            m_staging.clear();
             m_freeCapacity = m_totalCapacity;
-        }
-
-        void Vbo::pack() {
-            assert(m_state == VboMapped);
-            
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
 
-            if (m_totalCapacity == m_freeCapacity || (m_last->free() && m_last->capacity() == m_freeCapacity)) return;
+            if (m_state == VboInactive && m_pages.size() > 1) {
+                // nothing is in use anymore, so the pages can be merged without copying any data
+                deletePageBuffers();
+                m_pages.clear();
+                m_pages.push_back(Page(m_totalCapacity));
+            }
             
-            // find first free block
-            VboBlock* block = m_first;
-            while (block != NULL && !block->free())
-                block = block->m_next;
-            while (block != NULL && block->m_next != NULL)
-                block = packBlock(*block);
-
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
+            for (size_t i = 0; i < m_pages.size(); i++) {
+                VboBlock* block = new VboBlock(*this, i, 0, m_pages[i].capacity);
+                block->insertBetween(m_last, NULL);
+                if (m_first == NULL)
+                    m_first = block;
+                m_last = block;
+                insertFreeBlock(*block);
+            }
         }
 
 #ifdef _DEBUG_VBO
@@ -465,9 +357,20 @@ namespace TrenchBroom {
             VboBlock* block = m_first;
             VboBlock* previous = NULL;
             assert(block != NULL && block->m_previous == NULL);
+            assert(block->m_page == 0 && block->address() == 0);
             
             while (block != NULL) {
                 assert(&block->m_vbo == this);
+                assert(block->m_page < m_pages.size());
+                if (previous != NULL) {
+                    if (previous->m_page == block->m_page) {
+                        assert(previous->address() + previous->capacity() == block->address());
+                    } else {
+                        assert(previous->m_page + 1 == block->m_page);
+                        assert(previous->address() + previous->capacity() == m_pages[previous->m_page].capacity);
+                        assert(block->address() == 0);
+                    }
+                }
                 previous = block;
                 block = block->m_next;
                 assert(block == NULL || block->m_previous == previous);
@@ -477,13 +380,19 @@ namespace TrenchBroom {
         }
         
         void Vbo::checkFreeBlocks() {
-            for (size_t i = 0; i < m_freeBlocks.size(); i++) {
-                VboBlock* block = m_freeBlocks[i];
-                assert(block->free());
-                if (i < m_freeBlocks.size() - 1)
-                    assert((block->capacity() < m_freeBlocks[i + 1]->capacity()) || 
-                           (block->capacity() == m_freeBlocks[i + 1]->capacity() && block->address() < m_freeBlocks[i + 1]->address()));
+            size_t freeCapacity = 0;
+            for (size_t i = 0; i < SizeClassCount; i++) {
+                VboBlock* block = m_freeLists[i];
+                assert(block == NULL || block->m_previousFree == NULL);
+                while (block != NULL) {
+                    assert(block->free());
+                    assert(sizeClass(block->capacity()) == i);
+                    assert(block->m_nextFree == NULL || block->m_nextFree->m_previousFree == block);
+                    freeCapacity += block->capacity();
+                    block = block->m_nextFree;
+                }
             }
+            assert(freeCapacity == m_freeCapacity);
         }
 #endif
         
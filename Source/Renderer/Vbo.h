@@ -38,6 +38,9 @@ namespace TrenchBroom {
     namespace Renderer {
         class VboBlock;
 
+        // Manages the blocks of one or more GL buffer objects ("pages"). When the free space does not suffice,
+        // another page is added instead of reallocating and copying the existing data, so the address of a block
+        // never changes. Writes to mapped blocks are staged and only the written ranges are uploaded on unmap.
         class Vbo {
         public:
             typedef enum {
@@ -46,37 +49,90 @@ namespace TrenchBroom {
                 VboMapped   = 2
             } VboState;
         private:
-            struct MemBlock {
-                typedef std::vector<MemBlock> List;
-                
-                size_t start;
+            struct Page {
+                typedef std::vector<Page> List;
+
+                GLuint vboId;
+                size_t capacity;
+
+                Page(size_t i_capacity) :
+                vboId(0),
+                capacity(i_capacity) {}
+            };
+
+            struct StagedRange {
+                typedef std::vector<StagedRange> List;
+
+                size_t page;
+                size_t address;
+                size_t offset;
                 size_t length;
-                
-                MemBlock(size_t i_start, size_t i_length) :
-                start(i_start),
+
+                StagedRange(size_t i_page, size_t i_address, size_t i_offset, size_t i_length) :
+                page(i_page),
+                address(i_address),
+                offset(i_offset),
                 length(i_length) {}
-                
-                MemBlock() :
-                start(0),
-                length(0) {}
             };
 
+            // free blocks are kept in one list per power of two of their capacity
+            static const size_t SizeClassCount = 8 * sizeof(size_t);
+            // release the staging memory after large uploads
+            static const size_t MaxRetainedStagingSize = 1 << 20;
+            // writes of at least this size are uploaded at once instead of being staged
+            static const size_t MinDirectUploadSize = 1 << 16;
+
             GLenum m_type;
             size_t m_totalCapacity;
             size_t m_freeCapacity;
-            std::vector<VboBlock*> m_freeBlocks;
+            Page::List m_pages;
+            VboBlock* m_freeLists[SizeClassCount];
             VboBlock* m_first;
             VboBlock* m_last;
-            unsigned char* m_buffer;
-            GLuint m_vboId;
+            std::vector<unsigned char> m_staging;
+            StagedRange::List m_stagedRanges;
             VboState m_state;
-            size_t findFreeBlockInRange(size_t address, size_t capacity, size_t start, size_t length);
-            size_t findFreeBlock(size_t address, size_t capacity);
+
+            size_t sizeClass(size_t capacity) const;
             void insertFreeBlock(VboBlock& block);
             void removeFreeBlock(VboBlock& block);
-            void resizeVbo(size_t newCapacity);
-            void resizeBlock(VboBlock& block, size_t newCapacity);
-            VboBlock* packBlock(VboBlock& block);
+            VboBlock* findFreeBlock(size_t capacity);
+            void unlinkBlock(VboBlock& block);
+            void deleteBlocks();
+            void addPage(size_t capacity);
+            void createPageBuffer(Page& page);
+            void deletePageBuffers();
+            void uploadStagedRanges();
+            // uploads the earlier staged writes first so that they cannot overwrite the given data later
+            void uploadDirectly(size_t page, size_t address, const unsigned char* buffer, size_t length);
+
+            // creates the buffer object of pages that were added since the last upload
+            inline void bindPage(size_t page) {
+                assert(page < m_pages.size());
+                if (m_pages[page].vboId == 0)
+                    createPageBuffer(m_pages[page]);
+                else
+                    glBindBuffer(m_type, m_pages[page].vboId);
+            }
+
+            // returns the staging memory for the given range of a page, consecutive writes are merged into one range
+            inline unsigned char* stage(size_t page, size_t address, size_t length) {
+                assert(m_state == VboMapped);
+                const size_t offset = m_staging.size();
+                if (!m_stagedRanges.empty() && m_stagedRanges.back().page == page && m_stagedRanges.back().address + m_stagedRanges.back().length == address)
+                    m_stagedRanges.back().length += length;
+                else
+                    m_stagedRanges.push_back(StagedRange(page, address, offset, length));
+                m_staging.resize(offset + length);
+                return &m_staging[offset];
+            }
+
+            inline void write(size_t page, size_t address, const unsigned char* buffer, size_t length) {
+                if (length >= MinDirectUploadSize)
+                    uploadDirectly(page, address, buffer, length);
+                else
+                    memcpy(stage(page, address, length), buffer, length);
+            }
 #ifdef _DEBUG_VBO
             void checkBlockChain();
             void checkFreeBlocks();
@@ -102,7 +158,6 @@ namespace TrenchBroom {
             VboBlock* allocBlock(size_t capacity);
             VboBlock* freeBlock(VboBlock& block);
             void freeAllBlocks();
-            void pack();
             bool ownsBlock(VboBlock& block);
         };
 
@@ -166,20 +221,27 @@ namespace TrenchBroom {
             void insertBetween(VboBlock* previousBlock, VboBlock* nextBlock);
             friend class Vbo;
 
+            size_t m_page;
             size_t m_address;
             size_t m_capacity;
             bool m_free;
             VboBlock* m_previous;
             VboBlock* m_next;
+            VboBlock* m_previousFree;
+            VboBlock* m_nextFree;
         public:
-            inline VboBlock(Vbo& vbo, size_t address, size_t capacity) :
+            inline VboBlock(Vbo& vbo, size_t page, size_t address, size_t capacity) :
             m_vbo(vbo),
+            m_page(page),
             m_address(address),
             m_capacity(capacity),
             m_free(true),
             m_previous(NULL),
-            m_next(NULL) {}
+            m_next(NULL),
+            m_previousFree(NULL),
+            m_nextFree(NULL) {}
 
+            // the address is relative to the page, so the page must be bound before the block's data is used
             inline size_t address() const {
                 return m_address;
             }
@@ -192,43 +254,48 @@ namespace TrenchBroom {
                 return m_free;
             }
 
+            inline void bind() {
+                m_vbo.bindPage(m_page);
+            }
+
             inline size_t writeBuffer(const unsigned char* buffer, size_t offset, size_t length) {
                 assert(offset + length <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, buffer, length);
+                m_vbo.write(m_page, m_address + offset, buffer, length);
                 return offset + length;
             }
 
             inline size_t writeByte(unsigned char b, size_t offset) {
                 assert(offset < m_capacity);
-                m_vbo.m_buffer[m_address + offset] = b;
+                *m_vbo.stage(m_page, m_address + offset, 1) = b;
                 return offset + 1;
             }
 
             inline size_t writeFloat(float f, size_t offset) {
                 assert(offset + sizeof(float) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &f, sizeof(float));
+                memcpy(m_vbo.stage(m_page, m_address + offset, sizeof(float)), &f, sizeof(float));
                 return offset + sizeof(float);
             }
 
             inline size_t writeUInt32(size_t i, size_t offset) {
                 assert(offset + sizeof(size_t) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &i, sizeof(size_t));
+                memcpy(m_vbo.stage(m_page, m_address + offset, sizeof(size_t)), &i, sizeof(size_t));
                 return offset + sizeof(size_t);
             }
 
             inline size_t writeColor(const Color& color, size_t offset) {
                 assert(offset + 4 <= m_capacity);
-                m_vbo.m_buffer[m_address + offset + 0] = static_cast<unsigned char>(color.r() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 1] = static_cast<unsigned char>(color.g() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 2] = static_cast<unsigned char>(color.b() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 3] = static_cast<unsigned char>(color.a() * 0xFF);
+                unsigned char* buffer = m_vbo.stage(m_page, m_address + offset, 4);
+                buffer[0] = static_cast<unsigned char>(color.r() * 0xFF);
+                buffer[1] = static_cast<unsigned char>(color.g() * 0xFF);
+                buffer[2] = static_cast<unsigned char>(color.b() * 0xFF);
+                buffer[3] = static_cast<unsigned char>(color.a() * 0xFF);
                 return offset + 4;
             }
 
             template<class T>
             inline size_t writeVec(const T& vec, size_t offset) {
                 assert(offset + sizeof(T) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &vec, sizeof(T));
+                memcpy(m_vbo.stage(m_page, m_address + offset, sizeof(T)), &vec, sizeof(T));
                 return offset + sizeof(T);
             }
 
@@ -236,19 +303,11 @@ namespace TrenchBroom {
             inline size_t writeVecs(const std::vector<T>& vecs, size_t offset) {
                 size_t size = static_cast<size_t>(vecs.size() * sizeof(T));
                 assert(offset + size <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &(vecs[0]), size);
+                m_vbo.write(m_page, m_address + offset, reinterpret_cast<const unsigned char*>(&(vecs[0])), size);
                 return offset + size;
             }
 
             void freeBlock();
-
-            inline int compare(size_t address, size_t capacity) {
-                if (m_capacity < capacity) return -1;
-                if (m_capacity > capacity) return 1;
-                if (m_address < address) return -1;
-                if (m_address > address) return 1;
-                return 0;
-            }
         };
 
 		class VboException : public std::exception {
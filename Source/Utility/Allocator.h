@@ -20,10 +20,13 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include "Utility/MemoryRegistry.h"
+
 #include <cassert>
 #include <iostream>
 #include <limits>
 #include <stack>
+#include <typeinfo>
 #include <vector>
 
 // Undefine this to prevent false positives when looking for memory leaks.
@@ -109,10 +112,16 @@ namespace TrenchBroom {
                 return chunks;
             }
 
-            static inline ChunkList emptyChunks() {
+            static inline ChunkList& emptyChunks() {
                 static ChunkList chunks;
                 return chunks;
             }
+
+            // counts the bytes of the chunks and the number of live objects; like the pool, it is not thread safe
+            static inline MemoryTag& memoryTag() {
+                static MemoryTag tag(typeName(typeid(T)) + " pool", MemoryTag::Unshared);
+                return tag;
+            }
         public:
 #ifdef _ENABLE_ALLOCATOR
             inline void* operator new(size_t size) {
@@ -121,6 +130,7 @@ namespace TrenchBroom {
                 if (!pool().empty()) {
                     T* t = pool().top();
                     pool().pop();
+                    memoryTag().allocate(0);
                     return t;
                 }
 
@@ -131,6 +141,7 @@ namespace TrenchBroom {
                         emptyChunks().pop_back();
                     } else {
                         chunk = new Chunk();
+                        memoryTag().allocate(sizeof(Chunk), 0);
                     }
                 } else {
                     chunk = mixedChunks().back();
@@ -144,11 +155,13 @@ namespace TrenchBroom {
                     fullChunks().push_back(chunk);
                 else
                     mixedChunks().push_back(chunk);
+                memoryTag().allocate(0);
                 return block;
             }
 
             inline void operator delete(void* block) {
                 T* t = reinterpret_cast<T*>(block);
+                memoryTag().deallocate(0);
 
                 size_t poolSize = PoolSize;
                 if (poolSize > 0 && pool().size() < poolSize) {
@@ -193,10 +206,12 @@ namespace TrenchBroom {
 
                 if (chunk->empty()) {
                     mixedChunks().erase((mixedIt + 1).base());
-                    if (emptyChunks().size() < 2)
+                    if (emptyChunks().size() < 2) {
                         emptyChunks().push_back(chunk);
-                    else
+                    } else {
                         delete chunk;
+                        memoryTag().deallocate(sizeof(Chunk), 0);
+                    }
                 }
             }
 #endif
@@ -18,6 +18,7 @@
  */
 
 #include "CommandProcessor.h"
+#include "Utility/Tracer.h"
 
 #include <algorithm>
 #include <cassert>
@@ -41,6 +42,12 @@ bool CompoundCommand::empty() const {
     return m_commands.empty();
 }
 
+wxCommand* CompoundCommand::lastCommand() const {
+    if (m_commands.empty())
+        return NULL;
+    return m_commands.back();
+}
+
 void CompoundCommand::clear() {
     CommandList::iterator it, end;
     for (it = m_commands.begin(), end = m_commands.end(); it != end; ++it) {
@@ -155,9 +162,20 @@ void CommandProcessor::DiscardGroup() {
 }
 
 bool CommandProcessor::Submit(wxCommand* command, bool storeIt) {
+    TRACE_ZONE("CommandProcessor::Submit");
     if (m_groupStack.empty())
         return wxCommandProcessor::Submit(command, storeIt);
 
+    if (storeIt) {
+        // consecutive compatible commands, e.g. the steps of a drag, are folded into the previous command
+        CollatableCommand* previous = dynamic_cast<CollatableCommand*>(m_groupStack.top()->lastCommand());
+        CollatableCommand* collatable = dynamic_cast<CollatableCommand*>(command);
+        if (previous != NULL && collatable != NULL && previous->collateWith(*collatable)) {
+            delete command;
+            return true;
+        }
+    }
+    
     bool result = DoCommand(*command);
     if (result && storeIt)
         m_groupStack.top()->addCommand(command);
@@ -27,6 +27,22 @@
 
 typedef std::vector<wxCommand*> CommandList;
 
+class CollatableCommand : public wxCommand {
+public:
+    CollatableCommand(bool canUndo, const wxString& name) :
+    wxCommand(canUndo, name) {}
+    
+    virtual ~CollatableCommand() {}
+    
+    /*
+     Called when the given command is submitted to a group right after this command. Returns true if this command
+     has performed the given command itself, in which case the given command is discarded without being done.
+     */
+    virtual bool collateWith(CollatableCommand& command) {
+        return false;
+    }
+};
+
 class CompoundCommand : public wxCommand {
 protected:
     CommandList m_commands;
@@ -37,6 +53,7 @@ public:
     void addCommand(wxCommand* command);
     void removeCommand(wxCommand* command);
     bool empty() const;
+    wxCommand* lastCommand() const;
     void clear();
     
     bool Do();
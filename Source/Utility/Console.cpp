@@ -26,41 +26,13 @@
 #endif
 
 #include <cstdarg>
-#include <fstream>
-#include <wx/datetime.h>
 #include <wx/wx.h>
 
 namespace TrenchBroom {
     namespace Utility {
-        void Console::logToDebug(const LogMessage& message) {
-            // wxLogDebug(message.string().c_str());
-        }
-
-        void Console::logToConsole(const LogMessage& message) {
-            long start = m_textCtrl->GetLastPosition();
-            m_textCtrl->AppendText(message.string());
-            m_textCtrl->AppendText("\n");
-            long end = m_textCtrl->GetLastPosition();
-            switch (message.level()) {
-                case LLDebug:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLInfo:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLWarn:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLError:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-            }
-        }
-
-        void Console::logToFile(const LogMessage& message) {
-#if defined __APPLE__
-            NSLogWrapper(message.string());
-#else
+        void Console::FileWriter::open() {
+            m_streamOpened = true;
+#if !defined __APPLE__
             IO::FileManager fileManager;
             const String logDirectory = fileManager.logDirectory();
             if (logDirectory.empty())
@@ -68,35 +40,212 @@ namespace TrenchBroom {
             if (!fileManager.exists(logDirectory))
                 fileManager.makeDirectory(logDirectory);
             const String logFilePath = fileManager.appendPath(logDirectory, "TrenchBroom.log");
-            std::fstream logStream(logFilePath.c_str(), std::ios::out | std::ios::app);
-            if (logStream.is_open()) {
-                wxDateTime now = wxDateTime::Now();
-                logStream << wxGetProcessId() << " " << now.FormatISOCombined(' ') << ": " << message.string() << std::endl;
+            m_stream.open(logFilePath.c_str(), std::ios::out | std::ios::app);
+#endif
+        }
+
+        void Console::FileWriter::write(const Line::List& lines) {
+            if (!m_streamOpened)
+                open();
+            
+#if defined __APPLE__
+            for (size_t i = 0; i < lines.size(); i++)
+                NSLogWrapper(lines[i].string);
+#else
+            if (!m_stream.is_open())
+                return;
+            
+            const unsigned long processId = wxGetProcessId();
+            for (size_t i = 0; i < lines.size(); i++) {
+                const Line& line = lines[i];
+                m_stream << processId << " " << line.time.FormatISOCombined(' ') << ": " << line.string << "\n";
             }
+            m_stream.flush();
 #endif
         }
 
-        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
-            m_textCtrl = textCtrl;
-            if (m_textCtrl != NULL) {
-                for (unsigned int i = 0; i < m_buffer.size(); i++) {
-                    const LogMessage& message = m_buffer[i];
-                    logToConsole(message);
+        wxThread::ExitCode Console::FileWriter::Entry() {
+            while (true) {
+                m_semaphore.Wait();
+                
+                Line::List lines;
+                bool stopped;
+                {
+                    wxCriticalSectionLocker lock(m_lock);
+                    lines.swap(m_lines);
+                    stopped = m_stopped;
                 }
-                m_buffer.clear();
+                
+                if (!lines.empty())
+                    write(lines);
+                if (stopped)
+                    break;
             }
+            
+            m_stream.close();
+            return (wxThread::ExitCode)0;
         }
 
-        void Console::log(const LogMessage& message) {
-            if (message.string().empty())
+        Console::FileWriter::FileWriter() :
+        wxThread(wxTHREAD_JOINABLE),
+        m_stopped(false),
+        m_streamOpened(false) {
+            Create();
+            Run();
+        }
+
+        void Console::FileWriter::write(const String& string) {
+            bool notify;
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                if (m_stopped)
+                    return;
+                m_lines.push_back(Line(wxDateTime::Now(), string));
+                notify = m_lines.size() == 1;
+            }
+            if (notify)
+                m_semaphore.Post();
+        }
+
+        void Console::FileWriter::stop() {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                if (m_stopped)
+                    return;
+                m_stopped = true;
+            }
+            m_semaphore.Post();
+            Wait();
+        }
+
+        void Console::logToDebug(const LogMessage& message) {
+            // wxLogDebug(message.string().c_str());
+        }
+
+        void Console::logToConsole(const LogMessageList& messages) {
+            // consecutive messages of the same level are appended and styled at once
+            size_t i = 0;
+            while (i < messages.size()) {
+                const LogLevel level = messages[i].level();
+                StringStream text;
+                while (i < messages.size() && messages[i].level() == level) {
+                    text << messages[i].string() << "\n";
+                    i++;
+                }
+                
+                long start = m_textCtrl->GetLastPosition();
+                m_textCtrl->AppendText(text.str());
+                long end = m_textCtrl->GetLastPosition();
+                switch (level) {
+                    case LLDebug:
+                        m_textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLInfo:
+                        m_textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLWarn:
+                        m_textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLError:
+                        m_textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                }
+            }
+        }
+
+        void Console::logToFile(const LogMessage& message) {
+            m_fileWriter->write(message.string());
+        }
+
+        void Console::logRepeatCount() {
+            if (m_repeatCount == 0)
                 return;
+            
+            StringStream text;
+            text << "Last message repeated " << m_repeatCount << (m_repeatCount == 1 ? " time" : " times");
+            m_repeatCount = 0;
+            append(LogMessage(m_lastMessage.level(), text.str()));
+        }
 
+        void Console::append(const LogMessage& message) {
             logToDebug(message);
             logToFile(message);
-            if (m_textCtrl != NULL)
-                logToConsole(message);
-            else
-                m_buffer.push_back(message);
+            m_buffer.push_back(message);
+            queueFlush();
+        }
+
+        void Console::queueFlush() {
+            if (!m_flushQueued && m_textCtrl != NULL) {
+                QueueEvent(new wxThreadEvent(wxEVT_COMMAND_THREAD));
+                m_flushQueued = true;
+            }
+        }
+
+        void Console::flush() {
+            if (m_textCtrl == NULL)
+                return;
+            
+            LogMessageList messages;
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                logRepeatCount();
+                messages.swap(m_buffer);
+                m_flushQueued = false;
+            }
+            
+            if (messages.size() > MaxConsoleMessages) {
+                StringStream text;
+                text << messages.size() - MaxConsoleMessages << " more messages were not shown here, see the log file";
+                messages.resize(MaxConsoleMessages, LogMessage(LLInfo, ""));
+                messages.push_back(LogMessage(LLWarn, text.str()));
+            }
+            
+            logToConsole(messages);
+        }
+
+        void Console::OnFlush(wxThreadEvent& event) {
+            flush();
+        }
+
+        Console::Console() :
+        m_fileWriter(new FileWriter()),
+        m_lastMessage(LLDebug, ""),
+        m_repeatCount(0),
+        m_flushQueued(false),
+        m_textCtrl(NULL) {
+            Bind(wxEVT_COMMAND_THREAD, &Console::OnFlush, this);
+        }
+
+        Console::~Console() {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                logRepeatCount();
+            }
+            m_fileWriter->stop();
+            delete m_fileWriter;
+            m_fileWriter = NULL;
+        }
+
+        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
+            m_textCtrl = textCtrl;
+            flush();
+        }
+
+        void Console::log(const LogMessage& message) {
+            if (message.string().empty())
+                return;
+            
+            // repeated messages are only counted, the count is logged once a different message arrives
+            wxCriticalSectionLocker lock(m_lock);
+            if (message.level() == m_lastMessage.level() && message.string() == m_lastMessage.string()) {
+                m_repeatCount++;
+                queueFlush();
+                return;
+            }
+            
+            logRepeatCount();
+            append(message);
+            m_lastMessage = message;
         }
 
         void Console::debug(const String& message) {
@@ -22,13 +22,17 @@
 
 #include "Utility/String.h"
 
+#include <wx/datetime.h>
+#include <wx/event.h>
 #include <wx/textctrl.h>
+#include <wx/thread.h>
 
+#include <fstream>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Utility {
-        class Console {
+        class Console : public wxEvtHandler {
         protected:
             typedef enum {
                 LLDebug,
@@ -74,15 +78,67 @@ namespace TrenchBroom {
             
             typedef std::vector<LogMessage> LogMessageList;
 
+            // Writes the log file on a worker thread. The file is opened once and kept open, messages are written in
+            // batches and flushed once per batch.
+            class FileWriter : public wxThread {
+            private:
+                class Line {
+                public:
+                    typedef std::vector<Line> List;
+
+                    wxDateTime time;
+                    String string;
+
+                    Line(const wxDateTime& i_time, const String& i_string) :
+                    time(i_time),
+                    string(i_string) {}
+                };
+
+                wxCriticalSection m_lock;
+                wxSemaphore m_semaphore;
+                Line::List m_lines;
+                bool m_stopped;
+
+                std::ofstream m_stream; // only accessed by the worker thread
+                bool m_streamOpened;
+
+                void open();
+                void write(const Line::List& lines);
+                ExitCode Entry();
+            public:
+                FileWriter();
+
+                void write(const String& string);
+
+                // writes the remaining messages, then stops and joins the worker thread
+                void stop();
+            };
+
+            static const size_t MaxConsoleMessages = 500;
+
+            FileWriter* m_fileWriter;
+
+            // messages are collected here and appended to the text control in batches on the main thread
+            wxCriticalSection m_lock;
             LogMessageList m_buffer;
-            
+            LogMessage m_lastMessage;
+            unsigned int m_repeatCount;
+            bool m_flushQueued;
+
             wxTextCtrl* m_textCtrl;
-            
+
             void logToDebug(const LogMessage& message);
-            void logToConsole(const LogMessage& message);
+            void logToConsole(const LogMessageList& messages);
             void logToFile(const LogMessage& message);
+            void logRepeatCount();
+            void append(const LogMessage& message);
+            void queueFlush();
+            void flush();
+            
+            void OnFlush(wxThreadEvent& event);
         public:
-            Console() : m_textCtrl(NULL) {}
+            Console();
+            ~Console();
             
             void setTextCtrl(wxTextCtrl* textCtrl);
             
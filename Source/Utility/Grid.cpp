@@ -250,19 +250,19 @@ namespace TrenchBroom {
             if (Math<float>::zero(dist))
                 return Vec3f::Null;
             
-            const Model::EdgeList& brushEdges = face.brush()->edges();
-            const Model::VertexList& faceVertices = face.vertices();
+            const Model::BrushEdgeList brushEdges = face.brush()->edges();
+            const Model::SideVertexList faceVertices = face.vertices();
             
             // the edge rays indicate the direction into which each vertex of the given face moves if the face is dragged
             std::vector<Rayf> edgeRays;
             for (size_t i = 0; i < brushEdges.size(); ++i) {
-                const Model::Edge* edge = brushEdges[i];
+                const Model::BrushEdge edge = brushEdges[i];
                 size_t c = 0;
                 bool originAtStart = true;
                 
-                if (Model::findElement(faceVertices, edge->start) < faceVertices.size())
+                if (faceVertices.contains(edge.startIndex()))
                     c++;
-                if (Model::findElement(faceVertices, edge->end) < faceVertices.size()) {
+                if (faceVertices.contains(edge.endIndex())) {
                     c++;
                     originAtStart = false;
                 }
@@ -270,11 +270,11 @@ namespace TrenchBroom {
                 if (c == 1) {
                     Rayf ray;
                     if (originAtStart) {
-                        ray.origin = edge->start->position;
-                        ray.direction = (edge->end->position - edge->start->position).normalized();
+                        ray.origin = edge.start();
+                        ray.direction = (edge.end() - edge.start()).normalized();
                     } else {
-                        ray.origin = edge->end->position;
-                        ray.direction = (edge->start->position - edge->end->position).normalized();
+                        ray.origin = edge.end();
+                        ray.direction = (edge.start() - edge.end()).normalized();
                     }
                     
                     // depending on the direction of the drag vector, the rays must be inverted to reflect the
@@ -559,6 +559,40 @@ namespace TrenchBroom {
             return scalingMatrix(Vec<T,3>(f, f, f));
         }
 
+        // Rotations by multiples of 90 degrees computed with sinf and cosf are only almost exact. If the upper left
+        // 3x3 block of the given matrix is within epsilon of a signed permutation, i.e. such a rotation or a flip, it
+        // is replaced by the exact permutation and true is returned. Otherwise the matrix is left unchanged.
+        template <typename T>
+        inline bool snapSignedPermutation(Mat<T,4,4>& mat, const T epsilon = Math<T>::AlmostZero) {
+            static const T zero = static_cast<T>(0.0);
+            static const T one  = static_cast<T>(1.0);
+
+            Mat<T,4,4> snapped = mat;
+            size_t rowCounts[3] = { 0, 0, 0 };
+            for (size_t i = 0; i < 3; i++) {
+                size_t columnCount = 0;
+                for (size_t j = 0; j < 3; j++) {
+                    const T value = mat[i][j];
+                    if (Math<T>::zero(value, epsilon)) {
+                        snapped[i][j] = zero;
+                    } else if (Math<T>::eq(value, one, epsilon) || Math<T>::eq(value, -one, epsilon)) {
+                        snapped[i][j] = value > zero ? one : -one;
+                        columnCount++;
+                        rowCounts[j]++;
+                    } else {
+                        return false;
+                    }
+                }
+                if (columnCount != 1)
+                    return false;
+            }
+            if (rowCounts[0] != 1 || rowCounts[1] != 1 || rowCounts[2] != 1)
+                return false;
+
+            mat = snapped;
+            return true;
+        }
+
         template <typename T, size_t R, size_t C>
         const Mat<T,R,C> Mat<T,R,C>::Identity = Mat<T,R,C>().setIdentity();
 
@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MemoryRegistry.h"
+
+#include <wx/thread.h>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+#if defined __GNUC__
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        MemoryTag::MemoryTag(const String& name, Sharing sharing) :
+        m_name(name),
+        m_sharing(sharing),
+        m_bytes(0),
+        m_count(0),
+        m_peakBytes(0),
+        m_peakCount(0) {
+            MemoryRegistry::registry().addTag(*this);
+        }
+
+        MemoryTag::~MemoryTag() {
+            MemoryRegistry::registry().removeTag(*this);
+        }
+
+        class UsageOrder {
+        public:
+            inline bool operator()(const MemoryRegistry::Usage& lhs, const MemoryRegistry::Usage& rhs) const {
+                return lhs.name < rhs.name;
+            }
+        };
+
+        MemoryRegistry::MemoryRegistry() :
+        m_lock(new wxCriticalSection()) {}
+
+        MemoryRegistry::~MemoryRegistry() {
+            delete m_lock;
+            m_lock = NULL;
+        }
+
+        void MemoryRegistry::addTag(MemoryTag& tag) {
+            wxCriticalSectionLocker lock(*m_lock);
+            m_tags.push_back(&tag);
+        }
+
+        void MemoryRegistry::removeTag(MemoryTag& tag) {
+            wxCriticalSectionLocker lock(*m_lock);
+            TagList::iterator it = std::find(m_tags.begin(), m_tags.end(), &tag);
+            if (it != m_tags.end())
+                m_tags.erase(it);
+        }
+
+        void MemoryRegistry::updateShared(MemoryTag& tag, size_t addedBytes, size_t removedBytes, size_t addedCount, size_t removedCount) {
+            wxCriticalSectionLocker lock(*m_lock);
+            tag.apply(addedBytes, removedBytes, addedCount, removedCount);
+        }
+
+        MemoryRegistry& MemoryRegistry::registry() {
+            // tags register themselves during static initialization, so the registry is created on first use
+            static MemoryRegistry instance;
+            return instance;
+        }
+
+        MemoryRegistry::UsageList MemoryRegistry::usage() {
+            UsageList result;
+            {
+                wxCriticalSectionLocker lock(*m_lock);
+                result.reserve(m_tags.size());
+                for (size_t i = 0; i < m_tags.size(); i++) {
+                    const MemoryTag& tag = *m_tags[i];
+                    Usage usage;
+                    usage.name = tag.m_name;
+                    usage.bytes = tag.m_bytes;
+                    usage.count = tag.m_count;
+                    usage.peakBytes = tag.m_peakBytes;
+                    usage.peakCount = tag.m_peakCount;
+                    result.push_back(usage);
+                }
+            }
+            std::sort(result.begin(), result.end(), UsageOrder());
+            return result;
+        }
+
+        void MemoryRegistry::resetPeaks() {
+            wxCriticalSectionLocker lock(*m_lock);
+            for (size_t i = 0; i < m_tags.size(); i++) {
+                MemoryTag& tag = *m_tags[i];
+                tag.m_peakBytes = tag.m_bytes;
+                tag.m_peakCount = tag.m_count;
+            }
+        }
+
+        String MemoryRegistry::summaryString() {
+            const UsageList tags = usage();
+
+            size_t totalBytes = 0;
+            size_t totalPeakBytes = 0;
+            StringStream buffer;
+            buffer << "Tag: live KB (objects), peak KB (objects)";
+            for (size_t i = 0; i < tags.size(); i++) {
+                const Usage& tag = tags[i];
+                buffer << "\n" << tag.name << ": " << tag.bytes / 1024 << " (" << tag.count << "), " << tag.peakBytes / 1024 << " (" << tag.peakCount << ")";
+                totalBytes += tag.bytes;
+                totalPeakBytes += tag.peakBytes;
+            }
+            buffer << "\nTotal: " << totalBytes / 1024 << " KB, sum of peaks " << totalPeakBytes / 1024 << " KB";
+            return buffer.str();
+        }
+
+        bool MemoryRegistry::writeJson(const String& path) {
+            const UsageList tags = usage();
+
+            std::ofstream stream(path.c_str());
+            if (!stream.is_open())
+                return false;
+
+            stream << "{\"tags\":[";
+            for (size_t i = 0; i < tags.size(); i++) {
+                const Usage& tag = tags[i];
+                if (i > 0)
+                    stream << ",";
+                stream << "\n{\"name\":\"";
+                for (size_t j = 0; j < tag.name.size(); j++) {
+                    if (tag.name[j] == '"' || tag.name[j] == '\\')
+                        stream << '\\';
+                    stream << tag.name[j];
+                }
+                stream << "\",\"bytes\":" << tag.bytes;
+                stream << ",\"count\":" << tag.count;
+                stream << ",\"peakBytes\":" << tag.peakBytes;
+                stream << ",\"peakCount\":" << tag.peakCount << "}";
+            }
+            stream << "\n]}\n";
+            return stream.good();
+        }
+
+        String typeName(const std::type_info& type) {
+#if defined __GNUC__
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+            if (status == 0 && demangled != NULL) {
+                String result(demangled);
+                std::free(demangled);
+                return result;
+            }
+#endif
+            String result(type.name());
+            // MSVC prefixes the names with the kind of type
+            if (result.compare(0, 6, "class ") == 0)
+                return result.substr(6);
+            return result;
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__MemoryRegistry__
+#define __TrenchBroom__MemoryRegistry__
+
+#include "Utility/String.h"
+
+#include <cassert>
+#include <typeinfo>
+#include <vector>
+
+class wxCriticalSection;
+
+namespace TrenchBroom {
+    namespace Utility {
+        // Counts the live bytes and objects of one kind of allocation together with their high water marks. A tag
+        // registers itself with the memory registry for its whole lifetime, so tags should be static objects.
+        class MemoryTag {
+        public:
+            typedef enum {
+                // updated only by the main thread, so the counters are changed without locking the registry
+                Unshared,
+                // updated by worker threads too, so every update locks the registry
+                Shared
+            } Sharing;
+        private:
+            String m_name;
+            Sharing m_sharing;
+            size_t m_bytes;
+            size_t m_count;
+            size_t m_peakBytes;
+            size_t m_peakCount;
+
+            friend class MemoryRegistry;
+
+            // prevent copying
+            MemoryTag(const MemoryTag& other);
+            void operator= (const MemoryTag& other);
+
+            inline void apply(size_t addedBytes, size_t removedBytes, size_t addedCount, size_t removedCount) {
+                assert(m_bytes + addedBytes >= removedBytes);
+                assert(m_count + addedCount >= removedCount);
+                m_bytes = m_bytes + addedBytes - removedBytes;
+                m_count = m_count + addedCount - removedCount;
+                if (m_bytes > m_peakBytes)
+                    m_peakBytes = m_bytes;
+                if (m_count > m_peakCount)
+                    m_peakCount = m_count;
+            }
+
+            void update(size_t addedBytes, size_t removedBytes, size_t addedCount, size_t removedCount);
+        public:
+            MemoryTag(const String& name, Sharing sharing);
+            ~MemoryTag();
+
+            inline void allocate(size_t bytes, size_t count = 1) {
+                update(bytes, 0, count, 0);
+            }
+
+            inline void deallocate(size_t bytes, size_t count = 1) {
+                update(0, bytes, 0, count);
+            }
+
+            // adds or removes bytes without changing the object count
+            inline void resize(size_t oldBytes, size_t newBytes) {
+                if (newBytes > oldBytes)
+                    update(newBytes - oldBytes, 0, 0, 0);
+                else if (newBytes < oldBytes)
+                    update(0, oldBytes - newBytes, 0, 0);
+            }
+        };
+
+        class MemoryRegistry {
+        public:
+            struct Usage {
+                String name;
+                size_t bytes;
+                size_t count;
+                size_t peakBytes;
+                size_t peakCount;
+            };
+            typedef std::vector<Usage> UsageList;
+        private:
+            typedef std::vector<MemoryTag*> TagList;
+
+            TagList m_tags;
+            // not a member to keep wxWidgets out of this header, which is included by the allocator
+            wxCriticalSection* m_lock;
+
+            MemoryRegistry();
+            ~MemoryRegistry();
+
+            friend class MemoryTag;
+            void addTag(MemoryTag& tag);
+            void removeTag(MemoryTag& tag);
+            void updateShared(MemoryTag& tag, size_t addedBytes, size_t removedBytes, size_t addedCount, size_t removedCount);
+        public:
+            static MemoryRegistry& registry();
+
+            // sorted by name
+            UsageList usage();
+            void resetPeaks();
+
+            String summaryString();
+            bool writeJson(const String& path);
+        };
+
+        inline void MemoryTag::update(size_t addedBytes, size_t removedBytes, size_t addedCount, size_t removedCount) {
+            if (m_sharing == Unshared)
+                apply(addedBytes, removedBytes, addedCount, removedCount);
+            else
+                MemoryRegistry::registry().updateShared(*this, addedBytes, removedBytes, addedCount, removedCount);
+        }
+
+        // returns a readable name for the given type
+        String typeName(const std::type_info& type);
+    }
+}
+
+#endif /* defined(__TrenchBroom__MemoryRegistry__) */
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "PointBuffer.h"
+
+#if defined __SSE__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 1)
+#define TB_POINTBUFFER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace TrenchBroom {
+    namespace VecMath {
+        PointBuffer::Counts PointBuffer::classify(const Vec3f& origin, const Vec3f& normal, float offset, float epsilon, PointStatus::Type* statuses) const {
+            Counts counts;
+            const size_t count = size();
+            if (count == 0)
+                return counts;
+
+            const float* xs = &m_x[0];
+            const float* ys = &m_y[0];
+            const float* zs = &m_z[0];
+            size_t i = 0;
+
+#ifdef TB_POINTBUFFER_SSE
+            // number of set bits in a four bit mask
+            static const size_t BitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+            const __m128 ox = _mm_set1_ps(origin.x());
+            const __m128 oy = _mm_set1_ps(origin.y());
+            const __m128 oz = _mm_set1_ps(origin.z());
+            const __m128 nx = _mm_set1_ps(normal.x());
+            const __m128 ny = _mm_set1_ps(normal.y());
+            const __m128 nz = _mm_set1_ps(normal.z());
+            const __m128 off = _mm_set1_ps(offset);
+            const __m128 posEps = _mm_set1_ps(epsilon);
+            const __m128 negEps = _mm_set1_ps(-epsilon);
+
+            for (; i + 4 <= count; i += 4) {
+                __m128 dist = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(xs + i), ox), nx);
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ys + i), oy), ny));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(zs + i), oz), nz));
+                dist = _mm_sub_ps(dist, off);
+
+                const int aboveMask = _mm_movemask_ps(_mm_cmpgt_ps(dist, posEps));
+                const int belowMask = _mm_movemask_ps(_mm_cmplt_ps(dist, negEps));
+                counts.above += BitCount[aboveMask];
+                counts.below += BitCount[belowMask];
+
+                if (statuses != NULL) {
+                    for (size_t j = 0; j < 4; j++) {
+                        if ((aboveMask >> j) & 1)
+                            statuses[i + j] = PointStatus::PSAbove;
+                        else if ((belowMask >> j) & 1)
+                            statuses[i + j] = PointStatus::PSBelow;
+                        else
+                            statuses[i + j] = PointStatus::PSInside;
+                    }
+                }
+            }
+            counts.inside = i - counts.above - counts.below;
+#endif
+
+            // remaining points, or all points if SSE is not available
+            for (; i < count; i++) {
+                const float dist = (xs[i] - origin.x()) * normal.x() + (ys[i] - origin.y()) * normal.y() + (zs[i] - origin.z()) * normal.z() - offset;
+                PointStatus::Type status;
+                if (dist > epsilon) {
+                    status = PointStatus::PSAbove;
+                    counts.above++;
+                } else if (dist < -epsilon) {
+                    status = PointStatus::PSBelow;
+                    counts.below++;
+                } else {
+                    status = PointStatus::PSInside;
+                    counts.inside++;
+                }
+                if (statuses != NULL)
+                    statuses[i] = status;
+            }
+
+            return counts;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__PointBuffer__
+#define __TrenchBroom__PointBuffer__
+
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace VecMath {
+        // Stores points as separate coordinate arrays so that they can be classified against a plane four at a time.
+        class PointBuffer {
+        public:
+            struct Counts {
+                size_t above;
+                size_t below;
+                size_t inside;
+
+                Counts() : above(0), below(0), inside(0) {}
+            };
+        private:
+            std::vector<float> m_x;
+            std::vector<float> m_y;
+            std::vector<float> m_z;
+        public:
+            inline void reserve(size_t capacity) {
+                m_x.reserve(capacity);
+                m_y.reserve(capacity);
+                m_z.reserve(capacity);
+            }
+
+            inline void clear() {
+                m_x.clear();
+                m_y.clear();
+                m_z.clear();
+            }
+
+            inline void add(const Vec3f& point) {
+                m_x.push_back(point.x());
+                m_y.push_back(point.y());
+                m_z.push_back(point.z());
+            }
+
+            inline size_t size() const {
+                return m_x.size();
+            }
+
+            // Classifies every point by its signed distance dot(point - origin, normal) - offset and returns the number
+            // of points in each class. If statuses is not NULL, it receives the status of each point. The distances are
+            // computed in the same order as Plane::pointStatus and Ray::pointStatus, so the results are identical.
+            Counts classify(const Vec3f& origin, const Vec3f& normal, float offset, float epsilon, PointStatus::Type* statuses = NULL) const;
+
+            inline Counts classify(const Planef& plane, float epsilon, PointStatus::Type* statuses = NULL) const {
+                return classify(Vec3f::Null, plane.normal, plane.distance, epsilon, statuses);
+            }
+
+            inline Counts classify(const Rayf& ray, PointStatus::Type* statuses = NULL) const {
+                return classify(ray.origin, ray.direction, 0.0f, Math<float>::PointStatusEpsilon, statuses);
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__PointBuffer__) */
@@ -44,6 +44,7 @@ namespace TrenchBroom {
         const Preference<float> RendererBrightness = Preference<float>(                         "Renderer/Brightness",                                          1.0f);
         const Preference<float> GridAlpha = Preference<float>(                                  "Renderer/Grid Alpha",                                          0.25f);
         const Preference<bool>  GridCheckerboard = Preference<bool>(                            "Renderer/Grid Checkerboard",                                   false);
+        const Preference<bool>  RendererOcclusionCulling = Preference<bool>(                    "Renderer/Occlusion culling",                                   true);
 
         const Preference<Color> EntityRotationDecoratorFillColor = Preference<Color>(           "Renderer/Colors/Decorators/Entity rotation fill color",        Color(1.0f,  0.0f,  0.0f,  0.3f ));
         const Preference<Color> EntityRotationDecoratorOutlineColor = Preference<Color>(        "Renderer/Colors/Decorators/Entity rotation outline color",     Color(1.0f,  1.0f,  1.0f,  0.7f ));
@@ -158,6 +159,7 @@ namespace TrenchBroom {
         const int               RendererInstancingModeAutodetect    = 0;
         const int               RendererInstancingModeForceOn       = 1;
         const int               RendererInstancingModeForceOff      = 2;
+        const Preference<bool>  UseMapCache = Preference<bool>(                                 "General/Use map cache",                                        true);
 
         const Preference<KeyboardShortcut>  CameraMoveForward = Preference<KeyboardShortcut>(   "Controls/Camera/Move Forward",     KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'W', KeyboardShortcut::SCAny, "Move Camera Forward"));
         const Preference<KeyboardShortcut>  CameraMoveBackward = Preference<KeyboardShortcut>(  "Controls/Camera/Move Backward",    KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'S', KeyboardShortcut::SCAny, "Move Camera Backward"));
@@ -306,6 +308,7 @@ namespace TrenchBroom {
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectSiblings, WXK_CONTROL, WXK_ALT, 'A', KeyboardShortcut::SCAny, "Select Siblings"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectTouching, WXK_CONTROL, 'T', KeyboardShortcut::SCAny, "Select Touching"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectByFilePosition, KeyboardShortcut::SCAny, "Select by Line Number"));
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectByProperty, KeyboardShortcut::SCAny, "Select by Property"));
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectNone, WXK_CONTROL, WXK_SHIFT, 'A', KeyboardShortcut::SCAny, "Select None"));
             editMenu->addSeparator();
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditHideSelected, WXK_CONTROL, 'H', KeyboardShortcut::SCAny, "Hide Selected"));
@@ -419,6 +422,7 @@ namespace TrenchBroom {
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditNavigateUp, WXK_ESCAPE, KeyboardShortcut::SCAny, "Navigate Up"));
 #endif
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditShowMapProperties, KeyboardShortcut::SCAny, "Map Properties..."));
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditValidateMap, KeyboardShortcut::SCAny, "Validate Map..."));
 
             Menu* viewMenu = new Menu("View");
             menus[ViewMenu] = Menu::Ptr(viewMenu);
@@ -447,6 +451,14 @@ namespace TrenchBroom {
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToEntityTab, '1', KeyboardShortcut::SCAny, "Switch to Entity Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToFaceTab, '2', KeyboardShortcut::SCAny, "Switch to Face Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToViewTab, '3', KeyboardShortcut::SCAny, "Switch to View Inspector"));
+
+            viewMenu->addSeparator();
+            Menu& profilingMenu = viewMenu->addMenu("Profiling");
+            profilingMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewPrintTraceSummary, KeyboardShortcut::SCAny, "Print Summary"));
+            profilingMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSaveTrace, KeyboardShortcut::SCAny, "Save Trace..."));
+            profilingMenu.addSeparator();
+            profilingMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewPrintMemoryUsage, KeyboardShortcut::SCAny, "Print Memory Usage"));
+            profilingMenu.addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSaveMemoryReport, KeyboardShortcut::SCAny, "Save Memory Report..."));
             return menus;
         }
 
@@ -0,0 +1,149 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace TrenchBroom {
+    namespace Utility {
+        Tracer Tracer::Instance;
+
+        bool Tracer::NameOrder::operator()(const char* lhs, const char* rhs) const {
+            return std::strcmp(lhs, rhs) < 0;
+        }
+
+        Tracer::Tracer() :
+        m_nextEvent(0) {
+            m_events.reserve(MaxEvents);
+        }
+
+        void Tracer::record(const char* name, wxLongLong start, wxLongLong end) {
+            Event event;
+            event.name = name;
+            event.threadId = static_cast<unsigned long>(wxThread::GetCurrentId());
+            event.start = start;
+            event.duration = (end - start).ToLong();
+
+            wxCriticalSectionLocker lock(m_lock);
+            if (m_events.size() < MaxEvents) {
+                m_events.push_back(event);
+            } else {
+                m_events[m_nextEvent] = event;
+                m_nextEvent = (m_nextEvent + 1) % MaxEvents;
+            }
+
+            ZoneStats& stats = m_zones[name];
+            stats.count++;
+            stats.total += event.duration;
+            if (stats.samples.size() < MaxSamples) {
+                stats.samples.push_back(event.duration);
+            } else {
+                stats.samples[stats.nextSample] = event.duration;
+                stats.nextSample = (stats.nextSample + 1) % MaxSamples;
+            }
+        }
+
+        void Tracer::clear() {
+            wxCriticalSectionLocker lock(m_lock);
+            m_events.clear();
+            m_nextEvent = 0;
+            m_zones.clear();
+        }
+
+        Tracer::ZoneSummaryList Tracer::summary() {
+            ZoneSummaryList result;
+
+            wxCriticalSectionLocker lock(m_lock);
+            ZoneStatsMap::const_iterator it, end;
+            for (it = m_zones.begin(), end = m_zones.end(); it != end; ++it) {
+                const ZoneStats& stats = it->second;
+                std::vector<long> samples = stats.samples;
+
+                ZoneSummary zone;
+                zone.name = it->first;
+                zone.count = stats.count;
+                zone.totalMillis = stats.total.ToDouble() / 1000.0;
+
+                const size_t p50 = samples.size() / 2;
+                std::nth_element(samples.begin(), samples.begin() + p50, samples.end());
+                zone.p50Millis = samples[p50] / 1000.0;
+
+                const size_t p99 = (samples.size() * 99) / 100;
+                std::nth_element(samples.begin(), samples.begin() + p99, samples.end());
+                zone.p99Millis = samples[p99] / 1000.0;
+
+                result.push_back(zone);
+            }
+            return result;
+        }
+
+        String Tracer::summaryString() {
+            const ZoneSummaryList zones = summary();
+            if (zones.empty())
+                return "No trace zones recorded";
+
+            StringStream buffer;
+            buffer << std::fixed << std::setprecision(3);
+            buffer << "Zone: count, total ms, p50 ms, p99 ms";
+            for (size_t i = 0; i < zones.size(); i++) {
+                const ZoneSummary& zone = zones[i];
+                buffer << "\n" << zone.name << ": " << zone.count << ", " << zone.totalMillis << ", " << zone.p50Millis << ", " << zone.p99Millis;
+            }
+            return buffer.str();
+        }
+
+        bool Tracer::writeChromeTrace(const String& path) {
+            EventList events;
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                // oldest event first
+                events.reserve(m_events.size());
+                events.insert(events.end(), m_events.begin() + static_cast<EventList::difference_type>(m_nextEvent), m_events.end());
+                events.insert(events.end(), m_events.begin(), m_events.begin() + static_cast<EventList::difference_type>(m_nextEvent));
+            }
+
+            std::ofstream stream(path.c_str());
+            if (!stream.is_open())
+                return false;
+
+            stream << "{\"traceEvents\":[";
+            for (size_t i = 0; i < events.size(); i++) {
+                const Event& event = events[i];
+                if (i > 0)
+                    stream << ",";
+                stream << "\n{\"name\":\"";
+                for (const char* c = event.name; *c != 0; c++) {
+                    if (*c == '"' || *c == '\\')
+                        stream << '\\';
+                    stream << *c;
+                }
+                stream << "\",\"ph\":\"X\",\"ts\":" << event.start.ToString().ToStdString();
+                stream << ",\"dur\":" << event.duration;
+                stream << ",\"pid\":1,\"tid\":" << event.threadId << "}";
+            }
+            stream << "\n]}\n";
+            return stream.good();
+        }
+    }
+}
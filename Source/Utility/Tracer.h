@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__Tracer__
+#define __TrenchBroom__Tracer__
+
+#include "Utility/String.h"
+
+#include <wx/longlong.h>
+#include <wx/stopwatch.h>
+#include <wx/thread.h>
+
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        // Records the durations of named zones. The most recent events are kept in a ring buffer that can be written
+        // as a Chrome trace event file, and a rolling summary is kept for each zone. Zone names must be string
+        // literals since only the pointers are stored. Zones should wrap bulk operations rather than the work done for
+        // a single object, which would quickly push everything else out of the ring buffer.
+        class Tracer {
+        public:
+            struct ZoneSummary {
+                String name;
+                size_t count;
+                double totalMillis;
+                double p50Millis;
+                double p99Millis;
+            };
+            typedef std::vector<ZoneSummary> ZoneSummaryList;
+        private:
+            struct Event {
+                const char* name;
+                unsigned long threadId;
+                wxLongLong start;
+                long duration;
+            };
+            typedef std::vector<Event> EventList;
+
+            struct ZoneStats {
+                size_t count;
+                wxLongLong total;
+                std::vector<long> samples;
+                size_t nextSample;
+
+                ZoneStats() : count(0), total(0), nextSample(0) {}
+            };
+
+            struct NameOrder {
+                bool operator()(const char* lhs, const char* rhs) const;
+            };
+            typedef std::map<const char*, ZoneStats, NameOrder> ZoneStatsMap;
+
+            static const size_t MaxEvents = 1 << 16;
+            static const size_t MaxSamples = 512;
+            static Tracer Instance;
+
+            wxCriticalSection m_lock;
+            wxStopWatch m_clock;
+            EventList m_events;
+            size_t m_nextEvent;
+            ZoneStatsMap m_zones;
+
+            Tracer();
+        public:
+            inline static Tracer& tracer() {
+                return Instance;
+            }
+
+            // microseconds since the tracer was created
+            inline wxLongLong now() const {
+                return m_clock.TimeInMicro();
+            }
+
+            void record(const char* name, wxLongLong start, wxLongLong end);
+            void clear();
+
+            ZoneSummaryList summary();
+            String summaryString();
+            bool writeChromeTrace(const String& path);
+        };
+
+        class TraceZone {
+        private:
+            const char* m_name;
+            wxLongLong m_start;
+        public:
+            TraceZone(const char* name) :
+            m_name(name),
+            m_start(Tracer::tracer().now()) {}
+
+            ~TraceZone() {
+                Tracer& tracer = Tracer::tracer();
+                tracer.record(m_name, m_start, tracer.now());
+            }
+        };
+    }
+}
+
+// Define TB_DISABLE_TRACING to compile out all trace zones.
+#ifndef TB_DISABLE_TRACING
+#define TB_TRACE_CONCAT2(a, b) a##b
+#define TB_TRACE_CONCAT(a, b) TB_TRACE_CONCAT2(a, b)
+#define TRACE_ZONE(name) TrenchBroom::Utility::TraceZone TB_TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define TRACE_ZONE(name)
+#endif
+
+#endif /* defined(__TrenchBroom__Tracer__) */
@@ -37,6 +37,10 @@
 
 namespace TrenchBroom {
     namespace View {
+        namespace AngleEditorUniforms {
+            static const Renderer::Uniform Color("Color");
+        }
+
         BEGIN_EVENT_TABLE(AngleEditorCanvas, wxGLCanvas)
         EVT_PAINT(AngleEditorCanvas::OnPaint)
         END_EVENT_TABLE()
@@ -128,7 +132,7 @@ namespace TrenchBroom {
                 Renderer::ApplyModelMatrix apply(transformation, matrix);
 
                 Renderer::ActivateShader handleShader(m_sharedResources.shaderManager(), Renderer::Shaders::HandleShader);
-                handleShader.setUniformVariable("Color", Color(1.0f, 1.0f, 1.0f, 1.0f));
+                handleShader.setUniformVariable(AngleEditorUniforms::Color, Color(1.0f, 1.0f, 1.0f, 1.0f));
                 circleArray.render();
 
                 Renderer::ActivateShader coloredShader(m_sharedResources.shaderManager(), Renderer::Shaders::ColoredHandleShader);
@@ -88,7 +88,7 @@ namespace TrenchBroom {
             }
 
             inline bool intersectsY(float y, float height) const {
-                return bottom() >= y || top() <= y + height;
+                return bottom() >= y && top() <= y + height;
             }
         };
 
@@ -169,7 +169,7 @@ namespace TrenchBroom {
                 doLayout(maxUpScale, minWidth, maxWidth, minHeight, maxHeight);
             }
 
-            inline CellType item() const {
+            inline const CellType& item() const {
                 return m_item;
             }
 
@@ -352,15 +352,20 @@ namespace TrenchBroom {
                 }
             }
 
+            // returns the index of the first row whose bottom is below the given y coordinate
             size_t indexOfRowAt(float y) const {
-                for (size_t i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y < rowBounds.bottom())
-                        return i;
+                size_t first = 0;
+                size_t count = m_rows.size();
+                while (count > 0) {
+                    const size_t step = count / 2;
+                    if (m_rows[first + step].bounds().bottom() <= y) {
+                        first += step + 1;
+                        count -= step + 1;
+                    } else {
+                        count = step;
+                    }
                 }
-                
-                return m_rows.size();
+                return first;
             }
             
             bool rowAt(float y, const Row** result) const {
@@ -373,7 +378,7 @@ namespace TrenchBroom {
             }
             
             bool cellAt(float x, float y, const typename Row::Cell** result) const {
-                for (unsigned int i = 0; i < m_rows.size(); i++) {
+                for (size_t i = indexOfRowAt(y); i < m_rows.size(); i++) {
                     const Row& row = m_rows[i];
                     const LayoutBounds& rowBounds = row.bounds();
                     if (y > rowBounds.bottom())
@@ -563,11 +568,30 @@ namespace TrenchBroom {
                 invalidate();
             }
 
+            // returns the index of the first group whose bottom is below the given y coordinate
+            size_t indexOfGroupAt(float y) {
+                if (!m_valid)
+                    validate();
+                
+                size_t first = 0;
+                size_t count = m_groups.size();
+                while (count > 0) {
+                    const size_t step = count / 2;
+                    if (m_groups[first + step].bounds().bottom() <= y) {
+                        first += step + 1;
+                        count -= step + 1;
+                    } else {
+                        count = step;
+                    }
+                }
+                return first;
+            }
+            
             bool cellAt(float x, float y, const typename Group::Row::Cell** result) {
                 if (!m_valid)
                     validate();
 
-                for (unsigned int i = 0; i < m_groups.size(); i++) {
+                for (size_t i = indexOfGroupAt(y); i < m_groups.size(); i++) {
                     const Group& group = m_groups[i];
                     const LayoutBounds groupBounds = group.bounds();
                     if (y > groupBounds.bottom())
@@ -42,7 +42,6 @@ namespace TrenchBroom {
             typedef CellLayout<CellData, GroupData> Layout;
         private:
             Layout m_layout;
-            typename Layout::Group::Row::Cell* m_selectedCell;
             bool m_layoutInitialized;
 
             wxGLContext* m_glContext;
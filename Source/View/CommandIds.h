@@ -126,6 +126,12 @@ namespace TrenchBroom {
                 static const int EditFaceActions                    = Lowest + 100;
                 static const int EditPrintFilePositions             = Lowest + 101;
                 static const int EditToggleAxisRestriction          = Lowest + 102;
+                static const int EditValidateMap                    = Lowest + 103;
+                static const int ViewPrintTraceSummary              = Lowest + 104;
+                static const int ViewSaveTrace                      = Lowest + 105;
+                static const int ViewPrintMemoryUsage               = Lowest + 106;
+                static const int ViewSaveMemoryReport               = Lowest + 107;
+                static const int EditSelectByProperty               = Lowest + 108;
                 static const int Highest                            = Lowest + 199;
             }
             
@@ -233,6 +239,12 @@ namespace TrenchBroom {
                 static const int ForceIntCoordsId                   = Lowest +   9;
                 static const int Highest                            = Lowest +  99;
             }
+
+            namespace MapIssuesDialog {
+                static const int Lowest                             = MapPropertiesDialog::Highest + 1;
+                static const int IssueListId                        = Lowest +   1;
+                static const int Highest                            = Lowest +  99;
+            }
         }
     }
 }
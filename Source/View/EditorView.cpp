@@ -53,13 +53,17 @@
 #include "Renderer/Camera.h"
 #include "Renderer/EntityModelRendererManager.h"
 #include "Renderer/MapRenderer.h"
+#include "Renderer/RenderStatistics.h"
 #include "Renderer/SharedResources.h"
+#include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/TextureRendererManager.h"
 #include "Utility/CommandProcessor.h"
 #include "Utility/Console.h"
 #include "Utility/Grid.h"
 #include "Utility/List.h"
+#include "Utility/MemoryRegistry.h"
 #include "Utility/Preferences.h"
+#include "Utility/Tracer.h"
 #include "View/AbstractApp.h"
 #include "View/CameraAnimation.h"
 #include "View/CommandIds.h"
@@ -69,11 +73,13 @@
 #include "View/FlashSelectionAnimation.h"
 #include "View/Inspector.h"
 #include "View/MapGLCanvas.h"
+#include "View/MapIssuesDialog.h"
 #include "View/MapPropertiesDialog.h"
 #include "View/ViewOptions.h"
 
 #include <wx/clipbrd.h>
 #include <wx/dataobj.h>
+#include <wx/filedlg.h>
 #include <wx/tokenzr.h>
 
 namespace TrenchBroom {
@@ -105,6 +111,7 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::EditSelectSiblings, EditorView::OnEditSelectSiblings)
         EVT_MENU(CommandIds::Menu::EditSelectTouching, EditorView::OnEditSelectTouching)
         EVT_MENU(CommandIds::Menu::EditSelectByFilePosition, EditorView::OnEditSelectByFilePosition)
+        EVT_MENU(CommandIds::Menu::EditSelectByProperty, EditorView::OnEditSelectByProperty)
         EVT_MENU(CommandIds::Menu::EditSelectNone, EditorView::OnEditSelectNone)
 
         EVT_MENU(CommandIds::Menu::EditHideSelected, EditorView::OnEditHideSelected)
@@ -174,6 +181,7 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::EditToggleTextureLock, EditorView::OnEditToggleTextureLock)
         EVT_MENU(CommandIds::Menu::EditNavigateUp, EditorView::OnEditNavigateUp)
         EVT_MENU(CommandIds::Menu::EditShowMapProperties, EditorView::OnEditShowMapProperties)
+        EVT_MENU(CommandIds::Menu::EditValidateMap, EditorView::OnEditValidateMap)
 
         EVT_MENU(CommandIds::Menu::ViewToggleShowGrid, EditorView::OnViewToggleShowGrid)
         EVT_MENU(CommandIds::Menu::ViewToggleSnapToGrid, EditorView::OnViewToggleSnapToGrid)
@@ -194,6 +202,10 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::ViewSwitchToEntityTab, EditorView::OnViewSwitchToEntityInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToFaceTab, EditorView::OnViewSwitchToFaceInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToViewTab, EditorView::OnViewSwitchToViewInspector)
+        EVT_MENU(CommandIds::Menu::ViewPrintTraceSummary, EditorView::OnViewPrintTraceSummary)
+        EVT_MENU(CommandIds::Menu::ViewSaveTrace, EditorView::OnViewSaveTrace)
+        EVT_MENU(CommandIds::Menu::ViewPrintMemoryUsage, EditorView::OnViewPrintMemoryUsage)
+        EVT_MENU(CommandIds::Menu::ViewSaveMemoryReport, EditorView::OnViewSaveMemoryReport)
 
         EVT_UPDATE_UI(wxID_SAVE, EditorView::OnUpdateMenuItem)
         EVT_UPDATE_UI(wxID_UNDO, EditorView::OnUpdateMenuItem)
@@ -402,12 +414,12 @@ namespace TrenchBroom {
 
             for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                 const Model::Brush& brush = **brushIt;
-                const Model::VertexList& vertices = brush.vertices();
-                Model::VertexList::const_iterator vertexIt, vertexEnd;
+                const Vec3f::List& vertices = brush.vertices();
+                Vec3f::List::const_iterator vertexIt, vertexEnd;
                 for (vertexIt = vertices.begin(), vertexEnd = vertices.end(); vertexIt != vertexEnd; ++vertexIt) {
-                    const Model::Vertex& vertex = **vertexIt;
+                    const Vec3f& vertex = *vertexIt;
 
-                    const Vec3f toPosition = vertex.position - m_camera->position();
+                    const Vec3f toPosition = vertex - m_camera->position();
                     minDist = std::min(minDist, toPosition.dot(m_camera->direction()));
                 }
             }
@@ -449,14 +461,14 @@ namespace TrenchBroom {
 
             for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                 const Model::Brush& brush = **brushIt;
-                const Model::VertexList& vertices = brush.vertices();
-                Model::VertexList::const_iterator vertexIt, vertexEnd;
+                const Vec3f::List& vertices = brush.vertices();
+                Vec3f::List::const_iterator vertexIt, vertexEnd;
                 for (vertexIt = vertices.begin(), vertexEnd = vertices.end(); vertexIt != vertexEnd; ++vertexIt) {
-                    const Model::Vertex& vertex = **vertexIt;
+                    const Vec3f& vertex = *vertexIt;
 
                     for (size_t i = 0; i < 4; i++) {
                         const Planef& plane = frustumPlanes[i];
-                        float dist = (vertex.position - m_camera->position()).dot(plane.normal) + 8.0f; // adds a bit of a border
+                        float dist = (vertex - m_camera->position()).dot(plane.normal) + 8.0f; // adds a bit of a border
                         offset = std::min(offset, dist / m_camera->direction().dot(plane.normal));
                     }
                 }
@@ -1111,6 +1123,48 @@ namespace TrenchBroom {
             }
         }
 
+        void EditorView::OnEditSelectByProperty(wxCommandEvent& event) {
+            wxString string = wxGetTextFromUser(wxT("Enter a property key or a key and value in the form key=value."), wxT("Select by Property"), wxT(""), GetFrame());
+            if (string.empty())
+                return;
+
+            const String input = string.ToStdString();
+            const size_t separator = input.find('=');
+            const String key = Utility::trim(input.substr(0, separator));
+            if (key.empty())
+                return;
+
+            const Model::EntityPropertyIndex& index = mapDocument().map().propertyIndex();
+            const Model::EntityList entities = separator == String::npos ? index.entities(key) : index.entities(key, Utility::trim(input.substr(separator + 1)));
+
+            Model::EntityList selectEntities;
+            Model::BrushList selectBrushes;
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                Model::Entity& entity = **entityIt;
+                if (entity.worldspawn())
+                    continue;
+
+                const Model::BrushList& entityBrushes = entity.brushes();
+                if (!entityBrushes.empty()) {
+                    const Model::BrushList brushes = m_filter->selectableBrushes(entityBrushes);
+                    selectBrushes.insert(selectBrushes.end(), brushes.begin(), brushes.end());
+                } else if (m_filter->entitySelectable(entity)) {
+                    selectEntities.push_back(&entity);
+                }
+            }
+
+            if (!selectEntities.empty() || !selectBrushes.empty()) {
+                wxCommand* command = Controller::ChangeEditStateCommand::replace(mapDocument(), selectEntities, selectBrushes);
+                submit(command);
+                StringStream message;
+                message << "Selected " << selectEntities.size() << " " << (selectEntities.size() == 1 ? "entity" : "entities") << " and " << selectBrushes.size() << " " << (selectBrushes.size() == 1 ? "brush" : "brushes");
+                console().info(message.str());
+            } else {
+                console().info("No entities with the given property found");
+            }
+        }
+
         void EditorView::OnEditSelectNone(wxCommandEvent& event) {
             wxCommand* command = Controller::ChangeEditStateCommand::deselectAll(mapDocument());
             submit(command);
@@ -1550,6 +1604,17 @@ namespace TrenchBroom {
             dialog.ShowModal();
         }
 
+        void EditorView::OnEditValidateMap(wxCommandEvent& event) {
+            MapIssuesDialog dialog(GetFrame(), mapDocument());
+
+            wxPoint pos = GetFrame()->GetPosition();
+            pos.x += (GetFrame()->GetSize().x - dialog.GetSize().x) / 2;
+            pos.y += (GetFrame()->GetSize().y - dialog.GetSize().y) / 2;
+            dialog.SetPosition(pos);
+
+            dialog.ShowModal();
+        }
+
         void EditorView::OnViewToggleShowGrid(wxCommandEvent& event) {
             mapDocument().grid().toggleVisible();
             mapDocument().UpdateAllViews(NULL, new Controller::Command(Controller::Command::ChangeGrid));
@@ -1717,6 +1782,43 @@ namespace TrenchBroom {
             inspector().switchToInspector(2);
         }
 
+        void EditorView::OnViewPrintTraceSummary(wxCommandEvent& event) {
+            console().info(Utility::Tracer::tracer().summaryString());
+
+            const Renderer::RenderStatistics& statistics = mapDocument().sharedResources().shaderManager().statistics();
+            console().info("GL calls in the last frame: %u issued, %u skipped",
+                           static_cast<unsigned int>(statistics.lastFrameGlCalls()),
+                           static_cast<unsigned int>(statistics.lastFrameSkippedGlCalls()));
+        }
+
+        void EditorView::OnViewSaveTrace(wxCommandEvent& event) {
+            wxFileDialog saveDialog(GetFrame(), wxT("Save trace file"), wxT(""), wxT("trace.json"), wxT("JSON files (*.json)|*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (saveDialog.ShowModal() != wxID_OK)
+                return;
+
+            const String path = saveDialog.GetPath().ToStdString();
+            if (Utility::Tracer::tracer().writeChromeTrace(path))
+                console().info("Saved trace to %s", path.c_str());
+            else
+                console().error("Could not write trace file %s", path.c_str());
+        }
+
+        void EditorView::OnViewPrintMemoryUsage(wxCommandEvent& event) {
+            console().info(Utility::MemoryRegistry::registry().summaryString());
+        }
+
+        void EditorView::OnViewSaveMemoryReport(wxCommandEvent& event) {
+            wxFileDialog saveDialog(GetFrame(), wxT("Save memory report"), wxT(""), wxT("memory.json"), wxT("JSON files (*.json)|*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (saveDialog.ShowModal() != wxID_OK)
+                return;
+
+            const String path = saveDialog.GetPath().ToStdString();
+            if (Utility::MemoryRegistry::registry().writeJson(path))
+                console().info("Saved memory report to %s", path.c_str());
+            else
+                console().error("Could not write memory report %s", path.c_str());
+        }
+
         void EditorView::OnUpdateMenuItem(wxUpdateUIEvent& event) {
             AbstractApp* app = static_cast<AbstractApp*>(wxTheApp);
             if (app->preferencesFrame() != NULL) {
@@ -1760,6 +1862,10 @@ namespace TrenchBroom {
                     event.Enable(editStateManager.selectionMode() == Model::EditStateManager::SMBrushes &&
                                  editStateManager.selectedBrushes().size() == 1);
                     break;
+                case CommandIds::Menu::EditSelectByFilePosition:
+                case CommandIds::Menu::EditSelectByProperty:
+                    event.Enable(true);
+                    break;
                 case CommandIds::Menu::EditSelectNone:
                     event.Enable(editStateManager.selectionMode() != Model::EditStateManager::SMNone);
                     break;
@@ -1896,6 +2002,7 @@ namespace TrenchBroom {
                     event.Enable(editStateManager.selectionMode() != Model::EditStateManager::SMNone);
                     break;
                 case CommandIds::Menu::EditShowMapProperties:
+                case CommandIds::Menu::EditValidateMap:
                     event.Enable(true);
                     break;
                 case CommandIds::Menu::EditCreatePointEntity:
@@ -1974,6 +2081,10 @@ namespace TrenchBroom {
                 case CommandIds::Menu::ViewSwitchToEntityTab:
                 case CommandIds::Menu::ViewSwitchToFaceTab:
                 case CommandIds::Menu::ViewSwitchToViewTab:
+                case CommandIds::Menu::ViewPrintTraceSummary:
+                case CommandIds::Menu::ViewSaveTrace:
+                case CommandIds::Menu::ViewPrintMemoryUsage:
+                case CommandIds::Menu::ViewSaveMemoryReport:
                     event.Enable(true);
                     break;
             }
@@ -141,6 +141,7 @@ namespace TrenchBroom {
             void OnEditSelectSiblings(wxCommandEvent& event);
             void OnEditSelectTouching(wxCommandEvent& event);
             void OnEditSelectByFilePosition(wxCommandEvent& event);
+            void OnEditSelectByProperty(wxCommandEvent& event);
             void OnEditSelectNone(wxCommandEvent& event);
             
             void OnEditHideSelected(wxCommandEvent& event);
@@ -210,6 +211,7 @@ namespace TrenchBroom {
             void OnEditToggleTextureLock(wxCommandEvent& event);
             void OnEditNavigateUp(wxCommandEvent& event);
             void OnEditShowMapProperties(wxCommandEvent& event);
+            void OnEditValidateMap(wxCommandEvent& event);
             
             void OnViewToggleShowGrid(wxCommandEvent& event);
             void OnViewToggleSnapToGrid(wxCommandEvent& event);
@@ -230,6 +232,10 @@ namespace TrenchBroom {
             void OnViewSwitchToEntityInspector(wxCommandEvent& event);
             void OnViewSwitchToFaceInspector(wxCommandEvent& event);
             void OnViewSwitchToViewInspector(wxCommandEvent& event);
+            void OnViewPrintTraceSummary(wxCommandEvent& event);
+            void OnViewSaveTrace(wxCommandEvent& event);
+            void OnViewPrintMemoryUsage(wxCommandEvent& event);
+            void OnViewSaveMemoryReport(wxCommandEvent& event);
             
             void OnUpdateMenuItem(wxUpdateUIEvent& event);
             
@@ -40,6 +40,15 @@
 
 namespace TrenchBroom {
     namespace View {
+        namespace EntityBrowserCanvasUniforms {
+            static const Renderer::Uniform Color("Color");
+            static const Renderer::Uniform ApplyTinting("ApplyTinting");
+            static const Renderer::Uniform Brightness("Brightness");
+            static const Renderer::Uniform GrayScale("GrayScale");
+            static const Renderer::Uniform Texture("Texture");
+            static const Renderer::Uniform Offset("Offset");
+        }
+
         void EntityBrowserCanvas::addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font) {
             if ((!m_hideUnused || definition->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(definition->name(), m_filterText, false))) {
                 Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
@@ -78,7 +87,7 @@ namespace TrenchBroom {
                                       translationMatrix(-bounds.center()));
            
             Renderer::ApplyModelMatrix applyItemMatrix(transformation, itemMatrix);
-            boundsProgram.setUniformVariable("Color", definition.color());
+            boundsProgram.setUniformVariable(EntityBrowserCanvasUniforms::Color, definition.color());
 
             // TODO: use a vertex buffer here!
             Vec3f::List vertices;
@@ -124,6 +133,7 @@ namespace TrenchBroom {
 
             Renderer::Text::FontDescriptor font(fontName, static_cast<unsigned int>(fontSize));
             IO::FileManager fileManager;
+            m_modelLoadGeneration = m_modelRendererManager.loadGeneration();
 
             if (m_group) {
                 Model::EntityDefinitionManager::EntityDefinitionGroups groups = definitionManager.groups(Model::EntityDefinition::PointEntity, m_sortOrder);
@@ -245,9 +255,9 @@ namespace TrenchBroom {
 
             { // render models
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
-                shader.setUniformVariable("ApplyTinting", false);
-                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                shader.setUniformVariable("GrayScale", false);
+                shader.setUniformVariable(EntityBrowserCanvasUniforms::ApplyTinting, false);
+                shader.setUniformVariable(EntityBrowserCanvasUniforms::Brightness, prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable(EntityBrowserCanvasUniforms::GrayScale, false);
 
                 modelRendererManager.activate();
                 for (unsigned int i = 0; i < layout.size(); i++) {
@@ -296,7 +306,7 @@ namespace TrenchBroom {
 
                 Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::BrowserGroupShader);
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserGroupBackgroundColor));
+                shader.setUniformVariable(EntityBrowserCanvasUniforms::Color, prefs.getColor(Preferences::BrowserGroupBackgroundColor));
                 vertexArray.render();
             }
 
@@ -317,8 +327,9 @@ namespace TrenchBroom {
 
                     Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                     Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
-                    shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
-                    shader.setUniformVariable("Texture", 0);
+                    shader.setUniformVariable(EntityBrowserCanvasUniforms::Color, prefs.getColor(Preferences::BrowserTextColor));
+                    shader.setUniformVariable(EntityBrowserCanvasUniforms::Texture, 0);
+                    shader.setUniformVariable(EntityBrowserCanvasUniforms::Offset, Vec3f::Null);
 
                     font->activate();
                     vertexArray.render();
@@ -373,8 +384,8 @@ namespace TrenchBroom {
             } else {
                 modelRendererManager.activate();
                 entityModelProgram.activate();
-                entityModelProgram.setUniformVariable("ApplyTinting", false);
-                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                entityModelProgram.setUniformVariable(EntityBrowserCanvasUniforms::ApplyTinting, false);
+                entityModelProgram.setUniformVariable(EntityBrowserCanvasUniforms::Brightness, prefs.getFloat(Preferences::RendererBrightness));
                 renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
                 entityModelProgram.deactivate();
                 modelRendererManager.deactivate();
@@ -398,6 +409,8 @@ namespace TrenchBroom {
         EntityBrowserCanvas::EntityBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder) :
         CellLayoutGLCanvas(parent, windowId, documentViewHolder.document().sharedResources().attribs(), documentViewHolder.document().sharedResources().sharedContext(), scrollBar),
         m_documentViewHolder(documentViewHolder),
+        m_modelRendererManager(documentViewHolder.document().sharedResources().modelRendererManager()),
+        m_modelLoadGeneration(0),
         m_offscreenRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
         m_vbo(NULL),
         m_group(false),
@@ -406,12 +419,24 @@ namespace TrenchBroom {
             const Quatf hRotation = Quatf(Math<float>::radians(-30.0f), Vec3f::PosZ);
             const Quatf vRotation = Quatf(Math<float>::radians(20.0f), Vec3f::PosY);
             m_rotation = vRotation * hRotation;
+            m_modelRendererManager.addView(this);
+            Bind(wxEVT_COMMAND_THREAD, &EntityBrowserCanvas::OnModelsLoaded, this);
         }
 
         EntityBrowserCanvas::~EntityBrowserCanvas() {
+            m_modelRendererManager.removeView(this);
             clear();
             delete m_vbo;
             m_vbo = NULL;
         }
+
+        void EntityBrowserCanvas::OnModelsLoaded(wxThreadEvent& event) {
+            // models that were still loading when the layout was built have bounding box sized cells, the layout is
+            // rebuilt here rather than while painting so that no cell is replaced during a paint
+            if (m_modelLoadGeneration != m_modelRendererManager.loadGeneration())
+                reload();
+            else
+                Refresh();
+        }
     }
 }
@@ -36,6 +36,7 @@ namespace TrenchBroom {
 
     namespace Renderer {
         class EntityModelRenderer;
+        class EntityModelRendererManager;
         class ShaderProgram;
         class Vbo;
     }
@@ -62,6 +63,8 @@ namespace TrenchBroom {
         class EntityBrowserCanvas : public CellLayoutGLCanvas<EntityCellData, EntityGroupData> {
         protected:
             DocumentViewHolder& m_documentViewHolder;
+            Renderer::EntityModelRendererManager& m_modelRendererManager;
+            unsigned int m_modelLoadGeneration;
             Renderer::OffscreenRenderer m_offscreenRenderer;
             Renderer::Vbo* m_vbo;
             Quatf m_rotation;
@@ -86,6 +89,8 @@ namespace TrenchBroom {
             EntityBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder);
             ~EntityBrowserCanvas();
 
+            void OnModelsLoaded(wxThreadEvent& event);
+
             inline void setSortOrder(Model::EntityDefinitionManager::SortOrder sortOrder) {
                 if (sortOrder == m_sortOrder)
                     return;
@@ -24,10 +24,12 @@
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinition.h"
+#include "Model/Map.h"
 #include "Model/MapDocument.h"
 #include "Model/PropertyDefinition.h"
 #include "Utility/CommandProcessor.h"
 
+#include <map>
 #include <set>
 
 namespace TrenchBroom {
@@ -280,6 +282,10 @@ namespace TrenchBroom {
             EntryList newEntries;
             const Model::EntityList entities = m_document.editStateManager().allSelectedEntities();
             if (!entities.empty()) {
+                // maps the key of each entry to its index so that merging large selections does not scan the entries
+                typedef std::map<Model::PropertyKeyId, size_t> EntryIndex;
+                EntryIndex entryIndex;
+                
                 Model::EntityList::const_iterator entityIt, entityEnd;
                 for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
                     const Model::Entity& entity = **entityIt;
@@ -291,11 +297,12 @@ namespace TrenchBroom {
                         const Model::Property& property = *propertyIt;
                         const Model::PropertyDefinition* propertyDefinition = entityDefinition != NULL ? entityDefinition->propertyDefinition(property.key()) : NULL;
                         
-                        EntryList::iterator entryIt = findEntry(newEntries, property.key());
-                        if (entryIt != newEntries.end()) {
-                            entryIt->compareValue(property.value());
+                        EntryIndex::iterator indexIt = entryIndex.find(property.keyId());
+                        if (indexIt != entryIndex.end()) {
+                            newEntries[indexIt->second].compareValue(property.value());
                         } else {
                             const String tooltip = propertyDefinition != NULL ? propertyDefinition->description() : "";
+                            entryIndex[property.keyId()] = newEntries.size();
                             newEntries.push_back(Entry(property.key(), property.value(), tooltip, entities.size()));
                         }
                     }
@@ -322,7 +329,13 @@ namespace TrenchBroom {
             if (entry.multi())
                 return "";
             
-            return entry.tooltip;
+            // tell the user how common the value is, Edit > Select by Property selects all of these entities
+            const size_t count = m_document.map().propertyIndex().entityCount(entry.key, entry.value);
+            StringStream tooltip;
+            if (!entry.tooltip.empty())
+                tooltip << entry.tooltip << "\n\n";
+            tooltip << count << (count == 1 ? " entity has" : " entities have") << " this value";
+            return tooltip.str();
         }
     }
 }
@@ -24,6 +24,7 @@
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/Camera.h"
+#include "Renderer/EntityModelRendererManager.h"
 #include "Renderer/MapRenderer.h"
 #include "Renderer/OverlayRenderer.h"
 #include "Renderer/RenderContext.h"
@@ -136,6 +137,7 @@ namespace TrenchBroom {
         MapGLCanvas::MapGLCanvas(wxWindow* parent, DocumentViewHolder& documentViewHolder) :
         wxGLCanvas(parent, wxID_ANY, documentViewHolder.document().sharedResources().attribs()),
         m_documentViewHolder(documentViewHolder),
+        m_modelRendererManager(documentViewHolder.document().sharedResources().modelRendererManager()),
         m_glContext(new wxGLContext(this, documentViewHolder.document().sharedResources().sharedContext())),
         m_vbo(NULL),
         m_inputController(new Controller::InputController(documentViewHolder)),
@@ -143,12 +145,14 @@ namespace TrenchBroom {
         m_hasFocus(false),
         m_ignoreNextClick(false) {
             SetDropTarget(new MapGLCanvasDropTarget(this, *m_inputController));
+            m_modelRendererManager.addView(this);
         }
 
         MapGLCanvas::~MapGLCanvas() {
 			if (GetCapture() == this)
 				ReleaseMouse();
 
+            m_modelRendererManager.removeView(this);
             delete m_inputController;
             m_inputController = NULL;
             delete m_overlayRenderer;
@@ -288,6 +292,7 @@ namespace TrenchBroom {
                 }
 
 				SwapBuffers();
+                shaderManager.statistics().endFrame();
 			} else {
 				view.console().error("Unable to set current OpenGL context");
 			}
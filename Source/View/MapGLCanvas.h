@@ -39,6 +39,7 @@ namespace TrenchBroom {
     
     namespace Renderer {
         class Camera;
+        class EntityModelRendererManager;
         class MapRenderer;
         class OverlayRenderer;
         class Vbo;
@@ -72,6 +73,7 @@ namespace TrenchBroom {
         class MapGLCanvas : public wxGLCanvas {
         protected:
             DocumentViewHolder& m_documentViewHolder;
+            Renderer::EntityModelRendererManager& m_modelRendererManager;
             
             wxGLContext* m_glContext;
             Renderer::Vbo* m_vbo;
@@ -0,0 +1,195 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MapIssuesDialog.h"
+
+#include "Controller/ChangeEditStateCommand.h"
+#include "Model/Brush.h"
+#include "Model/MapDocument.h"
+#include "Utility/Console.h"
+#include "View/CommandIds.h"
+#include "View/LayoutConstants.h"
+
+#include <wx/listctrl.h>
+#include <wx/sizer.h>
+#include <wx/stattext.h>
+#include <wx/stopwatch.h>
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace View {
+        IMPLEMENT_DYNAMIC_CLASS(MapIssuesDialog, wxDialog)
+
+        BEGIN_EVENT_TABLE(MapIssuesDialog, wxDialog)
+        EVT_LIST_ITEM_SELECTED(CommandIds::MapIssuesDialog::IssueListId, MapIssuesDialog::OnIssueSelectionChanged)
+        EVT_LIST_ITEM_DESELECTED(CommandIds::MapIssuesDialog::IssueListId, MapIssuesDialog::OnIssueSelectionChanged)
+        EVT_BUTTON(wxID_CLOSE, MapIssuesDialog::OnCloseClicked)
+        END_EVENT_TABLE()
+
+        class MapValidationThread : public wxThread {
+        private:
+            wxEvtHandler& m_handler;
+            Model::MapValidator m_validator;
+            Model::MapIssue::List m_issues;
+            long m_time;
+        public:
+            MapValidationThread(wxEvtHandler& handler, Model::MapDocument& document) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_handler(handler),
+            m_validator(document.map(), document.octree()),
+            m_time(0) {}
+
+            ExitCode Entry() {
+                wxStopWatch watch;
+                const int cpuCount = wxThread::GetCPUCount();
+                m_issues = m_validator.validate(cpuCount > 0 ? static_cast<size_t>(cpuCount) : 1);
+                m_time = watch.Time();
+                m_handler.QueueEvent(new wxThreadEvent(wxEVT_COMMAND_THREAD));
+                return (wxThread::ExitCode)0;
+            }
+
+            // must only be called after the thread has finished
+            inline Model::MapIssue::List& issues() {
+                return m_issues;
+            }
+
+            inline long time() const {
+                return m_time;
+            }
+        };
+
+        void MapIssuesDialog::showIssues() {
+            wxString summary;
+            if (m_issues.empty())
+                summary = wxT("No issues were found.");
+            else
+                summary << static_cast<unsigned int>(m_issues.size()) << (m_issues.size() == 1 ? wxT(" issue was found.") : wxT(" issues were found.")) << wxT(" Select issues to select the affected brushes.");
+            m_summaryText->SetLabel(summary);
+
+            m_issueList->Freeze();
+            for (size_t i = 0; i < m_issues.size(); i++) {
+                const Model::MapIssue& issue = m_issues[i];
+                wxString line;
+                line << static_cast<unsigned int>(issue.brush().fileLine());
+                const long index = m_issueList->InsertItem(static_cast<long>(i), line);
+                m_issueList->SetItem(index, 1, wxString(issue.description()));
+                m_issueList->SetItemData(index, static_cast<long>(i));
+            }
+            m_issueList->Thaw();
+        }
+
+        MapIssuesDialog::MapIssuesDialog() :
+        wxDialog(),
+        m_document(NULL),
+        m_validationThread(NULL),
+        m_summaryText(NULL),
+        m_issueList(NULL) {}
+
+        MapIssuesDialog::MapIssuesDialog(wxWindow* parent, Model::MapDocument& document) :
+        wxDialog(),
+        m_document(NULL),
+        m_validationThread(NULL),
+        m_summaryText(NULL),
+        m_issueList(NULL) {
+            Create(parent, document);
+        }
+
+        MapIssuesDialog::~MapIssuesDialog() {
+            // the validation cannot be cancelled, but the validator must not outlive the dialog's document
+            if (m_validationThread != NULL) {
+                m_validationThread->Wait();
+                delete m_validationThread;
+                m_validationThread = NULL;
+            }
+        }
+
+        void MapIssuesDialog::Create(wxWindow* parent, Model::MapDocument& document) {
+            wxDialog::Create(parent, wxID_ANY, wxT("Map Issues"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
+            m_document = &document;
+
+            m_summaryText = new wxStaticText(this, wxID_ANY, wxT("Validating the map..."));
+
+            m_issueList = new wxListCtrl(this, CommandIds::MapIssuesDialog::IssueListId, wxDefaultPosition, wxSize(480, 300), wxLC_REPORT);
+            m_issueList->InsertColumn(0, wxT("Line"));
+            m_issueList->InsertColumn(1, wxT("Issue"));
+            m_issueList->SetColumnWidth(0, 60);
+            m_issueList->SetColumnWidth(1, 400);
+
+            wxSizer* buttonSizer = CreateButtonSizer(wxCLOSE);
+            SetAffirmativeId(wxCLOSE);
+            SetEscapeId(wxCLOSE);
+
+            wxSizer* outerSizer = new wxBoxSizer(wxVERTICAL);
+            outerSizer->Add(m_summaryText, 0, wxEXPAND | wxLEFT | wxTOP | wxRIGHT, LayoutConstants::DialogOuterMargin);
+            outerSizer->AddSpacer(LayoutConstants::ControlVerticalMargin);
+            outerSizer->Add(m_issueList, 1, wxEXPAND | wxLEFT | wxRIGHT, LayoutConstants::DialogOuterMargin);
+            outerSizer->Add(buttonSizer, 0, wxEXPAND | wxALL, LayoutConstants::DialogButtonMargin);
+
+            SetSizerAndFit(outerSizer);
+
+            // the dialog is modal, so the map cannot change while the worker reads it
+            Bind(wxEVT_COMMAND_THREAD, &MapIssuesDialog::OnValidationFinished, this);
+            m_validationThread = new MapValidationThread(*this, document);
+            if (m_validationThread->Create() != wxTHREAD_NO_ERROR || m_validationThread->Run() != wxTHREAD_NO_ERROR) {
+                delete m_validationThread;
+                m_validationThread = NULL;
+
+                Model::MapValidator validator(document.map(), document.octree());
+                m_issues = validator.validate(1);
+                showIssues();
+            }
+        }
+
+        void MapIssuesDialog::OnValidationFinished(wxThreadEvent& event) {
+            if (m_validationThread == NULL)
+                return;
+
+            m_validationThread->Wait();
+            m_issues.swap(m_validationThread->issues());
+            m_document->console().info("Found %u issues in %f seconds", static_cast<unsigned int>(m_issues.size()), m_validationThread->time() / 1000.0f);
+            delete m_validationThread;
+            m_validationThread = NULL;
+
+            showIssues();
+        }
+
+        void MapIssuesDialog::OnIssueSelectionChanged(wxListEvent& event) {
+            Model::BrushSet brushSet;
+            Model::BrushList brushes;
+            long index = m_issueList->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+            while (index != -1) {
+                Model::Brush& brush = m_issues[static_cast<size_t>(m_issueList->GetItemData(index))].brush();
+                if (brushSet.insert(&brush).second)
+                    brushes.push_back(&brush);
+                index = m_issueList->GetNextItem(index, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+            }
+
+            if (brushes.empty())
+                return;
+
+            Controller::ChangeEditStateCommand* command = Controller::ChangeEditStateCommand::replace(*m_document, brushes);
+            m_document->GetCommandProcessor()->Submit(command);
+        }
+
+        void MapIssuesDialog::OnCloseClicked(wxCommandEvent& event) {
+            EndModal(wxID_CLOSE);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__MapIssuesDialog__
+#define __TrenchBroom__MapIssuesDialog__
+
+#include "Model/MapValidator.h"
+
+#include <wx/dialog.h>
+
+class wxListCtrl;
+class wxListEvent;
+class wxStaticText;
+class wxThreadEvent;
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapDocument;
+    }
+
+    namespace View {
+        class MapValidationThread;
+
+        // Validates the map on a worker thread while it is shown and lists the issues found once the validation has
+        // finished. Selecting issues selects their brushes.
+        class MapIssuesDialog : public wxDialog {
+        private:
+            DECLARE_DYNAMIC_CLASS(MapIssuesDialog)
+        protected:
+            Model::MapDocument* m_document;
+            Model::MapIssue::List m_issues;
+            MapValidationThread* m_validationThread;
+            wxStaticText* m_summaryText;
+            wxListCtrl* m_issueList;
+
+            void showIssues();
+        public:
+            MapIssuesDialog();
+            MapIssuesDialog(wxWindow* parent, Model::MapDocument& document);
+            ~MapIssuesDialog();
+
+            void Create(wxWindow* parent, Model::MapDocument& document);
+
+            void OnValidationFinished(wxThreadEvent& event);
+            void OnIssueSelectionChanged(wxListEvent& event);
+            void OnCloseClicked(wxCommandEvent& event);
+
+            DECLARE_EVENT_TABLE();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapIssuesDialog__) */
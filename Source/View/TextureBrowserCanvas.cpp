@@ -22,10 +22,10 @@
 #include "IO/FileManager.h"
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
+#include "Renderer/Palette.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/TextureRenderer.h"
-#include "Renderer/TextureRendererManager.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
@@ -39,28 +39,84 @@
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 #include "View/TextureSelectedCommand.h"
+#include "View/TextureThumbnailLoader.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace View {
+        namespace TextureBrowserCanvasUniforms {
+            static const Renderer::Uniform ApplyTinting("ApplyTinting");
+            static const Renderer::Uniform Brightness("Brightness");
+            static const Renderer::Uniform Texture("Texture");
+            static const Renderer::Uniform GrayScale("GrayScale");
+            static const Renderer::Uniform Color("Color");
+            static const Renderer::Uniform Offset("Offset");
+        }
+
+        void TextureBrowserCanvas::clearThumbnails() {
+            m_thumbnailLoader->clear();
+            ThumbnailMap::iterator it, end;
+            for (it = m_thumbnails.begin(), end = m_thumbnails.end(); it != end; ++it)
+                delete it->second;
+            m_thumbnails.clear();
+        }
+        
+        void TextureBrowserCanvas::uploadThumbnails() {
+            const TextureThumbnailLoader::Result::List results = m_thumbnailLoader->takeResults();
+            if (results.empty())
+                return;
+            
+            const Renderer::Palette& palette = m_documentViewHolder.document().sharedResources().palette();
+            for (size_t i = 0; i < results.size(); i++) {
+                const TextureThumbnailLoader::Result& result = results[i];
+                IO::Mip* mip = result.mip;
+                if (m_thumbnails.count(result.texture) > 0) {
+                    delete mip;
+                    continue;
+                }
+                
+                Renderer::TextureRenderer* thumbnail = NULL;
+                if (mip != NULL) {
+                    const size_t pixelCount = mip->width() * mip->height();
+                    unsigned char* rgbImage = new unsigned char[pixelCount * 3];
+                    Color averageColor;
+                    palette.indexedToRgb(mip->mip0(), rgbImage, pixelCount, averageColor);
+                    thumbnail = new Renderer::TextureRenderer(rgbImage, averageColor, mip->width(), mip->height());
+                    delete mip;
+                }
+                m_thumbnails[result.texture] = thumbnail;
+            }
+        }
+        
+        unsigned int TextureBrowserCanvas::thumbnailLevel(const Model::Texture& texture, const LayoutBounds& bounds) const {
+            // use the smallest mip that is still at least as large as the cell
+            const unsigned int textureSize = std::max(texture.width(), texture.height());
+            const unsigned int cellSize = static_cast<unsigned int>(std::ceil(std::max(bounds.width(), bounds.height())));
+            unsigned int level = 0;
+            while (level < 3 && (textureSize >> (level + 1)) >= cellSize)
+                level++;
+            return level;
+        }
+        
         void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font) {
             if ((!m_hideUnused || texture->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(texture->name(), m_filterText, false))) {
                 Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
                 const float maxCellWidth = layout.maxCellWidth();
                 const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, texture->name(), maxCellWidth, 5);
-                const Vec2f actualSize = fontManager.font(actualFont)->measure(texture->name());
+                Renderer::Text::TexturedFont* actualTexturedFont = fontManager.font(actualFont);
+                const Vec2f actualSize = actualTexturedFont->measure(texture->name());
 
                 Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
                 const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
                 const unsigned int scaledTextureWidth = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->width())));
                 const unsigned int scaledTextureHeight = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->height())));
 
-                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
-                Renderer::TextureRenderer& textureRenderer = textureRendererManager.renderer(texture);
-                layout.addItem(TextureCellData(texture, &textureRenderer, actualFont), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
+                layout.addItem(TextureCellData(texture, actualFont, actualTexturedFont->quads(texture->name(), false)), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
             }
         }
 
@@ -109,12 +165,15 @@ namespace TrenchBroom {
         }
 
         void TextureBrowserCanvas::doClear() {
+            clearThumbnails();
         }
 
         void TextureBrowserCanvas::doRender(Layout& layout, float y, float height) {
             if (m_vbo == NULL)
                 m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
 
+            uploadThumbnails();
+
             Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
             Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
 
@@ -134,83 +193,84 @@ namespace TrenchBroom {
             const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, 0.1f));
             Renderer::Transformation transformation(projection, view);
 
-            size_t visibleGroupCount = 0;
-            size_t visibleItemCount = 0;
+            // the groups and rows are sorted by their y coordinates, so the visible ones can be found by binary search
+            typedef std::vector<const Layout::Group*> GroupList;
+            typedef std::vector<const Layout::Group::Row::Cell*> CellList;
+            GroupList visibleGroups;
+            CellList visibleCells;
+            
+            for (size_t i = layout.indexOfGroupAt(y); i < layout.size(); i++) {
+                const Layout::Group& group = layout[i];
+                if (group.bounds().top() > y + height)
+                    break;
+                visibleGroups.push_back(&group);
+                
+                for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    if (row.bounds().top() > y + height)
+                        break;
+                    for (size_t k = 0; k < row.size(); k++)
+                        visibleCells.push_back(&row[k]);
+                }
+            }
 
             typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
             StringMap stringVertices;
 
-            for (unsigned int i = 0; i < layout.size(); i++) {
-                const Layout::Group& group = layout[i];
-                if (group.intersectsY(y, height)) {
-                    visibleGroupCount++;
-
-                    Model::TextureCollection* collection = group.item();
-                    if (collection != NULL && !collection->name().empty()) {
-                        const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                        const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                        Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
-                        Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
-                        Vec2f::List& vertices = stringVertices[defaultDescriptor];
-                        vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                    }
-
-                    for (unsigned int j = 0; j < group.size(); j++) {
-                        const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                            }
-                        }
-                    }
+            for (size_t i = 0; i < visibleGroups.size(); i++) {
+                const Layout::Group& group = *visibleGroups[i];
+                Model::TextureCollection* collection = group.item();
+                if (collection != NULL && !collection->name().empty()) {
+                    const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                    const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+
+                    Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
+                    Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
+                    Vec2f::List& vertices = stringVertices[defaultDescriptor];
+                    vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
+                }
+            }
+            
+            for (size_t i = 0; i < visibleCells.size(); i++) {
+                const Layout::Group::Row::Cell& cell = *visibleCells[i];
+                const LayoutBounds& titleBounds = cell.titleBounds();
+                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+
+                // the title vertices are cached in the cell and alternate between positions and texture coordinates
+                const Vec2f::List& titleVertices = cell.item().titleVertices;
+                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
+                vertices.reserve(vertices.size() + titleVertices.size());
+                for (size_t j = 0; j < titleVertices.size(); j += 2) {
+                    vertices.push_back(titleVertices[j] + offset);
+                    vertices.push_back(titleVertices[j + 1]);
                 }
             }
 
-            if (visibleItemCount > 0) { // render borders
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleItemCount);
+            if (!visibleCells.empty()) { // render borders
+                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleCells.size());
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
                                                   Renderer::Attribute::position2f(),
                                                   Renderer::Attribute::color4f());
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-
-                                    bool selected = cell.item().texture == m_selectedTexture;
-                                    bool inUse = cell.item().texture->usageCount() > 0;
-                                    bool overridden = cell.item().texture->overridden();
-
-                                    if (selected || inUse || overridden) {
-                                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
-
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                    }
-                                }
-                            }
-                        }
+                for (size_t i = 0; i < visibleCells.size(); i++) {
+                    const Layout::Group::Row::Cell& cell = *visibleCells[i];
+
+                    bool selected = cell.item().texture == m_selectedTexture;
+                    bool inUse = cell.item().texture->usageCount() > 0;
+                    bool overridden = cell.item().texture->overridden();
+
+                    if (selected || inUse || overridden) {
+                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
+
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                        vertexArray.addAttribute(color);
                     }
                 }
 
@@ -220,60 +280,66 @@ namespace TrenchBroom {
             }
 
             { // render textures
+                TextureThumbnailLoader::Request::List requests;
+                
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
-                shader.setUniformVariable("ApplyTinting", false);
-                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
-                                    shader.setUniformVariable("Texture", 0);
-                                    cell.item().textureRenderer->activate();
-                                    glBegin(GL_QUADS);
-                                    glTexCoord2f(0.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
-                                    glTexCoord2f(0.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
-                                    glEnd();
-                                    cell.item().textureRenderer->deactivate();
-                                }
-                            }
-                        }
+                shader.setUniformVariable(TextureBrowserCanvasUniforms::ApplyTinting, false);
+                shader.setUniformVariable(TextureBrowserCanvasUniforms::Brightness, prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable(TextureBrowserCanvasUniforms::Texture, 0);
+                for (size_t i = 0; i < visibleCells.size(); i++) {
+                    const Layout::Group::Row::Cell& cell = *visibleCells[i];
+                    const Model::Texture* texture = cell.item().texture;
+                    
+                    ThumbnailMap::const_iterator it = m_thumbnails.find(texture);
+                    if (it == m_thumbnails.end()) {
+                        requests.push_back(TextureThumbnailLoader::Request(texture, texture->collection().path(), texture->name(), thumbnailLevel(*texture, cell.itemBounds())));
+                        continue;
                     }
+                    
+                    Renderer::TextureRenderer* thumbnail = it->second;
+                    if (thumbnail == NULL)
+                        continue;
+                    
+                    shader.setUniformVariable(TextureBrowserCanvasUniforms::GrayScale, texture->overridden());
+                    thumbnail->activate();
+                    glBegin(GL_QUADS);
+                    glTexCoord2f(0.0f, 0.0f);
+                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
+                    glTexCoord2f(0.0f, 1.0f);
+                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
+                    glTexCoord2f(1.0f, 1.0f);
+                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
+                    glTexCoord2f(1.0f, 0.0f);
+                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
+                    glEnd();
+                    thumbnail->deactivate();
                 }
+                
+                // the loader serves the last request first, but the topmost thumbnails should appear first
+                std::reverse(requests.begin(), requests.end());
+                m_thumbnailLoader->setRequests(requests);
             }
 
-            if (visibleGroupCount > 0) { // render group title background
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
+            if (!visibleGroups.empty()) { // render group title background
+                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroups.size());
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
                                                   Renderer::Attribute::position2f());
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        if (group.item() != NULL) {
-                            LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
-                        }
+                for (size_t i = 0; i < visibleGroups.size(); i++) {
+                    const Layout::Group& group = *visibleGroups[i];
+                    if (group.item() != NULL) {
+                        LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
                     }
                 }
 
                 Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::BrowserGroupShader);
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserGroupBackgroundColor));
+                shader.setUniformVariable(TextureBrowserCanvasUniforms::Color, prefs.getColor(Preferences::BrowserGroupBackgroundColor));
                 vertexArray.render();
             }
 
@@ -283,6 +349,8 @@ namespace TrenchBroom {
                     const Renderer::Text::FontDescriptor& descriptor = it->first;
                     Renderer::Text::TexturedFont* font = fontManager.font(descriptor);
                     const Vec2f::List& vertices = it->second;
+                    if (vertices.empty())
+                        continue;
 
                     unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
                     Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
@@ -294,8 +362,9 @@ namespace TrenchBroom {
 
                     Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                     Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
-                    shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
-                    shader.setUniformVariable("Texture", 0);
+                    shader.setUniformVariable(TextureBrowserCanvasUniforms::Color, prefs.getColor(Preferences::BrowserTextColor));
+                    shader.setUniformVariable(TextureBrowserCanvasUniforms::Texture, 0);
+                    shader.setUniformVariable(TextureBrowserCanvasUniforms::Offset, Vec3f::Null);
 
                     font->activate();
                     vertexArray.render();
@@ -329,6 +398,10 @@ namespace TrenchBroom {
             return tooltip;
         }
 
+        void TextureBrowserCanvas::OnThumbnailsLoaded(wxThreadEvent& event) {
+            Refresh();
+        }
+
         TextureBrowserCanvas::TextureBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder) :
         CellLayoutGLCanvas(parent, windowId, documentViewHolder.document().sharedResources().attribs(), documentViewHolder.document().sharedResources().sharedContext(), scrollBar),
         m_documentViewHolder(documentViewHolder),
@@ -336,10 +409,16 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::TextureSortOrder::Name),
-        m_vbo() {}
+        m_vbo(NULL),
+        m_thumbnailLoader(new TextureThumbnailLoader(*this)) {
+            Bind(wxEVT_COMMAND_THREAD, &TextureBrowserCanvas::OnThumbnailsLoaded, this);
+        }
 
         TextureBrowserCanvas::~TextureBrowserCanvas() {
+            m_thumbnailLoader->stop();
             clear();
+            delete m_thumbnailLoader;
+            m_thumbnailLoader = NULL;
             m_selectedTexture = NULL;
             delete m_vbo;
             m_vbo = NULL;
@@ -21,8 +21,11 @@
 #define __TrenchBroom__TextureBrowserCanvas__
 
 #include "Model/TextureManager.h"
+#include "Utility/VecMath.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <map>
+
 namespace TrenchBroom {
     namespace Model {
         class Texture;
@@ -47,23 +50,26 @@ namespace TrenchBroom {
     
     namespace View {
         class DocumentViewHolder;
+        class TextureThumbnailLoader;
 
         typedef Model::TextureCollection* TextureGroupData;
 
         class TextureCellData {
         public:
             Model::Texture* texture;
-            Renderer::TextureRenderer* textureRenderer;
             Renderer::Text::FontDescriptor fontDescriptor;
+            Vec2f::List titleVertices; // glyph quads of the title, relative to the title's origin
             
-            TextureCellData(Model::Texture* i_texture, Renderer::TextureRenderer* i_textureRenderer, const Renderer::Text::FontDescriptor& i_fontDescriptor) :
+            TextureCellData(Model::Texture* i_texture, const Renderer::Text::FontDescriptor& i_fontDescriptor, const Vec2f::List& i_titleVertices) :
             texture(i_texture),
-            textureRenderer(i_textureRenderer),
-            fontDescriptor(i_fontDescriptor) {}
+            fontDescriptor(i_fontDescriptor),
+            titleVertices(i_titleVertices) {}
         };
         
         class TextureBrowserCanvas : public CellLayoutGLCanvas<TextureCellData, TextureGroupData> {
         protected:
+            typedef std::map<const Model::Texture*, Renderer::TextureRenderer*> ThumbnailMap;
+            
             DocumentViewHolder& m_documentViewHolder;
             Model::Texture* m_selectedTexture;
             
@@ -73,6 +79,13 @@ namespace TrenchBroom {
             String m_filterText;
             Renderer::Vbo* m_vbo;
             
+            TextureThumbnailLoader* m_thumbnailLoader;
+            ThumbnailMap m_thumbnails; // contains NULL for textures that could not be loaded
+            
+            void clearThumbnails();
+            void uploadThumbnails();
+            unsigned int thumbnailLevel(const Model::Texture& texture, const LayoutBounds& bounds) const;
+            
             void addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font);
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
@@ -80,6 +93,8 @@ namespace TrenchBroom {
             virtual void doRender(Layout& layout, float y, float height);
             virtual void handleLeftClick(Layout& layout, float x, float y);
             virtual wxString tooltip(const Layout::Group::Row::Cell& cell);
+            
+            void OnThumbnailsLoaded(wxThreadEvent& event);
         public:
             TextureBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder);
             ~TextureBrowserCanvas();
@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureThumbnailLoader.h"
+
+#include "IO/Wad.h"
+#include "Utility/Map.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace View {
+        IO::Mip* TextureThumbnailLoader::load(const Request& request) {
+            try {
+                IO::Wad* wad = NULL;
+                WadMap::iterator it = m_wads.find(request.path);
+                if (it == m_wads.end()) {
+                    wad = new IO::Wad(request.path);
+                    m_wads[request.path] = wad;
+                } else {
+                    wad = it->second;
+                }
+                return wad->loadMipLevel(request.name, request.level);
+            } catch (IO::IOException&) {
+                return NULL;
+            }
+        }
+
+        wxThread::ExitCode TextureThumbnailLoader::Entry() {
+            while (true) {
+                m_semaphore.Wait();
+                
+                while (true) {
+                    Request::List requests;
+                    unsigned int generation;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_stopped)
+                            return (wxThread::ExitCode)0;
+                        if (m_discardWads) {
+                            Utility::deleteAll(m_wads);
+                            m_discardWads = false;
+                        }
+                        if (m_requests.empty())
+                            break;
+                        requests.push_back(m_requests.back());
+                        m_requests.pop_back();
+                        generation = m_generation;
+                    }
+                    
+                    const Request& request = requests.front();
+                    IO::Mip* mip = load(request);
+                    
+                    bool notify = false;
+                    {
+                        wxCriticalSectionLocker lock(m_lock);
+                        if (m_stopped) {
+                            delete mip;
+                            return (wxThread::ExitCode)0;
+                        }
+                        if (generation != m_generation) {
+                            delete mip;
+                        } else {
+                            // results for textures that cannot be loaded are delivered too, otherwise they would be requested again
+                            m_results.push_back(Result(request.texture, mip));
+                            notify = m_results.size() == 1;
+                        }
+                    }
+                    
+                    if (notify)
+                        m_handler.QueueEvent(new wxThreadEvent(wxEVT_COMMAND_THREAD));
+                }
+            }
+            
+            return (wxThread::ExitCode)0;
+        }
+        
+        TextureThumbnailLoader::TextureThumbnailLoader(wxEvtHandler& handler) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_handler(handler),
+        m_generation(0),
+        m_discardWads(false),
+        m_stopped(false) {
+            Create();
+            Run();
+        }
+        
+        TextureThumbnailLoader::~TextureThumbnailLoader() {
+            assert(m_stopped);
+            clear();
+            Utility::deleteAll(m_wads);
+        }
+
+        void TextureThumbnailLoader::setRequests(const Request::List& requests) {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                m_requests = requests;
+            }
+            if (!requests.empty())
+                m_semaphore.Post();
+        }
+        
+        void TextureThumbnailLoader::clear() {
+            wxCriticalSectionLocker lock(m_lock);
+            m_requests.clear();
+            for (size_t i = 0; i < m_results.size(); i++)
+                delete m_results[i].mip;
+            m_results.clear();
+            m_generation++;
+            m_discardWads = true;
+        }
+
+        TextureThumbnailLoader::Result::List TextureThumbnailLoader::takeResults() {
+            Result::List results;
+            wxCriticalSectionLocker lock(m_lock);
+            results.swap(m_results);
+            return results;
+        }
+        
+        void TextureThumbnailLoader::stop() {
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                if (m_stopped)
+                    return;
+                m_stopped = true;
+            }
+            m_semaphore.Post();
+            Wait();
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__TextureThumbnailLoader__
+#define __TrenchBroom__TextureThumbnailLoader__
+
+#include "Utility/String.h"
+
+#include <map>
+#include <vector>
+
+#include <wx/event.h>
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        class Mip;
+        class Wad;
+    }
+    
+    namespace Model {
+        class Texture;
+    }
+    
+    namespace View {
+        // Reads reduced size mips of textures from their wads on a worker thread. The loaded mips are still indexed
+        // so that the palette is only ever touched on the main thread. Whenever new mips are available, a wxThreadEvent
+        // is queued to the given handler, which should then collect them using takeResults.
+        class TextureThumbnailLoader : public wxThread {
+        public:
+            class Request {
+            public:
+                typedef std::vector<Request> List;
+                
+                const Model::Texture* texture;
+                String path;
+                String name;
+                unsigned int level;
+                
+                Request(const Model::Texture* i_texture, const String& i_path, const String& i_name, unsigned int i_level) :
+                texture(i_texture),
+                path(i_path),
+                name(i_name),
+                level(i_level) {}
+            };
+            
+            class Result {
+            public:
+                typedef std::vector<Result> List;
+                
+                const Model::Texture* texture;
+                IO::Mip* mip;
+                
+                Result(const Model::Texture* i_texture, IO::Mip* i_mip) :
+                texture(i_texture),
+                mip(i_mip) {}
+            };
+        private:
+            typedef std::map<String, IO::Wad*> WadMap;
+            
+            wxEvtHandler& m_handler;
+            wxCriticalSection m_lock;
+            wxSemaphore m_semaphore;
+            Request::List m_requests;
+            Result::List m_results;
+            unsigned int m_generation;
+            bool m_discardWads;
+            bool m_stopped;
+            
+            WadMap m_wads; // only accessed by the worker thread
+            
+            IO::Mip* load(const Request& request);
+            ExitCode Entry();
+        public:
+            TextureThumbnailLoader(wxEvtHandler& handler);
+            ~TextureThumbnailLoader();
+            
+            // replaces all pending requests, the last request is served first
+            void setRequests(const Request::List& requests);
+            void clear();
+            Result::List takeResults();
+            
+            // stops and joins the worker thread, must be called before the loader is deleted
+            void stop();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureThumbnailLoader__) */
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VertexHandleGridTest_h
+#define TrenchBroom_VertexHandleGridTest_h
+
+#include "TestSuite.h"
+#include "Controller/VertexHandleManager.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Controller {
+        class VertexHandleGridTest : public TestSuite<VertexHandleGridTest> {
+        private:
+            static bool containsHandle(const VertexHandleGrid::CandidateList& candidates, const Vec3f& position) {
+                for (size_t i = 0; i < candidates.size(); i++) {
+                    const VertexHandleGrid::HandleList& handles = *candidates[i].handles;
+                    for (size_t j = 0; j < handles.size(); j++)
+                        if (handles[j].position.equals(position))
+                            return true;
+                }
+                return false;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&VertexHandleGridTest::testFindCandidates);
+                registerTestCase(&VertexHandleGridTest::testDiagonalRay);
+            }
+        public:
+            void testFindCandidates() {
+                VertexHandleGrid grid(64.0f);
+                grid.add(Vec3f(500.0f, 0.0f, 0.0f), Model::HitType::VertexHandleHit);
+                grid.add(Vec3f(100.0f, 2.0f, 0.0f), Model::HitType::VertexHandleHit);
+                grid.add(Vec3f(300.0f, 0.0f, -3.0f), Model::HitType::EdgeHandleHit);
+                grid.add(Vec3f(300.0f, 300.0f, 0.0f), Model::HitType::VertexHandleHit);
+                grid.add(Vec3f(-200.0f, 0.0f, 0.0f), Model::HitType::VertexHandleHit);
+                grid.add(Vec3f(2000.0f, 0.0f, 0.0f), Model::HitType::VertexHandleHit);
+                
+                const Rayf ray(Vec3f(10.0f, 0.0f, 0.0f), Vec3f::PosX);
+                VertexHandleGrid::CandidateList candidates;
+                grid.findCandidates(ray, 0.02f, 1000.0f, candidates);
+                
+                assert(containsHandle(candidates, Vec3f(100.0f, 2.0f, 0.0f)));
+                assert(containsHandle(candidates, Vec3f(300.0f, 0.0f, -3.0f)));
+                assert(containsHandle(candidates, Vec3f(500.0f, 0.0f, 0.0f)));
+                
+                // too far from the ray, behind its origin or beyond the maximum distance
+                assert(!containsHandle(candidates, Vec3f(300.0f, 300.0f, 0.0f)));
+                assert(!containsHandle(candidates, Vec3f(-200.0f, 0.0f, 0.0f)));
+                assert(!containsHandle(candidates, Vec3f(2000.0f, 0.0f, 0.0f)));
+                
+                assert(candidates.size() == 3);
+                for (size_t i = 1; i < candidates.size(); i++)
+                    assert(candidates[i - 1].distance <= candidates[i].distance);
+                assert((*candidates[0].handles)[0].position.equals(Vec3f(100.0f, 2.0f, 0.0f)));
+                assert((*candidates[2].handles)[0].position.equals(Vec3f(500.0f, 0.0f, 0.0f)));
+            }
+            
+            void testDiagonalRay() {
+                VertexHandleGrid grid(64.0f);
+                grid.add(Vec3f(-400.0f, -400.0f, -400.0f), Model::HitType::VertexHandleHit);
+                grid.add(Vec3f(-100.0f, -100.0f, -100.0f), Model::HitType::FaceHandleHit);
+                grid.add(Vec3f(-100.0f, 100.0f, -100.0f), Model::HitType::FaceHandleHit);
+                
+                const Rayf ray(Vec3f::Null, Vec3f(-1.0f, -1.0f, -1.0f).normalized());
+                VertexHandleGrid::CandidateList candidates;
+                grid.findCandidates(ray, 0.02f, 1000.0f, candidates);
+                
+                assert(candidates.size() == 2);
+                assert((*candidates[0].handles)[0].position.equals(Vec3f(-100.0f, -100.0f, -100.0f)));
+                assert((*candidates[1].handles)[0].position.equals(Vec3f(-400.0f, -400.0f, -400.0f)));
+            }
+        };
+    }
+}
+
+#endif
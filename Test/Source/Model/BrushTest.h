@@ -0,0 +1,87 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushTest_h
+#define TrenchBroom_BrushTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushTest : public TestSuite<BrushTest> {
+        private:
+            // the fast path of Brush::transform keeps the vertex order, a rebuild recomputes the vertices from the planes
+            static bool verticesKept(const Vec3f::List& before, const Brush& brush, const Mat4f& pointTransform) {
+                const Vec3f::List& vertices = brush.vertices();
+                if (vertices.size() != before.size())
+                    return false;
+                for (size_t i = 0; i < vertices.size(); i++)
+                    if (!vertices[i].equals(pointTransform * before[i]))
+                        return false;
+                return true;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BrushTest::testRotate90KeepsGeometry);
+                registerTestCase(&BrushTest::testRotate45RebuildsGeometry);
+            }
+        public:
+            void testRotate90KeepsGeometry() {
+                const BBoxf worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f));
+                Brush brush(worldBounds, true, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 32.0f, 16.0f)), NULL);
+                const Vec3f::List before = brush.vertices();
+                
+                // built like TransformObjectsCommand::rotateObjects does, but without snapping the rotation
+                const Vec3f center(32.0f, 16.0f, 8.0f);
+                const Mat4f vectorTransform = rotationMatrix(Math<float>::PiOverTwo, Vec3f::PosZ);
+                const Mat4f pointTransform = translationMatrix(center) * vectorTransform * translationMatrix(-center);
+                assert(vectorTransform[0][0] != 0.0f);
+                
+                brush.transform(pointTransform, vectorTransform, false, false);
+                
+                assert(verticesKept(before, brush, pointTransform));
+                assert(brush.vertices().size() == 8);
+                assert(brush.faces().size() == 6);
+                assert(brush.bounds().min.equals(Vec3f(16.0f, -16.0f, 0.0f)));
+                assert(brush.bounds().max.equals(Vec3f(48.0f, 48.0f, 16.0f)));
+            }
+            
+            void testRotate45RebuildsGeometry() {
+                const BBoxf worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f));
+                Brush brush(worldBounds, true, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 32.0f, 16.0f)), NULL);
+                const Vec3f::List before = brush.vertices();
+                
+                const Mat4f vectorTransform = rotationMatrix(Math<float>::PiOverFour, Vec3f::PosZ);
+                brush.transform(vectorTransform, vectorTransform, false, false);
+                
+                assert(!verticesKept(before, brush, vectorTransform));
+                assert(brush.faces().size() == 6);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_OcclusionBufferTest_h
+#define TrenchBroom_OcclusionBufferTest_h
+
+#include "TestSuite.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class OcclusionBufferTest : public TestSuite<OcclusionBufferTest> {
+        private:
+            static const size_t BufferWidth = 256;
+            static const size_t BufferHeight = 192;
+
+            // a camera at the origin that looks down the X axis, built like Camera::validate does
+            static Mat4f viewProjection() {
+                const Mat4f projection = perspectiveMatrix(90.0f, 1.0f, 8192.0f, static_cast<int>(BufferWidth), static_cast<int>(BufferHeight));
+                return projection * viewMatrix(Vec3f::PosX, Vec3f::PosZ) * translationMatrix(Vec3f::Null);
+            }
+
+            // a square wall facing the camera at a distance of 256 units
+            static void addWall(OcclusionBuffer& buffer) {
+                Vec3f::List wall;
+                wall.push_back(Vec3f(256.0f, -128.0f, -128.0f));
+                wall.push_back(Vec3f(256.0f,  128.0f, -128.0f));
+                wall.push_back(Vec3f(256.0f,  128.0f,  128.0f));
+                wall.push_back(Vec3f(256.0f, -128.0f,  128.0f));
+                buffer.addOccluder(wall);
+            }
+
+            static void checkWall(bool vectorized) {
+                OcclusionBuffer buffer;
+                buffer.setVectorized(vectorized);
+                assert(buffer.vectorized() == vectorized);
+
+                buffer.clear(viewProjection(), BufferWidth, BufferHeight);
+                assert(buffer.visible(BBoxf(Vec3f(512.0f, -32.0f, -32.0f), Vec3f(576.0f, 32.0f, 32.0f))));
+
+                addWall(buffer);
+
+                // the wall covers the center of the view with the reciprocal of its distance
+                const float centerDepth = buffer.depth(BufferWidth / 2, BufferHeight / 2);
+                assert(centerDepth > 0.0f && centerDepth <= 1.0f / 256.0f);
+                assert(buffer.depth(0, 0) == 0.0f);
+                assert(buffer.depth(BufferWidth - 1, BufferHeight - 1) == 0.0f);
+
+                // behind the wall
+                assert(!buffer.visible(BBoxf(Vec3f(512.0f, -32.0f, -32.0f), Vec3f(576.0f, 32.0f, 32.0f))));
+                assert(!buffer.visible(BBoxf(Vec3f(300.0f, -100.0f, -100.0f), Vec3f(1024.0f, 100.0f, 100.0f))));
+
+                // in front of the wall, reaching through it, and behind it but next to it
+                assert(buffer.visible(BBoxf(Vec3f(128.0f, -16.0f, -16.0f), Vec3f(160.0f, 16.0f, 16.0f))));
+                assert(buffer.visible(BBoxf(Vec3f(200.0f, -32.0f, -32.0f), Vec3f(300.0f, 32.0f, 32.0f))));
+                assert(buffer.visible(BBoxf(Vec3f(512.0f, 300.0f, -32.0f), Vec3f(576.0f, 364.0f, 32.0f))));
+
+                // partly behind the camera
+                assert(buffer.visible(BBoxf(Vec3f(-64.0f, -32.0f, -32.0f), Vec3f(576.0f, 32.0f, 32.0f))));
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&OcclusionBufferTest::testWallScalar);
+                registerTestCase(&OcclusionBufferTest::testWallVectorized);
+                registerTestCase(&OcclusionBufferTest::testScalarMatchesVectorized);
+            }
+        public:
+            void testWallScalar() {
+                checkWall(false);
+            }
+
+            void testWallVectorized() {
+                if (OcclusionBuffer::vectorizationAvailable())
+                    checkWall(true);
+            }
+
+            void testScalarMatchesVectorized() {
+                if (!OcclusionBuffer::vectorizationAvailable())
+                    return;
+
+                OcclusionBuffer scalar;
+                scalar.setVectorized(false);
+                scalar.clear(viewProjection(), BufferWidth, BufferHeight);
+                addWall(scalar);
+
+                OcclusionBuffer vectorized;
+                vectorized.clear(viewProjection(), BufferWidth, BufferHeight);
+                addWall(vectorized);
+
+                assert(scalar.width() == vectorized.width() && scalar.height() == vectorized.height());
+                for (size_t y = 0; y < scalar.height(); y++)
+                    for (size_t x = 0; x < scalar.width(); x++)
+                        assert(scalar.depth(x, y) == vectorized.depth(x, y));
+            }
+        };
+    }
+}
+
+#endif
@@ -20,6 +20,9 @@
 #include <iostream>
 
 #include "TestSuite.h"
+#include "Controller/VertexHandleGridTest.h"
+#include "Model/BrushTest.h"
+#include "Renderer/OcclusionBufferTest.h"
 #include "Utility/FindIntegerPlanePointsTest.h"
 #include "Utility/MatTest.h"
 #include "Utility/PlaneTest.h"
@@ -36,6 +39,15 @@ int main(int argc, const char * argv[]) {
 
     VecMath::PlaneTest planeTest;
     planeTest.run();
+
+    Controller::VertexHandleGridTest vertexHandleGridTest;
+    vertexHandleGridTest.run();
+
+    Model::BrushTest brushTest;
+    brushTest.run();
+
+    Renderer::OcclusionBufferTest occlusionBufferTest;
+    occlusionBufferTest.run();
     
     /*
     VecMath::FindIntegerPlanePointsTest planePointsTest;